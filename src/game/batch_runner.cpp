@@ -0,0 +1,112 @@
+#include "batch_runner.h"
+#include "player.h"
+
+#include <algorithm>
+#include <cassert>
+
+BatchRunner::BatchRunner(const BatchRunnerConfig& cfg)
+    : config(cfg), seed_rng(cfg.seed), rounds_to_start(0) {
+    assert(config.num_tables > 0);
+    tables.resize(config.num_tables);
+    for (TableSlot& slot : tables) {
+        slot.round_index = 0;
+        slot.active = false;
+    }
+    pending.reserve(config.num_tables);
+}
+
+void BatchRunner::shuffleWall(uint32_t round_seed, TileIndex* wall) {
+    for (int i = 0; i < 136; ++i) wall[i] = i;
+    std::mt19937 wall_rng(round_seed);
+    std::shuffle(wall, wall + 136, wall_rng);
+}
+
+bool BatchRunner::dealNext(TableSlot& slot) {
+    if (rounds_to_start <= 0) {
+        slot.active = false;
+        return false;
+    }
+    rounds_to_start--;
+
+    slot.round_seed = static_cast<uint32_t>(seed_rng());
+    shuffleWall(slot.round_seed, slot.wall.data());
+    std::array<int, 4> scores;
+    scores.fill(config.start_score);
+    dealSnapshot(slot.state, slot.wall.data(), slot.round_index % 4, Wind::East, 0, 0, scores);
+    slot.state.fast_scoring = config.fast_scoring;
+    slot.round_index++;
+    slot.active = true;
+    return true;
+}
+
+void BatchRunner::start(long rounds) {
+    rounds_to_start += rounds;
+    for (TableSlot& slot : tables) {
+        if (!slot.active && !dealNext(slot)) break;
+    }
+}
+
+void BatchRunner::finishRound(int index) {
+    TableSlot& slot = tables[index];
+    stats.rounds++;
+    if (onRoundEnd) {
+        onRoundEnd(index, slot.round_seed, slot.state, slot.state.getResult());
+    }
+    dealNext(slot);
+}
+
+const std::vector<DecisionRequest>& BatchRunner::collect() {
+    pending.clear();
+    for (int i = 0; i < static_cast<int>(tables.size()); ++i) {
+        TableSlot& slot = tables[i];
+        if (!slot.active) continue;
+        const GameSnapshot& state = slot.state;
+        DecisionRequest request;
+        request.table = i;
+        request.seat = state.getDecisionSeat();
+        request.kind = state.getDecisionKind();
+        request.options = state.getOptions();
+        request.tile = request.kind == DecisionKind::Response ? state.discard : state.drawn;
+        request.state = &slot.state;
+        pending.push_back(request);
+    }
+    return pending;
+}
+
+void BatchRunner::resume(const int* actions) {
+    stats.batches++;
+    stats.decisions += pending.size();
+    stats.max_batch = std::max(stats.max_batch, pending.size());
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const DecisionRequest& request = pending[i];
+        GameSnapshot& state = tables[request.table].state;
+        int action = state.apply(actions[i]);
+        if (onDecision) {
+            onDecision(request.table, request.seat, request.kind, request.options, action);
+        }
+        // 一局结束后立即开下一局，下次 collect 就能提交新局的请求
+        if (state.isFinished()) finishRound(request.table);
+    }
+    pending.clear();
+}
+
+bool BatchRunner::isDone() const {
+    for (const TableSlot& slot : tables) {
+        if (slot.active) return false;
+    }
+    return true;
+}
+
+BatchRunnerStats BatchRunner::run(DecisionEvaluator& evaluator, long rounds) {
+    start(rounds);
+    std::vector<int> actions;
+    while (true) {
+        const std::vector<DecisionRequest>& requests = collect();
+        if (requests.empty()) break;
+        actions.assign(requests.size(), static_cast<int>(Action::Pass));
+        evaluator.evaluate(requests.data(), requests.size(), actions.data());
+        resume(actions.data());
+    }
+    return stats;
+}
@@ -0,0 +1,94 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+#include "snapshot.h"
+
+// 一张牌桌挂起时提交的决策请求
+// state 是整张牌桌的局面，评估器只应读取 seat 能看到的部分 (自己的手牌、牌河、副露等)
+struct DecisionRequest {
+    int table;                  // 牌桌编号
+    int seat;                   // 需要决策的座位
+    DecisionKind kind;
+    int options;                // DecisionOption 位
+    TileIndex tile;             // Action / RiichiDiscard: 摸到的牌；Response: 被响应的弃牌
+    const GameSnapshot* state;  // 在 resume 之前保持有效
+};
+
+// 批量决策: 一次回答所有请求，actions[i] 对应 requests[i] (编码同 Player 的决策返回值)
+class DecisionEvaluator {
+public:
+    virtual ~DecisionEvaluator() {}
+    virtual void evaluate(const DecisionRequest* requests, size_t count, int* actions) = 0;
+};
+
+struct BatchRunnerConfig {
+    int num_tables = 256;       // 同时进行的牌桌数，即每批最多的请求数
+    uint32_t seed = 1;          // 生成每局牌山种子的随机序列
+    int start_score = 25000;    // 每局开始时各家点数
+    bool fast_scoring = false;  // 和牌时按估算番数计分 (不解析役种)
+};
+
+struct BatchRunnerStats {
+    long rounds = 0;       // 已结束的局数
+    long decisions = 0;    // 已回答的请求数
+    long batches = 0;      // resume 次数
+    size_t max_batch = 0;
+};
+
+// 批量对局: 每张牌桌是一个 GameSnapshot，遇到决策就挂起并提交请求，
+// 收齐所有牌桌的请求后一次交给评估器，再用答案恢复各牌桌。
+// 评估器可以在别的线程或进程中运行，调用方只需按 collect -> resume 的顺序交替调用。
+class BatchRunner {
+private:
+    struct TableSlot {
+        GameSnapshot state;
+        std::array<TileIndex, 136> wall;
+        uint32_t round_seed;
+        long round_index;   // 这张牌桌上第几局 (决定庄家)
+        bool active;
+    };
+
+    BatchRunnerConfig config;
+    std::vector<TableSlot> tables;
+    std::vector<DecisionRequest> pending;
+    std::mt19937 seed_rng;
+    long rounds_to_start;   // 还允许开始的局数
+    BatchRunnerStats stats;
+
+public:
+    // 决策实际执行后 (action 为 apply 之后的动作)
+    std::function<void(int table, int seat, DecisionKind kind, int options, int action)> onDecision;
+    // 一局结束后，result 中的 deltas 为本局各家得失点
+    std::function<void(int table, uint32_t round_seed, const GameSnapshot& state, const GameResult& result)> onRoundEnd;
+
+    BatchRunner(const BatchRunnerConfig& cfg = BatchRunnerConfig());
+
+    // 开始最多 rounds 局 (分配到各牌桌)，之前未完成的局继续进行
+    void start(long rounds);
+
+    // 异步协议: 取出当前所有挂起的请求 (每张进行中的牌桌一个)，为空表示全部结束
+    const std::vector<DecisionRequest>& collect();
+    // 按 collect 返回的顺序提交答案，恢复各牌桌直到下一次决策
+    void resume(const int* actions);
+
+    // 同步驱动: 反复 collect / evaluate / resume 直到打完 rounds 局
+    BatchRunnerStats run(DecisionEvaluator& evaluator, long rounds);
+
+    bool isDone() const;
+    const BatchRunnerStats& getStats() const { return stats; }
+    const BatchRunnerConfig& getConfig() const { return config; }
+
+    // 与 Table 相同的牌山生成: 由种子决定 136 张的顺序
+    static void shuffleWall(uint32_t round_seed, TileIndex* wall);
+
+private:
+    bool dealNext(TableSlot& slot);
+    void finishRound(int index);
+};
+
+#endif // BATCH_RUNNER_H
@@ -0,0 +1,143 @@
+#include "danger_tracker.h"
+#include "player.h"
+
+#include <algorithm>
+#include <cstring>
+
+DangerTracker::DangerTracker() {
+    reset();
+}
+
+void DangerTracker::reset() {
+    std::memset(genbutsu, 0, sizeof(genbutsu));
+    std::memset(visible, 0, sizeof(visible));
+    std::memset(riichi, 0, sizeof(riichi));
+    rebuild();
+}
+
+void DangerTracker::rebuild() {
+    for (int seat = 0; seat < 4; ++seat) {
+        for (Tile tile = 0; tile < 34; ++tile) {
+            danger[seat][tile] = static_cast<uint8_t>(evaluate(seat, tile));
+        }
+    }
+}
+
+int DangerTracker::evaluate(int seat, Tile tile) const {
+    if ((genbutsu[seat] >> tile & 1) || visible[tile] >= 4) return 0;
+
+    // 字牌只能单骑或双碰
+    if (tile >= 27) return 4 - std::min<int>(visible[tile], 3);
+
+    int rank = tile % 9;
+    auto safe = [&](Tile t) { return (genbutsu[seat] >> t & 1) != 0; };
+    auto wall = [&](Tile t) { return visible[t] >= 4; };
+
+    // 低侧两面 (tile-2, tile-1) 听 tile-3 / tile，被筋 (tile-3 现物) 或壁排除
+    int open_sides = 0;
+    if (rank >= 3 && !safe(tile - 3) && !wall(tile - 1) && !wall(tile - 2)) open_sides++;
+    if (rank <= 5 && !safe(tile + 3) && !wall(tile + 1) && !wall(tile + 2)) open_sides++;
+
+    int shape = (rank == 0 || rank == 8) ? 1 : (rank == 1 || rank == 7) ? 2 : 3;
+    if (visible[tile] >= 3) shape = std::max(shape - 1, 1);
+    return open_sides * 4 + shape;
+}
+
+void DangerTracker::markSafe(int seat, Tile tile) {
+    if (genbutsu[seat] >> tile & 1) return;
+    genbutsu[seat] |= 1ULL << tile;
+    danger[seat][tile] = 0;
+    // 现物让同一门内前后 3 张成为筋
+    if (tile < 27) {
+        int rank = tile % 9;
+        if (rank >= 3) danger[seat][tile - 3] = static_cast<uint8_t>(evaluate(seat, tile - 3));
+        if (rank <= 5) danger[seat][tile + 3] = static_cast<uint8_t>(evaluate(seat, tile + 3));
+    }
+}
+
+void DangerTracker::refreshAround(Tile tile) {
+    // 可见张数影响本张的形状分和前后 2 张的壁；范围取前后 3 张，不跨门
+    Tile first = tile, last = tile;
+    if (tile < 27) {
+        Tile base = tile - tile % 9;
+        first = std::max<Tile>(base, tile - 3);
+        last = std::min<Tile>(base + 8, tile + 3);
+    }
+    for (int seat = 0; seat < 4; ++seat) {
+        for (Tile t = first; t <= last; ++t) {
+            danger[seat][t] = static_cast<uint8_t>(evaluate(seat, t));
+        }
+    }
+}
+
+void DangerTracker::onDiscard(int seat, TileIndex tile_index) {
+    Tile tile = tile_index / 4;
+    if (visible[tile] < 4) visible[tile]++;
+    refreshAround(tile);
+
+    markSafe(seat, tile);
+    // 立直后他家打出的牌都已通过 (立直振听)
+    for (int other = 0; other < 4; ++other) {
+        if (other != seat && riichi[other]) markSafe(other, tile);
+    }
+}
+
+void DangerTracker::onRiichi(int seat) {
+    riichi[seat] = true;
+}
+
+void DangerTracker::onReveal(TileIndex tile_index) {
+    Tile tile = tile_index / 4;
+    if (visible[tile] < 4) visible[tile]++;
+    refreshAround(tile);
+}
+
+// DangerTrackerHook 实现
+DangerTrackerHook::DangerTrackerHook(Table* t, DangerTracker* d)
+    : table(t), tracker(d), forward(t->getCallbacks()), dora_revealed(0) {
+    revealed.fill(0);
+    GameCallbacks callbacks = forward;
+
+    callbacks.onRoundStart = [this]() {
+        tracker->reset();
+        revealed.fill(0);
+        dora_revealed = 0;
+        revealDora();
+        if (forward.onRoundStart) forward.onRoundStart();
+    };
+
+    callbacks.onDecision = [this](int seat, DecisionKind kind, int options, int action) {
+        if (kind == DecisionKind::RiichiDiscard) tracker->onRiichi(seat);
+        if (forward.onDecision) forward.onDecision(seat, kind, options, action);
+    };
+
+    callbacks.onDiscard = [this](int seat, TileIndex tile) {
+        revealDora();
+        tracker->onDiscard(seat, tile);
+        if (forward.onDiscard) forward.onDiscard(seat, tile);
+    };
+
+    // 副露新增的牌中，除了鸣的那张 (已在牌河里计过) 都是从手里亮出的
+    callbacks.onMeld = [this](int seat, int action, TileIndex tile) {
+        const TileIndexList& open = table->getPlayer(seat)->getHand()->getOpenTiles();
+        for (size_t i = revealed[seat]; i < open.size(); ++i) {
+            if (open[i] != tile) tracker->onReveal(open[i]);
+        }
+        revealed[seat] = open.size();
+        revealDora();
+        if (forward.onMeld) forward.onMeld(seat, action, tile);
+    };
+
+    table->setCallbacks(callbacks);
+}
+
+void DangerTrackerHook::revealDora() {
+    // 只在杠数变化后才有新的指示牌，直接按位置从牌山读取
+    for (int count = table->getDoraCount(); static_cast<int>(dora_revealed) < count; ++dora_revealed) {
+        tracker->onReveal(table->getDoraIndicator(static_cast<int>(dora_revealed)));
+    }
+}
+
+DangerTrackerHook::~DangerTrackerHook() {
+    table->setCallbacks(forward);
+}
@@ -0,0 +1,66 @@
+#ifndef DANGER_TRACKER_H
+#define DANGER_TRACKER_H
+
+#include <array>
+#include <cstdint>
+#include "types.h"
+#include "table.h"
+
+// 各家对每种牌的危险度 (放铳风险的粗略估计)，随牌桌事件增量维护
+// 危险度只用场上公开的信息: 现物、筋、壁 (四张可见的 No Chance)、立直后的通过牌
+//   0      现物 / 立直后通过 / 四张都已可见
+//   1-4    字牌，按可见张数递减 (只剩单骑、双碰)
+//   1-11   数牌 = 未排除的两面方向 * 4 + 形状分 (幺九 1，二八 2，三至七 3)，已见 3 张时形状分减 1
+// 每个事件只影响同一门内前后 3 张以内的牌，更新为常数次
+class DangerTracker {
+private:
+    TileMask genbutsu[4];       // 对该家安全的牌 (自己打过的、立直后他家通过的)
+    uint8_t visible[34];        // 牌河、副露、宝牌指示牌中可见的张数
+    bool riichi[4];
+    uint8_t danger[4][34];
+
+public:
+    DangerTracker();
+
+    // 一局开始时清空
+    void reset();
+
+    // 事件
+    void onDiscard(int seat, TileIndex tile);   // 打出的牌 (先于其他家的响应)
+    void onRiichi(int seat);                    // 立直宣言 (宣言牌的 onDiscard 之前或之后均可)
+    void onReveal(TileIndex tile);              // 从手牌中亮出的牌 (副露) 或翻开的宝牌指示牌
+
+    // 查询
+    int getDanger(int seat, Tile tile) const { return danger[seat][tile]; }
+    const uint8_t* getDangerTable(int seat) const { return danger[seat]; }
+    TileMask getSafeMask(int seat) const { return genbutsu[seat]; }
+    bool isRiichi(int seat) const { return riichi[seat]; }
+    int getVisible(Tile tile) const { return visible[tile]; }
+
+    // 从当前事实重新计算整张表 (调试和测试用)
+    void rebuild();
+
+private:
+    int evaluate(int seat, Tile tile) const;
+    void markSafe(int seat, Tile tile);
+    void refreshAround(Tile tile);
+};
+
+// 把 Table 的事件接到 DangerTracker 上
+// 挂接到 Table 的回调上，原有回调仍会被调用
+class DangerTrackerHook {
+private:
+    Table* table;
+    DangerTracker* tracker;
+    GameCallbacks forward;   // 挂接前的回调
+    std::array<size_t, 4> revealed;  // 各家已经送入 tracker 的副露张数
+    size_t dora_revealed;            // 已经送入 tracker 的宝牌指示牌数
+
+    void revealDora();               // 杠后新翻开的宝牌指示牌
+
+public:
+    DangerTrackerHook(Table* t, DangerTracker* d);
+    ~DangerTrackerHook();
+};
+
+#endif // DANGER_TRACKER_H
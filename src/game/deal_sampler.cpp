@@ -0,0 +1,270 @@
+#include "deal_sampler.h"
+#include "table.h"
+#include "player.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// splitmix64: 状态只有 64 位，按 (seed, index) 直接定位到任意一个样本
+struct SampleRng {
+    uint64_t state;
+
+    SampleRng(uint64_t seed, uint64_t index) : state(seed ^ (index * 0xD1B54A32D192ED03ULL)) {}
+
+    uint64_t next() {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, n) 的整数 (乘法取高位，偏差可以忽略)
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+};
+
+inline void markTile(uint64_t bits[3], TileIndex tile) {
+    bits[tile >> 6] |= 1ULL << (tile & 63);
+}
+
+// 宝牌指示牌在王牌中的位置: 岭上牌 4 张之后，每杠多翻一张
+inline bool isIndicatorSlot(int pos, int dead_wall_start, int kan_count) {
+    int i = pos - dead_wall_start - 4;
+    return i >= 0 && i <= kan_count && i < 5;
+}
+
+void finishInfo(HiddenInfo& info, const uint64_t visible[3], int wall_pointer, int dead_wall_start, int kan_count) {
+    for (int i = 0; i < 3; ++i) info.unseen[i] = ~visible[i];
+    info.unseen[2] &= (1ULL << (136 - 128)) - 1;
+    info.wall_slot_count = 0;
+    for (int pos = wall_pointer; pos < 136; ++pos) {
+        if (!isIndicatorSlot(pos, dead_wall_start, kan_count)) info.wall_slots[info.wall_slot_count++] = pos;
+    }
+}
+
+// 从剩余牌种中构造 4 面子 1 雀头 (1/16 概率七对子) 再拿掉一张，得到 13 张听牌形
+bool buildTenpaiKinds(const uint8_t left[34], SampleRng& rng, uint8_t kinds[13]) {
+    uint8_t avail[34];
+    std::memcpy(avail, left, sizeof(avail));
+    uint8_t full[14];
+    int n = 0;
+
+    if (rng.below(16) == 0) {
+        Tile pairs[34];
+        int pair_count = 0;
+        for (Tile t = 0; t < 34; ++t) {
+            if (avail[t] >= 2) pairs[pair_count++] = t;
+        }
+        if (pair_count < 7) return false;
+        for (int i = 0; i < 7; ++i) {
+            std::swap(pairs[i], pairs[i + rng.below(pair_count - i)]);
+            full[n++] = pairs[i];
+            full[n++] = pairs[i];
+        }
+    } else {
+        for (int set = 0; set < 4; ++set) {
+            bool done = false;
+            for (int attempt = 0; attempt < 32 && !done; ++attempt) {
+                Tile t = rng.below(34);
+                if (t < 27 && t % 9 <= 6 && rng.below(2)) {
+                    if (avail[t] && avail[t + 1] && avail[t + 2]) {
+                        for (int d = 0; d < 3; ++d) { avail[t + d]--; full[n++] = t + d; }
+                        done = true;
+                    }
+                } else if (avail[t] >= 3) {
+                    avail[t] -= 3;
+                    full[n++] = t; full[n++] = t; full[n++] = t;
+                    done = true;
+                }
+            }
+            if (!done) return false;
+        }
+        bool paired = false;
+        for (int attempt = 0; attempt < 32 && !paired; ++attempt) {
+            Tile t = rng.below(34);
+            if (avail[t] >= 2) {
+                full[n++] = t; full[n++] = t;
+                paired = true;
+            }
+        }
+        if (!paired) return false;
+    }
+
+    // 和了形拿掉任意一张都听牌 (至少听拿掉的那张)
+    std::swap(full[rng.below(14)], full[13]);
+    std::memcpy(kinds, full, 13);
+    return true;
+}
+
+} // namespace
+
+bool buildHiddenInfo(const Table& table, int seat, HiddenInfo& info) {
+    std::memset(&info, 0, sizeof(info));
+    if (table.getWall().size() < 136 || !table.getPlayer(seat)) return false;
+    info.seat = seat;
+
+    uint64_t visible[3] = {0, 0, 0};
+    for (int s = 0; s < 4; ++s) {
+        const Player* player = table.getPlayer(s);
+        if (!player || !player->getHand()) continue;
+        const Hand* hand = player->getHand();
+        for (TileIndex tile : player->getDiscards()) markTile(visible, tile);
+        for (TileIndex tile : hand->getOpenTiles()) markTile(visible, tile);
+        bool has_drawn = player->getDrawnTile() != invalid_tile_index;
+        if (s == seat) {
+            for (TileIndex tile : hand->getTiles()) markTile(visible, tile);
+            if (has_drawn) markTile(visible, player->getDrawnTile());
+        } else {
+            info.hand_size[s] = static_cast<uint8_t>(hand->getTiles().size() + (has_drawn ? 1 : 0));
+            info.tenpai[s] = hand->isRiichi();
+            info.safe[s] = player->getDiscardMask();
+        }
+    }
+    for (TileIndex tile : table.getDoraIndicators()) markTile(visible, tile);
+
+    int wall_pointer = table.getWallPointer();
+    finishInfo(info, visible, wall_pointer, wall_pointer + table.getRemainingTiles(), table.getKanCount());
+    return true;
+}
+
+bool buildHiddenInfo(const GameSnapshot& snapshot, int seat, HiddenInfo& info) {
+    std::memset(&info, 0, sizeof(info));
+    if (!snapshot.wall) return false;
+    info.seat = seat;
+
+    uint64_t visible[3] = {0, 0, 0};
+    bool has_drawn = snapshot.drawn < 136;
+    for (int s = 0; s < 4; ++s) {
+        const SeatSnapshot& st = snapshot.seats[s];
+        for (int i = 0; i < st.river_len; ++i) markTile(visible, st.river[i]);
+        for (int m = 0; m < st.meld_count; ++m) {
+            for (int i = 1; i < 5; ++i) {
+                if (st.melds[m][i] < 136) markTile(visible, st.melds[m][i]);
+            }
+        }
+        if (s == seat) {
+            for (int i = 0; i < 3; ++i) visible[i] |= st.tiles[i];
+            if (has_drawn && snapshot.current == s) markTile(visible, snapshot.drawn);
+        } else {
+            int count = 0;
+            for (int tile = 0; tile < 34; ++tile) count += st.counts[tile];
+            info.hand_size[s] = static_cast<uint8_t>(count + (has_drawn && snapshot.current == s ? 1 : 0));
+            info.tenpai[s] = st.riichi > 0;
+            info.safe[s] = st.discard_mask;
+        }
+    }
+    for (int i = 0; i <= snapshot.kan_count && i < 5; ++i) {
+        markTile(visible, snapshot.wall[snapshot.dead_wall_start + 4 + i]);
+    }
+
+    finishInfo(info, visible, snapshot.wall_pointer, snapshot.dead_wall_start, snapshot.kan_count);
+    return true;
+}
+
+DealSampler::DealSampler() : unseen_count(0) {
+    std::memset(&info, 0, sizeof(info));
+    std::memset(kind_count, 0, sizeof(kind_count));
+}
+
+bool DealSampler::reset(const HiddenInfo& hidden) {
+    info = hidden;
+    std::memset(kind_count, 0, sizeof(kind_count));
+    unseen_count = 0;
+    for (int word = 0; word < 3; ++word) {
+        uint64_t bits = info.unseen[word];
+        while (bits) {
+            TileIndex tile = word * 64 + __builtin_ctzll(bits);
+            by_kind[tile / 4][kind_count[tile / 4]++] = tile;
+            unseen_count++;
+            bits &= bits - 1;
+        }
+    }
+    // 暗杠尚未实现时会丢掉一张摸牌，看不到的牌可能多于需要的张数，多出的不分配
+    int needed = info.wall_slot_count;
+    for (int s = 0; s < 4; ++s) needed += info.hand_size[s];
+    return unseen_count >= needed;
+}
+
+void DealSampler::sample(uint64_t seed, uint64_t index, DealSample& out) const {
+    SampleRng rng(seed, index);
+    TileIndex pool_kind[34][4];
+    uint8_t left[34];
+    std::memcpy(pool_kind, by_kind, sizeof(pool_kind));
+    std::memcpy(left, kind_count, sizeof(left));
+    out.constrained = true;
+
+    // 先给立直者构造听牌形，其余的牌再整体洗牌
+    bool placed[4] = {false, false, false, false};
+    for (int s = 0; s < 4; ++s) {
+        if (!info.tenpai[s] || (info.hand_size[s] != 13 && info.hand_size[s] != 14)) continue;
+        uint8_t kinds[13];
+        bool found = false;
+        for (int attempt = 0; attempt < 8 && !found; ++attempt) {
+            if (!buildTenpaiKinds(left, rng, kinds)) continue;
+            TileCounts counts;
+            counts.fill(0);
+            for (int i = 0; i < 13; ++i) counts[kinds[i]]++;
+            // 立直者一般不会振听立直，听到自己舍牌的形状换一个，实在找不到也接受
+            found = (calcWaitMask(counts, true) & info.safe[s]) == 0 || attempt == 7;
+        }
+        if (!found) {
+            out.constrained = false;
+            continue;
+        }
+        for (int i = 0; i < 13; ++i) {
+            Tile t = kinds[i];
+            int pick = rng.below(left[t]);
+            out.hands[s][i] = pool_kind[t][pick];
+            pool_kind[t][pick] = pool_kind[t][--left[t]];
+        }
+        placed[s] = true;
+    }
+
+    TileIndex pool[136];
+    int pool_size = 0;
+    for (Tile t = 0; t < 34; ++t) {
+        for (int i = 0; i < left[t]; ++i) pool[pool_size++] = pool_kind[t][i];
+    }
+    // 只需要洗出实际用到的前 needed 张
+    int needed = info.wall_slot_count;
+    for (int s = 0; s < 4; ++s) needed += placed[s] ? info.hand_size[s] - 13 : info.hand_size[s];
+    for (int i = 0; i < needed && i < pool_size - 1; ++i) {
+        std::swap(pool[i], pool[i + rng.below(pool_size - i)]);
+    }
+
+    int next = 0;
+    for (int s = 0; s < 4; ++s) {
+        for (int i = placed[s] ? 13 : 0; i < info.hand_size[s]; ++i) out.hands[s][i] = pool[next++];
+    }
+    for (int i = 0; i < info.wall_slot_count; ++i) out.wall[i] = pool[next++];
+}
+
+void DealSampler::apply(const DealSample& deal, GameSnapshot& snapshot, TileIndex* wall_buffer) const {
+    for (int s = 0; s < 4; ++s) {
+        if (s == info.seat || info.hand_size[s] == 0) continue;
+        SeatSnapshot& st = snapshot.seats[s];
+        int concealed = info.hand_size[s];
+        if (snapshot.current == s && snapshot.drawn < 136) {
+            concealed--;
+            snapshot.drawn = static_cast<uint8_t>(deal.hands[s][concealed]);
+        }
+        std::fill(st.tiles, st.tiles + 3, 0);
+        std::fill(st.counts, st.counts + 34, 0);
+        TileCounts counts;
+        counts.fill(0);
+        for (int i = 0; i < concealed; ++i) {
+            TileIndex tile = deal.hands[s][i];
+            markTile(st.tiles, tile);
+            st.counts[tile / 4]++;
+            counts[tile / 4]++;
+        }
+        st.wait_mask = calcWaitMask(counts, st.meld_count == 0);
+    }
+
+    std::copy(snapshot.wall, snapshot.wall + 136, wall_buffer);
+    for (int i = 0; i < info.wall_slot_count; ++i) wall_buffer[info.wall_slots[i]] = deal.wall[i];
+    snapshot.wall = wall_buffer;
+}
@@ -0,0 +1,57 @@
+#ifndef DEAL_SAMPLER_H
+#define DEAL_SAMPLER_H
+
+#include <cstdint>
+#include "types.h"
+
+class Table;
+struct GameSnapshot;
+
+// 某一家视角下看不到的信息
+struct HiddenInfo {
+    int seat;                  // 视角
+    uint64_t unseen[3];        // 看不到的 TileIndex 位图
+    uint8_t hand_size[4];      // 各家需要采样的门前手牌张数 (含尚未打出的摸牌，视角一家为 0)
+    bool tenpai[4];            // 立直者: 门前 13 张必须听牌
+    TileMask safe[4];          // 立直者尽量不听的牌 (自己的舍牌，避免采样出振听立直)
+    uint8_t wall_slots[136];   // 牌山中看不到的位置 (未摸的牌山和王牌，已翻开的宝牌指示牌除外)
+    uint8_t wall_slot_count;
+};
+
+// 一次采样的结果
+struct DealSample {
+    TileIndex hands[4][14];    // 各家门前手牌 (立直者的前 13 张听牌，第 14 张为摸牌)
+    TileIndex wall[136];       // 依次填入 HiddenInfo::wall_slots 的位置
+    bool constrained;          // 立直者的约束全部满足 (构造失败时退回无约束的随机分配)
+};
+
+// 从 Table / 快照收集 seat 看不到的牌: 自己的手牌和摸牌、所有牌河、副露、宝牌指示牌都是可见的
+bool buildHiddenInfo(const Table& table, int seat, HiddenInfo& info);
+bool buildHiddenInfo(const GameSnapshot& snapshot, int seat, HiddenInfo& info);
+
+// 与可见信息一致的发牌采样器
+// reset 后只读: sample 是 const 的，结果只由 (seed, index) 决定，多个线程可以同时对同一个采样器取样
+// 非立直家和牌山是看不到的牌的均匀随机排列；立直家先按 4 面子 1 雀头 (偶尔七对子) 拿掉一张构造听牌形
+class DealSampler {
+private:
+    HiddenInfo info;
+    TileIndex by_kind[34][4];  // 每种牌看不到的 TileIndex
+    uint8_t kind_count[34];
+    int unseen_count;
+
+public:
+    DealSampler();
+
+    // 张数对不上 (看不到的牌 != 各家手牌 + 牌山位置) 时返回 false
+    bool reset(const HiddenInfo& hidden);
+    const HiddenInfo& getInfo() const { return info; }
+    int getUnseenCount() const { return unseen_count; }
+
+    // 第 index 个样本，写入调用方预分配的 out，不分配内存
+    void sample(uint64_t seed, uint64_t index, DealSample& out) const;
+
+    // 把样本写入快照: 替换他家门前手牌 (重算听牌) 和看不到的牌山位置 (写入 wall_buffer 并指向它)
+    void apply(const DealSample& deal, GameSnapshot& snapshot, TileIndex* wall_buffer) const;
+};
+
+#endif // DEAL_SAMPLER_H
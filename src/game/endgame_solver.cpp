@@ -0,0 +1,269 @@
+#include "endgame_solver.h"
+#include "mcts_ai.h"
+#include "constants.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <thread>
+
+namespace {
+
+enum Bound : uint8_t { Empty, Exact, Lower, Upper };
+
+struct TableEntry {
+    uint64_t key;
+    int32_t value;
+    Bound bound;
+    uint8_t best;  // 最好的动作 (0-142)
+};
+
+const int max_moves = 48;
+
+inline uint64_t mix(uint64_t h, uint64_t x) {
+    h ^= x + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    return h ^ (h >> 29);
+}
+
+// 局面的键: 只取会影响之后走向和得点的字段 (牌河顺序不影响，舍张振听看 discard_mask)
+uint64_t hashSnapshot(const GameSnapshot& s) {
+    uint64_t h = static_cast<uint64_t>(s.phase) | static_cast<uint64_t>(s.current) << 8 |
+                 static_cast<uint64_t>(s.responder) << 16 | static_cast<uint64_t>(s.discard) << 24 |
+                 static_cast<uint64_t>(s.drawn) << 32 | static_cast<uint64_t>(s.wall_pointer) << 40 |
+                 static_cast<uint64_t>(s.kan_count) << 48 | static_cast<uint64_t>(s.riichi_pending) << 56;
+    uint64_t responses = 0;
+    for (int i = 0; i < 4; ++i) responses |= static_cast<uint64_t>(s.responses[i]) << (i * 8);
+    h = mix(h, responses | static_cast<uint64_t>(s.riichi_sticks) << 32);
+    for (const SeatSnapshot& seat : s.seats) {
+        h = mix(h, seat.tiles[0]);
+        h = mix(h, seat.tiles[1]);
+        h = mix(h, seat.tiles[2] ^ static_cast<uint64_t>(seat.riichi) << 56 ^ static_cast<uint64_t>(seat.missed_ron) << 60);
+        h = mix(h, seat.discard_mask);
+    }
+    for (int i = 0; i < 4; ++i) h = mix(h, static_cast<uint32_t>(s.deltas[i]));
+    return h;
+}
+
+// 不分支的决策点: 按策略行动的他家
+inline bool isForced(const GameSnapshot& s, int seat, bool follow_policy) {
+    return follow_policy && s.getDecisionSeat() != seat;
+}
+
+// 合法动作去重: 同种同赤的弃牌结果相同；快照中碰和明杠都只是让鸣牌者摸牌
+int listMoves(const GameSnapshot& s, int moves[max_moves]) {
+    const LegalActions& legal = s.getLegalActions();
+    int n = 0;
+    auto allows = [&](Action a) { return legal.allows(static_cast<int>(a)); };
+    if (allows(Action::Win)) moves[n++] = static_cast<int>(Action::Win);
+    if (s.phase == SnapshotPhase::Response) {
+        if (allows(Action::Pon)) moves[n++] = static_cast<int>(Action::Pon);
+        else if (allows(Action::Kan)) moves[n++] = static_cast<int>(Action::Kan);
+        if (allows(Action::Chi)) moves[n++] = static_cast<int>(Action::Chi);
+        if (allows(Action::Pass)) moves[n++] = static_cast<int>(Action::Pass);
+        return n;
+    }
+    if (allows(Action::Riichi)) moves[n++] = static_cast<int>(Action::Riichi);
+
+    uint64_t seen[2] = {0, 0};
+    for (int word = 0; word < 3; ++word) {
+        uint64_t bits = legal.bits[word];
+        if (word == 2) bits &= (1ULL << (136 - 128)) - 1;
+        while (bits && n < max_moves) {
+            TileIndex tile = word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            int key = tile / 4 * 2 + (tile % 4 == 0 && Five.contains(tile / 4));
+            if (seen[key >> 6] >> (key & 63) & 1) continue;
+            seen[key >> 6] |= 1ULL << (key & 63);
+            moves[n++] = tile;
+        }
+    }
+    return n;
+}
+
+class Searcher {
+private:
+    int seat;
+    bool follow_policy;
+    SnapshotPolicy policy;
+    long node_limit;
+    std::vector<TableEntry> table;
+    uint64_t mask;
+
+public:
+    long nodes = 0;
+    bool aborted = false;
+
+    Searcher(int solve_seat, const EndgameConfig& config)
+        : seat(solve_seat), follow_policy(config.opponents == EndgameOpponents::Policy),
+          policy(config.policy ? config.policy : MctsAI::rolloutPolicy), node_limit(config.node_limit) {
+        int bits = std::max(10, std::min(config.table_bits, 28));
+        table.assign(size_t(1) << bits, TableEntry{0, 0, Empty, 0});
+        mask = (uint64_t(1) << bits) - 1;
+    }
+
+    bool isForced(const GameSnapshot& s) const { return ::isForced(s, seat, follow_policy); }
+
+    int forcedMove(const GameSnapshot& s) const { return policy(s); }
+
+    // fail-soft alpha-beta: seat 最大化自己的点数变化，他家最小化
+    int search(const GameSnapshot& s, int alpha, int beta) {
+        if (s.isFinished()) return s.deltas[seat];
+        if (aborted) return 0;
+        if (node_limit > 0 && nodes >= node_limit) {
+            aborted = true;
+            return 0;
+        }
+        nodes++;
+
+        if (isForced(s)) {
+            GameSnapshot next = s;
+            next.apply(forcedMove(s));
+            return search(next, alpha, beta);
+        }
+
+        uint64_t key = hashSnapshot(s);
+        TableEntry& entry = table[key & mask];
+        int hint = -1;
+        if (entry.bound != Empty && entry.key == key) {
+            if (entry.bound == Exact) return entry.value;
+            if (entry.bound == Lower && entry.value >= beta) return entry.value;
+            if (entry.bound == Upper && entry.value <= alpha) return entry.value;
+            hint = entry.best;
+        }
+
+        int moves[max_moves];
+        int n = listMoves(s, moves);
+        for (int i = 1; i < n; ++i) {
+            if (moves[i] == hint) std::swap(moves[0], moves[i]);
+        }
+
+        bool maximizing = s.getDecisionSeat() == seat;
+        int best = maximizing ? INT_MIN : INT_MAX;
+        int best_move = moves[0];
+        int a = alpha, b = beta;
+        for (int i = 0; i < n; ++i) {
+            GameSnapshot next = s;
+            next.apply(moves[i]);
+            int value = search(next, a, b);
+            if (aborted) return value;
+            if (maximizing ? value > best : value < best) {
+                best = value;
+                best_move = moves[i];
+            }
+            if (maximizing) a = std::max(a, value);
+            else b = std::min(b, value);
+            if (a >= b) break;
+        }
+
+        TableEntry& slot = table[key & mask];
+        slot.key = key;
+        slot.value = best;
+        slot.bound = best <= alpha ? Upper : (best >= beta ? Lower : Exact);
+        slot.best = static_cast<uint8_t>(best_move);
+        return best;
+    }
+};
+
+} // namespace
+
+EndgameResult solveEndgame(const GameSnapshot& root, const EndgameConfig& config) {
+    EndgameResult result;
+    result.solved = false;
+    result.seat = config.seat >= 0 ? config.seat : root.getDecisionSeat();
+    result.value = 0;
+    result.nodes = 0;
+    result.seconds = 0;
+    auto start = std::chrono::steady_clock::now();
+    if (root.isFinished()) {
+        result.solved = true;
+        result.value = root.deltas[result.seat];
+        return result;
+    }
+
+    // 根节点的每个动作都用完整窗口搜索，得到精确值 (用于标注每个动作)
+    bool forced = isForced(root, result.seat, config.opponents == EndgameOpponents::Policy);
+    int moves[max_moves];
+    int n = forced ? 1 : listMoves(root, moves);
+    if (forced) moves[0] = (config.policy ? config.policy : MctsAI::rolloutPolicy)(root);
+
+    int num_threads = config.num_threads;
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min(num_threads, n);
+
+    std::vector<int> values(n, 0);
+    std::vector<std::unique_ptr<Searcher>> searchers(num_threads);
+    std::atomic<int> next_move(0);
+    auto worker = [&](int id) {
+        searchers[id].reset(new Searcher(result.seat, config));
+        Searcher* searcher = searchers[id].get();
+        for (int i = next_move++; i < n; i = next_move++) {
+            GameSnapshot next = root;
+            next.apply(moves[i]);
+            values[i] = searcher->search(next, INT_MIN, INT_MAX);
+            if (searcher->aborted) break;
+        }
+    };
+    if (num_threads == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) threads.emplace_back(worker, t);
+        for (std::thread& t : threads) t.join();
+    }
+
+    bool aborted = false;
+    for (const std::unique_ptr<Searcher>& searcher : searchers) {
+        result.nodes += searcher->nodes;
+        aborted = aborted || searcher->aborted;
+    }
+
+    if (!aborted) {
+        bool maximizing = forced || root.getDecisionSeat() == result.seat;
+        result.value = values[0];
+        for (int i = 0; i < n; ++i) {
+            result.moves.push_back({moves[i], values[i]});
+            result.value = maximizing ? std::max(result.value, values[i]) : std::min(result.value, values[i]);
+        }
+
+        // 沿着取到最优值的动作走到终局，复用第一个线程的置换表
+        Searcher& searcher = *searchers[0];
+        GameSnapshot s = root;
+        int target = result.value;
+        for (int i = 0; i < n; ++i) {
+            if (values[i] == target) {
+                result.line.push_back(moves[i]);
+                s.apply(moves[i]);
+                break;
+            }
+        }
+        while (!s.isFinished() && !searcher.aborted) {
+            int chosen = -1;
+            if (searcher.isForced(s)) {
+                chosen = searcher.forcedMove(s);
+            } else {
+                int child_moves[max_moves];
+                int count = listMoves(s, child_moves);
+                for (int i = 0; i < count && chosen < 0; ++i) {
+                    GameSnapshot next = s;
+                    next.apply(child_moves[i]);
+                    if (searcher.search(next, target - 1, target + 1) == target) chosen = child_moves[i];
+                }
+            }
+            if (chosen < 0) break;
+            result.line.push_back(chosen);
+            s.apply(chosen);
+        }
+        result.solved = s.isFinished() && s.deltas[result.seat] == target;
+        result.nodes = 0;
+        for (const std::unique_ptr<Searcher>& searcher : searchers) result.nodes += searcher->nodes;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
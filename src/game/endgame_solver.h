@@ -0,0 +1,42 @@
+#ifndef ENDGAME_SOLVER_H
+#define ENDGAME_SOLVER_H
+
+#include <vector>
+#include "snapshot.h"
+
+// 他家在搜索中的行为
+enum class EndgameOpponents {
+    Policy,       // 他家按固定策略行动，只在求解方的决策点分支 (剩 20 张左右在 1 秒内)
+    Adversarial   // 他家一起让求解方的得失最小 (paranoid)，三家都分支，适合剩 8 张以内
+};
+
+struct EndgameConfig {
+    int seat = -1;                  // 求解哪一家 (-1: 根局面的决策者)
+    EndgameOpponents opponents = EndgameOpponents::Policy;
+    SnapshotPolicy policy = nullptr;  // Policy 模式下他家的策略 (nullptr: MctsAI::rolloutPolicy)
+    int num_threads = 0;            // 根节点的动作分给多个线程，<= 0 时使用全部核心
+    int table_bits = 18;            // 每个线程的置换表 2^table_bits 项
+    long node_limit = 0;            // 每个线程最多展开的节点数 (0 不限制)
+};
+
+// 根节点一个动作的值
+struct EndgameMove {
+    int action;
+    int value;
+};
+
+struct EndgameResult {
+    bool solved;                    // 搜索完整 (没有触及 node_limit)
+    int seat;
+    int value;                      // 双方最优时 seat 本局的点数变化
+    std::vector<int> line;          // 最优路线: 从根开始每一步执行的动作 (含他家)
+    std::vector<EndgameMove> moves; // 根节点每个动作的精确值
+    long nodes;
+    double seconds;
+};
+
+// 牌山已知 (复盘) 时把本局剩下的部分完全搜索到底
+// 同种同赤的弃牌只展开一次，碰和明杠在快照中效果相同也只展开一次
+EndgameResult solveEndgame(const GameSnapshot& root, const EndgameConfig& config = EndgameConfig());
+
+#endif // ENDGAME_SOLVER_H
@@ -0,0 +1,440 @@
+#include "equity.h"
+#include "mcts_ai.h"
+#include "constants.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct TileSpec {
+    Tile kind;
+    bool red;
+};
+
+// "406m11z" 形式，0 为赤五
+bool parseTiles(const std::string& text, std::vector<TileSpec>& out) {
+    out.clear();
+    std::vector<int> digits;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            digits.push_back(c - '0');
+            continue;
+        }
+        int suit = c == 'm' ? 0 : c == 'p' ? 1 : c == 's' ? 2 : c == 'z' ? 3 : -1;
+        if (suit < 0 || digits.empty()) return false;
+        for (int d : digits) {
+            if (suit == 3 ? (d < 1 || d > 7) : d > 9) return false;
+            if (d == 0) out.push_back({static_cast<Tile>(suit * 9 + 4), true});
+            else out.push_back({static_cast<Tile>(suit * 9 + d - 1), false});
+        }
+        digits.clear();
+    }
+    return digits.empty();
+}
+
+// 取一张没用过的实际牌: 赤五是第 0 张，普通的五只能用另外三张
+TileIndex takeTile(bool used[136], const TileSpec& spec) {
+    bool five = Five.contains(spec.kind);
+    for (int i = 0; i < 4; ++i) {
+        TileIndex tile = spec.kind * 4 + i;
+        if (used[tile] || (five && (i == 0) != spec.red)) continue;
+        used[tile] = true;
+        return tile;
+    }
+    return invalid_tile_index;
+}
+
+bool readSeat(std::istringstream& in, int& seat) {
+    return static_cast<bool>(in >> seat) && seat >= 0 && seat < 4;
+}
+
+inline void markTile(uint64_t bits[3], TileIndex tile) {
+    bits[tile >> 6] |= 1ULL << (tile & 63);
+}
+
+inline bool isIndicatorSlot(int pos, int dead_wall_start, int kan_count) {
+    int i = pos - dead_wall_start - 4;
+    return i >= 0 && i <= kan_count && i < 5;
+}
+
+// 模拟结果的累计
+struct Tally {
+    long samples = 0;
+    long win[4] = {0, 0, 0, 0};
+    long deal_in[4] = {0, 0, 0, 0};
+    long draws = 0;
+    double sum[4] = {0, 0, 0, 0};
+    double sum_sq[4] = {0, 0, 0, 0};
+
+    void add(const GameSnapshot& sim) {
+        samples++;
+        if (sim.winner >= 0) {
+            win[sim.winner]++;
+            if (sim.from_player >= 0) deal_in[sim.from_player]++;
+        } else {
+            draws++;
+        }
+        for (int s = 0; s < 4; ++s) {
+            sum[s] += sim.deltas[s];
+            sum_sq[s] += static_cast<double>(sim.deltas[s]) * sim.deltas[s];
+        }
+    }
+
+    void merge(const Tally& other) {
+        samples += other.samples;
+        draws += other.draws;
+        for (int s = 0; s < 4; ++s) {
+            win[s] += other.win[s];
+            deal_in[s] += other.deal_in[s];
+            sum[s] += other.sum[s];
+            sum_sq[s] += other.sum_sq[s];
+        }
+    }
+
+    // 二项分布比例的 95% 置信区间半宽
+    double ci(long count) const {
+        double p = static_cast<double>(count) / samples;
+        return 1.96 * std::sqrt(p * (1 - p) / samples);
+    }
+
+    double maxCi() const {
+        if (samples == 0) return 1.0;
+        double worst = ci(draws);
+        for (int s = 0; s < 4; ++s) worst = std::max({worst, ci(win[s]), ci(deal_in[s])});
+        return worst;
+    }
+};
+
+} // namespace
+
+bool parsePosition(const std::string& text, EquityPosition& out, std::string& error) {
+    int dealer = 0, honba = 0, sticks = 0, remaining = 70, turn = -1;
+    Wind wind = Wind::East;
+    std::array<int, 4> scores = {25000, 25000, 25000, 25000};
+    std::string hands[4], rivers[4], drawn_text, dora_text;
+    std::vector<std::pair<MeldType, std::string>> melds[4];
+    bool riichi[4] = {false, false, false, false};
+
+    std::istringstream lines(text);
+    std::string line;
+    int line_no = 0;
+    while (std::getline(lines, line)) {
+        line_no++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        std::string key;
+        if (!(in >> key)) continue;
+        bool ok = true;
+        int seat = 0;
+        if (key == "wind") {
+            std::string w;
+            ok = static_cast<bool>(in >> w) && w.size() == 1 && std::string("ESWN").find(w[0]) != std::string::npos;
+            if (ok) wind = static_cast<Wind>(std::string("ESWN").find(w[0]));
+        } else if (key == "dealer") {
+            ok = readSeat(in, dealer);
+        } else if (key == "honba") {
+            ok = static_cast<bool>(in >> honba) && honba >= 0 && honba < 256;
+        } else if (key == "sticks") {
+            ok = static_cast<bool>(in >> sticks) && sticks >= 0 && sticks < 256;
+        } else if (key == "scores") {
+            ok = static_cast<bool>(in >> scores[0] >> scores[1] >> scores[2] >> scores[3]);
+        } else if (key == "remaining") {
+            ok = static_cast<bool>(in >> remaining) && remaining >= 0 && remaining <= 70;
+        } else if (key == "turn") {
+            ok = readSeat(in, turn);
+        } else if (key == "drawn") {
+            ok = static_cast<bool>(in >> drawn_text);
+        } else if (key == "dora") {
+            ok = static_cast<bool>(in >> dora_text);
+        } else if (key == "hand") {
+            ok = readSeat(in, seat) && static_cast<bool>(in >> hands[seat]);
+        } else if (key == "river") {
+            ok = readSeat(in, seat) && static_cast<bool>(in >> rivers[seat]);
+        } else if (key == "riichi") {
+            ok = readSeat(in, seat);
+            if (ok) riichi[seat] = true;
+        } else if (key == "meld") {
+            std::string type, tiles;
+            ok = readSeat(in, seat) && static_cast<bool>(in >> type >> tiles) && melds[seat].size() < 4;
+            if (ok && type == "chi") melds[seat].push_back({MeldType::Chi, tiles});
+            else if (ok && type == "pon") melds[seat].push_back({MeldType::Pon, tiles});
+            else if (ok && type == "kan") melds[seat].push_back({MeldType::Minkan, tiles});
+            else if (ok && type == "ankan") melds[seat].push_back({MeldType::Ankan, tiles});
+            else ok = false;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            error = "line " + std::to_string(line_no) + ": cannot parse '" + line + "'";
+            return false;
+        }
+    }
+    if (turn < 0) turn = dealer;
+
+    std::memset(&out.snapshot, 0, sizeof(out.snapshot));
+    std::memset(&out.hidden, 0, sizeof(out.hidden));
+    out.wall.fill(invalid_tile_index);
+    GameSnapshot& snapshot = out.snapshot;
+    snapshot.wall = out.wall.data();
+    snapshot.dead_wall_start = 122;
+    snapshot.wall_pointer = static_cast<uint8_t>(122 - remaining);
+    snapshot.dealer = static_cast<uint8_t>(dealer);
+    snapshot.round_wind = static_cast<uint8_t>(wind);
+    snapshot.honba = static_cast<uint8_t>(honba);
+    snapshot.riichi_sticks = static_cast<uint8_t>(sticks);
+    snapshot.current = static_cast<uint8_t>(turn);
+    snapshot.drawn = static_cast<uint8_t>(invalid_tile_index);
+    snapshot.winner = -1;
+    snapshot.from_player = -1;
+
+    bool used[136];
+    std::fill(used, used + 136, false);
+    std::vector<TileSpec> specs;
+    auto take = [&](const std::string& what, const std::string& tiles, std::vector<TileIndex>& picked) {
+        picked.clear();
+        if (!parseTiles(tiles, specs)) {
+            error = what + ": bad tiles '" + tiles + "'";
+            return false;
+        }
+        for (const TileSpec& spec : specs) {
+            TileIndex tile = takeTile(used, spec);
+            if (tile == invalid_tile_index) {
+                error = what + ": more than four of a tile in '" + tiles + "'";
+                return false;
+            }
+            picked.push_back(tile);
+        }
+        return true;
+    };
+
+    std::vector<TileIndex> picked;
+    int kan_count = 0;
+    bool has_melds = false;
+    for (int s = 0; s < 4; ++s) {
+        SeatSnapshot& seat = snapshot.seats[s];
+        seat.score = scores[s];
+        for (const auto& meld : melds[s]) {
+            if (!take("meld", meld.second, picked)) return false;
+            bool kan = meld.first == MeldType::Minkan || meld.first == MeldType::Ankan;
+            if (picked.size() != (kan ? 4u : 3u)) {
+                error = "meld: wrong number of tiles in '" + meld.second + "'";
+                return false;
+            }
+            uint8_t* slot = seat.melds[seat.meld_count++];
+            slot[0] = static_cast<uint8_t>(meld.first);
+            for (int i = 0; i < 4; ++i) slot[i + 1] = static_cast<uint8_t>(i < (int)picked.size() ? picked[i] : invalid_tile_index);
+            kan_count += kan;
+            has_melds = true;
+        }
+        if (!take("river", rivers[s], picked)) return false;
+        if (picked.size() > sizeof(seat.river)) {
+            error = "river: too many tiles";
+            return false;
+        }
+        for (TileIndex tile : picked) {
+            seat.river[seat.river_len++] = static_cast<uint8_t>(tile);
+            seat.discard_mask |= 1ULL << (tile / 4);
+        }
+        if (riichi[s]) {
+            if (seat.meld_count > 0) {
+                error = "riichi: seat " + std::to_string(s) + " has open melds";
+                return false;
+            }
+            seat.riichi = 2;
+        }
+    }
+    snapshot.kan_count = static_cast<uint8_t>(std::min(kan_count, 4));
+    snapshot.fast_scoring = has_melds;
+
+    // 宝牌指示牌放在王牌中的固定位置，没给出的由采样补上
+    if (!take("dora", dora_text, picked)) return false;
+    if ((int)picked.size() > snapshot.kan_count + 1) {
+        error = "dora: more indicators than kans + 1";
+        return false;
+    }
+    for (size_t i = 0; i < picked.size(); ++i) out.wall[snapshot.dead_wall_start + 4 + i] = picked[i];
+
+    out.drawn = invalid_tile_index;
+    if (!drawn_text.empty()) {
+        if (!take("drawn", drawn_text, picked)) return false;
+        if (picked.size() != 1) {
+            error = "drawn: expected one tile";
+            return false;
+        }
+        out.drawn = picked[0];
+    }
+
+    HiddenInfo& hidden = out.hidden;
+    hidden.seat = -1;
+    for (int s = 0; s < 4; ++s) {
+        SeatSnapshot& seat = snapshot.seats[s];
+        int size = 13 - 3 * seat.meld_count;
+        if (hands[s].empty() || hands[s] == "?") {
+            hidden.hand_size[s] = static_cast<uint8_t>(size);
+            hidden.tenpai[s] = seat.riichi > 0;
+            hidden.safe[s] = seat.discard_mask;
+            continue;
+        }
+        if (!take("hand", hands[s], picked)) return false;
+        if ((int)picked.size() != size) {
+            error = "hand: seat " + std::to_string(s) + " needs " + std::to_string(size) + " tiles";
+            return false;
+        }
+        TileCounts counts;
+        counts.fill(0);
+        for (TileIndex tile : picked) {
+            markTile(seat.tiles, tile);
+            seat.counts[tile / 4]++;
+            counts[tile / 4]++;
+        }
+        seat.wait_mask = calcWaitMask(counts, seat.meld_count == 0);
+    }
+
+    int unseen = 0;
+    for (TileIndex tile = 0; tile < 136; ++tile) {
+        if (used[tile]) continue;
+        markTile(hidden.unseen, tile);
+        unseen++;
+    }
+    int needed = 0;
+    for (int pos = snapshot.wall_pointer; pos < 136; ++pos) {
+        if (out.wall[pos] == invalid_tile_index) hidden.wall_slots[hidden.wall_slot_count++] = static_cast<uint8_t>(pos);
+    }
+    needed += hidden.wall_slot_count;
+    for (int s = 0; s < 4; ++s) needed += hidden.hand_size[s];
+    if (unseen < needed) {
+        error = "not enough unseen tiles for the hidden hands and wall";
+        return false;
+    }
+    out.resume = true;
+    return true;
+}
+
+bool positionFromSnapshot(const GameSnapshot& snapshot, EquityPosition& out) {
+    if (!snapshot.wall || snapshot.isFinished()) return false;
+    out.snapshot = snapshot;
+    std::copy(snapshot.wall, snapshot.wall + 136, out.wall.begin());
+    out.snapshot.wall = out.wall.data();
+    out.resume = false;
+    out.drawn = invalid_tile_index;
+
+    // 手牌、牌河、副露和摸牌都已知，只有未摸的牌山是看不到的
+    HiddenInfo& hidden = out.hidden;
+    std::memset(&hidden, 0, sizeof(hidden));
+    hidden.seat = -1;
+    uint64_t visible[3] = {0, 0, 0};
+    for (const SeatSnapshot& seat : snapshot.seats) {
+        for (int i = 0; i < 3; ++i) visible[i] |= seat.tiles[i];
+        for (int i = 0; i < seat.river_len; ++i) markTile(visible, seat.river[i]);
+        for (int m = 0; m < seat.meld_count; ++m) {
+            for (int i = 1; i < 5; ++i) {
+                if (seat.melds[m][i] < 136) markTile(visible, seat.melds[m][i]);
+            }
+        }
+    }
+    if (snapshot.drawn < 136) markTile(visible, snapshot.drawn);
+    for (int pos = snapshot.wall_pointer; pos < 136; ++pos) {
+        if (isIndicatorSlot(pos, snapshot.dead_wall_start, snapshot.kan_count)) {
+            markTile(visible, snapshot.wall[pos]);
+        } else {
+            hidden.wall_slots[hidden.wall_slot_count++] = static_cast<uint8_t>(pos);
+        }
+    }
+    for (int i = 0; i < 3; ++i) hidden.unseen[i] = ~visible[i];
+    hidden.unseen[2] &= (1ULL << (136 - 128)) - 1;
+    return true;
+}
+
+int tsumogiriPolicy(const GameSnapshot& snapshot) {
+    if (snapshot.getLegalActions().allows(static_cast<int>(Action::Win))) return static_cast<int>(Action::Win);
+    if (snapshot.phase == SnapshotPhase::Response) return static_cast<int>(Action::Pass);
+    return snapshot.drawn;
+}
+
+EquityResult runEquity(const EquityPosition& position, const EquityConfig& config) {
+    EquityResult result;
+    std::memset(&result, 0, sizeof(result));
+    DealSampler sampler;
+    if (!sampler.reset(position.hidden)) return result;
+
+    SnapshotPolicy policy = config.policy ? config.policy : MctsAI::rolloutPolicy;
+    int num_threads = config.num_threads;
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // 按批领取模拟编号，每批结束合并一次并检查置信区间
+    const long batch = 64;
+    std::atomic<long> next_batch(0);
+    std::atomic<bool> stop(false);
+    std::mutex mutex;
+    Tally total;
+    bool converged = false;
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        TileIndex wall_buffer[136];
+        DealSample deal;
+        while (!stop.load(std::memory_order_relaxed)) {
+            long first = next_batch.fetch_add(1) * batch;
+            if (first >= config.max_samples) break;
+            long last = std::min(first + batch, config.max_samples);
+
+            Tally local;
+            for (long i = first; i < last; ++i) {
+                GameSnapshot sim = position.snapshot;
+                sim.wall = position.wall.data();
+                sim.fast_scoring = sim.fast_scoring || config.fast_scoring;
+                sampler.sample(config.seed, static_cast<uint64_t>(i), deal);
+                sampler.apply(deal, sim, wall_buffer);
+                if (position.resume) {
+                    sim.drawn = static_cast<uint8_t>(position.drawn);
+                    sim.resume();
+                }
+                while (!sim.isFinished()) {
+                    sim.apply(policy(sim));
+                }
+                local.add(sim);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            total.merge(local);
+            if (total.samples >= config.min_samples && total.maxCi() <= config.target_ci) {
+                converged = true;
+                stop = true;
+            }
+        }
+    };
+
+    if (num_threads == 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) threads.emplace_back(worker);
+        for (std::thread& t : threads) t.join();
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.samples = total.samples;
+    result.converged = converged;
+    if (total.samples == 0) return result;
+    double n = static_cast<double>(total.samples);
+    result.draw = total.draws / n;
+    for (int s = 0; s < 4; ++s) {
+        result.win[s] = total.win[s] / n;
+        result.deal_in[s] = total.deal_in[s] / n;
+        result.delta[s] = total.sum[s] / n;
+        double variance = std::max(0.0, total.sum_sq[s] / n - result.delta[s] * result.delta[s]);
+        result.delta_ci[s] = 1.96 * std::sqrt(variance / n);
+    }
+    result.max_ci = total.maxCi();
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef EQUITY_H
+#define EQUITY_H
+
+#include <array>
+#include <string>
+#include "snapshot.h"
+#include "deal_sampler.h"
+
+// 估算用的局面: 已知部分放在快照里，看不到的手牌和牌山位置每次模拟重新采样
+struct EquityPosition {
+    GameSnapshot snapshot;            // 模拟起点 (wall 在模拟时指向下面的 wall)
+    std::array<TileIndex, 136> wall;  // 已知的牌山位置 (宝牌指示牌等)，其余由采样填入
+    HiddenInfo hidden;                // 需要采样的部分 (seat 为 -1，没有视角一家)
+    bool resume;                      // 采样后需要调用 GameSnapshot::resume 开始推进
+    TileIndex drawn;                  // resume 前放回的摸牌 (invalid_tile_index 表示从牌山摸)
+};
+
+// 文本局面，每行一项，# 之后为注释，牌用 m/p/s/z 表示 (0 为赤五，如 "406m11z"):
+//   wind E            场风 (E/S/W/N)
+//   dealer 0          庄家
+//   honba 0 / sticks 1
+//   scores 25000 25000 25000 25000
+//   remaining 40      剩余可摸的牌数
+//   turn 1            接下来行动的玩家 (缺省为庄家)
+//   drawn 5p          turn 家已经摸到的牌 (缺省时从牌山摸)
+//   dora 3m           已翻开的宝牌指示牌
+//   hand 0 123m456p789s1122z   门前手牌，"?" 或省略表示随机 (13 - 3 * 副露张)
+//   river 0 19m1z     牌河
+//   meld 2 pon 555z   副露 (chi / pon / kan / ankan)，有副露时按估算番数计分
+//   riichi 1          立直 (看不到手牌时采样成听牌形)
+bool parsePosition(const std::string& text, EquityPosition& out, std::string& error);
+
+// 对局中的快照: 各家手牌都已知，只重新排列未摸的牌山 (用于复盘)
+bool positionFromSnapshot(const GameSnapshot& snapshot, EquityPosition& out);
+
+// 能和就和，其余一律摸切 / 过 (只看牌运的基准)
+int tsumogiriPolicy(const GameSnapshot& snapshot);
+
+struct EquityConfig {
+    SnapshotPolicy policy = nullptr;  // nullptr 时使用 MctsAI::rolloutPolicy
+    int num_threads = 0;              // <= 0 时使用全部核心
+    long min_samples = 1000;
+    long max_samples = 200000;
+    double target_ci = 0.005;         // 所有概率的 95% 置信区间半宽都不超过它时提前结束
+    uint64_t seed = 1;
+    bool fast_scoring = false;        // 不解析役种，按估算番数计分 (有副露时总是使用)
+};
+
+struct EquityResult {
+    long samples;
+    std::array<double, 4> win;       // 和牌概率
+    std::array<double, 4> deal_in;   // 放铳概率
+    double draw;                     // 流局概率
+    std::array<double, 4> delta;     // 点数变化期望
+    std::array<double, 4> delta_ci;  // 点数变化期望的 95% 置信区间半宽
+    double max_ci;                   // 各概率中最宽的置信区间半宽
+    bool converged;                  // 达到 target_ci 提前结束
+    double seconds;
+};
+
+// 多线程蒙特卡洛模拟到本局结束；第 i 次模拟只由 (seed, i) 决定
+EquityResult runEquity(const EquityPosition& position, const EquityConfig& config);
+
+#endif // EQUITY_H
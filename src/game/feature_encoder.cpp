@@ -0,0 +1,130 @@
+#include "feature_encoder.h"
+#include "constants.h"
+#include "player.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+static void clearObservation(Observation& obs) {
+    std::memset(&obs, 0, sizeof(obs));
+    obs.drawn = invalid_tile_index;
+    obs.target = invalid_tile_index;
+}
+
+void observeTable(const Table& table, int seat, DecisionKind kind, int options, Observation& obs) {
+    clearObservation(obs);
+    obs.seat = seat;
+    obs.kind = kind;
+    obs.options = options;
+
+    const Player* self = table.getPlayer(seat);
+    for (TileIndex tile : self->getHand()->getTiles()) obs.hand[tile / 4]++;
+    if (kind != DecisionKind::Response && self->getDrawnTile() != invalid_tile_index) {
+        obs.drawn = self->getDrawnTile();
+        obs.hand[obs.drawn / 4]++;
+    }
+    // 响应时当前玩家刚打出的牌就是牌河最后一张
+    const Player* discarder = table.getPlayer(table.getCurrentPlayer());
+    if (kind == DecisionKind::Response && !discarder->getDiscards().empty()) {
+        obs.target = discarder->getDiscards().back();
+    }
+
+    for (int rel = 0; rel < 4; ++rel) {
+        const Player* player = table.getPlayer((seat + rel) % 4);
+        for (TileIndex tile : player->getDiscards()) obs.river[rel][tile / 4]++;
+        for (TileIndex tile : player->getHand()->getOpenTiles()) obs.melds[rel][tile / 4]++;
+        obs.riichi[rel] = player->getHand()->isRiichi();
+        obs.scores[rel] = player->getScore();
+    }
+    for (TileIndex tile : table.getDoraIndicators()) obs.dora[tile / 4]++;
+
+    obs.round_wind = table.getRoundWind();
+    obs.seat_wind = static_cast<Wind>((seat - table.getDealer() + 4) % 4);
+    obs.is_dealer = seat == table.getDealer();
+    obs.remaining = table.getRemainingTiles();
+    obs.honba = table.getHonba();
+    obs.riichi_sticks = table.getRiichiSticks();
+}
+
+void observeSnapshot(const GameSnapshot& snapshot, Observation& obs) {
+    clearObservation(obs);
+    int seat = snapshot.getDecisionSeat();
+    obs.seat = seat;
+    obs.kind = snapshot.getDecisionKind();
+    obs.options = snapshot.getOptions();
+
+    const SeatSnapshot& self = snapshot.seats[seat];
+    for (int tile = 0; tile < 34; ++tile) obs.hand[tile] = self.counts[tile];
+    if (obs.kind == DecisionKind::Response) {
+        obs.target = snapshot.discard;
+    } else {
+        obs.drawn = snapshot.drawn;
+        obs.hand[obs.drawn / 4]++;
+    }
+
+    for (int rel = 0; rel < 4; ++rel) {
+        const SeatSnapshot& s = snapshot.seats[(seat + rel) % 4];
+        for (int i = 0; i < s.river_len; ++i) obs.river[rel][s.river[i] / 4]++;
+        for (int m = 0; m < s.meld_count; ++m) {
+            int tiles = s.melds[m][0] == static_cast<int>(MeldType::Ankan) ||
+                        s.melds[m][0] == static_cast<int>(MeldType::Minkan) ? 4 : 3;
+            for (int i = 0; i < tiles; ++i) obs.melds[rel][s.melds[m][1 + i] / 4]++;
+        }
+        obs.riichi[rel] = s.riichi > 0;
+        obs.scores[rel] = s.score;
+    }
+    // 与 Table::getDoraIndicators 相同的位置
+    for (int i = 0; i <= snapshot.kan_count && i < 5; ++i) {
+        obs.dora[snapshot.wall[snapshot.dead_wall_start + 4 + i] / 4]++;
+    }
+
+    obs.round_wind = static_cast<Wind>(snapshot.round_wind);
+    obs.seat_wind = static_cast<Wind>((seat - snapshot.dealer + 4) % 4);
+    obs.is_dealer = seat == snapshot.dealer;
+    obs.remaining = snapshot.getRemainingTiles();
+    obs.honba = snapshot.honba;
+    obs.riichi_sticks = snapshot.riichi_sticks;
+}
+
+// float / uint8 共用的写入逻辑
+template <typename T>
+static void writePlanes(const Observation& obs, T* out) {
+    std::fill(out, out + feature_size, T(0));
+    auto plane = [out](int index) { return out + index * 34; };
+    auto fill = [&](int index, int value) {
+        value = std::max(0, std::min(255, value));
+        std::fill(plane(index), plane(index) + 34, static_cast<T>(value));
+    };
+
+    for (int tile = 0; tile < 34; ++tile) {
+        for (int n = 0; n < obs.hand[tile] && n < 4; ++n) plane(PlaneHand + n)[tile] = 1;
+        for (int rel = 0; rel < 4; ++rel) {
+            plane(PlaneRiver + rel)[tile] = obs.river[rel][tile];
+            plane(PlaneMeld + rel)[tile] = obs.melds[rel][tile];
+        }
+        plane(PlaneDora)[tile] = obs.dora[tile];
+    }
+    if (obs.drawn != invalid_tile_index) plane(PlaneDrawn)[obs.drawn / 4] = 1;
+    if (obs.target != invalid_tile_index) plane(PlaneTarget)[obs.target / 4] = 1;
+
+    for (int rel = 0; rel < 4; ++rel) {
+        if (obs.riichi[rel]) fill(PlaneRiichi + rel, 1);
+        fill(PlaneScore + rel, obs.scores[rel] / 1000);
+    }
+    plane(PlaneRoundWind)[EastWind + static_cast<int>(obs.round_wind)] = 1;
+    plane(PlaneSeatWind)[EastWind + static_cast<int>(obs.seat_wind)] = 1;
+    if (obs.is_dealer) fill(PlaneDealer, 1);
+    fill(PlaneRemaining, obs.remaining);
+    fill(PlaneHonba, obs.honba);
+    fill(PlaneSticks, obs.riichi_sticks);
+    fill(PlaneKind + static_cast<int>(obs.kind), 1);
+}
+
+void encodeFeatures(const Observation& obs, float* out) {
+    writePlanes(obs, out);
+}
+
+void encodeFeatures(const Observation& obs, uint8_t* out) {
+    writePlanes(obs, out);
+}
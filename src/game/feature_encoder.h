@@ -0,0 +1,68 @@
+#ifndef FEATURE_ENCODER_H
+#define FEATURE_ENCODER_H
+
+#include <array>
+#include <cstdint>
+#include "types.h"
+#include "table.h"
+
+struct GameSnapshot;
+
+// 特征平面布局 (版本 1)
+// 每个平面 34 个值，下标为 Tile (0-33)；输出按平面顺序连续排列: out[plane * 34 + tile]
+// 座位一律换成相对座位: 0 自己, 1 下家, 2 对家, 3 上家
+// 所有值都是 0-255 的小整数，float 与 uint8 输出的数值相同
+enum FeaturePlane : int {
+    PlaneHand = 0,          // 0-3: 自己门前手牌 (含摸到的牌) 张数 >= 1, 2, 3, 4
+    PlaneDrawn = 4,         // 摸到的牌
+    PlaneRiver = 5,         // 5-8: 各家牌河张数
+    PlaneMeld = 9,          // 9-12: 各家副露张数
+    PlaneDora = 13,         // 宝牌指示牌张数
+    PlaneTarget = 14,       // 响应阶段被响应的弃牌
+    PlaneRiichi = 15,       // 15-18: 各家已立直 (整面为 1)
+    PlaneRoundWind = 19,    // 场风牌
+    PlaneSeatWind = 20,     // 自风牌
+    PlaneDealer = 21,       // 自己是庄家 (整面为 1)
+    PlaneRemaining = 22,    // 牌山剩余张数 (整面)
+    PlaneHonba = 23,        // 本场数 (整面)
+    PlaneSticks = 24,       // 场上立直棒 (整面)
+    PlaneScore = 25,        // 25-28: 各家点数 / 1000，截断到 0-255 (整面)
+    PlaneKind = 29,         // 29-31: 决策种类 Action / Response / RiichiDiscard (整面为 1)
+    NumFeaturePlanes = 32
+};
+
+constexpr int feature_version = 1;
+constexpr int feature_size = NumFeaturePlanes * 34;
+
+// 一个座位在一次决策时能看到的信息 (编码前的中间形式)
+struct Observation {
+    int seat;
+    DecisionKind kind;
+    int options;                            // DecisionOption 位
+    uint8_t hand[34];                       // 门前手牌张数 (含摸到的牌)
+    TileIndex drawn;                        // 摸到的牌，没有时为 invalid_tile_index
+    TileIndex target;                       // 响应阶段被响应的弃牌
+    uint8_t river[4][34];                   // 相对座位
+    uint8_t melds[4][34];
+    uint8_t dora[34];
+    bool riichi[4];
+    int scores[4];
+    Wind round_wind;
+    Wind seat_wind;
+    bool is_dealer;
+    int remaining;
+    int honba;
+    int riichi_sticks;
+};
+
+// 从 Table 取 seat 的视角，在 onDecision 回调中调用 (此时决策尚未执行)
+void observeTable(const Table& table, int seat, DecisionKind kind, int options, Observation& obs);
+
+// 从快照取当前决策者的视角
+void observeSnapshot(const GameSnapshot& snapshot, Observation& obs);
+
+// 按上面的布局写入 feature_size 个值
+void encodeFeatures(const Observation& obs, float* out);
+void encodeFeatures(const Observation& obs, uint8_t* out);
+
+#endif // FEATURE_ENCODER_H
@@ -0,0 +1,118 @@
+#include "feature_writer.h"
+
+#include <cstring>
+
+static const char feature_magic[4] = {'M', 'J', 'F', 'T'};
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+// FeatureShardWriter 实现
+FeatureShardWriter::FeatureShardWriter()
+    : records_per_shard(0), file(nullptr), shard_count(0), shard_records(0), total_records(0) {
+    record.resize(feature_record_size);
+}
+
+FeatureShardWriter::~FeatureShardWriter() {
+    close();
+}
+
+std::string FeatureShardWriter::shardPath(const std::string& path_prefix, int index) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%05d.mjf", index);
+    return path_prefix + suffix;
+}
+
+bool FeatureShardWriter::open(const std::string& path_prefix, long per_shard) {
+    close();
+    prefix = path_prefix;
+    records_per_shard = per_shard > 0 ? per_shard : 1;
+    shard_count = 0;
+    total_records = 0;
+    return openShard();
+}
+
+bool FeatureShardWriter::openShard() {
+    if (file) std::fclose(file);
+    file = std::fopen(shardPath(prefix, shard_count).c_str(), "wb");
+    if (!file) return false;
+    shard_count++;
+    shard_records = 0;
+
+    uint8_t header[16] = {};
+    std::memcpy(header, feature_magic, 4);
+    put16(header + 4, feature_version);
+    put16(header + 6, NumFeaturePlanes);
+    put32(header + 8, feature_record_size);
+    return std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+void FeatureShardWriter::close() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+bool FeatureShardWriter::addRecord(const uint8_t* features, int seat, DecisionKind kind, int options,
+                                   int action, int outcome) {
+    if (!file) return false;
+    if (shard_records >= records_per_shard && !openShard()) return false;
+
+    std::memcpy(record.data(), features, feature_size);
+    uint8_t* tail = record.data() + feature_size;
+    tail[0] = static_cast<uint8_t>(seat);
+    tail[1] = static_cast<uint8_t>(kind);
+    tail[2] = static_cast<uint8_t>(options);
+    tail[3] = static_cast<uint8_t>(action);
+    put32(tail + 4, static_cast<uint32_t>(outcome));
+    if (std::fwrite(record.data(), 1, record.size(), file) != record.size()) return false;
+
+    shard_records++;
+    total_records++;
+    return true;
+}
+
+// FeatureRecorder 实现
+FeatureRecorder::FeatureRecorder(Table* t, FeatureShardWriter* w)
+    : table(t), writer(w), forward(t->getCallbacks()) {
+    GameCallbacks callbacks = forward;
+
+    callbacks.onRoundStart = [this]() {
+        features.clear();
+        pending.clear();
+        if (forward.onRoundStart) forward.onRoundStart();
+    };
+
+    // onDecision 在动作执行之前回调，此时的局面就是决策时的局面
+    callbacks.onDecision = [this](int seat, DecisionKind kind, int options, int action) {
+        observeTable(*table, seat, kind, options, obs);
+        features.resize(features.size() + feature_size);
+        encodeFeatures(obs, features.data() + features.size() - feature_size);
+        pending.push_back({seat, kind, options, action});
+        if (forward.onDecision) forward.onDecision(seat, kind, options, action);
+    };
+
+    callbacks.onGameEnd = [this](const GameResult& result) {
+        for (size_t i = 0; i < pending.size(); ++i) {
+            const PendingRecord& r = pending[i];
+            writer->addRecord(features.data() + i * feature_size, r.seat, r.kind, r.options, r.action,
+                              result.deltas[r.seat]);
+        }
+        features.clear();
+        pending.clear();
+        if (forward.onGameEnd) forward.onGameEnd(result);
+    };
+
+    table->setCallbacks(callbacks);
+}
+
+FeatureRecorder::~FeatureRecorder() {
+    table->setCallbacks(forward);
+}
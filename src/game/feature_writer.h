@@ -0,0 +1,68 @@
+#ifndef FEATURE_WRITER_H
+#define FEATURE_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "feature_encoder.h"
+
+// 训练数据分片文件 <prefix>-00000.mjf, <prefix>-00001.mjf, ...
+// 文件头 16 字节: "MJFT", u16 特征版本, u16 平面数, u32 每条记录字节数, u32 保留
+// 每条记录: uint8 特征[feature_size], u8 座位, u8 决策种类, u8 可选动作位, u8 实际动作,
+//           i32 这一座位本局的得失点 (小端)
+constexpr uint32_t feature_record_size = feature_size + 8;
+
+class FeatureShardWriter {
+private:
+    std::string prefix;
+    long records_per_shard;
+    std::FILE* file;
+    int shard_count;
+    long shard_records;   // 当前分片已写的记录数
+    long total_records;
+    std::vector<uint8_t> record;
+
+public:
+    FeatureShardWriter();
+    ~FeatureShardWriter();
+
+    bool open(const std::string& path_prefix, long per_shard = 1 << 16);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // features 为 encodeFeatures 的 uint8 输出
+    bool addRecord(const uint8_t* features, int seat, DecisionKind kind, int options, int action, int outcome);
+
+    int getShardCount() const { return shard_count; }
+    long getRecordCount() const { return total_records; }
+    static std::string shardPath(const std::string& path_prefix, int index);
+
+private:
+    bool openShard();
+};
+
+// 记录 Table 上每一次决策的特征
+// 挂接到 Table 的回调上，一局结束时用各家得失点补全记录后写入；原有回调仍会被调用
+class FeatureRecorder {
+private:
+    struct PendingRecord {
+        int seat;
+        DecisionKind kind;
+        int options;
+        int action;
+    };
+
+    Table* table;
+    FeatureShardWriter* writer;
+    GameCallbacks forward;  // 挂接前的回调
+    Observation obs;
+    std::vector<uint8_t> features;        // 本局各条记录的特征，连续存放
+    std::vector<PendingRecord> pending;
+
+public:
+    FeatureRecorder(Table* t, FeatureShardWriter* w);
+    ~FeatureRecorder();
+};
+
+#endif // FEATURE_WRITER_H
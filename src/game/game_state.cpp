@@ -1,100 +1,150 @@
 #include "game_state.h"
-#include <sstream>
-
-// 简单的 JSON 序列化实现
-// 注意: 生产环境应使用 nlohmann/json 等库
-
-static std::string escapeJSON(const std::string& s) {
-    std::ostringstream ss;
-    for (char c : s) {
-        switch (c) {
-            case '"': ss << "\\\""; break;
-            case '\\': ss << "\\\\"; break;
-            case '\n': ss << "\\n"; break;
-            case '\r': ss << "\\r"; break;
-            case '\t': ss << "\\t"; break;
-            default: ss << c;
-        }
-    }
-    return ss.str();
-}
-
-static std::string vectorToJSON(const std::vector<int>& v) {
-    std::ostringstream ss;
-    ss << "[";
-    for (size_t i = 0; i < v.size(); ++i) {
-        if (i > 0) ss << ",";
-        ss << v[i];
-    }
-    ss << "]";
-    return ss.str();
-}
+#include "json_writer.h"
+#include "json_reader.h"
 
-std::string GameState::toJSON() const {
-    std::ostringstream ss;
-    ss << "{";
+void GameState::writeJSON(JsonWriter& w, ViewLayout* layout) const {
+    w.beginObject();
 
     // 基本信息
-    ss << "\"round_wind\":" << round_wind << ",";
-    ss << "\"dealer\":" << dealer << ",";
-    ss << "\"current_player\":" << current_player << ",";
-    ss << "\"remaining_tiles\":" << remaining_tiles << ",";
-    ss << "\"honba\":" << honba << ",";
-    ss << "\"riichi_sticks\":" << riichi_sticks << ",";
+    w.field("round_wind", round_wind);
+    w.field("dealer", dealer);
+    w.field("current_player", current_player);
+    w.field("remaining_tiles", remaining_tiles);
+    w.field("honba", honba);
+    w.field("riichi_sticks", riichi_sticks);
 
     // 手牌
-    ss << "\"hands\":[";
+    w.key("hands");
+    w.beginArray();
     for (int i = 0; i < 4; ++i) {
-        if (i > 0) ss << ",";
-        ss << vectorToJSON(hands[i]);
+        size_t begin = w.buffer().size();
+        w.tiles(hands[i].data(), hands[i].size());
+        if (layout) {
+            // 不含前面的逗号
+            if (w.buffer()[begin] == ',') begin++;
+            layout->hand_begin[i] = begin;
+            layout->hand_end[i] = w.buffer().size();
+        }
     }
-    ss << "],";
+    w.endArray();
 
     // 牌河
-    ss << "\"discards\":[";
-    for (int i = 0; i < 4; ++i) {
-        if (i > 0) ss << ",";
-        ss << vectorToJSON(discards[i]);
-    }
-    ss << "],";
+    w.key("discards");
+    w.beginArray();
+    for (const RiverTiles& river : discards) w.tiles(river.data(), river.size());
+    w.endArray();
 
     // 点数
-    ss << "\"scores\":[";
-    for (int i = 0; i < 4; ++i) {
-        if (i > 0) ss << ",";
-        ss << scores[i];
-    }
-    ss << "],";
+    w.key("scores");
+    w.values(scores.data(), scores.size());
 
     // 立直状态
-    ss << "\"riichi_status\":[";
-    for (int i = 0; i < 4; ++i) {
-        if (i > 0) ss << ",";
-        ss << (riichi_status[i] ? "true" : "false");
-    }
-    ss << "],";
+    w.key("riichi_status");
+    w.beginArray();
+    for (bool riichi : riichi_status) w.value(riichi);
+    w.endArray();
 
     // 可用动作
-    ss << "\"can_tsumo\":" << (can_tsumo ? "true" : "false") << ",";
-    ss << "\"can_ron\":" << (can_ron ? "true" : "false") << ",";
-    ss << "\"can_riichi\":" << (can_riichi ? "true" : "false") << ",";
-    ss << "\"can_chi\":" << (can_chi ? "true" : "false") << ",";
-    ss << "\"can_pon\":" << (can_pon ? "true" : "false") << ",";
-    ss << "\"can_kan\":" << (can_kan ? "true" : "false") << ",";
+    w.field("can_tsumo", can_tsumo);
+    w.field("can_ron", can_ron);
+    w.field("can_riichi", can_riichi);
+    w.field("can_chi", can_chi);
+    w.field("can_pon", can_pon);
+    w.field("can_kan", can_kan);
 
     // 最后的牌
-    ss << "\"last_draw\":" << last_draw << ",";
-    ss << "\"last_discard\":" << last_discard << ",";
-    ss << "\"last_discard_player\":" << last_discard_player;
+    w.key("last_draw");
+    if (layout) layout->last_draw_begin = w.buffer().size();
+    w.value(last_draw);
+    if (layout) layout->last_draw_end = w.buffer().size();
+    w.field("last_discard", last_discard);
+    w.field("last_discard_player", last_discard_player);
+
+    w.endObject();
+}
 
-    ss << "}";
-    return ss.str();
+void GameState::appendJSON(std::string& out) const {
+    JsonWriter writer(out);
+    writeJSON(writer);
+}
+
+std::string GameState::toJSON() const {
+    std::string out;
+    appendJSON(out);
+    return out;
+}
+
+namespace {
+
+// 每家一个牌数组，最多 4 家
+template <size_t N>
+bool readSeatArrays(JsonReader& reader, std::array<TileArray<N>, 4>& out) {
+    thread_local std::vector<int> values;
+    if (!reader.beginArray()) return false;
+    size_t i = 0;
+    while (reader.nextElement()) {
+        if (i >= 4) return reader.fail("more than 4 seats");
+        if (!reader.readInts(values)) return false;
+        if (values.size() > N) return reader.fail("too many tiles");
+        if (!out[i].assign(values.data(), values.size())) return reader.fail("tile out of range");
+        i++;
+    }
+    for (; i < 4; ++i) out[i].clear();
+    return !reader.failed();
+}
+
+template <typename T, typename Read>
+bool readFixedArray(JsonReader& reader, std::array<T, 4>& out, Read read) {
+    if (!reader.beginArray()) return false;
+    size_t i = 0;
+    while (reader.nextElement()) {
+        if (i >= 4) return reader.fail("more than 4 seats");
+        if (!read(out[i])) return false;
+        i++;
+    }
+    if (!reader.failed() && i != 4) return reader.fail("expected 4 seats");
+    return !reader.failed();
+}
+
+} // namespace
+
+bool GameState::readJSON(JsonReader& r) {
+    if (!r.beginObject()) return false;
+    const char* key;
+    size_t length;
+    auto readInt = [&r](int& v) { return r.readInt(v); };
+    auto readBool = [&r](bool& v) { return r.readBool(v); };
+    while (r.nextKey(key, length)) {
+        bool ok;
+        if (keyIs(key, length, "round_wind")) ok = r.readInt(round_wind);
+        else if (keyIs(key, length, "dealer")) ok = r.readInt(dealer);
+        else if (keyIs(key, length, "current_player")) ok = r.readInt(current_player);
+        else if (keyIs(key, length, "remaining_tiles")) ok = r.readInt(remaining_tiles);
+        else if (keyIs(key, length, "honba")) ok = r.readInt(honba);
+        else if (keyIs(key, length, "riichi_sticks")) ok = r.readInt(riichi_sticks);
+        else if (keyIs(key, length, "hands")) ok = readSeatArrays(r, hands);
+        else if (keyIs(key, length, "discards")) ok = readSeatArrays(r, discards);
+        else if (keyIs(key, length, "scores")) ok = readFixedArray(r, scores, readInt);
+        else if (keyIs(key, length, "riichi_status")) ok = readFixedArray(r, riichi_status, readBool);
+        else if (keyIs(key, length, "can_tsumo")) ok = r.readBool(can_tsumo);
+        else if (keyIs(key, length, "can_ron")) ok = r.readBool(can_ron);
+        else if (keyIs(key, length, "can_riichi")) ok = r.readBool(can_riichi);
+        else if (keyIs(key, length, "can_chi")) ok = r.readBool(can_chi);
+        else if (keyIs(key, length, "can_pon")) ok = r.readBool(can_pon);
+        else if (keyIs(key, length, "can_kan")) ok = r.readBool(can_kan);
+        else if (keyIs(key, length, "last_draw")) ok = r.readInt(last_draw);
+        else if (keyIs(key, length, "last_discard")) ok = r.readInt(last_discard);
+        else if (keyIs(key, length, "last_discard_player")) ok = r.readInt(last_discard_player);
+        else ok = r.skipValue();
+        if (!ok) return false;
+    }
+    return !r.failed();
 }
 
 GameState GameState::fromJSON(const std::string& json) {
-    // TODO: 实现 JSON 解析
-    // 生产环境应使用 nlohmann/json
     GameState state;
+    JsonReader reader(json.data(), json.size());
+    if (!state.readJSON(reader) || !reader.finish()) return GameState();
     return state;
 }
 
@@ -104,35 +154,272 @@ GameState GameState::getViewFor(int seat) const {
     // 隐藏其他玩家的手牌 (用 -1 表示暗牌)
     for (int i = 0; i < 4; ++i) {
         if (i != seat) {
-            size_t count = view.hands[i].size();
-            view.hands[i].clear();
-            view.hands[i].resize(count, -1);  // 只显示牌数，不显示具体牌
+            view.hands[i].assign(view.hands[i].size(), -1);  // 只显示牌数，不显示具体牌
         }
     }
+    if (view.current_player != seat) view.last_draw = -1;
 
     return view;
 }
 
+bool applyStateEvent(GameState& state, const StateEvent& event) {
+    if (event.kind == StateEventKind::Sticks) {
+        state.riichi_sticks = event.value;
+        return true;
+    }
+    if (event.seat < 0 || event.seat >= 4) return false;
+    HandTiles& hand = state.hands[event.seat];
+    switch (event.kind) {
+        case StateEventKind::Draw:
+            if (!hand.insertSorted(event.tile)) return false;
+            state.remaining_tiles--;
+            state.current_player = event.seat;
+            state.last_draw = event.tile;
+            break;
+        case StateEventKind::Discard: {
+            // 他家视角的手牌都是 -1
+            int pos = hand.find(event.tile);
+            if (pos < 0) pos = hand.find(-1);
+            RiverTiles& river = state.discards[event.seat];
+            if (pos < 0 || river.full() || !RiverTiles::storable(event.tile)) return false;
+            hand.erase(pos);
+            river.push_back(event.tile);
+            state.last_discard = event.tile;
+            state.last_discard_player = event.seat;
+            break;
+        }
+        case StateEventKind::Call:
+            state.current_player = event.seat;
+            break;
+        case StateEventKind::Riichi:
+            state.riichi_status[event.seat] = true;
+            break;
+        case StateEventKind::Score:
+            state.scores[event.seat] = event.value;
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+StateEvent viewEventFor(const StateEvent& event, int seat) {
+    StateEvent view = event;
+    if (event.kind == StateEventKind::Draw && event.seat != seat) view.tile = -1;
+    return view;
+}
+
+namespace {
+
+// 每种消息实际携带的字段 (按 MessageType 顺序)
+const unsigned message_fields[] = {
+    0,                                    // CreateRoom
+    RoomIdField | TokenField,             // JoinRoom
+    0,                                    // LeaveRoom
+    0,                                    // Ready
+    ActionField | TileField,              // Action
+    RoomIdField | SeatField | TokenField, // RoomCreated
+    RoomIdField | SeatField | TokenField, // RoomJoined
+    SeatField,                            // PlayerJoined
+    SeatField,                            // PlayerLeft
+    0,                                    // GameStart
+    StateField | SeqField,                // GameState
+    SeatField | TileField | TilesField,   // YourTurn
+    SeatField | ActionField | TileField,  // PlayerAction
+    SeatField | TilesField,               // GameEnd
+    ErrorField,                           // Error
+    SeqField | EventsField,               // StateDelta
+    SeqField                              // SyncRequest
+};
+
+static_assert(sizeof(message_fields) / sizeof(message_fields[0]) == static_cast<size_t>(message_type_count),
+              "message_fields must cover every MessageType");
+
+} // namespace
+
+unsigned messageFields(MessageType type) {
+    return message_fields[static_cast<int>(type)];
+}
+
+void GameMessage::appendJSON(std::string& out, ViewLayout* layout) const {
+    unsigned fields = message_fields[static_cast<int>(type)];
+    JsonWriter w(out);
+    w.beginObject();
+    w.field("type", static_cast<int>(type));
+    if (fields & RoomIdField) w.field("room_id", room_id);
+    if (fields & SeatField) w.field("seat", seat);
+    if (fields & ActionField) w.field("action", action);
+    if (fields & TileField) w.field("tile", tile);
+    if (fields & TilesField) {
+        w.key("tiles");
+        w.values(tiles.data(), tiles.size());
+    }
+    if (fields & ErrorField) w.field("error_msg", error_msg);
+    if (fields & StateField) {
+        w.key("state");
+        state.writeJSON(w, layout);
+    }
+    if (fields & SeqField) w.field("seq", seq);
+    if (fields & EventsField) {
+        // 每个事件写成 [kind, seat, tile, value]
+        w.key("events");
+        w.beginArray();
+        for (const StateEvent& e : events) {
+            const int values[4] = {static_cast<int>(e.kind), e.seat, e.tile, e.value};
+            w.values(values, 4);
+        }
+        w.endArray();
+    }
+    if (fields & TokenField) w.field("token", token);
+    w.endObject();
+}
+
 std::string GameMessage::toJSON() const {
-    std::ostringstream ss;
-    ss << "{";
+    std::string out;
+    appendJSON(out);
+    return out;
+}
+
+const std::string& GameMessage::serialize() const {
+    // clear 不释放容量，稳定后不再分配
+    thread_local std::string buffer;
+    buffer.clear();
+    appendJSON(buffer);
+    return buffer;
+}
+
+namespace {
+
+// type 以外认识的键
+unsigned messageFieldOf(const char* key, size_t length) {
+    if (keyIs(key, length, "room_id")) return RoomIdField;
+    if (keyIs(key, length, "seat")) return SeatField;
+    if (keyIs(key, length, "action")) return ActionField;
+    if (keyIs(key, length, "tile")) return TileField;
+    if (keyIs(key, length, "tiles")) return TilesField;
+    if (keyIs(key, length, "error_msg")) return ErrorField;
+    if (keyIs(key, length, "state")) return StateField;
+    if (keyIs(key, length, "seq")) return SeqField;
+    if (keyIs(key, length, "events")) return EventsField;
+    if (keyIs(key, length, "token")) return TokenField;
+    return 0;
+}
+
+bool readEvents(JsonReader& reader, std::vector<StateEvent>& events) {
+    events.clear();
+    std::vector<int> values;
+    if (!reader.beginArray()) return false;
+    while (reader.nextElement()) {
+        if (events.size() >= reader.getLimits().max_array) return reader.fail("array too long");
+        if (!reader.readInts(values)) return false;
+        if (values.size() != 4) return reader.fail("event needs 4 values");
+        if (values[0] < 0 || values[0] > static_cast<int>(StateEventKind::Sticks)) {
+            return reader.fail("unknown event kind");
+        }
+        events.push_back({static_cast<StateEventKind>(values[0]), values[1], values[2], values[3]});
+    }
+    return !reader.failed();
+}
+
+bool readMessageField(JsonReader& reader, unsigned field, GameMessage& msg) {
+    switch (field) {
+        case RoomIdField: return reader.readString(msg.room_id);
+        case SeatField: return reader.readInt(msg.seat);
+        case ActionField: return reader.readInt(msg.action);
+        case TileField: return reader.readInt(msg.tile);
+        case TilesField: return reader.readInts(msg.tiles);
+        case ErrorField: return reader.readString(msg.error_msg);
+        case StateField: return msg.state.readJSON(reader);
+        case SeqField: return reader.readInt(msg.seq);
+        case EventsField: return readEvents(reader, msg.events);
+        case TokenField: return reader.readString(msg.token);
+        default: return reader.skipValue();
+    }
+}
 
-    ss << "\"type\":" << static_cast<int>(type) << ",";
-    ss << "\"room_id\":\"" << escapeJSON(room_id) << "\",";
-    ss << "\"seat\":" << seat << ",";
-    ss << "\"action\":" << action << ",";
-    ss << "\"tile\":" << tile << ",";
-    ss << "\"tiles\":" << vectorToJSON(tiles) << ",";
-    ss << "\"error_msg\":\"" << escapeJSON(error_msg) << "\",";
-    ss << "\"state\":" << state.toJSON();
+} // namespace
 
-    ss << "}";
-    return ss.str();
+bool GameMessage::parseJSON(const char* data, size_t size, const char** error) {
+    return parseJSON(data, size, JsonLimits(), error);
+}
+
+bool GameMessage::parseJSON(const char* data, size_t size, const JsonLimits& limits, const char** error) {
+    const char* problem = nullptr;
+    auto report = [&](const JsonReader& reader) {
+        if (error) *error = problem ? problem : reader.error();
+        return false;
+    };
+
+    room_id.clear();
+    seat = action = tile = -1;
+    tiles.clear();
+    error_msg.clear();
+    seq = -1;
+    events.clear();
+    token.clear();
+
+    JsonReader reader(data, size, limits);
+    if (!reader.beginObject()) return report(reader);
+
+    // type 之前出现的字段只记下位置，确定类型后再决定是否解码
+    const char* pending[10] = {};
+    unsigned seen = 0, fields = 0;
+    bool has_type = false;
+    const char* key;
+    size_t length;
+    while (reader.nextKey(key, length)) {
+        if (keyIs(key, length, "type")) {
+            int value;
+            if (has_type) problem = "duplicate key";
+            else if (!reader.readInt(value)) return report(reader);
+            else if (value < 0 || value >= message_type_count) problem = "unknown message type";
+            if (problem) return report(reader);
+            type = static_cast<MessageType>(value);
+            fields = message_fields[value];
+            has_type = true;
+            if (fields & StateField) state = GameState();  // 其他类型不带状态，不必重置
+
+            continue;
+        }
+        unsigned field = messageFieldOf(key, length);
+        if (field & seen) {
+            problem = "duplicate key";
+            return report(reader);
+        }
+        seen |= field;
+        if (field && !has_type) {
+            pending[__builtin_ctz(field)] = reader.position();
+            if (!reader.skipValue()) return report(reader);
+        } else if (!readMessageField(reader, field & fields, *this)) {
+            return report(reader);
+        }
+    }
+    if (!reader.finish()) return report(reader);
+    if (!has_type) {
+        problem = "missing type";
+        return report(reader);
+    }
+
+    // 已经检查过语法，这里只解码该类型需要的字段 (外层对象占了一层嵌套)
+    JsonLimits inner = limits;
+    inner.max_depth = limits.max_depth - 1;
+    for (unsigned bits = seen & fields; bits; bits &= bits - 1) {
+        unsigned field = bits & (0u - bits);
+        const char* start = pending[__builtin_ctz(field)];
+        if (!start) continue;
+        JsonReader value_reader(start, static_cast<size_t>(data + size - start), inner);
+        if (!readMessageField(value_reader, field, *this)) return report(value_reader);
+    }
+    return true;
 }
 
 GameMessage GameMessage::fromJSON(const std::string& json) {
-    // TODO: 实现 JSON 解析
     GameMessage msg;
-    msg.type = MessageType::Error;
+    const char* error = nullptr;
+    if (!msg.parseJSON(json.data(), json.size(), &error)) {
+        msg = GameMessage();
+        msg.type = MessageType::Error;
+        msg.error_msg = error;
+    }
     return msg;
 }
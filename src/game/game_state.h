@@ -1,59 +1,207 @@
 #ifndef GAME_STATE_H
 #define GAME_STATE_H
 
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <string>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
 #include "types.h"
 
+class JsonWriter;
+class JsonReader;
+struct JsonLimits;
+
+// 写出时记录随视角变化的几段在输出中的位置 [begin, end)
+// 只替换这几段就能由公共部分拼出各座位的视角
+struct ViewLayout {
+    std::array<size_t, 4> hand_begin{};
+    std::array<size_t, 4> hand_end{};
+    size_t last_draw_begin = 0;
+    size_t last_draw_end = 0;
+};
+
+// 容量固定的牌列表: TileIndex 存成 uint8，255 表示 -1 (暗牌)
+// 未使用的位置保持为 0，整体可 memcpy / memcmp
+template <size_t N>
+struct TileArray {
+    static const size_t capacity = N;
+    static const uint8_t hidden = 255;
+
+    uint8_t count = 0;
+    uint8_t tiles[N] = {};
+
+    TileArray() = default;
+    TileArray(std::initializer_list<int> values) { assign(values.begin(), values.size()); }
+
+    // 只接受 -1 .. 254
+    static bool storable(int tile) { return tile >= -1 && tile < hidden; }
+    static uint8_t pack(int tile) { return tile < 0 ? hidden : static_cast<uint8_t>(tile); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    int operator[](size_t i) const { return tiles[i] == hidden ? -1 : tiles[i]; }
+    const uint8_t* data() const { return tiles; }  // 即二进制线格式的每张一字节
+
+    void clear() {
+        std::memset(tiles, 0, count);
+        count = 0;
+    }
+    bool push_back(int tile) {
+        if (full() || !storable(tile)) return false;
+        tiles[count++] = pack(tile);
+        return true;
+    }
+    // 超出容量或范围时返回 false (此时内容不变)
+    bool assign(const int* values, size_t n) {
+        if (n > N) return false;
+        for (size_t i = 0; i < n; ++i) {
+            if (!storable(values[i])) return false;
+        }
+        clear();
+        // 上界写成 min 让编译器看到不会越界 (否则 -O3 误报 -Wstringop-overflow)
+        std::transform(values, values + std::min(n, N), tiles, pack);
+        count = static_cast<uint8_t>(n);
+        return true;
+    }
+    bool assign(size_t n, int tile) {
+        if (n > N || !storable(tile)) return false;
+        clear();
+        std::memset(tiles, pack(tile), n);
+        count = static_cast<uint8_t>(n);
+        return true;
+    }
+    // 已按线格式打包的字节 (255 为暗牌)
+    bool assignPacked(const uint8_t* bytes, size_t n) {
+        if (n > N) return false;
+        clear();
+        std::memcpy(tiles, bytes, n);
+        count = static_cast<uint8_t>(n);
+        return true;
+    }
+
+    // 按整数值有序插入 (-1 排在最前)
+    bool insertSorted(int tile) {
+        if (full() || !storable(tile)) return false;
+        size_t pos = count;
+        while (pos > 0 && (*this)[pos - 1] > tile) pos--;
+        std::memmove(tiles + pos + 1, tiles + pos, count - pos);
+        tiles[pos] = pack(tile);
+        count++;
+        return true;
+    }
+    int find(int tile) const {
+        uint8_t packed = pack(tile);
+        for (size_t i = 0; i < count; ++i) {
+            if (tiles[i] == packed) return static_cast<int>(i);
+        }
+        return -1;
+    }
+    void erase(size_t i) {
+        std::memmove(tiles + i, tiles + i + 1, count - i - 1);
+        tiles[--count] = 0;
+    }
+
+    bool operator==(const TileArray& other) const {
+        return count == other.count && std::memcmp(tiles, other.tiles, count) == 0;
+    }
+    bool operator!=(const TileArray& other) const { return !(*this == other); }
+    std::vector<int> toVector() const {
+        std::vector<int> out(count);
+        for (size_t i = 0; i < count; ++i) out[i] = (*this)[i];
+        return out;
+    }
+};
+
+// 手牌最多 14 张 (含摸到的牌)；牌河同 SeatSnapshot 的上限
+const size_t max_hand_tiles = 14;
+const size_t max_river_tiles = 32;
+using HandTiles = TileArray<max_hand_tiles>;
+using RiverTiles = TileArray<max_river_tiles>;
+
 // 游戏状态 (用于网络同步和状态保存)
+// 全部是定长字段，复制即 memcpy，不分配内存
 struct GameState {
     // 游戏基本信息
-    int round_wind;           // 场风 (0-3: 东南西北)
-    int dealer;               // 庄家座位
-    int current_player;       // 当前玩家
-    int remaining_tiles;      // 剩余牌数
-    int honba;                // 本场数
-    int riichi_sticks;        // 场上立直棒
+    int round_wind = 0;       // 场风 (0-3: 东南西北)
+    int dealer = 0;           // 庄家座位
+    int current_player = 0;   // 当前玩家
+    int remaining_tiles = 0;  // 剩余牌数
+    int honba = 0;            // 本场数
+    int riichi_sticks = 0;    // 场上立直棒
 
     // 各家手牌 (对于请求者可见的部分)
-    std::array<std::vector<int>, 4> hands;
+    std::array<HandTiles, 4> hands;
 
     // 各家牌河
-    std::array<std::vector<int>, 4> discards;
+    std::array<RiverTiles, 4> discards;
 
-    // 各家副露
-    std::array<std::vector<std::pair<int, std::vector<int>>>, 4> melds;  // (类型, 牌)
+    // 各家副露: 每组 MeldType + 4 张 TileIndex (同 SeatSnapshot)
+    std::array<uint8_t, 4> meld_counts{};
+    uint8_t melds[4][4][5] = {};
 
     // 各家点数
-    std::array<int, 4> scores;
+    std::array<int, 4> scores{};
 
     // 各家立直状态
-    std::array<bool, 4> riichi_status;
+    std::array<bool, 4> riichi_status{};
 
     // 当前可用动作 (针对请求玩家)
-    bool can_tsumo;
-    bool can_ron;
-    bool can_riichi;
-    bool can_chi;
-    bool can_pon;
-    bool can_kan;
+    bool can_tsumo = false;
+    bool can_ron = false;
+    bool can_riichi = false;
+    bool can_chi = false;
+    bool can_pon = false;
+    bool can_kan = false;
 
     // 最后摸到/打出的牌
-    int last_draw;
-    int last_discard;
-    int last_discard_player;
+    int last_draw = -1;
+    int last_discard = -1;
+    int last_discard_player = -1;
 
-    // 序列化为 JSON 字符串
+    // 序列化为 JSON: 直接写入 writer / 追加到 out 末尾 / 返回新字符串
+    // layout 非空时记录各家手牌和最后摸牌在 writer 缓冲区中的位置
+    void writeJSON(JsonWriter& writer, ViewLayout* layout = nullptr) const;
+    void appendJSON(std::string& out) const;
     std::string toJSON() const;
 
-    // 从 JSON 字符串反序列化
+    // 从 JSON 反序列化: readJSON 从 reader 当前位置读一个对象 (未出现的字段保持原值，不认识的键跳过)
+    bool readJSON(JsonReader& reader);
     static GameState fromJSON(const std::string& json);
 
-    // 创建针对特定玩家的视角 (隐藏其他玩家手牌)
+    // 创建针对特定玩家的视角 (隐藏其他玩家手牌和摸到的牌)
     GameState getViewFor(int seat) const;
 };
 
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must be memcpy-able");
+
+// 增量同步的事件，房间内按序号连续编号 (StateDelta 消息)
+enum class StateEventKind {
+    Draw,     // seat 摸到 tile (他家视角为 -1)
+    Discard,  // seat 打出 tile
+    Call,     // seat 鸣 tile (value 为动作)，轮到 seat
+    Riichi,   // seat 立直
+    Score,    // seat 的点数变为 value
+    Sticks    // 场上立直棒变为 value (不用 seat)
+};
+
+struct StateEvent {
+    StateEventKind kind;
+    int seat;
+    int tile;
+    int value;
+};
+
+// 把事件应用到状态上 (服务器的完整状态和客户端的视角共用，手牌保持有序)
+// 返回 false 表示事件和状态不一致 (座位越界、打出的牌不在手中)，此时应请求完整快照
+bool applyStateEvent(GameState& state, const StateEvent& event);
+// seat 视角下的事件
+StateEvent viewEventFor(const StateEvent& event, int seat);
+
 // 游戏消息类型
 enum class MessageType {
     // 客户端 -> 服务器
@@ -73,21 +221,56 @@ enum class MessageType {
     YourTurn,
     PlayerAction,
     GameEnd,
-    Error
+    Error,
+    StateDelta,   // 服务器 -> 客户端: 从 seq 开始的连续事件
+    SyncRequest   // 客户端 -> 服务器: 改用增量同步，已有到 seq 为止的状态 (-1 请求完整快照)
 };
 
+const int message_type_count = static_cast<int>(MessageType::SyncRequest) + 1;
+
+// 消息字段 (位掩码)，每种消息只携带其中一部分
+enum MessageField : unsigned {
+    RoomIdField = 1 << 0,
+    SeatField = 1 << 1,
+    ActionField = 1 << 2,
+    TileField = 1 << 3,
+    TilesField = 1 << 4,
+    ErrorField = 1 << 5,
+    StateField = 1 << 6,
+    SeqField = 1 << 7,
+    EventsField = 1 << 8,
+    TokenField = 1 << 9
+};
+
+// type 携带的字段
+unsigned messageFields(MessageType type);
+
 // 游戏消息
 struct GameMessage {
-    MessageType type;
+    MessageType type = MessageType::Error;
     std::string room_id;
-    int seat;
-    int action;
-    int tile;
+    int seat = -1;
+    int action = -1;
+    int tile = -1;
     std::vector<int> tiles;
     std::string error_msg;
     GameState state;
+    int seq = -1;                    // GameState: 快照对应的序号；StateDelta: 第一个事件的序号
+    std::vector<StateEvent> events;
+    std::string token;               // 座位凭证: 入座时下发，对局中重新加入时带回
 
+    // 只写出 type 用到的字段 (messageFields)
+    void appendJSON(std::string& out, ViewLayout* layout = nullptr) const;
     std::string toJSON() const;
+    // 写入当前线程复用的缓冲区，返回的引用在本线程下一次 serialize 之前有效
+    const std::string& serialize() const;
+
+    // 先确定 type，再只解码该类型用到的字段，其余的键只检查语法后跳过
+    // 解析到 *this 以复用字符串和数组的容量 (state 只在 GameState 消息中重置)
+    // 失败时返回 false，error 指向静态的错误说明
+    bool parseJSON(const char* data, size_t size, const char** error = nullptr);
+    bool parseJSON(const char* data, size_t size, const JsonLimits& limits, const char** error = nullptr);
+    // 失败时返回 type 为 Error、error_msg 为错误说明的消息
     static GameMessage fromJSON(const std::string& json);
 };
 
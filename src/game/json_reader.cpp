@@ -0,0 +1,331 @@
+#include "json_reader.h"
+
+#include <climits>
+#include <cstring>
+
+namespace {
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline int readHex4(const char* s) {
+    int v = 0;
+    for (int i = 0; i < 4; ++i) {
+        int h = hexValue(s[i]);
+        if (h < 0) return -1;
+        v = v << 4 | h;
+    }
+    return v;
+}
+
+void appendUtf8(std::string& out, unsigned code) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | code >> 6));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | code >> 12));
+        out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | code >> 18));
+        out.push_back(static_cast<char>(0x80 | (code >> 12 & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+} // namespace
+
+JsonReader::JsonReader(const char* data, size_t size, const JsonLimits& config)
+    : begin(data), p(data), end(data + size), limits(config), depth(0), first_bits(0), error_text(nullptr) {
+    if (limits.max_depth > 63) limits.max_depth = 63;
+    if (size > limits.max_size) fail("message too large");
+}
+
+bool JsonReader::fail(const char* message) {
+    if (!error_text) error_text = message;
+    return false;
+}
+
+void JsonReader::skipSpace() {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+}
+
+bool JsonReader::expect(char c) {
+    skipSpace();
+    if (p >= end || *p != c) return fail("unexpected character");
+    ++p;
+    return true;
+}
+
+bool JsonReader::enter() {
+    if (++depth > limits.max_depth) return fail("nesting too deep");
+    first_bits |= 1ULL << depth;
+    return true;
+}
+
+bool JsonReader::literal(const char* text, size_t length) {
+    if (static_cast<size_t>(end - p) < length || std::memcmp(p, text, length) != 0) {
+        return fail("invalid literal");
+    }
+    p += length;
+    return true;
+}
+
+// 找到字符串的范围 [start, stop)，检查转义和控制字符，但不解码
+bool JsonReader::scanString(const char*& start, const char*& stop, bool& escaped) {
+    if (!expect('"')) return false;
+    start = p;
+    escaped = false;
+    while (true) {
+        if (p >= end) return fail("unterminated string");
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"') break;
+        if (c < 0x20) return fail("control character in string");
+        if (c == '\\') {
+            escaped = true;
+            if (end - p < 2) return fail("unterminated string");
+            switch (p[1]) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    p += 2;
+                    break;
+                case 'u':
+                    if (end - p < 6 || readHex4(p + 2) < 0) return fail("invalid unicode escape");
+                    p += 6;
+                    break;
+                default:
+                    return fail("invalid escape");
+            }
+            continue;
+        }
+        ++p;
+    }
+    stop = p++;
+    return true;
+}
+
+// 解码已经检查过的字符串内容
+bool JsonReader::decodeString(const char* start, const char* stop, std::string& out, size_t max_len) {
+    out.clear();
+    for (const char* s = start; s < stop;) {
+        const char* run = s;
+        while (s < stop && *s != '\\') ++s;
+        out.append(run, s - run);
+        if (s >= stop) break;
+        char c = s[1];
+        s += 2;
+        switch (c) {
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                unsigned code = static_cast<unsigned>(readHex4(s));
+                s += 4;
+                if (code >= 0xDC00 && code <= 0xDFFF) return fail("unpaired surrogate");
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    int low = stop - s >= 6 && s[0] == '\\' && s[1] == 'u' ? readHex4(s + 2) : -1;
+                    if (low < 0xDC00 || low > 0xDFFF) return fail("unpaired surrogate");
+                    code = 0x10000 + ((code - 0xD800) << 10) + (static_cast<unsigned>(low) - 0xDC00);
+                    s += 6;
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default: out.push_back(c); break;  // " \ /
+        }
+        if (out.size() > max_len) return fail("string too long");
+    }
+    if (out.size() > max_len) return fail("string too long");
+    return true;
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool JsonReader::scanNumber(bool& integral) {
+    skipSpace();
+    integral = true;
+    if (p < end && *p == '-') ++p;
+    if (p >= end || !isDigit(*p)) return fail("invalid number");
+    if (*p == '0') {
+        ++p;
+    } else {
+        while (p < end && isDigit(*p)) ++p;
+    }
+    if (p < end && *p == '.') {
+        integral = false;
+        ++p;
+        if (p >= end || !isDigit(*p)) return fail("invalid number");
+        while (p < end && isDigit(*p)) ++p;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        integral = false;
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) ++p;
+        if (p >= end || !isDigit(*p)) return fail("invalid number");
+        while (p < end && isDigit(*p)) ++p;
+    }
+    return true;
+}
+
+bool JsonReader::beginObject() {
+    if (failed() || !expect('{')) return false;
+    return enter();
+}
+
+bool JsonReader::nextKey(const char*& key, size_t& length) {
+    if (failed()) return false;
+    skipSpace();
+    if (p < end && *p == '}') {
+        // 逗号后面的 '}' 在读键名时失败，这里只会遇到对象真正的结尾
+        ++p;
+        depth--;
+        return false;
+    }
+    if (!(first_bits >> depth & 1) && !expect(',')) return false;
+    first_bits &= ~(1ULL << depth);
+
+    const char* start;
+    const char* stop;
+    bool escaped;
+    if (!scanString(start, stop, escaped)) return false;
+    if (escaped) {
+        if (!decodeString(start, stop, escaped_key, limits.max_string)) return false;
+        key = escaped_key.data();
+        length = escaped_key.size();
+    } else {
+        key = start;
+        length = static_cast<size_t>(stop - start);
+    }
+    return expect(':');
+}
+
+bool JsonReader::beginArray() {
+    if (failed() || !expect('[')) return false;
+    return enter();
+}
+
+bool JsonReader::nextElement() {
+    if (failed()) return false;
+    skipSpace();
+    if (p < end && *p == ']') {
+        // "[1,]" 在读值时失败，这里只会遇到数组真正的结尾
+        ++p;
+        depth--;
+        return false;
+    }
+    if (!(first_bits >> depth & 1) && !expect(',')) return false;
+    first_bits &= ~(1ULL << depth);
+    return true;
+}
+
+bool JsonReader::readInt(int& value) {
+    if (failed()) return false;
+    skipSpace();
+    const char* start = p;
+    bool integral;
+    if (!scanNumber(integral)) return false;
+    if (!integral) return fail("expected integer");
+
+    const char* s = start;
+    bool negative = *s == '-';
+    if (negative) ++s;
+    long long v = 0;
+    for (; s < p; ++s) {
+        v = v * 10 + (*s - '0');
+        if (v > static_cast<long long>(INT_MAX) + 1) return fail("integer out of range");
+    }
+    if (negative) v = -v;
+    if (v > INT_MAX) return fail("integer out of range");
+    value = static_cast<int>(v);
+    return true;
+}
+
+bool JsonReader::readBool(bool& value) {
+    if (failed()) return false;
+    skipSpace();
+    if (p < end && *p == 't') {
+        value = true;
+        return literal("true", 4);
+    }
+    value = false;
+    if (p < end && *p == 'f') return literal("false", 5);
+    return fail("expected boolean");
+}
+
+bool JsonReader::readString(std::string& out) {
+    if (failed()) return false;
+    const char* start;
+    const char* stop;
+    bool escaped;
+    if (!scanString(start, stop, escaped)) return false;
+    if (!escaped) {
+        if (static_cast<size_t>(stop - start) > limits.max_string) return fail("string too long");
+        out.assign(start, stop);
+        return true;
+    }
+    return decodeString(start, stop, out, limits.max_string);
+}
+
+bool JsonReader::readInts(std::vector<int>& out) {
+    out.clear();
+    if (!beginArray()) return false;
+    while (nextElement()) {
+        if (out.size() >= limits.max_array) return fail("array too long");
+        int v;
+        if (!readInt(v)) return false;
+        out.push_back(v);
+    }
+    return !failed();
+}
+
+bool JsonReader::skipValue() {
+    if (failed()) return false;
+    skipSpace();
+    if (p >= end) return fail("unexpected end");
+    switch (*p) {
+        case '{': {
+            beginObject();
+            const char* key;
+            size_t length;
+            while (nextKey(key, length)) {
+                if (!skipValue()) return false;
+            }
+            return !failed();
+        }
+        case '[':
+            beginArray();
+            while (nextElement()) {
+                if (!skipValue()) return false;
+            }
+            return !failed();
+        case '"': {
+            const char* start;
+            const char* stop;
+            bool escaped;
+            return scanString(start, stop, escaped);
+        }
+        case 't': return literal("true", 4);
+        case 'f': return literal("false", 5);
+        case 'n': return literal("null", 4);
+        default: {
+            bool integral;
+            return scanNumber(integral);
+        }
+    }
+}
+
+bool JsonReader::finish() {
+    if (failed()) return false;
+    skipSpace();
+    if (p != end) return fail("trailing characters");
+    return true;
+}
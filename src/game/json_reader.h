@@ -0,0 +1,73 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 解析不可信输入时的上限
+struct JsonLimits {
+    size_t max_size = 64 * 1024;  // 整条消息的字节数
+    int max_depth = 16;           // 对象 / 数组的嵌套层数 (最多 63)
+    size_t max_array = 256;       // 整数数组的元素个数
+    size_t max_string = 1024;     // 解码后字符串的字节数
+};
+
+// 在原始缓冲区上就地解析的 JSON 读取器
+// 按调用方的需要逐个读取值，不建立文档树；键名直接和原始字节比较，不为键分配字符串
+// 任何一步出错后 failed() 为真，之后的读取都返回 false
+// 严格按 RFC 8259 检查语法 (数字格式、转义、控制字符)，不检查字符串的 UTF-8 编码
+class JsonReader {
+private:
+    const char* begin;
+    const char* p;
+    const char* end;
+    JsonLimits limits;
+    int depth;
+    unsigned long long first_bits;  // 每层一位: 该层还没有读过元素
+    const char* error_text;
+    std::string escaped_key;  // 含转义的键名解码到这里 (很少见)
+
+    void skipSpace();
+    bool expect(char c);
+    bool enter();
+    bool scanString(const char*& start, const char*& stop, bool& escaped);
+    bool decodeString(const char* start, const char* stop, std::string& out, size_t max_len);
+    bool scanNumber(bool& integral);
+    bool literal(const char* text, size_t length);
+
+public:
+    JsonReader(const char* data, size_t size, const JsonLimits& limits = JsonLimits());
+
+    bool failed() const { return error_text != nullptr; }
+    const char* error() const { return error_text ? error_text : ""; }
+    size_t offset() const { return static_cast<size_t>(p - begin); }
+    const char* position() const { return p; }
+    const JsonLimits& getLimits() const { return limits; }
+    // 调用方做语义检查 (个数、取值范围) 时用同样的方式报错
+    bool fail(const char* message);
+
+    // 对象: beginObject 后反复调用 nextKey，返回 false 表示对象结束 (已读掉 '}') 或出错
+    bool beginObject();
+    bool nextKey(const char*& key, size_t& length);
+    // 数组: beginArray 后反复调用 nextElement，返回 false 表示数组结束 (已读掉 ']') 或出错
+    bool beginArray();
+    bool nextElement();
+
+    bool readInt(int& value);
+    bool readBool(bool& value);
+    bool readString(std::string& out);
+    bool readInts(std::vector<int>& out);
+    bool skipValue();
+
+    // 值之后只剩空白
+    bool finish();
+};
+
+// 键名和字面量比较
+template <size_t N>
+inline bool keyIs(const char* key, size_t length, const char (&name)[N]) {
+    return length == N - 1 && std::char_traits<char>::compare(key, name, N - 1) == 0;
+}
+
+#endif // JSON_READER_H
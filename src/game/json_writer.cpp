@@ -0,0 +1,105 @@
+#include "json_writer.h"
+
+namespace {
+
+// "00" "01" ... "99"
+const char digit_pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// 需要转义的字节: 引号、反斜杠和控制字符
+inline bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+} // namespace
+
+size_t formatInt(int v, char* dst) {
+    char* p = dst;
+    uint32_t u = static_cast<uint32_t>(v);
+    if (v < 0) {
+        *p++ = '-';
+        u = 0u - u;  // INT_MIN 也不溢出
+    }
+
+    // 从低位往高位写到临时区，再整体拷贝
+    char tmp[10];
+    char* end = tmp + sizeof(tmp);
+    char* q = end;
+    while (u >= 100) {
+        uint32_t pair = u % 100;
+        u /= 100;
+        q -= 2;
+        std::memcpy(q, digit_pairs + pair * 2, 2);
+    }
+    if (u >= 10) {
+        q -= 2;
+        std::memcpy(q, digit_pairs + u * 2, 2);
+    } else {
+        *--q = static_cast<char>('0' + u);
+    }
+    size_t len = static_cast<size_t>(end - q);
+    std::memcpy(p, q, len);
+    return static_cast<size_t>(p - dst) + len;
+}
+
+void JsonWriter::value(int v) {
+    separate();
+    char text[12];
+    out.append(text, formatInt(v, text));
+}
+
+void JsonWriter::value(const char* s, size_t len) {
+    separate();
+    out.push_back('"');
+    // 不需要转义的连续片段整段追加
+    size_t start = 0;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (!needsEscape(c)) continue;
+        out.append(s + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"': out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            default: {
+                char code[6] = {'\\', 'u', '0', '0', "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 15]};
+                out.append(code, 6);
+            }
+        }
+    }
+    out.append(s + start, len - start);
+    out.push_back('"');
+}
+
+void JsonWriter::values(const int* data, size_t count) {
+    separate();
+    out.push_back('[');
+    char text[12];
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) out.push_back(',');
+        out.append(text, formatInt(data[i], text));
+    }
+    out.push_back(']');
+}
+
+void JsonWriter::tiles(const uint8_t* data, size_t count) {
+    separate();
+    out.push_back('[');
+    char text[12];
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) out.push_back(',');
+        if (data[i] == 255) {
+            out.append("-1", 2);
+        } else {
+            out.append(text, formatInt(data[i], text));
+        }
+    }
+    out.push_back(']');
+}
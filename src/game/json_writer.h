@@ -0,0 +1,58 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 直接追加到调用方缓冲区的 JSON 写入器
+// 缓冲区由调用方持有并反复使用 (clear 保留容量)，写入过程中不产生临时字符串
+// 逗号由写入器按嵌套层次自动补上；不检查结构是否合法，调用方保证 begin / end 成对
+class JsonWriter {
+private:
+    std::string& out;
+    uint32_t need_comma;  // 每层一位: 该层已经写过元素
+    int depth;
+
+    void separate() {
+        if (need_comma >> depth & 1) out.push_back(',');
+        need_comma |= 1u << depth;
+    }
+
+public:
+    explicit JsonWriter(std::string& buffer) : out(buffer), need_comma(0), depth(0) {}
+
+    std::string& buffer() { return out; }
+
+    void beginObject() { separate(); out.push_back('{'); depth++; need_comma &= ~(1u << depth); }
+    void endObject() { depth--; out.push_back('}'); }
+    void beginArray() { separate(); out.push_back('['); depth++; need_comma &= ~(1u << depth); }
+    void endArray() { depth--; out.push_back(']'); }
+
+    // 键名是不需要转义的字面量
+    template <size_t N>
+    void key(const char (&name)[N]) {
+        separate();
+        out.push_back('"');
+        out.append(name, N - 1);
+        out.append("\":", 2);
+        need_comma &= ~(1u << depth);  // 紧跟的值不加逗号
+    }
+
+    void value(int v);
+    void value(bool v) { separate(); v ? out.append("true", 4) : out.append("false", 5); }
+    void value(const std::string& s) { value(s.data(), s.size()); }
+    void value(const char* s, size_t len);
+    void values(const int* data, size_t count);  // 整数数组
+    void tiles(const uint8_t* data, size_t count);  // 打包的牌数组 (255 写成 -1)
+
+    // 常用的 "键: 值"
+    template <size_t N, typename T>
+    void field(const char (&name)[N], const T& v) { key(name); value(v); }
+};
+
+// 整数写到 dst，返回写入的字节数 (两位一组查表)
+size_t formatInt(int v, char* dst);
+
+#endif // JSON_WRITER_H
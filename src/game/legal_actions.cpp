@@ -0,0 +1,134 @@
+#include "legal_actions.h"
+#include "player.h"
+#include "table.h"
+
+#include <cstring>
+
+void LegalActions::clear() {
+    std::memset(this, 0, sizeof(*this));
+}
+
+TileMask LegalActions::getDiscardKinds() const {
+    TileMask kinds = 0;
+    for (TileIndex tile = 0; tile < 136; ++tile) {
+        if (allows(tile)) kinds |= 1ULL << (tile / 4);
+    }
+    return kinds;
+}
+
+static TileCounts toCounts(const LegalHand& hand) {
+    TileCounts counts;
+    counts.fill(0);
+    for (int tile = 0; tile < 34; ++tile) counts[tile] = hand.counts[tile];
+    return counts;
+}
+
+void fillLegalHand(const Player& player, LegalHand& out) {
+    std::memset(&out, 0, sizeof(out));
+    const Hand* hand = player.getHand();
+    if (!hand) return;
+    for (TileIndex tile : hand->getTiles()) {
+        out.tiles[tile >> 6] |= 1ULL << (tile & 63);
+        out.counts[tile / 4]++;
+    }
+    for (const TileMeld& meld : hand->getOpenMelds()) {
+        if (meld.type == MeldType::Pon) out.pon_mask |= 1ULL << meld.tile;
+    }
+    out.wait_mask = hand->getWaitMask();
+    out.is_menzen = hand->isMenzen();
+    out.is_riichi = hand->isRiichi();
+    out.is_furiten = player.isFuriten();
+    out.score = player.getScore();
+}
+
+void computeTurnActions(const LegalHand& hand, TileIndex drawn, int remaining, int kan_count,
+                        LegalActions& out) {
+    out.clear();
+    TileCounts counts = toCounts(hand);
+    counts[drawn / 4]++;
+
+    if (hand.wait_mask >> (drawn / 4) & 1) {
+        out.set(static_cast<int>(Action::Win));
+        out.options |= DecisionOption::Tsumo;
+    }
+
+    // 立直后只能摸切
+    if (!hand.is_riichi) {
+        for (int word = 0; word < 3; ++word) out.bits[word] |= hand.tiles[word];
+    }
+    out.set(drawn);
+
+    // 立直: 门清、未立直、点数够 1000、牌山至少还剩 4 张，且有打出后听牌的牌
+    if (!hand.is_riichi && hand.is_menzen && hand.score >= 1000 && remaining >= 4) {
+        out.riichi = calcRiichiDiscards(counts);
+        if (out.riichi) {
+            out.set(static_cast<int>(Action::Riichi));
+            out.options |= DecisionOption::Riichi;
+        }
+    }
+
+    // 暗杠 / 加杠: 需要岭上牌，且牌山不能已经摸完
+    // Table 还不能执行杠，只给出可杠的牌种，不开放 Action::Ankan
+    if (kan_count < 4 && remaining > 0) {
+        for (Tile tile = 0; tile < 34; ++tile) {
+            if (counts[tile] == 4) {
+                if (!hand.is_riichi) {
+                    out.ankan |= 1ULL << tile;
+                } else if (tile == drawn / 4) {
+                    // 立直后只能杠摸到的牌，且不能改变听牌
+                    TileCounts rest = toCounts(hand);
+                    rest[tile] -= 3;
+                    if (calcWaitMask(rest, true) == hand.wait_mask) out.ankan |= 1ULL << tile;
+                }
+            } else if (counts[tile] > 0 && (hand.pon_mask >> tile & 1)) {
+                out.kakan |= 1ULL << tile;
+            }
+        }
+    }
+}
+
+void restrictToRiichiDiscards(LegalActions& out) {
+    LegalActions turn = out;
+    out.clear();
+    out.riichi = turn.riichi;
+    for (TileIndex tile = 0; tile < 136; ++tile) {
+        if (turn.allows(tile) && (turn.riichi >> (tile / 4) & 1)) out.set(tile);
+    }
+}
+
+void computeResponseActions(const LegalHand& hand, TileIndex discard, bool is_next_seat, int remaining,
+                            int kan_count, LegalActions& out) {
+    out.clear();
+    Tile tile = discard / 4;
+
+    if ((hand.wait_mask >> tile & 1) && !hand.is_furiten) {
+        out.set(static_cast<int>(Action::Win));
+        out.options |= DecisionOption::Ron;
+    }
+
+    // 立直后不能鸣牌，海底牌不能鸣牌
+    if (!hand.is_riichi && remaining > 0) {
+        if (hand.counts[tile] >= 2) {
+            out.set(static_cast<int>(Action::Pon));
+            out.options |= DecisionOption::Pon;
+        }
+        if (hand.counts[tile] == 3 && kan_count < 4) {
+            out.set(static_cast<int>(Action::Kan));
+            out.options |= DecisionOption::Kan;
+        }
+        if (is_next_seat) {
+            auto has = [&](Tile t) { return t != invalid_tile && hand.counts[t] > 0; };
+            Tile prev = getPrevTile(tile), next = getNextTile(tile);
+            Tile prev2 = getPrevTile(prev), next2 = getNextTile(next);
+            if (has(next) && has(next2)) out.chi |= ChiShape::Low;
+            if (has(prev) && has(next)) out.chi |= ChiShape::Mid;
+            if (has(prev2) && has(prev)) out.chi |= ChiShape::High;
+            if (out.chi) {
+                out.set(static_cast<int>(Action::Chi));
+                out.options |= DecisionOption::Chi;
+            }
+        }
+    }
+
+    if (out.any()) out.set(static_cast<int>(Action::Pass));
+}
@@ -0,0 +1,66 @@
+#ifndef LEGAL_ACTIONS_H
+#define LEGAL_ACTIONS_H
+
+#include <cstdint>
+#include "types.h"
+
+class Player;
+
+// 吃的形状 (被吃的牌在顺子中的位置)
+namespace ChiShape {
+    const int Low  = 1 << 0;  // 被吃的牌最小: call, call+1, call+2
+    const int Mid  = 1 << 1;  // 被吃的牌居中: call-1, call, call+1
+    const int High = 1 << 2;  // 被吃的牌最大: call-2, call-1, call
+}
+
+// 计算合法动作所需的一家手牌信息 (Player 和 GameSnapshot 都能低成本填充)
+struct LegalHand {
+    uint64_t tiles[3];      // 门前手牌的 TileIndex 位图 (不含摸到的牌)
+    uint8_t counts[34];     // 门前手牌各种牌的张数
+    TileMask wait_mask;     // 门前手牌的和了牌
+    TileMask pon_mask;      // 已碰的牌种 (加杠用)
+    bool is_menzen;
+    bool is_riichi;
+    bool is_furiten;
+    int score;
+};
+
+// 一家在一个决策点上的全部合法动作，决策前计算一次
+// bits 按动作编码排列 (0-135 弃牌，136 起为 Action)，校验客户端动作只需一次位测试
+// 自摸与荣和都是 Action::Win，细分信息在各自的掩码中
+// Table 实现杠之前 ankan / kakan 只是可杠的牌种，bits 中不含 Action::Ankan
+struct LegalActions {
+    uint64_t bits[3];
+    TileMask riichi;   // 立直宣言牌可选的牌种
+    TileMask ankan;    // 可暗杠的牌种
+    TileMask kakan;    // 可加杠的牌种
+    uint8_t chi;       // 可吃的形状 (ChiShape 位)
+    uint8_t options;   // 同 onDecision 的 DecisionOption 位
+
+    void clear();
+    bool allows(int action) const { return action >= 0 && action < 192 && (bits[action >> 6] >> (action & 63) & 1); }
+    bool canDiscard(TileIndex tile) const { return tile >= 0 && tile < 136 && allows(tile); }
+    bool any() const { return (bits[0] | bits[1] | bits[2]) != 0; }
+    int getOptions() const { return options; }
+    TileMask getDiscardKinds() const;  // 可打出的牌种
+
+    void set(int action) { bits[action >> 6] |= 1ULL << (action & 63); }
+};
+
+// 从玩家当前的手牌填充 (摸到的牌不计入)
+void fillLegalHand(const Player& player, LegalHand& hand);
+
+// 摸牌后的决策: 自摸、弃牌、立直 (暗杠、加杠只填掩码)
+// remaining 为牌山剩余张数 (不含王牌)，立直后只能摸切，暗杠不能改变听牌
+void computeTurnActions(const LegalHand& hand, TileIndex drawn, int remaining, int kan_count,
+                        LegalActions& out);
+
+// 立直宣言牌的决策: 在 computeTurnActions 的结果上只保留打出后听牌的弃牌
+void restrictToRiichiDiscards(LegalActions& out);
+
+// 对他家弃牌的响应: 荣和、碰、大明杠、吃 (只有下家)，有任一动作时才能过
+// 立直后和海底牌不能鸣牌
+void computeResponseActions(const LegalHand& hand, TileIndex discard, bool is_next_seat, int remaining,
+                            int kan_count, LegalActions& out);
+
+#endif // LEGAL_ACTIONS_H
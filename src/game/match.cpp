@@ -0,0 +1,131 @@
+#include "match.h"
+#include "table.h"
+#include "player.h"
+
+#include <cassert>
+
+Match::Match(Table* t, const MatchRules& r) : table(t), rules(r) {
+    result.scores.fill(0);
+    result.ranks.fill(0);
+    result.wins.fill(0);
+    result.deal_ins.fill(0);
+    result.rounds_played = 0;
+    result.busted = false;
+}
+
+int Match::getTopSeat(int first_dealer) const {
+    int top = -1;
+    for (int i = 0; i < 4; ++i) {
+        int seat = (first_dealer + i) % 4;
+        Player* player = table->getPlayer(seat);
+        if (!player) continue;
+        if (top < 0 || player->getScore() > table->getPlayer(top)->getScore()) {
+            top = seat;
+        }
+    }
+    return top;
+}
+
+void Match::finishMatch(int first_dealer) {
+    // 场上剩余的立直棒归一位
+    int top = getTopSeat(first_dealer);
+    if (top >= 0 && table->getRiichiSticks() > 0) {
+        table->getPlayer(top)->addScore(table->getRiichiSticks() * 1000);
+        table->setRiichiSticks(0);
+    }
+
+    for (int seat = 0; seat < 4; ++seat) {
+        Player* player = table->getPlayer(seat);
+        result.scores[seat] = player ? player->getScore() : 0;
+    }
+
+    // 点数高者在前，同分时起家顺序靠前者在前
+    for (int seat = 0; seat < 4; ++seat) {
+        int rank = 0;
+        int order = (seat - first_dealer + 4) % 4;
+        for (int other = 0; other < 4; ++other) {
+            if (other == seat) continue;
+            int other_order = (other - first_dealer + 4) % 4;
+            if (result.scores[other] > result.scores[seat] ||
+                (result.scores[other] == result.scores[seat] && other_order < order)) {
+                rank++;
+            }
+        }
+        result.ranks[seat] = rank;
+    }
+}
+
+const MatchResult& Match::play(int first_dealer) {
+    assert(first_dealer >= 0 && first_dealer < 4);
+
+    for (int seat = 0; seat < 4; ++seat) {
+        if (table->getPlayer(seat)) {
+            table->getPlayer(seat)->setScore(rules.start_score);
+        }
+    }
+    result.wins.fill(0);
+    result.deal_ins.fill(0);
+    result.rounds_played = 0;
+    result.busted = false;
+
+    // 最终场风，之后的一个场风作为延长战
+    int last_wind = (rules.length == MatchLength::Hanchan) ? static_cast<int>(Wind::South)
+                                                           : static_cast<int>(Wind::East);
+    int wind = static_cast<int>(Wind::East);
+    int round_index = 0;  // 本场风的第几局 (0-3)
+    int honba = 0;
+    table->setRiichiSticks(0);
+
+    while (true) {
+        int dealer = (first_dealer + round_index) % 4;
+        table->setDealer(dealer);
+        table->setRoundWind(static_cast<Wind>(wind));
+        table->setHonba(honba);
+
+        const GameResult& round = table->playRound();
+        result.rounds_played++;
+        if (round.winner >= 0) {
+            result.wins[round.winner]++;
+            if (!round.is_tsumo) result.deal_ins[round.from_player]++;
+        }
+
+        // 击飞
+        if (rules.allow_bust) {
+            for (int seat = 0; seat < 4; ++seat) {
+                Player* player = table->getPlayer(seat);
+                if (player && player->getScore() < 0) result.busted = true;
+            }
+            if (result.busted) break;
+        }
+
+        // 庄家和牌或流局听牌时连庄
+        bool renchan = (round.winner == dealer) ||
+                       (round.winner < 0 && table->getPlayer(dealer)->getHand()->isTenpai());
+        bool is_last = wind > last_wind || (wind == last_wind && round_index == 3);
+        int top = getTopSeat(first_dealer);
+        bool top_reached = table->getPlayer(top)->getScore() >= rules.target_score;
+
+        if (renchan) {
+            honba++;
+            // 和了止め / 听牌止め: 最终局 (含延长战) 庄家已是达到返点的一位
+            if (is_last && rules.agari_yame && top == dealer && top_reached) break;
+            continue;
+        }
+
+        // 闲家和牌本场清零，流局积一本场
+        honba = (round.winner < 0) ? honba + 1 : 0;
+        round_index++;
+        if (round_index == 4) {
+            round_index = 0;
+            wind++;
+        }
+
+        if (is_last) {
+            // 有人达到返点即终局，否则进入延长战 (延长战打完仍然终局)
+            if (top_reached || wind > last_wind + 1) break;
+        }
+    }
+
+    finishMatch(first_dealer);
+    return result;
+}
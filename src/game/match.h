@@ -0,0 +1,58 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include <array>
+#include "types.h"
+
+class Table;
+
+// 对局长度
+enum class MatchLength {
+    Tonpuusen,  // 东风战
+    Hanchan     // 半庄战 (东南)
+};
+
+// 对局规则
+struct MatchRules {
+    MatchLength length = MatchLength::Hanchan;
+    int start_score = 25000;   // 起始点数
+    int target_score = 30000;  // 返点: 终局时无人达到则进入延长战
+    bool allow_bust = true;    // 有人点数为负时立即终局
+    bool agari_yame = true;    // 最终局庄家连庄且为一位时可以结束
+};
+
+// 对局结果
+struct MatchResult {
+    std::array<int, 4> scores;    // 终局点数 (含供托)
+    std::array<int, 4> ranks;     // 各座位名次 (0 为一位)
+    std::array<int, 4> wins;      // 和牌次数
+    std::array<int, 4> deal_ins;  // 放铳次数
+    int rounds_played;            // 总局数 (含连庄)
+    bool busted;                  // 是否因击飞结束
+};
+
+// 跑完一整场东风战/半庄战
+// 每局通过 Table::playRound 进行，负责庄家轮换、连庄、本场、立直棒和终局判定
+// 同一个 Match 可以反复调用 play，不会为每场对局分配内存
+class Match {
+private:
+    Table* table;
+    MatchRules rules;
+    MatchResult result;
+
+public:
+    Match(Table* t, const MatchRules& r = MatchRules());
+
+    void setRules(const MatchRules& r) { rules = r; }
+    const MatchRules& getRules() const { return rules; }
+
+    // 从 first_dealer 起家开始打一整场
+    const MatchResult& play(int first_dealer = 0);
+    const MatchResult& getResult() const { return result; }
+
+private:
+    int getTopSeat(int first_dealer) const;   // 当前一位 (同分按起家顺序)
+    void finishMatch(int first_dealer);       // 供托归一位并计算名次
+};
+
+#endif // MATCH_H
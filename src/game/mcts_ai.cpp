@@ -0,0 +1,234 @@
+#include "mcts_ai.h"
+#include "table.h"
+#include "constants.h"
+#include "deal_sampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+MctsAI::MctsAI(const std::string& name, const MctsConfig& cfg)
+    : Player(name), config(cfg), rng(cfg.seed), riichi_tile(invalid_tile_index) {
+}
+
+// 看不到的牌重新洗入他家手牌和牌山 (立直家保持听牌)
+void MctsAI::determinize(GameSnapshot& snapshot, int seat, TileIndex* wall_buffer, std::mt19937& rng) {
+    HiddenInfo info;
+    DealSampler sampler;
+    if (!buildHiddenInfo(snapshot, seat, info) || !sampler.reset(info)) return;
+    DealSample deal;
+    uint64_t seed = (static_cast<uint64_t>(rng()) << 32) | rng();
+    sampler.sample(seed, 0, deal);
+    sampler.apply(deal, snapshot, wall_buffer);
+}
+
+// 评估牌的价值 (越低越先打)，只看张数，不做手牌解析
+static int rolloutTileValue(const SeatSnapshot& seat, Tile tile) {
+    int count = seat.counts[tile];
+    if (tile >= 27) return count * 30;
+    int num = tile % 9;
+    int value = count * 30 + ((num == 0 || num == 8) ? 0 : 5);
+    for (int d = -2; d <= 2; ++d) {
+        int t = tile + d;
+        if (d == 0 || t < tile / 9 * 9 || t > tile / 9 * 9 + 8) continue;
+        if (seat.counts[t] > 0) value += (d == -1 || d == 1) ? 12 : 8;
+    }
+    return value;
+}
+
+// 在 mask 中选价值最低的一种牌，返回一张具体的 TileIndex
+static TileIndex pickDiscard(const SeatSnapshot& seat, TileIndex drawn, TileMask mask) {
+    TileIndex best = drawn;
+    int best_value = 1 << 30;
+    for (Tile tile = 0; tile < 34; ++tile) {
+        if (!(mask >> tile & 1)) continue;
+        TileIndex index = invalid_tile_index;
+        if (drawn / 4 == tile) {
+            index = drawn;
+        } else if (seat.counts[tile] > 0) {
+            for (int copy = 0; copy < 4; ++copy) {
+                if (seat.hasTile(tile * 4 + copy)) { index = tile * 4 + copy; break; }
+            }
+        }
+        if (index == invalid_tile_index) continue;
+        int value = rolloutTileValue(seat, tile);
+        if (value < best_value) {
+            best_value = value;
+            best = index;
+        }
+    }
+    return best;
+}
+
+int MctsAI::rolloutPolicy(const GameSnapshot& snapshot) {
+    const SeatSnapshot& seat = snapshot.seats[snapshot.current];
+    switch (snapshot.phase) {
+        case SnapshotPhase::Response:
+            return (snapshot.getOptions() & DecisionOption::Ron) ? static_cast<int>(Action::Win)
+                                                                 : static_cast<int>(Action::Pass);
+        case SnapshotPhase::RiichiDiscard:
+            return pickDiscard(seat, snapshot.drawn, snapshot.getLegalActions().riichi);
+        case SnapshotPhase::Action: {
+            int options = snapshot.getOptions();
+            if (options & DecisionOption::Tsumo) return static_cast<int>(Action::Win);
+            if (options & DecisionOption::Riichi) return static_cast<int>(Action::Riichi);
+            if (seat.riichi) return snapshot.drawn;
+            TileMask all = 1ULL << (snapshot.drawn / 4);
+            for (Tile tile = 0; tile < 34; ++tile) {
+                if (seat.counts[tile] > 0) all |= 1ULL << tile;
+            }
+            return pickDiscard(seat, snapshot.drawn, all);
+        }
+        default:
+            return static_cast<int>(Action::Pass);
+    }
+}
+
+std::vector<MctsMove> MctsAI::listMoves(const GameSnapshot& root) const {
+    std::vector<MctsMove> moves;
+    const LegalActions& legal = root.getLegalActions();
+    TileIndex drawn = root.drawn;
+
+    // 每种牌只保留一张 (摸到的牌优先)
+    TileMask seen = 0;
+    auto add = [&](TileIndex tile) {
+        if (seen >> (tile / 4) & 1) return;
+        seen |= 1ULL << (tile / 4);
+        moves.push_back({tile, false});
+    };
+    add(drawn);
+    for (TileIndex tile = 0; tile < 136; ++tile) {
+        if (legal.canDiscard(tile)) add(tile);
+    }
+
+    if (root.getOptions() & DecisionOption::Riichi) {
+        size_t plain = moves.size();
+        for (size_t i = 0; i < plain; ++i) {
+            if (legal.riichi >> (moves[i].tile / 4) & 1) moves.push_back({moves[i].tile, true});
+        }
+    }
+    return moves;
+}
+
+MctsMove MctsAI::search(const GameSnapshot& root, const std::vector<MctsMove>& moves) {
+    int num_threads = config.num_threads;
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t n = moves.size();
+    int me = root.current;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.time_budget_ms);
+    long playouts_per_thread = config.max_playouts > 0 ? (config.max_playouts + num_threads - 1) / num_threads : 0;
+
+    // 每个线程独立的统计，结束后合并
+    std::vector<std::vector<MctsMoveStats>> thread_stats(num_threads);
+    std::vector<uint32_t> seeds(num_threads);
+    for (int t = 0; t < num_threads; ++t) seeds[t] = static_cast<uint32_t>(rng());
+
+    // 看不到的牌只整理一次，各线程按 (种子, 局数) 从同一个采样器取样
+    HiddenInfo info;
+    DealSampler sampler;
+    bool can_sample = buildHiddenInfo(root, me, info) && sampler.reset(info);
+
+    auto worker = [&](int id) {
+        std::vector<MctsMoveStats>& stats = thread_stats[id];
+        stats.resize(n);
+        for (size_t i = 0; i < n; ++i) stats[i] = {moves[i], 0, 0.0};
+        TileIndex wall_buffer[136];
+        DealSample deal;
+
+        for (long played = 0; ; ++played) {
+            if (playouts_per_thread > 0 && played >= playouts_per_thread) break;
+            if (config.time_budget_ms > 0 && (played & 7) == 0 && played >= (long)n &&
+                std::chrono::steady_clock::now() >= deadline) break;
+
+            // UCB1 选择候选动作，未试过的优先
+            size_t pick = 0;
+            double best = -1e300;
+            for (size_t i = 0; i < n; ++i) {
+                double score;
+                if (stats[i].visits == 0) {
+                    score = 1e300 - i;
+                } else {
+                    score = stats[i].value / stats[i].visits +
+                            config.exploration * std::sqrt(std::log((double)played) / stats[i].visits);
+                }
+                if (score > best) { best = score; pick = i; }
+            }
+
+            GameSnapshot sim = root;
+            sim.fast_scoring = true;
+            if (can_sample) {
+                sampler.sample(seeds[id], static_cast<uint64_t>(played), deal);
+                sampler.apply(deal, sim, wall_buffer);
+            }
+            if (moves[pick].riichi) sim.apply(static_cast<int>(Action::Riichi));
+            sim.apply(moves[pick].tile);
+            while (!sim.isFinished()) {
+                sim.apply(rolloutPolicy(sim));
+            }
+
+            stats[pick].visits++;
+            stats[pick].value += sim.deltas[me] / 1000.0;
+        }
+    };
+
+    if (num_threads == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) threads.emplace_back(worker, t);
+        for (std::thread& t : threads) t.join();
+    }
+
+    // 合并后选访问次数最多的动作 (同次数比平均收益)
+    last_stats = thread_stats[0];
+    for (int t = 1; t < num_threads; ++t) {
+        for (size_t i = 0; i < n; ++i) {
+            last_stats[i].visits += thread_stats[t][i].visits;
+            last_stats[i].value += thread_stats[t][i].value;
+        }
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < n; ++i) {
+        const MctsMoveStats& a = last_stats[i];
+        const MctsMoveStats& b = last_stats[best];
+        if (a.visits > b.visits ||
+            (a.visits == b.visits && a.visits > 0 && a.value / a.visits > b.value / b.visits)) {
+            best = i;
+        }
+    }
+    return moves[best];
+}
+
+int MctsAI::decideAction(TileIndex drawn_tile, bool can_tsumo, bool, bool) {
+    riichi_tile = invalid_tile_index;
+
+    // 能和则和，立直后只能摸切
+    if (can_tsumo) return static_cast<int>(Action::Win);
+    if (hand && hand->isRiichi()) return drawn_tile;
+
+    GameSnapshot root;
+    if (!table || !captureSnapshot(*table, root)) return drawn_tile;
+
+    std::vector<MctsMove> moves = listMoves(root);
+    if (moves.size() == 1 && !moves[0].riichi) return moves[0].tile;
+
+    MctsMove move = search(root, moves);
+    if (move.riichi) {
+        riichi_tile = move.tile;
+        return static_cast<int>(Action::Riichi);
+    }
+    return move.tile;
+}
+
+int MctsAI::decideResponse(TileIndex, int, bool, bool, bool, bool can_ron) {
+    // 鸣牌目前不改变手牌，只考虑荣和
+    if (can_ron) return static_cast<int>(Action::Win);
+    return static_cast<int>(Action::Pass);
+}
+
+TileIndex MctsAI::selectRiichiDiscard(TileIndex drawn_tile) {
+    return riichi_tile != invalid_tile_index ? riichi_tile : drawn_tile;
+}
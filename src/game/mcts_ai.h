@@ -0,0 +1,64 @@
+#ifndef MCTS_AI_H
+#define MCTS_AI_H
+
+#include "player.h"
+#include "snapshot.h"
+#include <random>
+#include <vector>
+
+// 搜索参数
+struct MctsConfig {
+    int num_threads = 0;        // <= 0 时使用全部核心
+    int time_budget_ms = 100;   // 每次决策的时间预算
+    int max_playouts = 0;       // 每次决策的模拟次数上限 (0 表示只看时间)
+    double exploration = 1.0;   // UCB1 探索系数 (以千点为单位)
+    uint32_t seed = 1;
+};
+
+// 候选动作: 打出一张牌，或者立直并打出这张牌
+struct MctsMove {
+    TileIndex tile;
+    bool riichi;
+};
+
+// 每个候选动作的统计
+struct MctsMoveStats {
+    MctsMove move;
+    long visits;
+    double value;   // 模拟结束时自己点数变化的总和 (千点)
+};
+
+// 确定化蒙特卡洛搜索 AI
+// 从 Table 截取局面后，把看不到的牌 (他家手牌、牌山) 随机重排为一种可能的局面，
+// 在根节点上用 UCB1 分配模拟次数，每次模拟用快速策略把这一局打完并以得失点作为收益。
+// 多线程采用根并行: 各线程独立搜索，最后合并各候选动作的统计。
+class MctsAI : public Player {
+private:
+    MctsConfig config;
+    std::mt19937 rng;
+    TileIndex riichi_tile;                 // decideAction 选择立直时预定的宣言牌
+    std::vector<MctsMoveStats> last_stats; // 最近一次搜索的统计 (调试用)
+
+public:
+    MctsAI(const std::string& name = "MCTS", const MctsConfig& cfg = MctsConfig());
+
+    void setConfig(const MctsConfig& cfg) { config = cfg; }
+    const MctsConfig& getConfig() const { return config; }
+    const std::vector<MctsMoveStats>& getLastStats() const { return last_stats; }
+
+    int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override;
+    int decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) override;
+    TileIndex selectRiichiDiscard(TileIndex drawn_tile) override;
+
+    // 把 seat 看不到的牌重新随机分配: 他家门前手牌和未摸的牌山 (写入 wall_buffer)，立直家构造成听牌
+    static void determinize(GameSnapshot& snapshot, int seat, TileIndex* wall_buffer, std::mt19937& rng);
+
+    // 快速模拟策略: 能和就和，能立直就立直，否则打孤立的幺九字牌
+    static int rolloutPolicy(const GameSnapshot& snapshot);
+
+private:
+    std::vector<MctsMove> listMoves(const GameSnapshot& root) const;
+    MctsMove search(const GameSnapshot& root, const std::vector<MctsMove>& moves);
+};
+
+#endif // MCTS_AI_H
@@ -2,7 +2,8 @@
 #include "table.h"
 
 Player::Player(const std::string& player_name)
-    : hand(nullptr), table(nullptr), seat(-1), score(25000), name(player_name) {
+    : hand(nullptr), table(nullptr), seat(-1), score(25000), name(player_name),
+      drawn_tile(invalid_tile_index), discard_mask(0), missed_ron(false) {
 }
 
 Player::~Player() {
@@ -10,8 +11,15 @@ Player::~Player() {
 }
 
 void Player::initHand(const TileIndexList& tiles, Wind round, Wind seat_wind) {
-    delete hand;
-    hand = new Hand(tiles, round, seat_wind);
+    if (hand) {
+        hand->reset(tiles, round, seat_wind);
+    } else {
+        hand = new Hand(tiles, round, seat_wind);
+    }
+    discards.clear();
+    drawn_tile = invalid_tile_index;
+    discard_mask = 0;
+    missed_ron = false;
 }
 
 void Player::setTable(Table* t, int seat_pos) {
@@ -49,21 +57,38 @@ bool Player::canWin(TileIndex tile) const {
     return hand->isWinningHand(tile);
 }
 
+bool Player::isFuriten() const {
+    if (!hand) return false;
+    return missed_ron || (hand->getWaitMask() & discard_mask) != 0;
+}
+
 bool Player::canTsumo() const {
     // 自摸检查: 需要在摸牌后检查 (14张状态)
     // 这里假设已经摸牌，检查是否能和
     return false;  // 由 Table 处理
 }
 
+bool Player::canDiscard(TileIndex tile) const {
+    if (!hand) return false;
+    if (tile == drawn_tile) return true;
+    return hand->hasTileIndex(tile);
+}
+
 // 执行动作
 void Player::draw(TileIndex tile) {
-    // 摸牌由 Hand 内部管理，这里只更新状态
-    // Hand 目前没有单独的 draw 方法，需要通过 drawAndDiscard
+    // Hand 没有单独的摸牌方法，摸到的牌先暂存，弃牌时通过 drawAndDiscard 并入
+    drawn_tile = tile;
 }
 
 void Player::discard(TileIndex tile) {
+    if (hand && drawn_tile != invalid_tile_index) {
+        hand->drawAndDiscard(drawn_tile, tile);
+        drawn_tile = invalid_tile_index;
+    }
     discards.push_back(tile);
-    // Hand 的弃牌在 drawAndDiscard 中处理
+    discard_mask |= 1ULL << (tile / 4);
+    // 同巡振听在自己弃牌后解除，立直后的见逃一直有效
+    if (hand && !hand->isRiichi()) missed_ron = false;
 }
 
 void Player::callChi(TileIndex call, TileIndex tile1, TileIndex tile2) {
@@ -28,12 +28,15 @@ protected:
     int score;          // 点数
     std::string name;   // 玩家名称
     TileIndexList discards;  // 牌河
+    TileIndex drawn_tile;    // 本巡摸到、尚未并入手牌的牌
+    TileMask discard_mask;   // 自己打过的牌 (舍张振听用)
+    bool missed_ron;         // 见逃后到自己下次弃牌前 (立直后则一直) 振听
 
 public:
     Player(const std::string& player_name = "Player");
     virtual ~Player();
 
-    // 初始化
+    // 初始化 (同时清空牌河)
     void initHand(const TileIndexList& tiles, Wind round, Wind seat_wind);
     void setTable(Table* t, int seat_pos);
 
@@ -43,17 +46,23 @@ public:
     int getScore() const { return score; }
     const std::string& getName() const { return name; }
     const TileIndexList& getDiscards() const { return discards; }
+    TileIndex getDrawnTile() const { return drawn_tile; }
+    TileMask getDiscardMask() const { return discard_mask; }
+    bool hasMissedRon() const { return missed_ron; }
 
     // 点数操作
     void addScore(int delta) { score += delta; }
+    void setScore(int value) { score = value; }
 
     // 判定方法 (委托给 Hand)
     bool canChi(TileIndex tile) const;
     bool canPon(TileIndex tile) const;
     bool canKan(TileIndex tile) const;
     bool canAnkan() const;
-    bool canWin(TileIndex tile) const;
+    bool canWin(TileIndex tile) const;      // 只看牌型，O(1)
+    bool isFuriten() const;
     bool canTsumo() const;  // 自摸
+    bool canDiscard(TileIndex tile) const;  // 手牌或摸到的牌中是否有这张
 
     // 执行动作
     void draw(TileIndex tile);               // 摸牌
@@ -62,6 +71,7 @@ public:
     void callPon(TileIndex call);
     void callKan(TileIndex call);
     void performAnkan(TileIndex tile);
+    void missRon() { missed_ron = true; }   // 能荣和却没有荣和
 
     // 决策接口 (子类实现)
     // 返回: 0-135 弃牌, 或 Action 枚举值
@@ -70,6 +80,9 @@ public:
 
     // 如果选择吃，返回要打出的两张牌
     virtual std::pair<TileIndex, TileIndex> selectChiTiles(TileIndex call) { return {-1, -1}; }
+
+    // 如果选择立直，返回立直宣言牌 (打出后必须听牌，否则视为不立直)
+    virtual TileIndex selectRiichiDiscard(TileIndex drawn_tile) { return drawn_tile; }
 };
 
 #endif // PLAYER_H
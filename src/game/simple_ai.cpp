@@ -1,9 +1,11 @@
 #include "simple_ai.h"
 #include "constants.h"
+#include "shanten.h"
+#include "table.h"
 #include <chrono>
 #include <algorithm>
 
-SimpleAI::SimpleAI(const std::string& name) : Player(name), last_drawn(-1) {
+SimpleAI::SimpleAI(const std::string& name) : Player(name), last_drawn(invalid_tile_index), danger(nullptr) {
     auto seed = std::chrono::steady_clock::now().time_since_epoch().count();
     rng.seed(static_cast<unsigned>(seed));
 }
@@ -16,12 +18,17 @@ int SimpleAI::decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan,
         return static_cast<int>(Action::Win);
     }
 
-    // 2. 暂时不处理暗杠 (简单 AI)
+    // 2. 能立直则立直 (宣言牌在 selectRiichiDiscard 中选择)
+    if (can_riichi) {
+        return static_cast<int>(Action::Riichi);
+    }
+
+    // 3. 暂时不处理暗杠 (简单 AI)
     // if (can_ankan) { ... }
 
-    // 3. 选择弃牌
-    TileIndex discard = selectDiscard();
-    return discard;
+    // 4. 选择弃牌 (立直后只能摸切)
+    if (hand && hand->isRiichi()) return drawn_tile;
+    return selectDiscard(table ? table->getLegalActions(seat).getDiscardKinds() : ~0ULL);
 }
 
 int SimpleAI::decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) {
@@ -44,36 +51,100 @@ int SimpleAI::decideResponse(TileIndex discard, int from_seat, bool can_chi, boo
     return static_cast<int>(Action::Pass);
 }
 
-TileIndex SimpleAI::selectDiscard() {
-    if (!hand) return last_drawn;
-
-    TileCounts counts = hand->getTileCounts();
+TileIndex SimpleAI::selectRiichiDiscard(TileIndex drawn_tile) {
+    if (!hand) return drawn_tile;
+    last_drawn = drawn_tile;
+    // 打出后都听牌，选听牌枚数最多的
+    return selectDiscard(table ? table->getLegalActions(seat).riichi : hand->getRiichiDiscards(drawn_tile));
+}
 
-    // 收集所有可打的牌及其评估值
-    std::vector<std::pair<int, Tile>> candidates;  // (评估值, 牌)
+TileIndex SimpleAI::findTileIndex(Tile tile) const {
+    // 摸到的牌优先 (摸切)
+    if (last_drawn != invalid_tile_index && last_drawn / 4 == tile) return last_drawn;
+    for (TileIndex index : hand->getTiles()) {
+        if (index / 4 == tile) return index;
+    }
+    return invalid_tile_index;
+}
 
-    for (int tile = 0; tile < 34; ++tile) {
-        if (counts[tile] > 0) {
-            int value = evaluateTile(tile);
-            candidates.push_back({value, tile});
+TileCounts SimpleAI::countVisible(const TileCounts& own) const {
+    // 看得到的牌: 自己的手牌和所有牌河
+    TileCounts visible = own;
+    if (table) {
+        for (int seat = 0; seat < 4; ++seat) {
+            const Player* player = table->getPlayer(seat);
+            if (!player) continue;
+            for (TileIndex index : player->getDiscards()) visible[index / 4]++;
         }
     }
+    return visible;
+}
 
-    // 按评估值排序 (值越低越应该打出)
-    std::sort(candidates.begin(), candidates.end());
+TileIndex SimpleAI::selectDiscard(TileMask allowed) {
+    if (!hand) return last_drawn;
 
-    if (candidates.empty()) {
-        return last_drawn;
+    TileCounts counts = hand->getTileCounts();
+    if (last_drawn != invalid_tile_index) counts[last_drawn / 4]++;
+    int total = 0;
+    for (int tile = 0; tile < 34; ++tile) total += counts[tile];
+    int open_melds = (14 - total) / 3;
+    bool is_menzen = hand->isMenzen();
+
+    TileCounts visible = countVisible(counts);
+
+    // 对所有立直者的危险度之和
+    auto threat = [&](Tile tile) {
+        int sum = 0;
+        for (int other = 0; other < 4; ++other) {
+            if (other != seat && danger->isRiichi(other)) sum += danger->getDanger(other, tile);
+        }
+        return sum;
+    };
+    bool under_attack = false;
+    if (danger && !hand->isRiichi()) {
+        for (int other = 0; other < 4; ++other) {
+            if (other != seat && danger->isRiichi(other)) under_attack = true;
+        }
     }
 
-    // 选择评估值最低的牌
-    Tile best_tile = candidates[0].second;
+    // 向听数最小 > 有效牌最多 > evaluateTile 最低
+    Tile best_tile = invalid_tile, safest_tile = invalid_tile;
+    int best_shanten = 99, best_ukeire = -1, best_value = 0;
+    int safest_danger = 1 << 30, safest_shanten = 99;
+    for (Tile tile = 0; tile < 34; ++tile) {
+        if (counts[tile] == 0 || !(allowed >> tile & 1)) continue;
+        counts[tile]--;
+        int shanten = calcShanten(counts, open_melds, is_menzen);
+        if (shanten <= best_shanten) {
+            int ukeire = 0;
+            calcUkeire(counts, open_melds, is_menzen, visible, ukeire);
+            int value = evaluateTile(tile);
+            if (shanten < best_shanten || ukeire > best_ukeire ||
+                (ukeire == best_ukeire && value < best_value)) {
+                best_tile = tile;
+                best_shanten = shanten;
+                best_ukeire = ukeire;
+                best_value = value;
+            }
+        }
+        // 弃和候选: 危险度最低，相同时保留向听数
+        if (under_attack) {
+            int d = threat(tile);
+            if (d < safest_danger || (d == safest_danger && shanten < safest_shanten)) {
+                safest_tile = tile;
+                safest_danger = d;
+                safest_shanten = shanten;
+            }
+        }
+        counts[tile]++;
+    }
+    if (under_attack && best_shanten >= 2 && safest_tile != invalid_tile) {
+        best_tile = safest_tile;
+    }
 
-    // 找到对应的 TileIndex
-    // 遍历手牌找到这张牌的 TileIndex
-    // 由于 Hand 类没有暴露手牌列表，我们用 last_drawn 或随机选择
-    // 简化处理: 返回 tile * 4 作为 TileIndex
-    return best_tile * 4;
+    if (best_tile == invalid_tile) return last_drawn;
+    TileIndex index = findTileIndex(best_tile);
+    return index != invalid_tile_index ? index : last_drawn;
 }
 
 int SimpleAI::evaluateTile(Tile tile) const {
@@ -142,20 +213,21 @@ int SimpleAI::evaluateTile(Tile tile) const {
     return value;
 }
 
-bool SimpleAI::shouldPon(TileIndex tile_index) const {
+bool SimpleAI::shouldPon(TileIndex tile_index) {
     Tile tile = tile_index / 4;
 
-    // 役牌 (三元牌) 必碰
-    if (tile == Haku || tile == Hatsu || tile == Chun) {
-        return true;
+    // 只碰役牌 (三元牌、风牌简化处理也碰)，其他牌保持门清
+    if (!Sangen.contains(tile) && !Kaze.contains(tile)) {
+        return false;
     }
+    if (!hand) return true;
 
-    // 风牌: 简化处理，也碰
-    if (Kaze.contains(tile)) {
-        return true;
+    // 碰完打出最好的牌后向听数不能后退
+    TileCounts visible = countVisible(hand->getTileCounts());
+    evaluateCalls(*hand, tile_index, false, visible, calls);
+    for (const CallOption& option : calls.options) {
+        if (option.type == MeldType::Pon && option.shanten <= calls.shanten) return true;
     }
-
-    // 其他牌: 简单 AI 不碰 (保持门清)
     return false;
 }
 
@@ -2,18 +2,23 @@
 #define SIMPLE_AI_H
 
 #include "player.h"
+#include "danger_tracker.h"
+#include "call_options.h"
 #include <random>
 
 // 简单 AI 玩家
 // 策略:
 // 1. 能和则和
-// 2. 打字牌优先 (非役牌)
-// 3. 打边张/孤张
-// 4. 随机选择
+// 2. 能立直则立直 (宣言牌选有效牌最多的)
+// 3. 打出后向听数最小、有效牌最多的牌，相同时按 evaluateTile 先打字牌、边张、孤张
+// 4. 役牌 (三元牌、风牌) 碰了之后向听数不后退才碰
+// 5. 设置了 DangerTracker 时，有人立直而自己打完仍在两向听以上就弃和，打对立直者最安全的牌
 class SimpleAI : public Player {
 private:
     std::mt19937 rng;
     TileIndex last_drawn;  // 上次摸到的牌
+    const DangerTracker* danger;  // 可选，用于防守
+    CallEvaluation calls;  // 鸣牌评估结果 (复用容量)
 
 public:
     SimpleAI(const std::string& name = "AI");
@@ -21,12 +26,18 @@ public:
     // 实现决策接口
     int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override;
     int decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) override;
+    TileIndex selectRiichiDiscard(TileIndex drawn_tile) override;
+
+    // 由 DangerTrackerHook 维护的危险度表 (nullptr 表示不防守)
+    void setDangerTracker(const DangerTracker* tracker) { danger = tracker; }
 
 private:
     // AI 策略方法
-    TileIndex selectDiscard();           // 选择要打出的牌
+    TileIndex selectDiscard(TileMask allowed);  // 在 allowed 牌种中选择要打出的牌
+    TileIndex findTileIndex(Tile tile) const;    // 手牌或摸到的牌中这种牌的一张
+    TileCounts countVisible(const TileCounts& own) const;  // 自己的手牌加上所有牌河
     int evaluateTile(Tile tile) const;   // 评估牌的价值 (越低越应该打出)
-    bool shouldPon(TileIndex tile) const; // 是否应该碰
+    bool shouldPon(TileIndex tile);       // 是否应该碰
     bool shouldChi(TileIndex tile) const; // 是否应该吃
 };
 
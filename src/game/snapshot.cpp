@@ -0,0 +1,365 @@
+#include "snapshot.h"
+#include "player.h"
+#include "scoring.h"
+
+#include <algorithm>
+#include <cstring>
+
+static TileCounts toTileCounts(const SeatSnapshot& seat) {
+    TileCounts counts;
+    counts.fill(0);
+    for (int tile = 0; tile < 34; ++tile) counts[tile] = seat.counts[tile];
+    return counts;
+}
+
+static void addTile(SeatSnapshot& seat, TileIndex tile) {
+    seat.tiles[tile >> 6] |= 1ULL << (tile & 63);
+    seat.counts[tile / 4]++;
+}
+
+static void removeTile(SeatSnapshot& seat, TileIndex tile) {
+    seat.tiles[tile >> 6] &= ~(1ULL << (tile & 63));
+    seat.counts[tile / 4]--;
+}
+
+DecisionKind GameSnapshot::getDecisionKind() const {
+    switch (phase) {
+        case SnapshotPhase::RiichiDiscard: return DecisionKind::RiichiDiscard;
+        case SnapshotPhase::Response: return DecisionKind::Response;
+        default: return DecisionKind::Action;
+    }
+}
+
+void GameSnapshot::beginTurn() {
+    if (wall_pointer >= dead_wall_start) {
+        finishDraw();
+        return;
+    }
+    drawn = wall[wall_pointer++];
+    enterAction();
+}
+
+void GameSnapshot::resume() {
+    winner = -1;
+    from_player = -1;
+    if (drawn < 136) {
+        enterAction();
+    } else {
+        beginTurn();
+    }
+}
+
+void GameSnapshot::toLegalHand(int seat, LegalHand& out) const {
+    const SeatSnapshot& s = seats[seat];
+    std::memset(&out, 0, sizeof(out));
+    std::memcpy(out.tiles, s.tiles, sizeof(out.tiles));
+    std::memcpy(out.counts, s.counts, sizeof(out.counts));
+    out.wait_mask = s.wait_mask;
+    for (int m = 0; m < s.meld_count; ++m) {
+        if (s.melds[m][0] == static_cast<uint8_t>(MeldType::Pon)) out.pon_mask |= 1ULL << (s.melds[m][1] / 4);
+    }
+    out.is_menzen = s.meld_count == 0;
+    out.is_riichi = s.riichi > 0;
+    out.is_furiten = s.isFuriten();
+    out.score = s.score;
+}
+
+void GameSnapshot::enterAction() {
+    // 与 Table::playRound 相同的合法动作
+    phase = SnapshotPhase::Action;
+    LegalHand hand;
+    toLegalHand(current, hand);
+    computeTurnActions(hand, drawn, getRemainingTiles(), kan_count, legal);
+}
+
+int GameSnapshot::apply(int action) {
+    if (phase == SnapshotPhase::Finished) return action;
+
+    if (phase == SnapshotPhase::Action) {
+        // 不可执行的动作一律按摸切处理
+        if (!legal.allows(action)) action = drawn;
+        if (action == static_cast<int>(Action::Win)) {
+            finishWin(current, -1, drawn);
+            return action;
+        }
+        if (action == static_cast<int>(Action::Riichi)) {
+            phase = SnapshotPhase::RiichiDiscard;
+            restrictToRiichiDiscards(legal);
+            return action;
+        }
+        discardTile(action, false);
+        return action;
+    }
+
+    if (phase == SnapshotPhase::RiichiDiscard) {
+        bool valid = legal.canDiscard(action);
+        // 宣言牌不合法时按不立直摸切处理
+        if (!valid) action = drawn;
+        discardTile(action, valid);
+        return action;
+    }
+
+    // 响应阶段: 不在可选范围内的响应视为过
+    int seat = responder;
+    if (!legal.allows(action)) {
+        action = static_cast<int>(Action::Pass);
+    }
+    responses[seat] = static_cast<uint8_t>(action);
+    if ((legal.getOptions() & DecisionOption::Ron) && action != static_cast<int>(Action::Win)) {
+        seats[seat].missed_ron = true;
+    }
+    askNextResponder();
+    return action;
+}
+
+void GameSnapshot::discardTile(TileIndex tile, bool declare_riichi) {
+    SeatSnapshot& seat = seats[current];
+    // 一发只维持到立直后自己的下一次弃牌
+    if (seat.riichi == 1) seat.riichi = 2;
+    if (declare_riichi && seat.meld_count == 0) seat.riichi = 1;
+
+    addTile(seat, drawn);
+    removeTile(seat, tile);
+    seat.wait_mask = calcWaitMask(toTileCounts(seat), seat.meld_count == 0);
+    if (seat.river_len < sizeof(seat.river)) {
+        seat.river[seat.river_len++] = static_cast<uint8_t>(tile);
+    }
+    seat.discard_mask |= 1ULL << (tile / 4);
+    if (seat.riichi == 0) seat.missed_ron = false;
+
+    drawn = invalid_tile_index;
+    riichi_pending = declare_riichi;
+    beginResponses(tile);
+}
+
+void GameSnapshot::beginResponses(TileIndex tile) {
+    discard = static_cast<uint8_t>(tile);
+    for (int i = 0; i < 4; ++i) {
+        responses[i] = static_cast<uint8_t>(Action::Pass);
+    }
+    responder = current;
+    askNextResponder();
+}
+
+void GameSnapshot::askNextResponder() {
+    // 从上一个被询问的玩家的下家开始，找下一个有合法动作的玩家
+    int offset = (responder - current + 4) % 4;
+    for (int i = offset + 1; i <= 3; ++i) {
+        int seat = (current + i) % 4;
+        LegalHand hand;
+        toLegalHand(seat, hand);
+        computeResponseActions(hand, discard, i == 1, getRemainingTiles(), kan_count, legal);
+        if (legal.any()) {
+            responder = static_cast<uint8_t>(seat);
+            phase = SnapshotPhase::Response;
+            return;
+        }
+    }
+    resolveResponses();
+}
+
+void GameSnapshot::resolveResponses() {
+    // 荣和优先 (头跳)
+    for (int i = 1; i <= 3; ++i) {
+        int seat = (current + i) % 4;
+        if (responses[seat] == static_cast<int>(Action::Win)) {
+            finishWin(seat, current, discard);
+            return;
+        }
+    }
+
+    // 宣言牌通过后立直成立
+    if (riichi_pending) {
+        seats[current].score -= 1000;
+        deltas[current] -= 1000;
+        riichi_sticks++;
+        riichi_pending = false;
+    }
+
+    // 与 Table 一致: 鸣牌尚未改变手牌，鸣牌者直接摸牌
+    int caller = -1;
+    for (int i = 1; i <= 3 && caller < 0; ++i) {
+        int seat = (current + i) % 4;
+        if (responses[seat] == static_cast<int>(Action::Pon) || responses[seat] == static_cast<int>(Action::Kan)) {
+            caller = seat;
+        }
+    }
+    int next_seat = (current + 1) % 4;
+    if (caller < 0 && responses[next_seat] == static_cast<int>(Action::Chi)) {
+        caller = next_seat;
+    }
+
+    if (caller < 0) {
+        current = static_cast<uint8_t>(next_seat);
+    } else {
+        for (SeatSnapshot& seat : seats) {
+            if (seat.riichi == 1) seat.riichi = 2;
+        }
+        current = static_cast<uint8_t>(caller);
+    }
+    beginTurn();
+}
+
+Hand GameSnapshot::toHand(int seat) const {
+    const SeatSnapshot& s = seats[seat];
+    TileIndexList tiles;
+    for (TileIndex tile = 0; tile < 136; ++tile) {
+        if (s.hasTile(tile)) tiles.push_back(tile);
+    }
+    Hand hand(tiles, static_cast<Wind>(round_wind), static_cast<Wind>((seat - dealer + 4) % 4));
+    if (s.riichi >= 1) hand.declareRiichi();
+    if (s.riichi >= 2) hand.consumeIppatsu();
+    return hand;
+}
+
+void GameSnapshot::finishWin(int seat, int from_seat, TileIndex tile) {
+    GameResult result;
+    result.winner = seat;
+    result.from_player = from_seat;
+    if (fast_scoring) {
+        // 不构造 Hand: 一个基本役，加门清自摸、立直、一发，按 30 符
+        const SeatSnapshot& s = seats[seat];
+        result.is_tsumo = from_seat < 0;
+        result.han = 1 + (result.is_tsumo && s.meld_count == 0) + (s.riichi > 0) + (s.riichi == 1);
+        result.fu = 30;
+        result.score = calcScore(result.han, result.fu, seat == dealer, result.is_tsumo).total_points;
+    } else {
+        scoreAgari(toHand(seat), tile, from_seat < 0, wall_pointer >= dead_wall_start, seat == dealer, result);
+    }
+
+    winner = static_cast<int8_t>(seat);
+    from_player = static_cast<int8_t>(from_seat);
+    win_tile = static_cast<uint8_t>(tile);
+    han = static_cast<uint8_t>(result.han);
+    fu = static_cast<uint8_t>(result.fu);
+    win_score = result.score;
+    settle(result);
+}
+
+void GameSnapshot::finishDraw() {
+    GameResult result;
+    result.winner = -1;
+    result.is_tsumo = false;
+    result.from_player = -1;
+    result.han = result.fu = result.score = 0;
+    winner = -1;
+    from_player = -1;
+    settle(result);
+}
+
+void GameSnapshot::settle(const GameResult& result) {
+    std::array<bool, 4> seated, tenpai;
+    for (int seat = 0; seat < 4; ++seat) {
+        seated[seat] = true;
+        tenpai[seat] = seats[seat].wait_mask != 0;
+    }
+    std::array<int, 4> transfer = calcSettlement(result, dealer, honba, riichi_sticks, seated, tenpai);
+    if (result.winner >= 0) riichi_sticks = 0;
+    for (int seat = 0; seat < 4; ++seat) {
+        seats[seat].score += transfer[seat];
+        deltas[seat] += transfer[seat];
+    }
+    phase = SnapshotPhase::Finished;
+    legal.clear();
+}
+
+GameResult GameSnapshot::getResult() const {
+    GameResult result;
+    result.winner = isFinished() ? winner : -1;
+    result.from_player = isFinished() ? from_player : -1;
+    result.is_tsumo = false;
+    result.han = result.fu = result.score = 0;
+    if (result.winner >= 0 && fast_scoring) {
+        result.is_tsumo = from_player < 0;
+        result.han = han;
+        result.fu = fu;
+        result.score = win_score;
+    } else if (result.winner >= 0) {
+        // 役种列表不在快照里保存，按结束时的手牌重新计算
+        scoreAgari(toHand(winner), win_tile, from_player < 0, wall_pointer >= dead_wall_start,
+                   winner == dealer, result);
+    }
+    for (int seat = 0; seat < 4; ++seat) result.deltas[seat] = deltas[seat];
+    return result;
+}
+
+GameSnapshot stepSnapshot(const GameSnapshot& snapshot, int action) {
+    GameSnapshot next = snapshot;
+    next.apply(action);
+    return next;
+}
+
+bool captureSnapshot(const Table& table, GameSnapshot& snapshot) {
+    std::memset(&snapshot, 0, sizeof(snapshot));
+    int current = table.getCurrentPlayer();
+    if (table.isFinished() || !table.getPlayer(current) ||
+        table.getPlayer(current)->getDrawnTile() == invalid_tile_index) {
+        return false;
+    }
+
+    snapshot.wall = table.getWall().data();
+    snapshot.wall_pointer = static_cast<uint8_t>(table.getWallPointer());
+    snapshot.dead_wall_start = static_cast<uint8_t>(table.getWallPointer() + table.getRemainingTiles());
+    snapshot.kan_count = static_cast<uint8_t>(table.getKanCount());
+    snapshot.dealer = static_cast<uint8_t>(table.getDealer());
+    snapshot.round_wind = static_cast<uint8_t>(table.getRoundWind());
+    snapshot.honba = static_cast<uint8_t>(table.getHonba());
+    snapshot.riichi_sticks = static_cast<uint8_t>(table.getRiichiSticks());
+
+    for (int i = 0; i < 4; ++i) {
+        const Player* player = table.getPlayer(i);
+        if (!player || !player->getHand()) return false;
+        const Hand* hand = player->getHand();
+        if (!hand->isMenzen() || player->getDiscards().size() > sizeof(snapshot.seats[i].river)) return false;
+
+        SeatSnapshot& seat = snapshot.seats[i];
+        for (TileIndex tile : hand->getTiles()) addTile(seat, tile);
+        for (TileIndex tile : player->getDiscards()) seat.river[seat.river_len++] = static_cast<uint8_t>(tile);
+        seat.riichi = hand->isIppatsu() ? 1 : (hand->isRiichi() ? 2 : 0);
+        seat.missed_ron = player->hasMissedRon();
+        seat.discard_mask = player->getDiscardMask();
+        seat.wait_mask = hand->getWaitMask();
+        seat.score = player->getScore();
+        snapshot.deltas[i] = table.getResult().deltas[i];
+    }
+
+    snapshot.current = static_cast<uint8_t>(current);
+    snapshot.drawn = static_cast<uint8_t>(table.getPlayer(current)->getDrawnTile());
+    snapshot.winner = -1;
+    snapshot.from_player = -1;
+    snapshot.enterAction();
+    return true;
+}
+
+void dealSnapshot(GameSnapshot& snapshot, const TileIndex* wall, int dealer, Wind round_wind,
+                  int honba, int riichi_sticks, const std::array<int, 4>& scores) {
+    std::memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.wall = wall;
+    snapshot.wall_pointer = 52;
+    snapshot.dead_wall_start = 122;
+    snapshot.dealer = static_cast<uint8_t>(dealer);
+    snapshot.round_wind = static_cast<uint8_t>(round_wind);
+    snapshot.honba = static_cast<uint8_t>(honba);
+    snapshot.riichi_sticks = static_cast<uint8_t>(riichi_sticks);
+
+    // 与 Table::dealTiles 相同: 第 i 家拿 wall[i * 13, i * 13 + 13)
+    for (int i = 0; i < 4; ++i) {
+        SeatSnapshot& seat = snapshot.seats[i];
+        for (int j = 0; j < 13; ++j) addTile(seat, wall[i * 13 + j]);
+        seat.wait_mask = calcWaitMask(toTileCounts(seat), true);
+        seat.score = scores[i];
+    }
+
+    snapshot.current = static_cast<uint8_t>(dealer);
+    snapshot.winner = -1;
+    snapshot.from_player = -1;
+    snapshot.beginTurn();
+}
+
+TileIndex* WallStore::fork(GameSnapshot& snapshot) {
+    walls.emplace_back();
+    TileIndex* wall = walls.back().data();
+    std::copy(snapshot.wall, snapshot.wall + 136, wall);
+    snapshot.wall = wall;
+    return wall;
+}
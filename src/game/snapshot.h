@@ -0,0 +1,135 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <type_traits>
+#include "types.h"
+#include "table.h"
+#include "legal_actions.h"
+
+// 快照所处的决策阶段
+enum class SnapshotPhase : uint8_t {
+    Action,         // 当前玩家摸牌后的决策
+    RiichiDiscard,  // 当前玩家选择立直宣言牌
+    Response,       // 他家对弃牌的响应 (按座次逐个询问)
+    Finished        // 本局结束
+};
+
+// 一家的局面
+struct SeatSnapshot {
+    uint64_t tiles[3];         // 门前手牌的 TileIndex 位图 (不含摸到的牌)
+    uint8_t counts[34];        // 门前手牌各种牌的张数
+    uint8_t river[32];         // 牌河
+    uint8_t river_len;
+    uint8_t meld_count;        // 副露 (鸣牌尚未改变手牌，目前总为 0)
+    uint8_t melds[4][5];       // 每组: MeldType + 4 张 TileIndex
+    uint8_t riichi;            // 同 Hand::is_richii: 0 未立直, 1 一发有效, 2 一发无效
+    bool missed_ron;           // 同巡 / 立直后见逃振听
+    TileMask discard_mask;     // 打过的牌 (舍张振听)
+    TileMask wait_mask;        // 门前 13 张的和了牌
+    int32_t score;
+
+    bool hasTile(TileIndex tile) const { return tiles[tile >> 6] >> (tile & 63) & 1; }
+    bool isFuriten() const { return missed_ron || (wait_mask & discard_mask) != 0; }
+};
+
+// 可整体 memcpy 的一局局面，和 Table 按同样的规则推进
+// 牌山一局内不变，快照只保存指向它的指针 (与 Table 或 WallStore 共享)，需要改动时先复制一份
+struct GameSnapshot {
+    const TileIndex* wall;     // 136 张牌山，只读共享
+    SeatSnapshot seats[4];
+
+    uint8_t wall_pointer;      // 下一张要摸的牌
+    uint8_t dead_wall_start;   // 王牌起始位置
+    uint8_t kan_count;
+    uint8_t dealer;
+    uint8_t round_wind;
+    uint8_t honba;
+    uint8_t riichi_sticks;
+
+    SnapshotPhase phase;
+    uint8_t current;           // 摸牌 / 弃牌的玩家
+    uint8_t drawn;             // 当前玩家摸到的牌
+    uint8_t responder;         // 响应阶段正在询问的玩家
+    uint8_t discard;           // 响应阶段被响应的弃牌
+    bool riichi_pending;       // 这张弃牌是立直宣言牌，通过后供托立直棒
+    bool fast_scoring;         // 和牌时不解析役种，按估算番数计分 (搜索模拟用)
+    uint8_t responses[4];      // 已收集的响应 (Action - Win)
+    LegalActions legal;        // 当前决策者的合法动作 (与 Table::getLegalActions 相同)
+
+    // 结束时的结果 (役种在 getResult 中重新计算)
+    int8_t winner;
+    int8_t from_player;
+    uint8_t win_tile;
+    uint8_t han;
+    uint8_t fu;
+    int32_t win_score;
+    int32_t deltas[4];
+
+    bool isFinished() const { return phase == SnapshotPhase::Finished; }
+    int getDecisionSeat() const { return phase == SnapshotPhase::Response ? responder : current; }
+    DecisionKind getDecisionKind() const;
+    int getOptions() const { return legal.getOptions(); }
+    const LegalActions& getLegalActions() const { return legal; }
+    int getRemainingTiles() const { return dead_wall_start - wall_pointer; }
+
+    // 执行当前决策，不合法的动作按 Table 的规则改为摸切 / 过
+    // 返回实际执行的动作 (与 Table 的 onDecision 一致)
+    int apply(int action);
+
+    // 外部拼装好局面 (牌山、各家手牌、current) 后开始推进:
+    // 已有摸牌时进入 current 的 Action 阶段，否则 current 从牌山摸牌
+    void resume();
+
+    // 本局结果 (未结束时 winner 为 -1，fast_scoring 时役种为空)
+    GameResult getResult() const;
+
+private:
+    friend bool captureSnapshot(const Table& table, GameSnapshot& snapshot);
+    friend void dealSnapshot(GameSnapshot& snapshot, const TileIndex* wall, int dealer, Wind round_wind,
+                             int honba, int riichi_sticks, const std::array<int, 4>& scores);
+
+    void beginTurn();                   // 当前玩家摸牌，进入 Action 阶段
+    void enterAction();                 // 计算摸牌后的合法动作
+    void beginResponses(TileIndex tile);
+    void askNextResponder();
+    void resolveResponses();
+    void discardTile(TileIndex tile, bool declare_riichi);
+    void finishWin(int seat, int from_seat, TileIndex tile);
+    void finishDraw();
+    void settle(const GameResult& result);
+    Hand toHand(int seat) const;
+    void toLegalHand(int seat, LegalHand& out) const;
+};
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "GameSnapshot must be memcpy-able");
+
+// 纯函数形式: 返回执行 action 之后的新局面
+GameSnapshot stepSnapshot(const GameSnapshot& snapshot, int action);
+
+// 模拟策略: 根据快照返回当前决策者的动作
+using SnapshotPolicy = int (*)(const GameSnapshot& snapshot);
+
+// 从 Table 截取局面，只能在当前玩家摸牌后的决策中调用 (decideAction 内)
+bool captureSnapshot(const Table& table, GameSnapshot& snapshot);
+
+// 不经过 Table 直接开一局: 按 Table 的发牌顺序配牌，庄家摸第一张后停在 Action 阶段
+// wall 的生命周期需覆盖整局
+void dealSnapshot(GameSnapshot& snapshot, const TileIndex* wall, int dealer, Wind round_wind,
+                  int honba, int riichi_sticks, const std::array<int, 4>& scores);
+
+// 快照改写牌山时使用的存储 (写时复制)，存储的生命周期需覆盖所有引用它的快照
+class WallStore {
+private:
+    std::deque<std::array<TileIndex, 136>> walls;
+
+public:
+    // 复制一份牌山并让 snapshot 指向它，返回可写的副本
+    TileIndex* fork(GameSnapshot& snapshot);
+    void clear() { walls.clear(); }
+    size_t size() const { return walls.size(); }
+};
+
+#endif // SNAPSHOT_H
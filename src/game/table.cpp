@@ -1,5 +1,6 @@
 #include "table.h"
 #include "player.h"
+#include "scoring.h"
 
 #include <algorithm>
 #include <cassert>
@@ -7,9 +8,10 @@
 
 Table::Table()
     : current_player(0), dealer(0), round_wind(Wind::East),
-      wall_pointer(0), dead_wall_start(122), kan_count(0),
+      preset_cursor(0), round_seed(0), wall_pointer(0), dead_wall_start(122), kan_count(0),
       honba(0), riichi_sticks(0), is_started(false), is_finished(false) {
     players.fill(nullptr);
+    for (LegalActions& l : legal) l.clear();
     // 初始化随机数生成器
     auto seed = std::chrono::steady_clock::now().time_since_epoch().count();
     rng.seed(static_cast<unsigned>(seed));
@@ -34,24 +36,30 @@ Wind Table::getSeatWind(int seat) const {
 }
 
 void Table::shuffleWall() {
+    // 指定了牌山时直接使用 (回放)
+    if (!preset_wall.empty()) {
+        wall.swap(preset_wall);
+        preset_wall.clear();
+        return;
+    }
     wall.clear();
     wall.reserve(136);
     for (int i = 0; i < 136; ++i) {
         wall.push_back(i);
     }
-    std::shuffle(wall.begin(), wall.end(), rng);
+    // 每局单独取一个种子，记录下来即可复现这一局的牌山
+    round_seed = static_cast<uint32_t>(rng());
+    std::mt19937 wall_rng(round_seed);
+    std::shuffle(wall.begin(), wall.end(), wall_rng);
 }
 
 void Table::dealTiles() {
     // 每人发13张牌
     for (int i = 0; i < 4; ++i) {
         if (players[i]) {
-            TileIndexList hand_tiles;
             int start = i * 13;
-            for (int j = 0; j < 13; ++j) {
-                hand_tiles.push_back(wall[start + j]);
-            }
-            players[i]->initHand(hand_tiles, round_wind, getSeatWind(i));
+            deal_buffer.assign(wall.begin() + start, wall.begin() + start + 13);
+            players[i]->initHand(deal_buffer, round_wind, getSeatWind(i));
         }
     }
     wall_pointer = 52;  // 52张已发出
@@ -60,11 +68,28 @@ void Table::dealTiles() {
 
 void Table::initRound() {
     shuffleWall();
+    preset_decisions.swap(next_decisions);
+    next_decisions.clear();
+    preset_cursor = 0;
     dealTiles();
     current_player = dealer;
     kan_count = 0;
+    for (LegalActions& l : legal) l.clear();
     is_started = true;
     is_finished = false;
+
+    result.winner = -1;
+    result.is_tsumo = false;
+    result.from_player = -1;
+    result.yaku.clear();
+    result.han = 0;
+    result.fu = 0;
+    result.score = 0;
+    result.deltas.fill(0);
+
+    if (callbacks.onRoundStart) {
+        callbacks.onRoundStart();
+    }
 }
 
 void Table::nextPlayer() {
@@ -80,12 +105,23 @@ TileIndex Table::drawTile() {
         return invalid_tile_index;
     }
     TileIndex tile = wall[wall_pointer++];
+    if (players[current_player]) {
+        players[current_player]->draw(tile);
+    }
     if (callbacks.onDraw) {
         callbacks.onDraw(current_player, tile);
     }
     return tile;
 }
 
+TileIndexList Table::getDoraIndicators() const {
+    TileIndexList indicators;
+    for (int i = 0; i < getDoraCount(); ++i) {
+        indicators.push_back(getDoraIndicator(i));
+    }
+    return indicators;
+}
+
 TileIndex Table::drawFromDeadWall() {
     // 岭上摸牌 (杠后摸牌)
     if (kan_count >= 4) {
@@ -97,17 +133,118 @@ TileIndex Table::drawFromDeadWall() {
     return tile;
 }
 
+void scoreAgari(const Hand& hand, TileIndex tile, bool is_tsumo, bool is_last_tile, bool is_dealer,
+                GameResult& result) {
+    AgariFlags flags;
+    flags.is_tsumo = is_tsumo;
+    flags.is_riichi = hand.isRiichi();
+    flags.is_ippatsu = hand.isIppatsu();
+    flags.is_haitei = is_tsumo && is_last_tile;
+    flags.is_houtei = !is_tsumo && is_last_tile;
+
+    result.is_tsumo = is_tsumo;
+    result.yaku = hand.calcYaku(tile, flags);
+    result.han = calcHan(result.yaku, !hand.isMenzen());
+
+    // 七对子固定25符，国士等无法拆解面子的和牌按30符
+    if (std::find(result.yaku.begin(), result.yaku.end(), Yaku::Chiitoitsu) != result.yaku.end()) {
+        result.fu = 25;
+    } else {
+        TileMeldList melds = hand.getBestMelds(tile);
+        result.fu = melds.empty() ? 30 : hand.calcFu(melds, tile, is_tsumo);
+    }
+
+    result.score = calcScore(result.han, result.fu, is_dealer, is_tsumo).total_points;
+}
+
+std::array<int, 4> calcSettlement(const GameResult& result, int dealer, int honba, int riichi_sticks,
+                                  const std::array<bool, 4>& seated, const std::array<bool, 4>& tenpai) {
+    std::array<int, 4> transfer;
+    transfer.fill(0);
+
+    if (result.winner >= 0) {
+        int winner = result.winner;
+        if (result.is_tsumo) {
+            AgariResult agari = calcScore(result.han, result.fu, winner == dealer, true);
+            for (int seat = 0; seat < 4; ++seat) {
+                if (seat == winner || !seated[seat]) continue;
+                int pay = (seat == dealer) ? agari.dealer_payment : agari.non_dealer_payment;
+                pay += honba * 100;
+                transfer[seat] -= pay;
+                transfer[winner] += pay;
+            }
+        } else {
+            int pay = result.score + honba * 300;
+            transfer[result.from_player] -= pay;
+            transfer[winner] += pay;
+        }
+        // 场上立直棒归和牌者
+        transfer[winner] += riichi_sticks * 1000;
+    } else {
+        // 荒牌流局: 不听的玩家共付 3000 点给听牌的玩家
+        int tenpai_count = 0, seat_count = 0;
+        for (int seat = 0; seat < 4; ++seat) {
+            if (seated[seat] && tenpai[seat]) tenpai_count++;
+            if (seated[seat]) seat_count++;
+        }
+        if (tenpai_count > 0 && tenpai_count < seat_count) {
+            int gain = 3000 / tenpai_count, loss = 3000 / (seat_count - tenpai_count);
+            for (int seat = 0; seat < 4; ++seat) {
+                if (!seated[seat]) continue;
+                transfer[seat] = tenpai[seat] ? gain : -loss;
+            }
+        }
+    }
+    return transfer;
+}
+
+void Table::scoreWin(int winner, int from_seat, TileIndex tile) {
+    result.winner = winner;
+    result.from_player = from_seat;
+    scoreAgari(*players[winner]->getHand(), tile, from_seat < 0, isWallEmpty(), winner == dealer, result);
+}
+
+void Table::settleRound() {
+    std::array<bool, 4> seated, tenpai;
+    for (int seat = 0; seat < 4; ++seat) {
+        seated[seat] = players[seat] != nullptr;
+        tenpai[seat] = seated[seat] && players[seat]->getHand()->isTenpai();
+    }
+    std::array<int, 4> transfer = calcSettlement(result, dealer, honba, riichi_sticks, seated, tenpai);
+    if (result.winner >= 0) {
+        riichi_sticks = 0;
+    }
+
+    for (int seat = 0; seat < 4; ++seat) {
+        if (players[seat]) players[seat]->addScore(transfer[seat]);
+        result.deltas[seat] += transfer[seat];
+    }
+}
+
+GameResult Table::finishRound() {
+    settleRound();
+    is_finished = true;
+    if (callbacks.onGameEnd) {
+        callbacks.onGameEnd(result);
+    }
+    return result;
+}
+
+void Table::notifyDecision(int seat, DecisionKind kind, int options, int action) {
+    if (callbacks.onDecision) {
+        callbacks.onDecision(seat, kind, options, action);
+    }
+}
+
+bool Table::takePresetDecision(int& action) {
+    if (preset_cursor >= preset_decisions.size()) return false;
+    action = preset_decisions[preset_cursor++];
+    return true;
+}
+
 GameResult Table::playRound() {
     initRound();
 
-    GameResult result;
-    result.winner = -1;
-    result.is_tsumo = false;
-    result.from_player = -1;
-    result.han = 0;
-    result.fu = 0;
-    result.score = 0;
-
     while (!isWallEmpty()) {
         Player* player = players[current_player];
         if (!player) {
@@ -124,47 +261,58 @@ GameResult Table::playRound() {
         if (drawn == invalid_tile_index) {
             break;  // 牌山空了
         }
+        Hand* hand = player->getHand();
 
-        // 检查是否能自摸
-        bool can_tsumo = player->canWin(drawn);
-        bool can_ankan = player->canAnkan();
-        bool can_riichi = false;  // TODO: 实现立直判定
+        // 本决策点的合法动作只算一次，之后的校验都是位测试
+        LegalHand legal_hand;
+        fillLegalHand(*player, legal_hand);
+        LegalActions& turn = legal[current_player];
+        computeTurnActions(legal_hand, drawn, getRemainingTiles(), kan_count, turn);
+        int options = turn.getOptions();
 
         // 玩家决策
-        int action = player->decideAction(drawn, can_tsumo, can_ankan, can_riichi);
+        int action;
+        if (!takePresetDecision(action)) {
+            action = player->decideAction(drawn, options & DecisionOption::Tsumo, options & DecisionOption::Ankan,
+                                          options & DecisionOption::Riichi);
+        }
 
-        // 处理自摸
-        if (action == static_cast<int>(Action::Win)) {
-            result.winner = current_player;
-            result.is_tsumo = true;
-            result.from_player = -1;
-            result.yaku = player->getHand()->calcYaku(drawn, true);
-            // TODO: 计算番数和点数
-            is_finished = true;
-            if (callbacks.onGameEnd) {
-                callbacks.onGameEnd(result);
-            }
-            return result;
+        // 不可执行的动作一律按摸切处理
+        if (!turn.allows(action)) {
+            action = drawn;
+        }
+        bool is_tsumo = action == static_cast<int>(Action::Win);
+        bool is_riichi = action == static_cast<int>(Action::Riichi);
+        TileIndex riichi_tile = invalid_tile_index;
+        if (is_riichi) {
+            restrictToRiichiDiscards(turn);
+            int preset;
+            riichi_tile = takePresetDecision(preset) ? preset : player->selectRiichiDiscard(drawn);
+            is_riichi = turn.canDiscard(riichi_tile);
+            if (!is_riichi) action = drawn;
+        }
+        turn.clear();
+        notifyDecision(current_player, DecisionKind::Action, options, action);
+        if (is_riichi) {
+            notifyDecision(current_player, DecisionKind::RiichiDiscard, 0, riichi_tile);
         }
 
-        // 处理暗杠
-        if (action == static_cast<int>(Action::Ankan)) {
-            // TODO: 处理暗杠
-            TileIndex rinshan = drawFromDeadWall();
-            // 继续当前玩家回合
-            continue;
+        // 处理自摸
+        if (is_tsumo) {
+            scoreWin(current_player, -1, drawn);
+            return finishRound();
         }
 
+        // TODO: 暗杠 / 加杠 (合法动作中暂不开放 Action::Ankan)
+
         // 处理弃牌
-        TileIndex discard_tile;
-        if (action >= 0 && action < 136) {
-            discard_tile = action;
-        } else {
-            // 默认打出摸到的牌
-            discard_tile = drawn;
-        }
+        TileIndex discard_tile = is_riichi ? riichi_tile : action;
 
-        // 执行弃牌
+        // 执行弃牌 (一发只维持到立直后自己的下一次弃牌)
+        hand->consumeIppatsu();
+        if (is_riichi) {
+            hand->declareRiichi();
+        }
         player->discard(discard_tile);
         if (callbacks.onDiscard) {
             callbacks.onDiscard(current_player, discard_tile);
@@ -176,24 +324,31 @@ GameResult Table::playRound() {
         if (response_result == static_cast<int>(Action::Win)) {
             // 有人荣和
             // result 在 checkResponses 中设置
-            is_finished = true;
-            return result;
+            return finishRound();
+        }
+
+        // 宣言牌通过后立直成立，供托一根立直棒 (鸣牌后 current_player 已是鸣牌者)
+        if (is_riichi) {
+            player->addScore(-1000);
+            result.deltas[player->getSeat()] -= 1000;
+            riichi_sticks++;
         }
 
         if (response_result == static_cast<int>(Action::Pass)) {
             // 没人响应，下一个玩家
             nextPlayer();
+        } else {
+            // 有人鸣牌，所有人的一发失效
+            for (Player* p : players) {
+                if (p) p->getHand()->breakIppatsu();
+            }
         }
         // 如果有人吃/碰/杠，current_player 已在 checkResponses 中更新
     }
 
     // 流局
     result.winner = -1;
-    is_finished = true;
-    if (callbacks.onGameEnd) {
-        callbacks.onGameEnd(result);
-    }
-    return result;
+    return finishRound();
 }
 
 int Table::checkResponses(TileIndex discard, int from_seat) {
@@ -209,13 +364,30 @@ int Table::checkResponses(TileIndex discard, int from_seat) {
         Player* player = players[seat];
         if (!player) continue;
 
-        bool can_chi = (i == 1) && player->canChi(discard);  // 只有下家能吃
-        bool can_pon = player->canPon(discard);
-        bool can_kan = player->canKan(discard);
-        bool can_ron = player->canWin(discard);
+        LegalHand legal_hand;
+        fillLegalHand(*player, legal_hand);
+        LegalActions& options = legal[seat];
+        computeResponseActions(legal_hand, discard, i == 1, getRemainingTiles(), kan_count, options);
+
+        if (options.any()) {
+            int opts = options.getOptions();
+            int response;
+            if (!takePresetDecision(response)) {
+                response = player->decideResponse(discard, from_seat, opts & DecisionOption::Chi,
+                                                  opts & DecisionOption::Pon, opts & DecisionOption::Kan,
+                                                  opts & DecisionOption::Ron);
+            }
 
-        if (can_chi || can_pon || can_kan || can_ron) {
-            responses[seat] = player->decideResponse(discard, from_seat, can_chi, can_pon, can_kan, can_ron);
+            // 不在可选范围内的响应视为过
+            if (!options.allows(response)) {
+                response = static_cast<int>(Action::Pass);
+            }
+            responses[seat] = response;
+            if ((opts & DecisionOption::Ron) && response != static_cast<int>(Action::Win)) {
+                player->missRon();
+            }
+            options.clear();
+            notifyDecision(seat, DecisionKind::Response, opts, response);
         }
     }
 
@@ -223,7 +395,8 @@ int Table::checkResponses(TileIndex discard, int from_seat) {
     for (int i = 1; i <= 3; ++i) {
         int seat = (from_seat + i) % 4;
         if (responses[seat] == static_cast<int>(Action::Win)) {
-            // TODO: 处理荣和，设置 GameResult
+            // 头跳: 按逆时针顺序第一个荣和的玩家和牌
+            scoreWin(seat, from_seat, discard);
             return static_cast<int>(Action::Win);
         }
     }
@@ -1,12 +1,15 @@
 #ifndef TABLE_H
 #define TABLE_H
 
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <string>
 #include <functional>
 #include <random>
+#include <cstdint>
 #include "types.h"
+#include "legal_actions.h"
 
 class Player;
 
@@ -18,16 +21,46 @@ struct GameResult {
     YakuList yaku;        // 役种
     int han;              // 番数
     int fu;               // 符数
-    int score;            // 得点
+    int score;            // 得点 (不含本场和立直棒)
+    std::array<int, 4> deltas;  // 本局各家点数变化 (含立直棒、本场、流局罚符)
 };
 
+// 计算和牌的役种、番符与得点，写入 result (winner/from_player/deltas 由调用方填写)
+void scoreAgari(const Hand& hand, TileIndex tile, bool is_tsumo, bool is_last_tile, bool is_dealer,
+                GameResult& result);
+
+// 按结果计算本局各家点数转移 (本场、立直棒、流局罚符，不含供托立直棒)
+std::array<int, 4> calcSettlement(const GameResult& result, int dealer, int honba, int riichi_sticks,
+                                  const std::array<bool, 4>& seated, const std::array<bool, 4>& tenpai);
+
+// 决策类型 (随 onDecision 回调一起给出)
+enum class DecisionKind {
+    Action,         // 摸牌后的决策
+    Response,       // 对他家弃牌的响应
+    RiichiDiscard   // 立直后选择的宣言牌
+};
+
+// 决策时的可选动作位 (随 onDecision 回调一起给出)
+namespace DecisionOption {
+    const int Tsumo  = 1 << 0;
+    const int Ankan  = 1 << 1;
+    const int Riichi = 1 << 2;
+    const int Chi    = 1 << 3;
+    const int Pon    = 1 << 4;
+    const int Kan    = 1 << 5;
+    const int Ron    = 1 << 6;
+}
+
 // 游戏事件回调 (用于网络同步)
 struct GameCallbacks {
+    std::function<void()> onRoundStart;  // 发牌完成后
     std::function<void(int seat, TileIndex tile)> onDraw;
     std::function<void(int seat, TileIndex tile)> onDiscard;
     std::function<void(int seat, int action, TileIndex tile)> onMeld;
     std::function<void(const GameResult&)> onGameEnd;
     std::function<void(int seat)> onTurnStart;
+    // 每次玩家决策返回后，action 为实际执行的动作 (用于牌谱记录)
+    std::function<void(int seat, DecisionKind kind, int options, int action)> onDecision;
 };
 
 class Table {
@@ -38,6 +71,12 @@ private:
     Wind round_wind;          // 场风
 
     TileIndexList wall;       // 牌山 (136张)
+    TileIndexList preset_wall; // 下一局指定使用的牌山 (回放用)
+    TileIndexList deal_buffer; // 发牌时复用的配牌缓冲
+    std::vector<int> preset_decisions;  // 本局开头按记录执行的决策 (恢复检查点用)
+    std::vector<int> next_decisions;    // 下一局的 preset_decisions
+    size_t preset_cursor;
+    uint32_t round_seed;      // 本局洗牌种子
     int wall_pointer;         // 牌山指针
     int dead_wall_start;      // 王牌起始位置
 
@@ -48,7 +87,10 @@ private:
     bool is_started;
     bool is_finished;
 
+    std::array<LegalActions, 4> legal;  // 各家当前决策点的合法动作 (不在决策中时为空)
+
     GameCallbacks callbacks;
+    GameResult result;        // 本局结果
     std::mt19937 rng;
 
 public:
@@ -61,13 +103,40 @@ public:
 
     // 设置回调
     void setCallbacks(const GameCallbacks& cb) { callbacks = cb; }
+    const GameCallbacks& getCallbacks() const { return callbacks; }
+
+    // 随机种子与牌山 (用于复现和回放)
+    void setSeed(uint32_t seed) { rng.seed(seed); }
+    void setNextWall(const TileIndexList& tiles) { preset_wall = tiles; }
+    uint32_t getRoundSeed() const { return round_seed; }
+    const TileIndexList& getWall() const { return wall; }
+    // 下一局开头的决策直接按给定动作 (onDecision 给出的实际动作) 执行，用完后再询问玩家
+    void setNextDecisions(const std::vector<int>& actions) { next_decisions = actions; }
+    bool isReplaying() const { return preset_cursor < preset_decisions.size(); }
+
+    // 局面设置
+    void setDealer(int seat) { dealer = seat; }
+    void setRoundWind(Wind wind) { round_wind = wind; }
+    void setHonba(int count) { honba = count; }
+    void setRiichiSticks(int count) { riichi_sticks = count; }
 
     // 游戏信息
     int getCurrentPlayer() const { return current_player; }
     int getDealer() const { return dealer; }
     Wind getRoundWind() const { return round_wind; }
+    int getHonba() const { return honba; }
+    int getRiichiSticks() const { return riichi_sticks; }
     int getRemainingTiles() const { return dead_wall_start - wall_pointer; }
+    int getWallPointer() const { return wall_pointer; }
+    int getKanCount() const { return kan_count; }
+    TileIndexList getDoraIndicators() const;  // 已翻开的宝牌指示牌 (开局一张，每杠加一张)
+    int getDoraCount() const { return wall.size() < 136 ? 0 : std::min(kan_count, 4) + 1; }
+    // 第 i 张指示牌 (i < getDoraCount())，王牌前 4 张是岭上牌，其后依次是宝牌指示牌
+    TileIndex getDoraIndicator(int i) const { return wall[dead_wall_start + 4 + i]; }
     bool isFinished() const { return is_finished; }
+    const GameResult& getResult() const { return result; }
+    // 正在决策的玩家的合法动作，决策返回后清空 (网络层用它校验客户端动作)
+    const LegalActions& getLegalActions(int seat) const { return legal[seat]; }
 
     // 游戏流程
     void initRound();         // 初始化一局
@@ -85,6 +154,11 @@ private:
     void nextPlayer();
     bool isWallEmpty() const;
     TileIndex drawFromDeadWall();  // 岭上摸牌
+    void scoreWin(int winner, int from_seat, TileIndex tile);  // 计算和牌役种与得点
+    void settleRound();       // 按结果结算点数 (本场、立直棒、流局罚符)
+    GameResult finishRound(); // 结算并通知本局结束
+    void notifyDecision(int seat, DecisionKind kind, int options, int action);
+    bool takePresetDecision(int& action);  // 还有记录的决策时取出下一个
 };
 
 #endif // TABLE_H
@@ -0,0 +1,175 @@
+#include "tournament.h"
+#include "table.h"
+#include "player.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+
+// EntrantStats 实现
+double EntrantStats::averageRank() const {
+    if (matches == 0) return 0;
+    long sum = 0;
+    for (int rank = 0; rank < 4; ++rank) {
+        sum += rank_counts[rank] * (rank + 1);
+    }
+    return static_cast<double>(sum) / matches;
+}
+
+void EntrantStats::merge(const EntrantStats& other) {
+    matches += other.matches;
+    for (int i = 0; i < 4; ++i) {
+        rank_counts[i] += other.rank_counts[i];
+        seat_counts[i] += other.seat_counts[i];
+    }
+    score_sum += other.score_sum;
+    wins += other.wins;
+    deal_ins += other.deal_ins;
+    rounds += other.rounds;
+    busted += other.busted;
+}
+
+// Tournament 实现
+Tournament::Tournament(const TournamentConfig& cfg, PlayerFactory f)
+    : config(cfg), factory(std::move(f)) {
+    std::array<int, 4> seating = {0, 1, 2, 3};
+    switch (config.rotation) {
+        case SeatRotation::Fixed:
+            seatings.push_back(seating);
+            break;
+        case SeatRotation::Cycle:
+            for (int r = 0; r < 4; ++r) {
+                for (int seat = 0; seat < 4; ++seat) seating[seat] = (seat + r) % 4;
+                seatings.push_back(seating);
+            }
+            break;
+        case SeatRotation::All:
+            do {
+                seatings.push_back(seating);
+            } while (std::next_permutation(seating.begin(), seating.end()));
+            break;
+    }
+}
+
+uint32_t Tournament::getSeed(long task) const {
+    // 同一副牌山的所有座次使用同一个种子
+    long game = task / static_cast<long>(seatings.size());
+    if (config.seeds == SeedSchedule::Sequential) {
+        return config.base_seed + static_cast<uint32_t>(game);
+    }
+    // 可跳转的随机序列: 以场次为输入做一次混合，不依赖执行顺序
+    uint64_t x = (static_cast<uint64_t>(config.base_seed) << 32) ^ static_cast<uint64_t>(game);
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<uint32_t>(x ^ (x >> 31));
+}
+
+bool Tournament::popTask(WorkQueue& queue, long& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool Tournament::stealTask(WorkQueue& queue, long& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+TournamentReport Tournament::run() {
+    int num_threads = config.num_threads;
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    long total = getTotalMatches();
+    if (num_threads > total) num_threads = std::max(1L, total);
+
+    // 按连续区间预先分配，同一副牌山的不同座次尽量在同一线程
+    std::vector<WorkQueue> queues(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        long begin = total * t / num_threads, end = total * (t + 1) / num_threads;
+        // 队尾先出，倒序放入使本线程按场次顺序执行
+        for (long task = end - 1; task >= begin; --task) {
+            queues[t].tasks.push_back(task);
+        }
+    }
+
+    struct alignas(64) Accumulator {
+        std::array<EntrantStats, 4> entrants;
+        long steals = 0;
+    };
+    std::vector<Accumulator> accumulators(num_threads);
+
+    auto worker = [&](int id) {
+        Table table;
+        std::array<std::unique_ptr<Player>, 4> players;
+        for (int e = 0; e < 4; ++e) {
+            players[e] = factory(e);
+        }
+        Match match(&table, config.rules);
+        Accumulator& acc = accumulators[id];
+        std::mt19937 victim_rng(id);
+
+        long task;
+        while (true) {
+            if (!popTask(queues[id], task)) {
+                // 本地队列空了，从随机位置开始依次尝试偷取
+                bool stolen = false;
+                int start = victim_rng() % num_threads;
+                for (int i = 0; i < num_threads && !stolen; ++i) {
+                    int victim = (start + i) % num_threads;
+                    if (victim != id) stolen = stealTask(queues[victim], task);
+                }
+                if (!stolen) break;  // 任务只会减少，所有队列都空即可结束
+                acc.steals++;
+            }
+
+            const std::array<int, 4>& seating = getSeating(task);
+            for (int seat = 0; seat < 4; ++seat) {
+                table.setPlayer(seat, players[seating[seat]].get());
+            }
+            table.setSeed(getSeed(task));
+            const MatchResult& result = match.play(0);
+
+            for (int seat = 0; seat < 4; ++seat) {
+                EntrantStats& stats = acc.entrants[seating[seat]];
+                stats.matches++;
+                stats.rank_counts[result.ranks[seat]]++;
+                stats.seat_counts[seat]++;
+                stats.score_sum += result.scores[seat];
+                stats.wins += result.wins[seat];
+                stats.deal_ins += result.deal_ins[seat];
+                stats.rounds += result.rounds_played;
+                if (result.busted && result.scores[seat] < 0) stats.busted++;
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    TournamentReport report;
+    for (const Accumulator& acc : accumulators) {
+        for (int e = 0; e < 4; ++e) {
+            report.entrants[e].merge(acc.entrants[e]);
+        }
+        report.steals += acc.steals;
+    }
+    report.matches = total;
+    report.threads = num_threads;
+    report.seconds = elapsed.count();
+    return report;
+}
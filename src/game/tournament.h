@@ -0,0 +1,95 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "match.h"
+
+class Player;
+
+// 座位轮换方式
+enum class SeatRotation {
+    Fixed,   // 参赛者 i 固定坐 i 号位
+    Cycle,   // 同一副牌山轮换 4 次，每人坐遍四个座位
+    All      // 同一副牌山打遍 24 种座次
+};
+
+// 每场牌山种子的生成方式
+enum class SeedSchedule {
+    Sequential,  // base_seed + 场次
+    Random       // 由 base_seed 生成的随机序列
+};
+
+struct TournamentConfig {
+    int games = 1000;                            // 不同牌山的场数 (总对局数 = games * 每场座次数)
+    MatchRules rules;
+    SeatRotation rotation = SeatRotation::Cycle;
+    SeedSchedule seeds = SeedSchedule::Sequential;
+    uint32_t base_seed = 1;
+    int num_threads = 0;                         // <= 0 时使用全部核心
+};
+
+// 单个参赛者的累计成绩
+struct EntrantStats {
+    long matches = 0;
+    std::array<long, 4> rank_counts = {};  // 各名次次数
+    std::array<long, 4> seat_counts = {};  // 各座位 (起家为 0) 次数
+    long score_sum = 0;
+    long wins = 0;
+    long deal_ins = 0;
+    long rounds = 0;   // 参与的总局数
+    long busted = 0;   // 被击飞次数
+
+    double averageRank() const;
+    void merge(const EntrantStats& other);
+};
+
+struct TournamentReport {
+    std::array<EntrantStats, 4> entrants;
+    long matches = 0;
+    long steals = 0;    // 从其他线程偷到的任务数
+    int threads = 0;
+    double seconds = 0;
+};
+
+// 为参赛者创建一个玩家实例，每个工作线程各自调用一次
+using PlayerFactory = std::function<std::unique_ptr<Player>(int entrant)>;
+
+// 多牌桌锦标赛调度
+// 每个工作线程持有一张牌桌、四个玩家和一个本地双端队列；
+// 自己从队尾取任务，空了就从其他线程的队首偷，成绩写入线程私有的累加器，结束后再合并
+class Tournament {
+private:
+    // 一个线程的任务队列，锁只在偷取时才会有竞争
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::deque<long> tasks;
+    };
+
+    TournamentConfig config;
+    PlayerFactory factory;
+    std::vector<std::array<int, 4>> seatings;  // 每种座次: 座位 -> 参赛者
+
+public:
+    Tournament(const TournamentConfig& cfg, PlayerFactory f);
+
+    const TournamentConfig& getConfig() const { return config; }
+    long getTotalMatches() const { return static_cast<long>(config.games) * seatings.size(); }
+
+    // 第 task 场对局使用的牌山种子与座次
+    uint32_t getSeed(long task) const;
+    const std::array<int, 4>& getSeating(long task) const { return seatings[task % seatings.size()]; }
+
+    TournamentReport run();
+
+private:
+    static bool popTask(WorkQueue& queue, long& task);
+    static bool stealTask(WorkQueue& queue, long& task);
+};
+
+#endif // TOURNAMENT_H
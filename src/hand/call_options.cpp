@@ -0,0 +1,161 @@
+#include "call_options.h"
+#include "constants.h"
+#include "shanten.h"
+
+// 鸣牌后手牌必然不是门清，只需要一般型的拆解
+
+static bool isRedFive( TileIndex tile_index ) {
+    return tile_index % 4 == 0 && Five.contains(tile_index / 4);
+}
+
+TileMask getKuikaeMask( MeldType type, Tile call, Tile low ) {
+    TileMask mask = 1ULL << call;
+    if ( type != MeldType::Chi ) return mask;
+    // 两面吃时打出另一端的筋牌也是食替 (吃 3 拿 45 不能打 6)
+    if ( call == low && getNextTile(low + 2) != invalid_tile ) mask |= 1ULL << (low + 3);
+    if ( call == low + 2 && getPrevTile(low) != invalid_tile ) mask |= 1ULL << (low - 1);
+    return mask;
+}
+
+// 手牌中某种牌可以拿出来的方式: 有赤五且普通牌够用时，分别给出用赤五和不用赤五两种
+static int pickTiles( const TileIndexList &tiles, Tile tile, int need, TileIndex picks[2][3] ) {
+    TileIndex red = invalid_tile_index;
+    TileIndex normal[4];
+    int normal_count = 0;
+    for ( TileIndex index : tiles ) {
+        if ( index / 4 != tile ) continue;
+        if ( isRedFive(index) ) red = index;
+        else normal[normal_count++] = index;
+    }
+    int variants = 0;
+    if ( red != invalid_tile_index && normal_count >= need - 1 ) {
+        picks[variants][0] = red;
+        for ( int i = 1; i < need; ++i ) picks[variants][i] = normal[i - 1];
+        variants++;
+    }
+    if ( normal_count >= need ) {
+        for ( int i = 0; i < need; ++i ) picks[variants][i] = normal[i];
+        variants++;
+    }
+    return variants;
+}
+
+// 一种鸣牌方式: 计算杠后的结果，或每张合法打出牌的结果
+static void addOption( const TileCounts &counts, const ShantenGroup base[4], int melds, const TileCounts &visible,
+                       MeldType type, const TileIndex used[3], int used_count, TileMask kuikae,
+                       CallEvaluation &out ) {
+    TileCounts post(counts);
+    ShantenGroup groups[4];
+    for ( int g = 0; g < 4; ++g ) groups[g] = base[g];
+    bool dirty[4] = {false, false, false, false};
+    for ( int i = 0; i < used_count; ++i ) {
+        post[used[i] / 4]--;
+        dirty[used[i] / 36] = true;
+    }
+    for ( int g = 0; g < 4; ++g ) {
+        if ( dirty[g] ) calcShantenGroup(post, g, groups[g]);
+    }
+
+    CallOption option;
+    option.type = type;
+    for ( int i = 0; i < 3; ++i ) option.tiles[i] = i < used_count ? used[i] : invalid_tile_index;
+
+    if ( type == MeldType::Minkan ) {
+        option.discard = invalid_tile;
+        option.shanten = combineShanten(groups, melds);
+        option.ukeire_mask = calcUkeire(post, melds, false, visible, option.ukeire);
+        out.options.push_back(option);
+        return;
+    }
+
+    // 摸到 t 后 t 所在一门的拆解，与打出的牌不在同一门时可以直接复用
+    ShantenGroup drawn[34];
+    TileCounts next(post);
+    for ( int tile = 0; tile < 34; ++tile ) {
+        if ( visible[tile] >= 4 ) continue;
+        next[tile]++;
+        calcShantenGroup(next, tile / 9, drawn[tile]);
+        next[tile]--;
+    }
+
+    for ( int d = 0; d < 34; ++d ) {
+        if ( post[d] == 0 || (kuikae >> d & 1) ) continue;
+        int gd = d / 9;
+        TileCounts after(post);
+        after[d]--;
+        ShantenGroup cur[4];
+        for ( int g = 0; g < 4; ++g ) cur[g] = groups[g];
+        calcShantenGroup(after, gd, cur[gd]);
+
+        option.discard = d;
+        option.shanten = combineShanten(cur, melds);
+        option.ukeire = 0;
+        option.ukeire_mask = 0;
+        for ( int tile = 0; tile < 34; ++tile ) {
+            int left = 4 - visible[tile];
+            if ( left <= 0 ) continue;
+            int g = tile / 9;
+            ShantenGroup saved = cur[g];
+            if ( g == gd ) {
+                after[tile]++;
+                calcShantenGroup(after, g, cur[g]);
+                after[tile]--;
+            } else {
+                cur[g] = drawn[tile];
+            }
+            int s = combineShanten(cur, melds);
+            cur[g] = saved;
+            if ( s < option.shanten ) {
+                option.ukeire_mask |= 1ULL << tile;
+                option.ukeire += left;
+            }
+        }
+        out.options.push_back(option);
+    }
+}
+
+void evaluateCalls( const Hand &hand, TileIndex discard, bool allow_chi, const TileCounts &visible,
+                    CallEvaluation &out ) {
+    out.options.clear();
+    TileCounts counts = hand.getTileCounts();
+    int melds = static_cast<int>(hand.getOpenMelds().size());
+    out.shanten = calcShanten(counts, melds, hand.isMenzen());
+    calcUkeire(counts, melds, hand.isMenzen(), visible, out.ukeire);
+
+    ShantenGroup base[4];
+    for ( int g = 0; g < 4; ++g ) calcShantenGroup(counts, g, base[g]);
+
+    const TileIndexList &tiles = hand.getTiles();
+    Tile call = discard / 4;
+    TileIndex picks[2][3], picks2[2][3];
+
+    // 碰
+    int variants = pickTiles(tiles, call, 2, picks);
+    for ( int v = 0; v < variants; ++v )
+        addOption(counts, base, melds + 1, visible, MeldType::Pon, picks[v], 2,
+                  getKuikaeMask(MeldType::Pon, call, call), out);
+
+    // 大明杠
+    if ( counts[call] == 3 ) {
+        pickTiles(tiles, call, 3, picks);
+        addOption(counts, base, melds + 1, visible, MeldType::Minkan, picks[0], 3, 0, out);
+    }
+
+    // 吃: 被吃的牌在顺子中的三个位置
+    if ( !allow_chi || Honor.contains(call) ) return;
+    for ( int pos = 0; pos < 3; ++pos ) {
+        Tile low = call - pos;
+        if ( low < 0 || low / 9 != call / 9 || low % 9 > 6 ) continue;
+        Tile need[2];
+        int n = 0;
+        for ( Tile t = low; t < low + 3; ++t )
+            if ( t != call ) need[n++] = t;
+        int v1 = pickTiles(tiles, need[0], 1, picks);
+        int v2 = pickTiles(tiles, need[1], 1, picks2);
+        TileMask kuikae = getKuikaeMask(MeldType::Chi, call, low);
+        for ( int a = 0; a < v1; ++a ) for ( int b = 0; b < v2; ++b ) {
+            TileIndex used[3] = {picks[a][0], picks2[b][0], invalid_tile_index};
+            addOption(counts, base, melds + 1, visible, MeldType::Chi, used, 2, kuikae, out);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef CALL_OPTIONS_H
+#define CALL_OPTIONS_H
+
+#include <vector>
+#include "types.h"
+
+// 一种鸣牌方式 (含鸣牌后打出的牌) 及其结果
+struct CallOption {
+    MeldType type;          // Chi / Pon / Minkan
+    TileIndex tiles[3];     // 从手牌中拿出的牌 (吃、碰 2 张，杠 3 张，其余为 invalid_tile_index)
+    Tile discard;           // 鸣牌后打出的牌种 (大明杠为 invalid_tile，杠后摸岭上牌)
+    int shanten;            // 打出后的向听数 (杠为杠后 3n+1 张的向听数)
+    int ukeire;             // 有效牌剩余枚数
+    TileMask ukeire_mask;   // 有效牌牌种
+};
+
+// 对一张弃牌的全部鸣牌选择
+struct CallEvaluation {
+    int shanten;                      // 不鸣牌时的向听数
+    int ukeire;                       // 不鸣牌时的有效牌枚数
+    std::vector<CallOption> options;  // 每种鸣牌方式 x 每种合法的打出牌 (复用容量)
+};
+
+// 列举对 discard 的吃 (allow_chi 时)、碰、大明杠，区分赤五和普通五，
+// 吃碰后打出的牌排除食替 (同种牌和吃两面时的筋牌)
+// visible 为已经看到的各种牌张数 (含自己手牌)，用于计算有效牌枚数
+// 按门增量计算: 鸣牌只重新拆解涉及的一门，每张打出牌、每张有效牌也只重新拆解一门
+void evaluateCalls( const Hand &hand, TileIndex discard, bool allow_chi, const TileCounts &visible,
+                    CallEvaluation &out );
+
+// 鸣牌后不能打出的牌种 (食替): 被鸣的牌种，吃两面时另一端的筋牌
+TileMask getKuikaeMask( MeldType type, Tile call, Tile low );
+
+#endif // CALL_OPTIONS_H
@@ -5,5 +5,6 @@
 #include "constants.h"
 #include "tiles.h"
 #include "scoring.h"
+#include "shanten.h"
 
 #endif
\ No newline at end of file
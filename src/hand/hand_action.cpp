@@ -14,15 +14,22 @@ TileCounts getTileCounts(const TileIndexList &hand) {
 }
 
 Hand::Hand(const TileIndexList& init_tiles, Wind round, Wind seat){
+    reset(init_tiles, round, seat);
+}
+
+// 重新配牌，复用已有容量 (连续对局时避免反复分配)
+void Hand::reset(const TileIndexList& init_tiles, Wind round, Wind seat){
     assert(init_tiles.size() == 13);
     // for ( const TileIndex &tile_index : init_tiles ) 
     //     assert(tile_index >= 0 && tile_index < 136);
-    hand = TileList(init_tiles);
+    hand.assign(init_tiles.begin(), init_tiles.end());
+    open.clear();
     open_melds.clear();
     round_wind = round;
     seat_wind = seat;
     tile_counts = ::getTileCounts(init_tiles);
     is_menzen = 1; is_richii = 0;
+    updateWaitMask();
 }
 
 void Hand::arrangeTiles() {
@@ -114,6 +121,7 @@ bool Hand::callChi(const TileIndex &call, const TileIndex &discard, int opt){
     else open_melds.push_back(TileMeld(MeldType::Chi, t1));
     is_menzen = false;
 
+    updateWaitMask();
     return true;
 }
 
@@ -131,6 +139,7 @@ bool Hand::callPon(const TileIndex &call, const TileIndex &discard, int opt = 0)
     open_melds.push_back(TileMeld(MeldType::Pon, tile));
     is_menzen = false;
 
+    updateWaitMask();
     return true;
 }
 
@@ -145,6 +154,7 @@ bool Hand::callKan(const TileIndex &call){
     open_melds.push_back(TileMeld(MeldType::Minkan, tile));
     is_menzen = false;
 
+    updateWaitMask();
     return true;
 }
 
@@ -158,6 +168,7 @@ bool Hand::performAnkan(const TileIndex &tile_index){
 
     open_melds.push_back(TileMeld(MeldType::Ankan, tile));
 
+    updateWaitMask();
     return true;
 }
 
@@ -171,17 +182,21 @@ bool Hand::performChakan(const TileIndex &tile_index){
     }
     assert(is_found);
     open.push_back(tile_index);
-
     return true;
 }
 
-bool Hand::drawAndDiscard(const Tile &draw, const Tile &discard){
+bool Hand::hasTileIndex(const TileIndex &tile_index) const{
+    return std::find(hand.begin(), hand.end(), tile_index) != hand.end();
+}
+
+bool Hand::drawAndDiscard(const TileIndex &draw, const TileIndex &discard){
     hand.push_back(draw);
     tile_counts[draw / 4]++;
 
-    auto it = findByTile(hand, discard); assert(it != hand.end());
+    auto it = findByTileIndex(hand, discard); assert(it != hand.end());
     hand.erase(it); tile_counts[discard / 4]--;
     
+    updateWaitMask();
     return true;
 }
 
@@ -188,11 +188,14 @@ AgariResult calcScore(int han, int fu, bool is_dealer, bool is_tsumo) {
     result.base_points = calcBasePoints(han, fu);
 
     int base = result.base_points;
+    result.dealer_payment = 0;
+    result.non_dealer_payment = 0;
 
     if (is_dealer) {
         if (is_tsumo) {
             // 庄家自摸: 各家支付 base * 2
             int each = roundUp100(base * 2);
+            result.non_dealer_payment = each;
             result.total_points = each * 3;
         } else {
             // 庄家荣和: 放铳者支付 base * 6
@@ -203,6 +206,8 @@ AgariResult calcScore(int han, int fu, bool is_dealer, bool is_tsumo) {
             // 闲家自摸: 庄家支付 base * 2, 闲家各支付 base * 1
             int dealer_pay = roundUp100(base * 2);
             int other_pay = roundUp100(base);
+            result.dealer_payment = dealer_pay;
+            result.non_dealer_payment = other_pay;
             result.total_points = dealer_pay + other_pay * 2;
         } else {
             // 闲家荣和: 放铳者支付 base * 4
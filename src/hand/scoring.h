@@ -10,6 +10,8 @@ struct AgariResult {
     int fu;
     int base_points;
     int total_points;
+    int dealer_payment;      // 自摸时庄家支付 (庄家自摸时为 0)
+    int non_dealer_payment;  // 自摸时每个闲家支付
     bool is_dealer;
     bool is_tsumo;
     std::string yaku_names;
@@ -19,6 +21,9 @@ struct AgariResult {
 int calcFu(const TileMeldList& melds, const TileIndex& draw,
            Wind round_wind, Wind seat_wind, bool is_tsumo, bool is_menzen);
 
+// 番数计算 (役满返回 100, 双倍役满返回 200)
+int calcHan(const YakuList& yaku_list, const bool& is_fuuro);
+
 // 基本点数计算 (切上满贯)
 int calcBasePoints(int han, int fu);
 
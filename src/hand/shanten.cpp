@@ -0,0 +1,157 @@
+#include "shanten.h"
+#include <algorithm>
+
+// 按门拆解后再合成: 一门内用回溯枚举 (面子, 雀头) 组合下最多的搭子数，
+// 四门之间只需要对 best 表做 max-plus 合并，不再整体回溯
+
+static void scanGroup( int c[9], int len, bool is_honor, int i, int m, int t, int p, ShantenGroup &out ) {
+    while ( i < len && c[i] == 0 ) ++i;
+    if ( i == len ) {
+        if ( m > 4 ) m = 4;
+        if ( t > out.best[m][p] ) out.best[m][p] = t;
+        return;
+    }
+
+    // 刻子
+    if ( c[i] >= 3 ) {
+        c[i] -= 3;
+        scanGroup(c, len, is_honor, i, m + 1, t, p, out);
+        c[i] += 3;
+    }
+    // 顺子
+    if ( !is_honor && i + 2 < len && c[i + 1] > 0 && c[i + 2] > 0 ) {
+        c[i]--; c[i + 1]--; c[i + 2]--;
+        scanGroup(c, len, is_honor, i, m + 1, t, p, out);
+        c[i]++; c[i + 1]++; c[i + 2]++;
+    }
+    if ( c[i] >= 2 ) {
+        c[i] -= 2;
+        // 雀头
+        if ( p == 0 ) scanGroup(c, len, is_honor, i, m, t, 1, out);
+        // 对子搭子
+        scanGroup(c, len, is_honor, i, m, t + 1, p, out);
+        c[i] += 2;
+    }
+    if ( !is_honor ) {
+        // 两面 / 边张
+        if ( i + 1 < len && c[i + 1] > 0 ) {
+            c[i]--; c[i + 1]--;
+            scanGroup(c, len, is_honor, i, m, t + 1, p, out);
+            c[i]++; c[i + 1]++;
+        }
+        // 嵌张
+        if ( i + 2 < len && c[i + 2] > 0 ) {
+            c[i]--; c[i + 2]--;
+            scanGroup(c, len, is_honor, i, m, t + 1, p, out);
+            c[i]++; c[i + 2]++;
+        }
+    }
+    // 孤张
+    c[i]--;
+    scanGroup(c, len, is_honor, i, m, t, p, out);
+    c[i]++;
+}
+
+void calcShantenGroup( const TileCounts &counts, int group, ShantenGroup &out ) {
+    for ( auto &row : out.best ) row[0] = row[1] = -1;
+    int len = (group == 3) ? 7 : 9;
+    int c[9];
+    for ( int i = 0; i < len; ++i ) c[i] = counts[group * 9 + i];
+    scanGroup(c, len, group == 3, 0, 0, 0, 0, out);
+}
+
+int combineShanten( const ShantenGroup groups[4], int open_melds ) {
+    // best[m][p] 的 max-plus 合并
+    int best[5][2];
+    for ( auto &row : best ) row[0] = row[1] = -1;
+    best[0][0] = 0;
+    for ( int g = 0; g < 4; ++g ) {
+        int next[5][2];
+        for ( auto &row : next ) row[0] = row[1] = -1;
+        for ( int m1 = 0; m1 <= 4; ++m1 ) for ( int p1 = 0; p1 <= 1; ++p1 ) {
+            if ( best[m1][p1] < 0 ) continue;
+            for ( int m2 = 0; m1 + m2 <= 4; ++m2 ) for ( int p2 = 0; p1 + p2 <= 1; ++p2 ) {
+                int t2 = groups[g].best[m2][p2];
+                if ( t2 < 0 ) continue;
+                next[m1 + m2][p1 + p2] = std::max(next[m1 + m2][p1 + p2], best[m1][p1] + t2);
+            }
+        }
+        std::copy(&next[0][0], &next[0][0] + 10, &best[0][0]);
+    }
+
+    int shanten = 8;
+    for ( int m = 0; m + open_melds <= 4; ++m ) for ( int p = 0; p <= 1; ++p ) {
+        if ( best[m][p] < 0 ) continue;
+        int melds = m + open_melds;
+        int t = std::min(best[m][p], 4 - melds);
+        shanten = std::min(shanten, 8 - 2 * melds - t - p);
+    }
+    return shanten;
+}
+
+int calcShantenChiitoitsu( const TileCounts &counts ) {
+    int pairs = 0, kinds = 0;
+    for ( int i = 0; i < 34; ++i ) {
+        if ( counts[i] >= 2 ) pairs++;
+        if ( counts[i] >= 1 ) kinds++;
+    }
+    return 6 - pairs + std::max(0, 7 - kinds);
+}
+
+int calcShantenKokushi( const TileCounts &counts ) {
+    const int yao_tiles[] = {0, 8, 9, 17, 18, 26, 27, 28, 29, 30, 31, 32, 33};
+    int yao_count = 0;
+    bool has_pair = false;
+    for ( int tile : yao_tiles ) {
+        if ( counts[tile] >= 1 ) yao_count++;
+        if ( counts[tile] >= 2 ) has_pair = true;
+    }
+    return 13 - yao_count - (has_pair ? 1 : 0);
+}
+
+int calcShanten( const TileCounts &counts, int open_melds, bool is_menzen ) {
+    ShantenGroup groups[4];
+    for ( int g = 0; g < 4; ++g ) calcShantenGroup(counts, g, groups[g]);
+    int shanten = combineShanten(groups, open_melds);
+    if ( is_menzen ) {
+        shanten = std::min(shanten, calcShantenChiitoitsu(counts));
+        shanten = std::min(shanten, calcShantenKokushi(counts));
+    }
+    return shanten;
+}
+
+TileMask calcUkeire( const TileCounts &counts, int open_melds, bool is_menzen,
+                     const TileCounts &visible, int &count ) {
+    ShantenGroup groups[4];
+    for ( int g = 0; g < 4; ++g ) calcShantenGroup(counts, g, groups[g]);
+    int shanten = combineShanten(groups, open_melds);
+    if ( is_menzen ) {
+        shanten = std::min(shanten, calcShantenChiitoitsu(counts));
+        shanten = std::min(shanten, calcShantenKokushi(counts));
+    }
+
+    TileCounts next(counts);
+    TileMask mask = 0;
+    count = 0;
+    for ( int tile = 0; tile < 34; ++tile ) {
+        int left = 4 - visible[tile];
+        if ( left <= 0 ) continue;
+        next[tile]++;
+        // 只有摸牌所在的一门需要重新拆解
+        int g = tile / 9;
+        ShantenGroup saved = groups[g];
+        calcShantenGroup(next, g, groups[g]);
+        int s = combineShanten(groups, open_melds);
+        if ( is_menzen ) {
+            s = std::min(s, calcShantenChiitoitsu(next));
+            s = std::min(s, calcShantenKokushi(next));
+        }
+        groups[g] = saved;
+        next[tile]--;
+        if ( s < shanten ) {
+            mask |= 1ULL << tile;
+            count += left;
+        }
+    }
+    return mask;
+}
@@ -0,0 +1,31 @@
+#ifndef SHANTEN_H
+#define SHANTEN_H
+
+#include "types.h"
+
+// 一门牌 (万/筒/索/字) 的拆解结果
+// best[m][p]: 拆出 m 个面子、p 个雀头时最多能有几个搭子 (-1 表示拆不出)
+struct ShantenGroup {
+    int8_t best[5][2];
+};
+
+// 计算第 group 门 (0 万, 1 筒, 2 索, 3 字) 的拆解结果
+void calcShantenGroup( const TileCounts &counts, int group, ShantenGroup &out );
+
+// 由四门的拆解结果合成一般型向听数 (-1 表示和了)
+int combineShanten( const ShantenGroup groups[4], int open_melds );
+
+// 七对子 / 国士无双向听数
+int calcShantenChiitoitsu( const TileCounts &counts );
+int calcShantenKokushi( const TileCounts &counts );
+
+// 向听数 (-1 表示和了)，门清时同时考虑七对子、国士
+// counts 可以是 3n+1 或 3n+2 张，open_melds 为副露面子数
+int calcShanten( const TileCounts &counts, int open_melds, bool is_menzen );
+
+// 有效牌: 摸到后向听数前进的牌种 (visible 为已经看到的各种牌张数，含自己手牌)
+// 3n+1 张手牌，返回牌种掩码，count 返回剩余枚数
+TileMask calcUkeire( const TileCounts &counts, int open_melds, bool is_menzen,
+                     const TileCounts &visible, int &count );
+
+#endif // SHANTEN_H
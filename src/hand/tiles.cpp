@@ -21,6 +21,6 @@ TileName getTileName(const TileIndex &tile_index){
     assert(isValidTileIndex(tile_index));
     int suitIndex = getSuitIndex(tile_index);
     int rank = tile_index / 4 % 9 + 1;
-    if ( Five.contains(tile_index) && tile_index % 4 == 0 ) rank = 0;
+    if ( Five.containsIdx(tile_index) && tile_index % 4 == 0 ) rank = 0;
     return std::to_string((int)rank) + suits[suitIndex];
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <string>
 #include <array>
 #include <cassert>
+#include <cstdint>
 
 using Tile = int; // 0-34
 using TileIndex = int; // 0-136
@@ -13,6 +14,7 @@ using TileCounts = std::array<int, 35>;
 using TileIndexList = std::vector<TileIndex>;
 using TileMap = std::array<bool, 35>;
 using TileList = std::vector<Tile>;
+using TileMask = uint64_t; // 第 i 位表示 Tile i (0-33)
 
 enum class Wind { East, South, West, North };
 enum class Yaku { Richii, Tanyao, Tsumo, YakuhaiSelfWind, YakuhaiRoundWind, YakuhaiHaku, YakuhaiHatsu, YakuhaiChun,
@@ -43,6 +45,14 @@ const TileIndex invalid_tile_index = 136;
 const Tile invalid_tile = 34;
 
 TileMap getTileMap( const TileList& list );
+// 同门相邻的牌 (字牌、边张返回 invalid_tile)
+Tile getPrevTile( const Tile &tile );
+Tile getNextTile( const Tile &tile );
+
+// 3n+1 张手牌的和了牌掩码 (is_menzen 时包含七对子、国士)
+TileMask calcWaitMask( TileCounts counts, bool is_menzen );
+// 3n+2 张门清手牌中打出后仍听牌的牌
+TileMask calcRiichiDiscards( TileCounts counts );
 
 struct TileFamily {
     const int num;
@@ -86,8 +96,11 @@ private:
     // is_richii = 0 : 未立直
     // is_richii = 1 : 立直中 (一发有效)
     // is_richii > 1 : 立直中 (一发无效)
+    TileMask wait_mask; // 能让这手牌和牌的牌 (只在手牌变化后重算)
+    void updateWaitMask();
 public:
     Hand(const TileList& init_tiles, Wind round, Wind seat);
+    void reset(const TileList& init_tiles, Wind round, Wind seat);
     void arrangeTiles();
     TileList getAllTiles() const;
     TileCounts getAllTileCounts() const;
@@ -98,6 +111,13 @@ public:
     Wind getRoundWind() const { return round_wind; }
     Wind getSeatWind() const { return seat_wind; }
     TileCounts getTileCounts() const { return tile_counts; };
+    const TileIndexList& getTiles() const { return hand; }  // 门前手牌 (不含副露)
+    const TileIndexList& getOpenTiles() const { return open; }  // 副露的牌
+    const TileMeldList& getOpenMelds() const { return open_melds; }  // 副露的面子
+    bool hasTileIndex(const TileIndex &tile_index) const;
+    TileMask getWaitMask() const { return wait_mask; }
+    bool isTenpai() const { return wait_mask != 0; }
+    TileMask getRiichiDiscards(const TileIndex &draw) const; // 摸 draw 后打哪些牌仍听牌
 
     // 立直相关
     void declareRiichi() { if (is_menzen) is_richii = 1; }
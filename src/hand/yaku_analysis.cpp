@@ -5,6 +5,7 @@
 #include "constants.h"
 #include "tiles.h"
 #include "scoring.h"
+#include "shanten.h"
 
 Tile getTileFromWind(const Wind &wind) {
     switch (wind) {
@@ -673,13 +674,16 @@ bool Hand::isChinroutou(const TileIndex &draw) const{
 }
 
 bool Hand::isKokushiMuso(const TileIndex &draw) const{
+    if ( !is_menzen || !Yao.containsIdx(draw) ) return false;
     TileCounts counts(tile_counts); counts[draw / 4]++;
 
+    int yao_sum = 0;
     for (const Tile &tile : Yao.list) {
         if (counts[tile] == 0) return false;
+        yao_sum += counts[tile];
     }
     
-    return true;
+    return yao_sum == 14;
 }
 
 bool Hand::isShousuushii(const TileIndex &draw) const{
@@ -760,143 +764,152 @@ bool Hand::isDaisuushii(const TileIndex &draw) const{
     return true;
 }
 
-bool Hand::isWinningHand(const TileIndex &draw) const{
-    // Check for Kokushi Muso (special hand that doesn't parse normally)
-    if ( isKokushiMuso(draw) ) return true;
-    // Check for Chiitoitsu (7 pairs)
-    if ( isChiitoitsu(draw) ) return true;
-    // Check for standard winning hand (4 melds + 1 pair)
-    HandParseResult res = parseWinningHand(draw);
-    return !res.empty();
-}
-
-int Hand::calcHan() const{
-    // This method needs a draw tile to calculate yaku
-    // For now, return 0 as placeholder - actual calculation done via calcYaku
-    return 0;
+// 一门牌能否全部拆成面子 (不含雀头)
+// 从小到大贪心: 够三张先取刻子，剩下的只能作为顺子的第一张
+static bool isAllMentsu(const TileCounts &counts, int suit) {
+    int begin = suit * 9, len = (suit < 3) ? 9 : 7;
+    int c[9];
+    for ( int i = 0; i < len; ++i ) c[i] = counts[begin + i];
+    for ( int i = 0; i < len; ++i ) {
+        if ( c[i] < 0 ) return false;
+        if ( c[i] >= 3 ) c[i] -= 3;
+        if ( c[i] == 0 ) continue;
+        if ( suit == 3 || i + 2 >= len ) return false;
+        c[i + 1] -= c[i]; c[i + 2] -= c[i];
+        if ( c[i + 1] < 0 || c[i + 2] < 0 ) return false;
+    }
+    return true;
 }
 
-// Helper function for shanten calculation
-static int calcShantenNormal(TileCounts counts, int melds, int tatsu, bool has_pair, int idx) {
-    if ( idx == 34 ) {
-        int need_melds = 4 - melds;
-        int need_tatsu = std::min(tatsu, need_melds);
-        // Formula: how many tiles needed to complete
-        // If has_pair: need to complete melds only
-        // If no pair: need to complete melds AND get a pair (but if 4 melds, just need pair completion = 0)
-        int shanten;
-        if (has_pair) {
-            shanten = need_melds * 2 - need_tatsu;
-        } else {
-            // Without pair, need one more tile for the pair
-            // But if we have 4 melds and no pair, we're tenpai (waiting for the pair tile)
-            if (need_melds == 0) {
-                shanten = 0; // Tenpai - waiting for pair
-            } else {
-                shanten = need_melds * 2 - need_tatsu;
-            }
+// 标准型 (n 面子 + 1 雀头) 判定，与 parseWinningHand 非空等价但不分配内存
+static bool isStandardAgari(TileCounts &counts) {
+    int pair_suit = -1;
+    for ( int suit = 0; suit < 4; ++suit ) {
+        int begin = suit * 9, len = (suit < 3) ? 9 : 7, sum = 0;
+        for ( int i = 0; i < len; ++i ) sum += counts[begin + i];
+        if ( sum % 3 == 1 ) return false;
+        if ( sum % 3 == 2 ) {
+            if ( pair_suit != -1 ) return false;
+            pair_suit = suit;
         }
-        return shanten;
     }
+    if ( pair_suit == -1 ) return false;
 
-    int res = 8; // Maximum shanten
+    for ( int suit = 0; suit < 4; ++suit )
+        if ( suit != pair_suit && !isAllMentsu(counts, suit) ) return false;
 
-    // Try triplet
-    if ( counts[idx] >= 3 ) {
-        counts[idx] -= 3;
-        res = std::min(res, calcShantenNormal(counts, melds + 1, tatsu, has_pair, idx));
-        counts[idx] += 3;
+    int begin = pair_suit * 9, len = (pair_suit < 3) ? 9 : 7;
+    for ( int i = begin; i < begin + len; ++i ) {
+        if ( counts[i] < 2 ) continue;
+        counts[i] -= 2;
+        bool ok = isAllMentsu(counts, pair_suit);
+        counts[i] += 2;
+        if ( ok ) return true;
     }
+    return false;
+}
+
+TileMask calcWaitMask( TileCounts counts, bool is_menzen ) {
+    TileMask wait_mask = 0;
 
-    // Try sequence (only for numbered tiles 0-26)
-    if ( idx < 27 && idx % 9 <= 6 && counts[idx] > 0 && counts[idx+1] > 0 && counts[idx+2] > 0 ) {
-        counts[idx]--; counts[idx+1]--; counts[idx+2]--;
-        res = std::min(res, calcShantenNormal(counts, melds + 1, tatsu, has_pair, idx));
-        counts[idx]++; counts[idx+1]++; counts[idx+2]++;
+    // 标准型: 和了牌必然与某张手牌同门且相差不超过 2 (字牌必须相同)
+    TileMask near = 0;
+    for ( const Tile &tile : All.list ) {
+        if ( counts[tile] == 0 ) continue;
+        if ( Honor.contains(tile) ) { near |= 1ULL << tile; continue; }
+        int lo = std::max(tile - 2, tile / 9 * 9), hi = std::min(tile + 2, tile / 9 * 9 + 8);
+        for ( int t = lo; t <= hi; ++t ) near |= 1ULL << t;
     }
+    for ( const Tile &tile : All.list ) {
+        if ( !(near >> tile & 1) ) continue;
+        counts[tile]++;
+        if ( isStandardAgari(counts) ) wait_mask |= 1ULL << tile;
+        counts[tile]--;
+    }
+
+    if ( !is_menzen ) return wait_mask;
 
-    // Try pair
-    if ( !has_pair && counts[idx] >= 2 ) {
-        counts[idx] -= 2;
-        res = std::min(res, calcShantenNormal(counts, melds, tatsu, true, idx));
-        counts[idx] += 2;
+    // 七对子: 6 个对子 + 1 张单牌，听这张单牌
+    int pairs = 0; Tile single = invalid_tile;
+    for ( const Tile &tile : All.list ) {
+        if ( counts[tile] == 2 ) pairs++;
+        else if ( counts[tile] == 1 ) single = tile;
     }
+    if ( pairs == 6 && single != invalid_tile ) wait_mask |= 1ULL << single;
 
-    // Try tatsu (partial meld)
-    if ( tatsu < 4 - melds ) {
-        // Ryanmen/Penchan (edge/middle wait)
-        if ( idx < 27 && idx % 9 <= 7 && counts[idx] > 0 && counts[idx+1] > 0 ) {
-            counts[idx]--; counts[idx+1]--;
-            res = std::min(res, calcShantenNormal(counts, melds, tatsu + 1, has_pair, idx));
-            counts[idx]++; counts[idx+1]++;
-        }
-        // Kanchan (middle wait)
-        if ( idx < 27 && idx % 9 <= 6 && counts[idx] > 0 && counts[idx+2] > 0 ) {
-            counts[idx]--; counts[idx+2]--;
-            res = std::min(res, calcShantenNormal(counts, melds, tatsu + 1, has_pair, idx));
-            counts[idx]++; counts[idx+2]++;
-        }
-        // Toitsu (pair as tatsu)
-        if ( counts[idx] >= 2 ) {
-            counts[idx] -= 2;
-            res = std::min(res, calcShantenNormal(counts, melds, tatsu + 1, has_pair, idx));
-            counts[idx] += 2;
+    // 国士无双: 全是幺九牌，缺一种听缺的那种，十三种齐全则十三面听
+    int yao_sum = 0, kinds = 0; Tile missing = invalid_tile;
+    for ( const Tile &tile : Yao.list ) {
+        yao_sum += counts[tile];
+        if ( counts[tile] > 0 ) kinds++;
+        else missing = tile;
+    }
+    if ( yao_sum == 13 ) {
+        if ( kinds == 13 ) {
+            for ( const Tile &tile : Yao.list ) wait_mask |= 1ULL << tile;
+        } else if ( kinds == 12 ) {
+            wait_mask |= 1ULL << missing;
         }
     }
+    return wait_mask;
+}
 
-    // Skip this tile
-    if ( counts[idx] > 0 ) {
-        int tmp = counts[idx];
-        counts[idx] = 0;
-        res = std::min(res, calcShantenNormal(counts, melds, tatsu, has_pair, idx + 1));
-        counts[idx] = tmp;
-    } else {
-        res = std::min(res, calcShantenNormal(counts, melds, tatsu, has_pair, idx + 1));
-    }
+void Hand::updateWaitMask() {
+    wait_mask = calcWaitMask(tile_counts, is_menzen);
+}
 
-    return res;
+TileMask Hand::getRiichiDiscards(const TileIndex &draw) const {
+    if ( !is_menzen ) return 0;
+    TileCounts counts(tile_counts); counts[draw / 4]++;
+    return calcRiichiDiscards(counts);
 }
 
-static int calcShantenChiitoitsu(const TileCounts &counts) {
-    int pairs = 0, singles = 0;
-    for ( int i = 0; i < 34; ++i ) {
-        if ( counts[i] >= 2 ) pairs++;
-        else if ( counts[i] == 1 ) singles++;
+TileMask calcRiichiDiscards( TileCounts counts ) {
+
+    // 剪枝: 听牌的 13 张里孤张 (前后两张内无同门牌的单张) 最多一张，再加一张摸牌最多两张
+    // 七对子的单张同样最多两张，只有国士无双形 (幺九牌 11 种以上) 例外
+    int isolated = 0, yao_kinds = 0;
+    for ( const Tile &tile : All.list ) {
+        if ( counts[tile] == 0 ) continue;
+        if ( Yao.contains(tile) ) yao_kinds++;
+        if ( counts[tile] != 1 ) continue;
+        bool has_neighbor = false;
+        if ( !Honor.contains(tile) ) {
+            int lo = std::max(tile - 2, tile / 9 * 9), hi = std::min(tile + 2, tile / 9 * 9 + 8);
+            for ( int t = lo; t <= hi; ++t ) if ( t != tile && counts[t] > 0 ) has_neighbor = true;
+        }
+        if ( !has_neighbor ) isolated++;
+    }
+    if ( isolated > 2 && yao_kinds < 11 ) return 0;
+
+    TileMask discards = 0;
+    for ( const Tile &tile : All.list ) {
+        if ( counts[tile] == 0 ) continue;
+        counts[tile]--;
+        if ( calcWaitMask(counts, true) ) discards |= 1ULL << tile;
+        counts[tile]++;
     }
-    return 6 - pairs + std::max(0, 7 - pairs - singles);
+    return discards;
 }
 
-static int calcShantenKokushi(const TileCounts &counts) {
-    const int yao_tiles[] = {0, 8, 9, 17, 18, 26, 27, 28, 29, 30, 31, 32, 33};
-    int yao_count = 0;
-    bool has_pair = false;
-    for ( int tile : yao_tiles ) {
-        if ( counts[tile] >= 1 ) yao_count++;
-        if ( counts[tile] >= 2 ) has_pair = true;
-    }
-    return 13 - yao_count - (has_pair ? 1 : 0);
+bool Hand::isWinningHand(const TileIndex &draw) const{
+    // 和了牌掩码在手牌变化时已经算好 (含国士、七对子、标准型)
+    return wait_mask >> (draw / 4) & 1;
 }
 
-int Hand::calcShanten() const{
-    TileCounts counts = tile_counts;
+int Hand::calcHan() const{
+    // This method needs a draw tile to calculate yaku
+    // For now, return 0 as placeholder - actual calculation done via calcYaku
+    return 0;
+}
 
-    // Account for open melds
+int Hand::calcShanten() const{
+    // 副露面子数
     int open_meld_count = 0;
     for ( const auto &meld : open_melds ) {
         if ( meld.type != MeldType::Pair ) open_meld_count++;
     }
-
-    // Calculate shanten for different hand types
-    int normal_shanten = calcShantenNormal(counts, open_meld_count, 0, false, 0);
-    int shanten = normal_shanten;
-
-    // Chiitoitsu and Kokushi only valid for menzen hands
-    if ( is_menzen ) {
-        shanten = std::min(shanten, calcShantenChiitoitsu(counts));
-        shanten = std::min(shanten, calcShantenKokushi(counts));
-    }
-
-    return shanten;
+    return ::calcShanten(tile_counts, open_meld_count, is_menzen);
 }
 
 // Hand 类的 calcFu 方法
@@ -3,39 +3,80 @@
 #include <random>
 #include <chrono>
 
+// 落后超过这么多事件时直接发快照 (此时快照通常更小)
+static const int max_delta_events = 64;
+// 恢复后序号跳过这么多: 客户端在检查点之后收到的序号不会落进新的范围
+static const int restore_seq_gap = 1 << 16;
+
+// 座位凭证: 128 位随机数的十六进制
+static std::string newSeatToken() {
+    static const char hex[] = "0123456789abcdef";
+    std::random_device rd;
+    std::string token(32, '0');
+    for (size_t i = 0; i < token.size(); i += 8) {
+        uint32_t bits = rd();
+        for (size_t j = 0; j < 8; ++j) token[i + j] = hex[(bits >> (4 * j)) & 15];
+    }
+    return token;
+}
+
 // HumanPlayer 实现
 HumanPlayer::HumanPlayer(Session* s, const std::string& name)
-    : Player(name), session(s), pending_action(-1), action_ready(false) {
+    : Player(name), session(s), pending_action(-1), pending_tile(invalid_tile_index), action_ready(false) {
 }
 
-void HumanPlayer::setAction(int action) {
+void HumanPlayer::setAction(int action, TileIndex tile) {
     pending_action = action;
+    pending_tile = tile;
     action_ready = true;
 }
 
+bool HumanPlayer::takeAction(int& action) {
+    if (!action_ready) return false;
+    action_ready = false;
+    // 只接受当前决策点的合法动作 (一次位测试，不重新检查手牌)
+    if (!table) return false;
+    const LegalActions& legal = table->getLegalActions(seat);
+    if (!legal.allows(pending_action)) return false;
+    // 立直时宣言牌也要是可立直的弃牌
+    if (pending_action == static_cast<int>(Action::Riichi) &&
+        !(legal.canDiscard(pending_tile) && (legal.riichi >> (pending_tile / 4) & 1))) {
+        return false;
+    }
+    action = pending_action;
+    return true;
+}
+
 int HumanPlayer::decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) {
     // 等待网络输入 (在实际实现中，这应该是异步的)
     // 这里简单返回打出摸到的牌
-    if (action_ready) {
-        action_ready = false;
-        return pending_action;
-    }
+    int action;
+    if (takeAction(action)) return action;
     return drawn_tile;  // 默认摸什么打什么
 }
 
 int HumanPlayer::decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) {
-    if (action_ready) {
-        action_ready = false;
-        return pending_action;
-    }
+    int action;
+    if (takeAction(action)) return action;
     return static_cast<int>(Action::Pass);  // 默认过
 }
 
+TileIndex HumanPlayer::selectRiichiDiscard(TileIndex drawn_tile) {
+    // 立直动作只有在宣言牌合法时才会被接受
+    return pending_action == static_cast<int>(Action::Riichi) ? pending_tile : drawn_tile;
+}
+
 // Room 实现
 Room::Room(const std::string& id)
-    : room_id(id), game_table(nullptr), state(RoomState::Waiting), player_count(0) {
+    : room_id(id), game_table(nullptr), state(RoomState::Waiting), player_count(0), snapshot_seq(0),
+      checkpoint_version(0), resume_pending(false) {
     sessions.fill(nullptr);
     players.fill(nullptr);
+    sync_modes.fill(SyncMode::Full);
+    sent_seq.fill(-1);
+    snapshot_view_seq.fill(-1);
+    checkpoint.room_id = id;
+    checkpointProgress(false);
 }
 
 Room::~Room() {
@@ -54,6 +95,15 @@ int Room::findEmptySeat() const {
     return -1;
 }
 
+int Room::findSeat(const Session* session) const {
+    for (int i = 0; i < 4; ++i) {
+        if (sessions[i] == session) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 bool Room::addPlayer(Session* session) {
     if (state != RoomState::Waiting) {
         return false;
@@ -67,9 +117,13 @@ bool Room::addPlayer(Session* session) {
     sessions[seat] = session;
     session->setRoom(this, seat);
     player_count++;
+    sync_modes[seat] = SyncMode::Full;
+    sent_seq[seat] = -1;
 
     // 创建人类玩家对象
     players[seat] = new HumanPlayer(session, session->getName());
+    seat_tokens[seat] = newSeatToken();
+    checkpointSeats();
 
     return true;
 }
@@ -78,8 +132,17 @@ void Room::removePlayer(Session* session) {
     for (int i = 0; i < 4; ++i) {
         if (sessions[i] == session) {
             sessions[i] = nullptr;
-            delete players[i];
-            players[i] = nullptr;
+            sync_modes[i] = SyncMode::Full;
+            sent_seq[i] = -1;
+            if (state == RoomState::Waiting) {
+                delete players[i];
+                players[i] = nullptr;
+                seat_tokens[i].clear();
+                checkpointSeats();
+            } else {
+                // 牌桌还引用着这个玩家: 保留座位 (没有输入时摸切 / 过)，等待重新加入
+                static_cast<HumanPlayer*>(players[i])->setSession(nullptr);
+            }
             player_count--;
             session->setRoom(nullptr, -1);
             break;
@@ -87,6 +150,23 @@ void Room::removePlayer(Session* session) {
     }
 }
 
+bool Room::rejoin(Session* session, const std::string& token) {
+    if (state == RoomState::Waiting || token.empty()) return false;
+    for (int i = 0; i < 4; ++i) {
+        HumanPlayer* human = dynamic_cast<HumanPlayer*>(players[i]);
+        if (human && !sessions[i] && seat_tokens[i] == token) {
+            sessions[i] = session;
+            human->setSession(session);
+            session->setRoom(this, i);
+            player_count++;
+            sync_modes[i] = SyncMode::Full;
+            sent_seq[i] = -1;
+            return true;
+        }
+    }
+    return false;
+}
+
 void Room::fillWithAI() {
     for (int i = 0; i < 4; ++i) {
         if (players[i] == nullptr) {
@@ -101,44 +181,90 @@ void Room::setupCallbacks() {
 
     GameCallbacks callbacks;
 
+    callbacks.onRoundStart = [this]() {
+        // 恢复的局面从最后一个记录的决策之后开始对外发送
+        resume_pending = game_table->isReplaying();
+        checkpointProgress(true);
+        resetSync();
+    };
+
     callbacks.onDraw = [this](int seat, TileIndex tile) {
         // 通知对应玩家摸牌
-        if (sessions[seat]) {
+        if (sessions[seat] && !isReplaying()) {
             GameMessage msg;
             msg.type = MessageType::YourTurn;
             msg.seat = seat;
             msg.tile = tile;
-            sessions[seat]->send(msg.toJSON());
+            sessions[seat]->send(msg);
         }
+
+        recordChanges();
+        recordEvent(StateEventKind::Draw, seat, tile);
+        flushSync();
     };
 
     callbacks.onDiscard = [this](int seat, TileIndex tile) {
         // 广播弃牌
-        GameMessage msg;
-        msg.type = MessageType::PlayerAction;
-        msg.seat = seat;
-        msg.action = tile;  // 弃牌动作
-        msg.tile = tile;
-        broadcast(msg.toJSON());
+        if (!isReplaying()) {
+            GameMessage msg;
+            msg.type = MessageType::PlayerAction;
+            msg.seat = seat;
+            msg.action = tile;  // 弃牌动作
+            msg.tile = tile;
+            broadcast(msg);
+        }
+
+        // 立直宣言在弃牌回调之前
+        recordChanges();
+        recordEvent(StateEventKind::Discard, seat, tile);
+        flushSync();
     };
 
     callbacks.onMeld = [this](int seat, int action, TileIndex tile) {
         // 广播副露
-        GameMessage msg;
-        msg.type = MessageType::PlayerAction;
-        msg.seat = seat;
-        msg.action = action;
-        msg.tile = tile;
-        broadcast(msg.toJSON());
+        if (!isReplaying()) {
+            GameMessage msg;
+            msg.type = MessageType::PlayerAction;
+            msg.seat = seat;
+            msg.action = action;
+            msg.tile = tile;
+            broadcast(msg);
+        }
+
+        recordChanges();
+        recordEvent(StateEventKind::Call, seat, tile, action);
+        flushSync();
+    };
+
+    callbacks.onDecision = [this](int seat, DecisionKind kind, int options, int action) {
+        ReplayDecision d;
+        d.seat = static_cast<uint8_t>(seat);
+        d.kind = static_cast<uint8_t>(kind);
+        d.options = static_cast<uint8_t>(options);
+        d.action = static_cast<uint8_t>(action);
+        checkpoint.round.decisions.push_back(d);
+
+        // 重放完最后一个记录的决策: 先给所有座位发快照，这个决策的结果之后照常发送
+        if (resume_pending && !game_table->isReplaying()) {
+            resume_pending = false;
+            flushSync();
+        }
     };
 
     callbacks.onGameEnd = [this](const GameResult& result) {
         state = RoomState::Finished;
+        resume_pending = false;
+        checkpointProgress(false);
+
+        // 结算后的点数和立直棒先同步，再通知结果
+        recordChanges();
+        flushSync();
+
         GameMessage msg;
         msg.type = MessageType::GameEnd;
         msg.seat = result.winner;
         // TODO: 添加更多结果信息
-        broadcast(msg.toJSON());
+        broadcast(msg);
     };
 
     game_table->setCallbacks(callbacks);
@@ -151,51 +277,69 @@ void Room::startGame() {
 
     // 用 AI 填充空位
     fillWithAI();
-
-    // 创建牌桌
-    game_table = new Table();
-    for (int i = 0; i < 4; ++i) {
-        game_table->setPlayer(i, players[i]);
-    }
-
-    setupCallbacks();
+    createTable();
 
     state = RoomState::Playing;
+    checkpointSeats();
 
     // 广播游戏开始
     GameMessage msg;
     msg.type = MessageType::GameStart;
-    broadcast(msg.toJSON());
+    broadcast(msg);
 
     // TODO: 在异步环境中运行游戏
     // 这里暂时同步运行
     // game_table->playRound();
 }
 
+void Room::createTable() {
+    game_table = new Table();
+    for (int i = 0; i < 4; ++i) {
+        game_table->setPlayer(i, players[i]);
+    }
+    setupCallbacks();
+}
+
+GameResult Room::playRound() {
+    GameResult result{};
+    result.winner = -1;
+    if (state != RoomState::Playing || !game_table) return result;
+    return game_table->playRound();
+}
+
 void Room::handleAction(Session* session, int action, int tile) {
     if (state != RoomState::Playing) {
         return;
     }
 
-    // 找到玩家座位
-    int seat = -1;
-    for (int i = 0; i < 4; ++i) {
-        if (sessions[i] == session) {
-            seat = i;
-            break;
-        }
-    }
-
+    int seat = findSeat(session);
     if (seat < 0) return;
 
-    // 设置玩家动作
+    // 设置玩家动作 (消息在两个决策之间到达，到玩家的下一个决策点再对照合法动作检查)
     HumanPlayer* human = dynamic_cast<HumanPlayer*>(players[seat]);
     if (human) {
-        human->setAction(action);
+        human->setAction(action, tile);
+    }
+}
+
+void Room::broadcast(const GameMessage& message) {
+    // 每种格式只编码一次，各连接的发送队列共用编码结果
+    SharedMessage encoded[2];
+    for (int i = 0; i < 4; ++i) {
+        if (sessions[i]) {
+            WireFormat format = sessions[i]->getWireFormat();
+            SharedMessage& bytes = encoded[static_cast<int>(format)];
+            if (!bytes) bytes = encodeShared(message, format);
+            sessions[i]->send(bytes);
+        }
     }
 }
 
 void Room::broadcast(const std::string& message) {
+    broadcast(shareMessage(message));
+}
+
+void Room::broadcast(const SharedMessage& message) {
     for (int i = 0; i < 4; ++i) {
         if (sessions[i]) {
             sessions[i]->send(message);
@@ -204,29 +348,102 @@ void Room::broadcast(const std::string& message) {
 }
 
 void Room::broadcastState(int for_seat) {
-    GameState state = getCurrentState();
+    for (int i = 0; i < 4; ++i) {
+        if (for_seat < 0 || for_seat == i) {
+            sent_seq[i] = -1;
+            flushSeat(i);
+        }
+    }
+}
 
-    if (for_seat >= 0) {
-        // 发送给特定玩家
-        if (sessions[for_seat]) {
-            GameState view = state.getViewFor(for_seat);
-            GameMessage msg;
-            msg.type = MessageType::GameState;
-            msg.state = view;
-            sessions[for_seat]->send(msg.toJSON());
+void Room::handleSyncRequest(Session* session, int seq) {
+    int seat = findSeat(session);
+    if (seat < 0) return;
+
+    sync_modes[seat] = SyncMode::Delta;
+    if (!game_table) {
+        // 还没有对局状态，开局时会收到快照
+        sent_seq[seat] = getSyncSeq();
+        return;
+    }
+    // 客户端声明的序号不在本局范围内时重发快照
+    sent_seq[seat] = seq >= snapshot_seq && seq <= getSyncSeq() ? seq : -1;
+    flushSeat(seat);
+}
+
+void Room::resetSync() {
+    // 序号在整个房间内单调递增
+    snapshot_seq = getSyncSeq() + 1;
+    sync_state = getCurrentState();
+    event_log.clear();
+    // 之前的序号都不再有效
+    for (int i = 0; i < 4; ++i) {
+        sent_seq[i] = -1;
+    }
+    flushSync();
+}
+
+void Room::recordEvent(StateEventKind kind, int seat, int tile, int value) {
+    StateEvent event;
+    event.kind = kind;
+    event.seat = seat;
+    event.tile = tile;
+    event.value = value;
+    if (!applyStateEvent(sync_state, event)) {
+        // 按事件维护的状态放不下这次变化: 不中断对局，所有人改发当前状态的快照
+        resetSync();
+        return;
+    }
+    event_log.push_back(event);
+}
+
+void Room::recordChanges() {
+    for (int i = 0; i < 4; ++i) {
+        if (!players[i]) continue;
+        const Hand* hand = players[i]->getHand();
+        if (hand && hand->isRiichi() && !sync_state.riichi_status[i]) {
+            recordEvent(StateEventKind::Riichi, i);
+        }
+        if (players[i]->getScore() != sync_state.scores[i]) {
+            recordEvent(StateEventKind::Score, i, -1, players[i]->getScore());
         }
+    }
+    if (game_table && game_table->getRiichiSticks() != sync_state.riichi_sticks) {
+        recordEvent(StateEventKind::Sticks, -1, -1, game_table->getRiichiSticks());
+    }
+}
+
+void Room::flushSync() {
+    for (int i = 0; i < 4; ++i) {
+        flushSeat(i);
+    }
+}
+
+void Room::flushSeat(int seat) {
+    int current = getSyncSeq();
+    // 重放到检查点之前的状态客户端早已收到，重放完再发快照
+    if (!sessions[seat] || sent_seq[seat] == current || isReplaying()) return;
+
+    int behind = current - sent_seq[seat];
+    if (sync_modes[seat] == SyncMode::Delta && sent_seq[seat] >= snapshot_seq && behind <= max_delta_events) {
+        // 事件 seq 对应 event_log[seq - snapshot_seq - 1]
+        GameMessage msg;
+        msg.type = MessageType::StateDelta;
+        msg.seq = sent_seq[seat] + 1;
+        for (int seq = msg.seq; seq <= current; ++seq) {
+            msg.events.push_back(viewEventFor(event_log[seq - snapshot_seq - 1], seat));
+        }
+        sessions[seat]->send(msg);
     } else {
-        // 分别发送给每个玩家 (各自视角)
-        for (int i = 0; i < 4; ++i) {
-            if (sessions[i]) {
-                GameState view = state.getViewFor(i);
-                GameMessage msg;
-                msg.type = MessageType::GameState;
-                msg.state = view;
-                sessions[i]->send(msg.toJSON());
-            }
+        // 同一序号的快照各座位只差自己的手牌，公共部分每种格式只编码一次
+        int format = static_cast<int>(sessions[seat]->getWireFormat());
+        if (snapshot_view_seq[format] != current) {
+            snapshot_views[format].reset(sync_state, current, sessions[seat]->getWireFormat());
+            snapshot_view_seq[format] = current;
         }
+        sessions[seat]->send(snapshot_views[format].encodeFor(seat));
     }
+    sent_seq[seat] = current;
 }
 
 GameState Room::getCurrentState() const {
@@ -235,29 +452,110 @@ GameState Room::getCurrentState() const {
     state.dealer = game_table ? game_table->getDealer() : 0;
     state.current_player = game_table ? game_table->getCurrentPlayer() : 0;
     state.remaining_tiles = game_table ? game_table->getRemainingTiles() : 70;
-    state.honba = 0;
-    state.riichi_sticks = 0;
+    state.honba = game_table ? game_table->getHonba() : 0;
+    state.riichi_sticks = game_table ? game_table->getRiichiSticks() : 0;
 
-    // 收集各家信息
+    // 收集各家信息 (手牌排好序，和按事件维护的状态一致)
     for (int i = 0; i < 4; ++i) {
         state.scores[i] = players[i] ? players[i]->getScore() : 25000;
-        state.riichi_status[i] = false;  // TODO
+        const Hand* hand = players[i] ? players[i]->getHand() : nullptr;
+        state.riichi_status[i] = hand && hand->isRiichi();
+        if (hand) {
+            // 摸到的牌在弃牌前还没有并入 Hand；超出容量的牌 (不应出现) 不发送
+            for (TileIndex tile : hand->getTiles()) state.hands[i].insertSorted(tile);
+            TileIndex drawn = players[i]->getDrawnTile();
+            if (drawn != invalid_tile_index) {
+                state.hands[i].insertSorted(drawn);
+                state.last_draw = drawn;
+            }
+        }
+        if (players[i]) {
+            const TileIndexList& river = players[i]->getDiscards();
+            state.discards[i].assign(river.data(), std::min(river.size(), max_river_tiles));
+        }
+    }
+
+    return state;
+}
+
+void Room::checkpointSeats() {
+    checkpoint.state = state;
+    for (int i = 0; i < 4; ++i) {
+        checkpoint.seats[i] = !players[i] ? SeatKind::Empty
+                              : dynamic_cast<HumanPlayer*>(players[i]) ? SeatKind::Human : SeatKind::AI;
+        checkpoint.names[i] = players[i] ? players[i]->getName() : std::string();
+        checkpoint.tokens[i] = seat_tokens[i];
+    }
+    checkpoint_version++;
+}
+
+void Room::checkpointProgress(bool in_round) {
+    ReplayRound& round = checkpoint.round;
+    round.seed = game_table ? game_table->getRoundSeed() : 0;
+    round.dealer = game_table ? game_table->getDealer() : 0;
+    round.round_wind = game_table ? game_table->getRoundWind() : Wind::East;
+    round.honba = game_table ? game_table->getHonba() : 0;
+    round.riichi_sticks = game_table ? game_table->getRiichiSticks() : 0;
+    for (int i = 0; i < 4; ++i) {
+        round.scores[i] = players[i] ? players[i]->getScore() : 25000;
+    }
+    if (in_round) {
+        round.wall = game_table->getWall();
+    } else {
+        round.wall.clear();
+    }
+    round.decisions.clear();
+    checkpoint.in_round = in_round;
+    checkpointSeats();
+}
+
+bool Room::restore(const RoomCheckpoint& saved) {
+    if (state != RoomState::Waiting || game_table || player_count > 0) return false;
+    const ReplayRound& round = saved.round;
+    if (saved.in_round && (saved.state != RoomState::Playing || round.wall.size() != 136)) return false;
 
-        // 手牌和牌河需要从 Player/Hand 获取
-        // 这里简化处理
-        state.discards[i] = std::vector<int>(players[i] ? players[i]->getDiscards().begin() : std::vector<int>::iterator(),
-                                              players[i] ? players[i]->getDiscards().end() : std::vector<int>::iterator());
+    // 序号继续单调递增，旧的序号都会换来一个快照
+    snapshot_seq = saved.sync_seq + restore_seq_gap;
+    if (saved.state == RoomState::Waiting) {
+        // 还没开局: 玩家重新加入即可
+        return true;
     }
 
-    state.can_tsumo = false;
-    state.can_ron = false;
-    state.can_riichi = false;
-    state.can_chi = false;
-    state.can_pon = false;
-    state.can_kan = false;
-    state.last_draw = -1;
-    state.last_discard = -1;
-    state.last_discard_player = -1;
+    for (int i = 0; i < 4; ++i) {
+        if (saved.seats[i] == SeatKind::Human) {
+            players[i] = new HumanPlayer(nullptr, saved.names[i]);
+            seat_tokens[i] = saved.tokens[i];
+        } else if (saved.seats[i] == SeatKind::AI) {
+            players[i] = new SimpleAI(saved.names[i]);
+        }
+    }
+    fillWithAI();
+    createTable();
+    state = saved.state;
 
-    return state;
+    game_table->setDealer(round.dealer);
+    game_table->setRoundWind(round.round_wind);
+    game_table->setHonba(round.honba);
+    game_table->setRiichiSticks(round.riichi_sticks);
+    for (int i = 0; i < 4; ++i) {
+        players[i]->setScore(round.scores[i]);
+    }
+
+    checkpoint = saved;
+    checkpoint.room_id = room_id;
+    checkpointSeats();
+    if (saved.in_round) {
+        // 下一局用同一副牌山，开头按记录的决策执行
+        std::vector<int> actions;
+        actions.reserve(round.decisions.size());
+        for (const ReplayDecision& d : round.decisions) {
+            actions.push_back(d.action);
+        }
+        game_table->setNextWall(round.wall);
+        game_table->setNextDecisions(actions);
+        resume_pending = true;
+    } else {
+        sync_state = getCurrentState();
+    }
+    return true;
 }
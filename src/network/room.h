@@ -9,6 +9,7 @@
 #include "table.h"
 #include "simple_ai.h"
 #include "game_state.h"
+#include "replay_log.h"
 
 // 房间状态
 enum class RoomState {
@@ -17,26 +18,59 @@ enum class RoomState {
     Finished    // 游戏结束
 };
 
+// 连接的状态同步方式
+enum class SyncMode {
+    Full,   // 每次变化后发送完整快照
+    Delta   // 只发送事件，加入、断档或请求时才发送快照
+};
+
+// 检查点中座位的类型
+enum class SeatKind : uint8_t {
+    Empty,
+    Human,  // 恢复后留给持有座位凭证的玩家重新加入
+    AI
+};
+
+// 房间检查点: 以进度 (座位、点数、庄家等) 为基准，局中再加上本局牌山和开局以来的决策
+// 恢复时按牌山和决策把牌桌重放到检查点的局面，之后照常进行
+struct RoomCheckpoint {
+    std::string room_id;
+    RoomState state = RoomState::Waiting;
+    std::array<SeatKind, 4> seats{};
+    std::array<std::string, 4> names;
+    std::array<std::string, 4> tokens;  // 人类座位的凭证 (其余为空)
+    int sync_seq = 0;       // 状态同步序号 (写入时取房间当前的序号)
+    bool in_round = false;
+    // 局中: 开局时的庄家、场风、本场、立直棒、点数、牌山和之后的决策
+    // 局外: 当前的进度 (牌山和决策为空)
+    ReplayRound round;
+};
+
 // 人类玩家 (通过网络控制)
 class HumanPlayer : public Player {
 private:
     Session* session;
     int pending_action;
+    TileIndex pending_tile;   // 立直的宣言牌
     bool action_ready;
 
 public:
     HumanPlayer(Session* s, const std::string& name);
 
     Session* getSession() const { return session; }
+    void setSession(Session* s) { session = s; }
 
     // 设置玩家的决策 (由网络消息触发)
-    void setAction(int action);
+    void setAction(int action, TileIndex tile = invalid_tile_index);
     bool isActionReady() const { return action_ready; }
     void clearAction() { action_ready = false; }
+    // 取出待执行的动作，不是当前决策点的合法动作时丢弃
+    bool takeAction(int& action);
 
     // 实现决策接口 (阻塞等待网络输入)
     int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override;
     int decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) override;
+    TileIndex selectRiichiDiscard(TileIndex drawn_tile) override;
 };
 
 // 游戏房间
@@ -45,10 +79,25 @@ private:
     std::string room_id;
     std::array<Session*, 4> sessions;  // 玩家会话 (nullptr 表示 AI 或空位)
     std::array<Player*, 4> players;    // 玩家对象
+    std::array<std::string, 4> seat_tokens;  // 人类座位的凭证，入座时随机生成，重新加入时校验
     Table* game_table;
     RoomState state;
     int player_count;
 
+    // 状态同步: sync_state 是按事件维护的完整状态，对应序号 snapshot_seq + event_log.size()
+    GameState sync_state;
+    std::vector<StateEvent> event_log;  // 本局开始 (快照 snapshot_seq) 之后的事件
+    int snapshot_seq;
+    std::array<SyncMode, 4> sync_modes;
+    std::array<int, 4> sent_seq;        // 已发给各座位的序号 (-1: 需要快照)
+    std::array<StateViewEncoder, 2> snapshot_views;  // 按格式，各座位快照共用公共部分
+    std::array<int, 2> snapshot_view_seq;             // snapshot_views 对应的序号
+
+    // 检查点: 进度变化时 checkpoint_version 加一，决策只追加
+    RoomCheckpoint checkpoint;
+    uint32_t checkpoint_version;
+    bool resume_pending;     // 恢复了局中的房间，牌桌还没有重放完记录的决策
+
 public:
     Room(const std::string& id);
     ~Room();
@@ -57,26 +106,56 @@ public:
     const std::string& getId() const { return room_id; }
     RoomState getState() const { return state; }
     int getPlayerCount() const { return player_count; }
+    const std::string& getSeatToken(int seat) const { return seat_tokens[seat]; }
 
     // 玩家管理
     bool addPlayer(Session* session);       // 添加人类玩家
-    void removePlayer(Session* session);    // 移除玩家
+    void removePlayer(Session* session);    // 移除玩家 (对局开始后保留座位)
+    bool rejoin(Session* session, const std::string& token);  // 凭座位凭证回到对局中的空座位 (断线或服务器重启后)
     void fillWithAI();                      // 用 AI 填充空位
 
     // 游戏控制
     void startGame();                       // 开始游戏
+    GameResult playRound();                 // 同步打完一局 (人类玩家没有输入时摸切 / 过)
     void handleAction(Session* session, int action, int tile = -1);  // 处理玩家动作
 
-    // 广播消息
+    // 广播消息: GameMessage 按各连接的格式编码；字符串原样发给所有连接
+    // 同一份编码结果只保存一次，各连接的发送队列持有引用
+    void broadcast(const GameMessage& message);
     void broadcast(const std::string& message);
-    void broadcastState(int for_seat = -1);  // 广播游戏状态
+    void broadcast(const SharedMessage& message);
+    void broadcastState(int for_seat = -1);  // 发送完整快照 (-1: 所有座位)
+
+    // 状态同步
+    void handleSyncRequest(Session* session, int seq);  // 改为增量同步，客户端已有到 seq 的状态
+    int getSyncSeq() const { return snapshot_seq + static_cast<int>(event_log.size()); }
+    const GameState& getSyncState() const { return sync_state; }
 
-    // 获取当前游戏状态
+    // 从牌桌和玩家重新收集的当前状态 (不含最后弃牌)
     GameState getCurrentState() const;
 
+    // 检查点 (写入和恢复见 room_checkpoint.h)
+    const RoomCheckpoint& getCheckpoint() const { return checkpoint; }
+    uint32_t getCheckpointVersion() const { return checkpoint_version; }
+    // 在刚创建的房间上恢复；局中的检查点在下一次 playRound 时先重放已记录的决策
+    // 重放到检查点之前不向连接发送任何消息，之后先给各座位发快照
+    bool restore(const RoomCheckpoint& saved);
+    bool isReplaying() const { return resume_pending; }
+
 private:
     int findEmptySeat() const;
+    int findSeat(const Session* session) const;
     void setupCallbacks();
+    void createTable();
+
+    void checkpointSeats();                 // 房间状态或座位变化
+    void checkpointProgress(bool in_round); // 开局 / 结束: 记录进度，开局时加上牌山
+
+    void resetSync();                       // 以当前状态为快照重新开始 (新的一局或事件无法应用时)
+    void recordEvent(StateEventKind kind, int seat, int tile = -1, int value = 0);
+    void recordChanges();                   // 立直、点数、立直棒的变化 (没有单独的牌桌回调)
+    void flushSync();                       // 把新事件 / 快照发给所有座位
+    void flushSeat(int seat);
 };
 
 #endif // ROOM_H
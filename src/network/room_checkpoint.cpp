@@ -0,0 +1,451 @@
+#include "room_checkpoint.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t header_size = 8;
+static const size_t max_record_decisions = 0xFFFF;
+
+static void put8(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void put16(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static void putString(std::vector<uint8_t>& out, const std::string& s) {
+    size_t size = std::min<size_t>(s.size(), 255);
+    put8(out, size);
+    out.insert(out.end(), s.begin(), s.begin() + size);
+}
+
+static void putDecisions(std::vector<uint8_t>& out, const ReplayDecision* decisions, size_t count) {
+    put16(out, count);
+    for (size_t i = 0; i < count; ++i) {
+        put8(out, decisions[i].seat);
+        put8(out, decisions[i].kind);
+        put8(out, decisions[i].options);
+        put8(out, decisions[i].action);
+    }
+}
+
+static uint32_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// 记录头: 长度占位 + 类型 + 房间号 + 序号，返回长度字段的位置
+static size_t beginRecord(std::vector<uint8_t>& out, CheckpointRecord kind, const std::string& room_id, int sync_seq) {
+    size_t length_pos = out.size();
+    put32(out, 0);
+    put8(out, static_cast<uint32_t>(kind));
+    putString(out, room_id);
+    put32(out, static_cast<uint32_t>(sync_seq));
+    return length_pos;
+}
+
+static void endRecord(std::vector<uint8_t>& out, size_t length_pos) {
+    uint32_t length = out.size() - length_pos - 4;
+    for (int i = 0; i < 4; ++i) {
+        out[length_pos + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+}
+
+void encodeCheckpointBase(const RoomCheckpoint& checkpoint, int sync_seq, std::vector<uint8_t>& out) {
+    size_t length_pos = beginRecord(out, CheckpointRecord::Base, checkpoint.room_id, sync_seq);
+
+    put8(out, static_cast<uint32_t>(checkpoint.state));
+    for (int i = 0; i < 4; ++i) {
+        put8(out, static_cast<uint32_t>(checkpoint.seats[i]));
+        putString(out, checkpoint.names[i]);
+        putString(out, checkpoint.tokens[i]);
+    }
+    put8(out, checkpoint.in_round ? 1 : 0);
+
+    const ReplayRound& round = checkpoint.round;
+    put32(out, round.seed);
+    put8(out, round.dealer);
+    put8(out, static_cast<uint32_t>(round.round_wind));
+    put8(out, round.honba);
+    put8(out, round.riichi_sticks);
+    for (int score : round.scores) {
+        put32(out, static_cast<uint32_t>(score));
+    }
+    if (checkpoint.in_round) {
+        for (int i = 0; i < 136; ++i) {
+            put8(out, i < (int)round.wall.size() ? round.wall[i] : invalid_tile_index);
+        }
+        putDecisions(out, round.decisions.data(), std::min(round.decisions.size(), max_record_decisions));
+    }
+
+    endRecord(out, length_pos);
+}
+
+void encodeCheckpointDecisions(const std::string& room_id, int sync_seq, const ReplayDecision* decisions,
+                               size_t count, std::vector<uint8_t>& out) {
+    size_t length_pos = beginRecord(out, CheckpointRecord::Decisions, room_id, sync_seq);
+    putDecisions(out, decisions, count);
+    endRecord(out, length_pos);
+}
+
+// 按顺序读取记录内容，越界时 ok 置为 false 并返回 0
+struct RecordReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    bool need(size_t n) {
+        if (ok && static_cast<size_t>(end - p) < n) ok = false;
+        return ok;
+    }
+    uint32_t u8() { return need(1) ? *p++ : 0; }
+    uint32_t u16() {
+        if (!need(2)) return 0;
+        uint32_t v = get16(p);
+        p += 2;
+        return v;
+    }
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = get32(p);
+        p += 4;
+        return v;
+    }
+    std::string str() {
+        size_t size = u8();
+        if (!need(size)) return std::string();
+        std::string s(reinterpret_cast<const char*>(p), size);
+        p += size;
+        return s;
+    }
+    void decisions(std::vector<ReplayDecision>& out) {
+        size_t count = u16();
+        if (!need(count * 4)) return;
+        for (size_t i = 0; i < count; ++i, p += 4) {
+            ReplayDecision d;
+            d.seat = p[0];
+            d.kind = p[1];
+            d.options = p[2];
+            d.action = p[3];
+            if (d.seat > 3 || d.kind > static_cast<int>(DecisionKind::RiichiDiscard)) ok = false;
+            out.push_back(d);
+        }
+    }
+};
+
+static bool decodeBase(RecordReader& in, RoomCheckpoint& checkpoint) {
+    uint32_t state = in.u8();
+    if (state > static_cast<uint32_t>(RoomState::Finished)) return false;
+    checkpoint.state = static_cast<RoomState>(state);
+    for (int i = 0; i < 4; ++i) {
+        uint32_t seat = in.u8();
+        if (seat > static_cast<uint32_t>(SeatKind::AI)) return false;
+        checkpoint.seats[i] = static_cast<SeatKind>(seat);
+        checkpoint.names[i] = in.str();
+        checkpoint.tokens[i] = in.str();
+    }
+    checkpoint.in_round = in.u8() != 0;
+
+    ReplayRound& round = checkpoint.round;
+    round.seed = in.u32();
+    round.dealer = in.u8();
+    uint32_t wind = in.u8();
+    if (round.dealer > 3 || wind > 3) return false;
+    round.round_wind = static_cast<Wind>(wind);
+    round.honba = in.u8();
+    round.riichi_sticks = in.u8();
+    for (int& score : round.scores) {
+        score = static_cast<int32_t>(in.u32());
+    }
+    round.wall.clear();
+    round.decisions.clear();
+    if (checkpoint.in_round) {
+        // 牌山必须是 136 张牌的一个排列
+        if (!in.need(136)) return false;
+        uint64_t seen[3] = {0, 0, 0};
+        round.wall.resize(136);
+        for (int i = 0; i < 136; ++i) {
+            int tile = *in.p++;
+            if (tile >= 136 || (seen[tile >> 6] >> (tile & 63) & 1)) return false;
+            seen[tile >> 6] |= uint64_t(1) << (tile & 63);
+            round.wall[i] = tile;
+        }
+        in.decisions(round.decisions);
+    }
+    return in.ok;
+}
+
+bool readCheckpoint(const std::string& path, std::vector<RoomCheckpoint>& rooms, bool* truncated) {
+    rooms.clear();
+    if (truncated) *truncated = false;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < header_size) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    const uint8_t* data = static_cast<const uint8_t*>(mapped);
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    bool ok = std::memcmp(data, checkpoint_magic, 4) == 0 && get16(data + 4) == checkpoint_format_version;
+
+    // 房间号 -> rooms 中的位置；关闭的房间最后统一去掉
+    std::unordered_map<std::string, size_t> index;
+    std::vector<bool> removed;
+    size_t pos = header_size;
+    while (ok && pos + 4 <= size) {
+        uint32_t length = get32(data + pos);
+        if (length > size - pos - 4) break;
+        RecordReader in{data + pos + 4, data + pos + 4 + length};
+        pos += 4 + length;
+
+        uint32_t kind = in.u8();
+        std::string room_id = in.str();
+        int sync_seq = static_cast<int32_t>(in.u32());
+        if (!in.ok) {
+            ok = false;
+            break;
+        }
+        auto it = index.find(room_id);
+        if (kind == static_cast<uint32_t>(CheckpointRecord::Base)) {
+            if (it == index.end()) {
+                it = index.emplace(room_id, rooms.size()).first;
+                rooms.emplace_back();
+                removed.push_back(false);
+            }
+            RoomCheckpoint& checkpoint = rooms[it->second];
+            checkpoint.room_id = room_id;
+            checkpoint.sync_seq = sync_seq;
+            removed[it->second] = false;
+            ok = decodeBase(in, checkpoint);
+        } else if (kind == static_cast<uint32_t>(CheckpointRecord::Decisions)) {
+            // 决策只能接在局中的基准之后
+            if (it == index.end() || removed[it->second] || !rooms[it->second].in_round) {
+                ok = false;
+                break;
+            }
+            rooms[it->second].sync_seq = sync_seq;
+            in.decisions(rooms[it->second].round.decisions);
+            ok = in.ok;
+        } else if (kind == static_cast<uint32_t>(CheckpointRecord::Removed)) {
+            if (it != index.end()) removed[it->second] = true;
+        } else {
+            ok = false;
+        }
+        ok = ok && in.p == in.end;
+    }
+    if (ok && truncated) *truncated = (pos != size);
+    munmap(mapped, size);
+
+    if (!ok) {
+        rooms.clear();
+        return false;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < rooms.size(); ++i) {
+        if (removed[i]) continue;
+        if (kept != i) rooms[kept] = std::move(rooms[i]);
+        kept++;
+    }
+    rooms.resize(kept);
+    return true;
+}
+
+// CheckpointWriter 实现
+CheckpointWriter::CheckpointWriter() : file(nullptr), committed(0), rollback_pending(false) {
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    close();
+}
+
+bool CheckpointWriter::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    // 自己有缓冲，不经过 stdio 的缓冲，写失败时才知道文件里到底有哪些字节
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    committed = 0;
+    rollback_pending = false;
+
+    cursors.clear();
+    buffer.clear();
+    for (char c : checkpoint_magic) put8(buffer, static_cast<uint8_t>(c));
+    put16(buffer, checkpoint_format_version);
+    put16(buffer, 0);
+    return true;
+}
+
+bool CheckpointWriter::close() {
+    if (!file) return true;
+    bool ok = flush();
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+size_t CheckpointWriter::write(const Room& room) {
+    if (!file) return 0;
+    const RoomCheckpoint& checkpoint = room.getCheckpoint();
+    const std::vector<ReplayDecision>& decisions = checkpoint.round.decisions;
+    size_t before = buffer.size();
+
+    auto it = cursors.find(room.getId());
+    if (it == cursors.end() || it->second.room != &room || it->second.version != room.getCheckpointVersion() ||
+        decisions.size() < it->second.decisions) {
+        // 新房间或进度变了: 写完整的基准
+        encodeCheckpointBase(checkpoint, room.getSyncSeq(), buffer);
+        Cursor cursor{&room, room.getCheckpointVersion(), std::min(decisions.size(), max_record_decisions)};
+        it = cursors.insert_or_assign(room.getId(), cursor).first;
+    }
+    // 只追加新的决策
+    Cursor& cursor = it->second;
+    while (cursor.decisions < decisions.size()) {
+        size_t count = std::min(decisions.size() - cursor.decisions, max_record_decisions);
+        encodeCheckpointDecisions(room.getId(), room.getSyncSeq(), decisions.data() + cursor.decisions, count, buffer);
+        cursor.decisions += count;
+    }
+
+    size_t written = buffer.size() - before;
+    if (buffer.size() >= (1 << 16)) {
+        flush();
+    }
+    return written;
+}
+
+void CheckpointWriter::removeRoom(const std::string& room_id) {
+    if (!file) return;
+    auto it = cursors.find(room_id);
+    if (it == cursors.end()) return;
+    cursors.erase(it);
+    endRecord(buffer, beginRecord(buffer, CheckpointRecord::Removed, room_id, 0));
+}
+
+bool CheckpointWriter::rollback() {
+    // 写了一半的记录会让之后追加的内容都读不出来，截回最后一条完整的记录
+    rollback_pending = ftruncate(fileno(file), static_cast<off_t>(committed)) != 0 ||
+                       std::fseek(file, static_cast<long>(committed), SEEK_SET) != 0;
+    return !rollback_pending;
+}
+
+bool CheckpointWriter::flush() {
+    if (!file || (rollback_pending && !rollback())) return false;
+    if (buffer.empty()) return true;
+
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() || std::fflush(file) != 0) {
+        // 磁盘满或 I/O 错误: 缓冲保留，下次 flush 时重试
+        std::clearerr(file);
+        rollback();
+        return false;
+    }
+    committed += buffer.size();
+    buffer.clear();
+    return true;
+}
+
+size_t checkDecisions(const RoomCheckpoint& checkpoint) {
+    const ReplayRound& round = checkpoint.round;
+    if (!checkpoint.in_round || round.wall.size() != 136) return 0;
+
+    GameSnapshot snapshot;
+    dealSnapshot(snapshot, round.wall.data(), round.dealer, round.round_wind, round.honba, round.riichi_sticks,
+                 round.scores);
+    size_t valid = 0;
+    for (const ReplayDecision& d : round.decisions) {
+        if (snapshot.isFinished() || snapshot.getDecisionSeat() != d.seat ||
+            static_cast<int>(snapshot.getDecisionKind()) != d.kind || snapshot.getOptions() != d.options) {
+            break;
+        }
+        if (snapshot.apply(d.action) != d.action) break;
+        valid++;
+    }
+    return valid;
+}
+
+std::vector<std::unique_ptr<Room>> restoreRooms(const std::vector<RoomCheckpoint>& checkpoints,
+                                                int num_threads, RestoreReport* report) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = static_cast<int>(std::min<size_t>(num_threads, std::max<size_t>(1, checkpoints.size())));
+
+    std::vector<std::unique_ptr<Room>> rooms(checkpoints.size());
+    std::atomic<size_t> next_room(0);
+    std::atomic<size_t> in_round(0), decisions(0), dropped(0), failed(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // 各房间互不相关，每个线程按原子计数领取
+    auto worker = [&]() {
+        RoomCheckpoint trimmed;
+        while (true) {
+            size_t index = next_room.fetch_add(1, std::memory_order_relaxed);
+            if (index >= checkpoints.size()) break;
+            const RoomCheckpoint& checkpoint = checkpoints[index];
+
+            // 与引擎不一致的决策 (以及之后的) 不重放
+            const RoomCheckpoint* source = &checkpoint;
+            size_t valid = checkDecisions(checkpoint);
+            if (valid < checkpoint.round.decisions.size()) {
+                trimmed = checkpoint;
+                trimmed.round.decisions.resize(valid);
+                source = &trimmed;
+                dropped.fetch_add(checkpoint.round.decisions.size() - valid, std::memory_order_relaxed);
+            }
+
+            auto room = std::make_unique<Room>(checkpoint.room_id);
+            if (!room->restore(*source)) {
+                failed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (source->in_round) {
+                in_round.fetch_add(1, std::memory_order_relaxed);
+                decisions.fetch_add(valid, std::memory_order_relaxed);
+            }
+            rooms[index] = std::move(room);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    if (report) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report->rooms = checkpoints.size() - failed.load();
+        report->in_round = in_round.load();
+        report->decisions = decisions.load();
+        report->dropped = dropped.load();
+        report->failed = failed.load();
+        report->seconds = elapsed.count();
+    }
+    return rooms;
+}
@@ -0,0 +1,94 @@
+#ifndef ROOM_CHECKPOINT_H
+#define ROOM_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "room.h"
+
+// 检查点文件格式 (小端序):
+//   文件头: "MJCP" + u16 版本 + u16 保留
+//   每条记录: u32 记录长度 + 记录内容
+//   记录: u8 类型, u8 房间号长度 + 房间号, i32 同步序号, 之后按类型:
+//     Base:      u8 房间状态, 4 个座位 (u8 SeatKind + u8 长度 + 名字 + u8 长度 + 座位凭证), u8 是否局中,
+//                u32 种子, u8 庄家, u8 场风, u8 本场, u8 立直棒, i32[4] 点数,
+//                局中时 u8[136] 牌山, u16 决策数 + 决策 (每条 4 字节，同牌谱)
+//     Decisions: u16 决策数 + 决策，接在该房间已有的决策之后
+//     Removed:   无内容，房间已关闭
+// 同一房间后面的 Base 覆盖前面的全部记录，所以文件只追加；重新打开 (截断) 即可压缩
+const char checkpoint_magic[4] = {'M', 'J', 'C', 'P'};
+const uint16_t checkpoint_format_version = 2;
+
+enum class CheckpointRecord : uint8_t {
+    Base,
+    Decisions,
+    Removed
+};
+
+// 编码一条记录 (追加到 out)
+void encodeCheckpointBase(const RoomCheckpoint& checkpoint, int sync_seq, std::vector<uint8_t>& out);
+void encodeCheckpointDecisions(const std::string& room_id, int sync_seq, const ReplayDecision* decisions,
+                               size_t count, std::vector<uint8_t>& out);
+
+// 检查点写入 (追加写，带缓冲)
+// 记住每个房间写到了哪里: 进度没变时只追加新的决策，没有变化的房间什么都不写
+class CheckpointWriter {
+private:
+    struct Cursor {
+        const Room* room;
+        uint32_t version;     // 已写入的基准对应的 Room::getCheckpointVersion
+        size_t decisions;     // 已写入的决策数
+    };
+
+    std::FILE* file;
+    std::vector<uint8_t> buffer;
+    size_t committed;        // 文件中完整写入的字节数
+    bool rollback_pending;   // 写入失败后没能截回，文件尾可能有半条记录
+
+    bool rollback();
+    std::unordered_map<std::string, Cursor> cursors;
+
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // 新建 (截断) 文件，之后每个房间先写一次基准
+    bool open(const std::string& path);
+    bool close();
+    bool isOpen() const { return file != nullptr; }
+
+    // 追加房间自上次以来的变化，返回这次编码的字节数
+    size_t write(const Room& room);
+    void removeRoom(const std::string& room_id);
+    // 写出缓冲的记录；失败 (磁盘满、I/O 错误) 时返回 false，文件退回到最后一条完整的记录，
+    // 缓冲保留，下次 flush 时重试
+    bool flush();
+};
+
+// 读取检查点文件，按记录顺序合并出每个房间的最新检查点
+// 文件尾部不完整的记录 (写入时崩溃) 被忽略并设置 truncated；文件头或记录内容错误时返回 false
+bool readCheckpoint(const std::string& path, std::vector<RoomCheckpoint>& rooms, bool* truncated = nullptr);
+
+// 检查点中的决策流是否和引擎一致 (用快照重放)，返回一致的前缀长度
+size_t checkDecisions(const RoomCheckpoint& checkpoint);
+
+struct RestoreReport {
+    size_t rooms = 0;
+    size_t in_round = 0;        // 恢复时在局中的房间
+    size_t decisions = 0;       // 待重放的决策总数
+    size_t dropped = 0;         // 与引擎不一致而丢弃的决策
+    size_t failed = 0;          // 检查点无效、没有恢复的房间
+    double seconds = 0;
+};
+
+// 多线程恢复房间 (num_threads <= 0 时使用全部核心)，结果与 checkpoints 一一对应，失败的为空
+// 各房间相互独立: 每个线程按原子计数领取房间，校验决策后在新建的 Room 上 restore
+std::vector<std::unique_ptr<Room>> restoreRooms(const std::vector<RoomCheckpoint>& checkpoints,
+                                                int num_threads = 0, RestoreReport* report = nullptr);
+
+#endif // ROOM_CHECKPOINT_H
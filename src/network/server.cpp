@@ -1,5 +1,7 @@
 #include "server.h"
 #include "game_state.h"
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
 #include <iostream>
 
@@ -66,6 +68,7 @@ Room* GameServer::getRoom(const std::string& room_id) {
 
 void GameServer::removeRoom(const std::string& room_id) {
     rooms.erase(room_id);
+    checkpoint_writer.removeRoom(room_id);
     std::cout << "Room removed: " << room_id << std::endl;
 }
 
@@ -77,9 +80,54 @@ std::vector<std::string> GameServer::listRooms() const {
     return result;
 }
 
+bool GameServer::openCheckpoint(const std::string& path) {
+    return checkpoint_writer.open(path);
+}
+
+bool GameServer::writeCheckpoint(size_t* bytes) {
+    size_t written = 0;
+    for (const auto& pair : rooms) {
+        written += checkpoint_writer.write(*pair.second);
+    }
+    if (bytes) *bytes = written;
+    return checkpoint_writer.flush();
+}
+
+bool GameServer::restoreCheckpoint(const std::string& path, int num_threads, RestoreReport* report) {
+    std::vector<RoomCheckpoint> checkpoints;
+    bool truncated = false;
+    if (!readCheckpoint(path, checkpoints, &truncated)) {
+        std::cout << "Failed to read checkpoint: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Room>> restored = restoreRooms(checkpoints, num_threads, report);
+    size_t count = 0;
+    for (auto& room : restored) {
+        if (!room || rooms.count(room->getId())) continue;
+        // 新建的房间号接在恢复的房间之后
+        const std::string& id = room->getId();
+        if (id.compare(0, 4, "ROOM") == 0) {
+            next_room_id = std::max(next_room_id, std::atoi(id.c_str() + 4) + 1);
+        }
+        rooms[id] = std::move(room);
+        count++;
+    }
+    std::cout << "Rooms restored: " << count << (truncated ? " (checkpoint tail truncated)" : "") << std::endl;
+    return true;
+}
+
 void GameServer::handleMessage(Session* session, const std::string& message) {
-    // 解析消息
-    GameMessage msg = GameMessage::fromJSON(message);
+    // 按连接的格式解析消息 (只解码该类型用到的字段，格式错误或超出限制时回复错误)
+    GameMessage msg;
+    const char* parse_error = nullptr;
+    if (!decodeMessage(message, session->getWireFormat(), msg, &parse_error)) {
+        GameMessage error;
+        error.type = MessageType::Error;
+        error.error_msg = std::string("Invalid message: ") + parse_error;
+        session->send(error);
+        return;
+    }
 
     switch (msg.type) {
         case MessageType::CreateRoom: {
@@ -89,31 +137,34 @@ void GameServer::handleMessage(Session* session, const std::string& message) {
                 response.type = MessageType::RoomCreated;
                 response.room_id = room->getId();
                 response.seat = session->getSeat();
-                session->send(response.toJSON());
+                response.token = room->getSeatToken(response.seat);
+                session->send(response);
             }
             break;
         }
 
         case MessageType::JoinRoom: {
+            // 对局中的房间只能凭入座时拿到的座位凭证回到自己的座位
             Room* room = getRoom(msg.room_id);
-            if (room && room->addPlayer(session)) {
+            if (room && (room->addPlayer(session) || room->rejoin(session, msg.token))) {
                 // 通知加入成功
                 GameMessage response;
                 response.type = MessageType::RoomJoined;
                 response.room_id = room->getId();
                 response.seat = session->getSeat();
-                session->send(response.toJSON());
+                response.token = room->getSeatToken(response.seat);
+                session->send(response);
 
                 // 通知房间内其他玩家
                 GameMessage notify;
                 notify.type = MessageType::PlayerJoined;
                 notify.seat = session->getSeat();
-                room->broadcast(notify.toJSON());
+                room->broadcast(notify);
             } else {
                 GameMessage error;
                 error.type = MessageType::Error;
                 error.error_msg = "Failed to join room";
-                session->send(error.toJSON());
+                session->send(error);
             }
             break;
         }
@@ -128,7 +179,7 @@ void GameServer::handleMessage(Session* session, const std::string& message) {
                 GameMessage notify;
                 notify.type = MessageType::PlayerLeft;
                 notify.seat = seat;
-                room->broadcast(notify.toJSON());
+                room->broadcast(notify);
             }
             break;
         }
@@ -151,19 +202,32 @@ void GameServer::handleMessage(Session* session, const std::string& message) {
             break;
         }
 
+        case MessageType::SyncRequest: {
+            // 客户端改为增量同步，或发现序号断档后请求重发
+            Room* room = session->getRoom();
+            if (room) {
+                room->handleSyncRequest(session, msg.seq);
+            }
+            break;
+        }
+
         default:
             break;
     }
 }
 
-void GameServer::onClientConnect(int client_fd) {
+const char* GameServer::negotiateProtocol(Session* session, const std::string& offered) {
+    WireFormat format = negotiateWireFormat(offered);
+    session->setWireFormat(format);
+    return wireProtocolName(format);
+}
+
+void GameServer::onClientConnect(int client_fd, const std::string& protocols) {
     Session* session = createSession();
+    negotiateProtocol(session, protocols);
 
-    // 设置发送回调
-    session->setSendCallback([client_fd](const std::string& msg) {
-        // 实际的发送需要使用具体的网络库
-        std::cout << "Send to client " << client_fd << ": " << msg << std::endl;
-    });
+    // 不设置发送回调: 消息 (广播时共用同一份) 进入会话的发送队列，由 onClientWritable 写出
+    connections[client_fd] = session;
 
     if (on_connect) {
         on_connect(session);
@@ -171,11 +235,26 @@ void GameServer::onClientConnect(int client_fd) {
 }
 
 void GameServer::onClientMessage(int client_fd, const std::string& message) {
-    // 查找对应的 session
-    // 实际实现需要维护 client_fd -> session_id 的映射
-    // 这里简化处理
+    auto it = connections.find(client_fd);
+    if (it != connections.end()) {
+        handleMessage(it->second, message);
+    }
 }
 
 void GameServer::onClientDisconnect(int client_fd) {
-    // 实际实现需要维护 client_fd -> session_id 的映射
+    auto it = connections.find(client_fd);
+    if (it != connections.end()) {
+        Session* session = it->second;
+        connections.erase(it);
+        if (on_disconnect) {
+            on_disconnect(session);
+        }
+        removeSession(session->getId());
+    }
+}
+
+bool GameServer::onClientWritable(int client_fd) {
+    auto it = connections.find(client_fd);
+    if (it == connections.end()) return false;
+    return it->second->flushQueued(client_fd) >= 0;
 }
@@ -7,6 +7,7 @@
 #include <functional>
 #include "session.h"
 #include "room.h"
+#include "room_checkpoint.h"
 
 // 游戏服务器
 // 注意: 这是一个抽象接口，实际的 WebSocket 实现需要使用具体库
@@ -24,6 +25,8 @@ private:
 
     std::map<int, std::unique_ptr<Session>> sessions;
     std::map<std::string, std::unique_ptr<Room>> rooms;
+    std::map<int, Session*> connections;  // client_fd -> session
+    CheckpointWriter checkpoint_writer;
 
     ConnectionCallback on_connect;
     MessageCallback on_message;
@@ -49,14 +52,27 @@ public:
     void removeRoom(const std::string& room_id);
     std::vector<std::string> listRooms() const;
 
+    // 检查点: 打开后定期调用 writeCheckpoint，只追加各房间自上次以来的变化
+    // 重启时先 restoreCheckpoint (并行恢复所有房间)，再打开新的检查点文件
+    bool openCheckpoint(const std::string& path);
+    // 返回 false 表示写文件失败 (可记录日志后下次再调用重试)；bytes 为这次编码的字节数
+    bool writeCheckpoint(size_t* bytes = nullptr);
+    bool restoreCheckpoint(const std::string& path, int num_threads = 0, RestoreReport* report = nullptr);
+
+    // 握手: 按客户端提供的子协议 (Sec-WebSocket-Protocol) 确定连接的编码
+    // 返回应写回响应头的子协议名
+    const char* negotiateProtocol(Session* session, const std::string& offered);
+
     // 消息处理
     void handleMessage(Session* session, const std::string& message);
 
 protected:
     // 子类实现实际的网络操作
-    virtual void onClientConnect(int client_fd);
+    virtual void onClientConnect(int client_fd, const std::string& protocols);
     virtual void onClientMessage(int client_fd, const std::string& message);
     virtual void onClientDisconnect(int client_fd);
+    // socket 可写时把发送队列用 writev 写出 (返回 false 表示连接出错)
+    virtual bool onClientWritable(int client_fd);
 
     Session* createSession();
     void removeSession(int session_id);
@@ -1,7 +1,34 @@
 #include "session.h"
+#include <cerrno>
+#include <sys/uio.h>
+
+namespace {
+
+// 服务器发出的 WebSocket 帧头 (FIN、不加掩码)
+size_t frameHeader(char* out, size_t size, bool binary) {
+    out[0] = static_cast<char>(0x80 | (binary ? 0x2 : 0x1));
+    if (size < 126) {
+        out[1] = static_cast<char>(size);
+        return 2;
+    }
+    if (size <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = static_cast<char>(size >> 8);
+        out[3] = static_cast<char>(size & 0xFF);
+        return 4;
+    }
+    out[1] = 127;
+    for (int i = 0; i < 8; ++i) {
+        out[2 + i] = static_cast<char>(static_cast<uint64_t>(size) >> (56 - 8 * i) & 0xFF);
+    }
+    return 10;
+}
+
+} // namespace
 
 Session::Session(int session_id)
-    : id(session_id), current_room(nullptr), seat(-1) {
+    : id(session_id), current_room(nullptr), seat(-1), wire_format(WireFormat::Json),
+      queued_bytes(0), front_sent(0) {
 }
 
 void Session::setRoom(Room* room, int seat_pos) {
@@ -9,8 +36,78 @@ void Session::setRoom(Room* room, int seat_pos) {
     seat = seat_pos;
 }
 
+void Session::send(const SharedMessage& message) {
+    if (!message) return;
+    if (send_callback) {
+        send_callback(*message);
+        return;
+    }
+
+    OutgoingFrame frame;
+    frame.payload = message;
+    frame.header_size = frameHeader(frame.header, message->size(), wire_format == WireFormat::Binary);
+    queued_bytes += frame.header_size + message->size();
+    outgoing.push_back(std::move(frame));
+}
+
 void Session::send(const std::string& message) {
     if (send_callback) {
         send_callback(message);
+    } else {
+        send(shareMessage(message));
+    }
+}
+
+void Session::send(const GameMessage& message) {
+    send(encodeMessage(message, wire_format));
+}
+
+int Session::gatherQueued(struct iovec* iov, int max_iov) const {
+    int count = 0;
+    size_t skip = front_sent;
+    for (const OutgoingFrame& frame : outgoing) {
+        const char* parts[2] = {frame.header, frame.payload->data()};
+        size_t sizes[2] = {frame.header_size, frame.payload->size()};
+        for (int p = 0; p < 2; ++p) {
+            if (skip >= sizes[p]) {
+                skip -= sizes[p];
+                continue;
+            }
+            if (count == max_iov) return count;
+            iov[count].iov_base = const_cast<char*>(parts[p] + skip);
+            iov[count].iov_len = sizes[p] - skip;
+            skip = 0;
+            count++;
+        }
+    }
+    return count;
+}
+
+void Session::consumeQueued(size_t bytes) {
+    front_sent += bytes;
+    while (!outgoing.empty()) {
+        size_t size = outgoing.front().header_size + outgoing.front().payload->size();
+        if (front_sent < size) break;
+        front_sent -= size;
+        queued_bytes -= size;
+        outgoing.pop_front();
+    }
+}
+
+ssize_t Session::flushQueued(int fd) {
+    const int max_iov = 64;
+    struct iovec iov[max_iov];
+    ssize_t total = 0;
+    while (!outgoing.empty()) {
+        int count = gatherQueued(iov, max_iov);
+        ssize_t written = ::writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        consumeQueued(static_cast<size_t>(written));
+        total += written;
     }
+    return total;
 }
@@ -2,9 +2,13 @@
 #define SESSION_H
 
 #include <string>
+#include <deque>
 #include <functional>
+#include <sys/types.h>
+#include "wire_protocol.h"
 
 class Room;
+struct iovec;
 
 // 玩家会话 (表示一个网络连接)
 class Session {
@@ -12,12 +16,24 @@ public:
     using MessageCallback = std::function<void(const std::string&)>;
 
 private:
+    // 发送队列中的一帧: WebSocket 帧头属于本连接，消息内容与其他连接共用
+    struct OutgoingFrame {
+        SharedMessage payload;
+        char header[10];
+        size_t header_size;
+    };
+
     int id;
     std::string player_name;
     Room* current_room;
     int seat;  // 在房间中的座位 (-1 表示观战)
+    WireFormat wire_format;  // 握手时确定，之后不变
     MessageCallback send_callback;
 
+    std::deque<OutgoingFrame> outgoing;
+    size_t queued_bytes;  // 队列中帧头和内容的总字节数 (含已部分写出的)
+    size_t front_sent;    // 队首帧已写出的字节数
+
 public:
     Session(int session_id);
     virtual ~Session() = default;
@@ -32,9 +48,26 @@ public:
     void setRoom(Room* room, int seat_pos = -1);
     int getSeat() const { return seat; }
 
-    // 消息发送
+    // 消息编码 (JSON 文本帧 / 二进制帧)
+    WireFormat getWireFormat() const { return wire_format; }
+    void setWireFormat(WireFormat format) { wire_format = format; }
+
+    // 消息发送: 设置了回调时交给回调 (不复制)，否则加入发送队列
+    // SharedMessage 只增加引用计数；字符串和 GameMessage 各复制 / 编码一次
     void setSendCallback(MessageCallback cb) { send_callback = cb; }
+    void send(const SharedMessage& message);
     void send(const std::string& message);
+    void send(const GameMessage& message);
+
+    // 发送队列，由 socket 层在可写时写出
+    size_t queuedFrames() const { return outgoing.size(); }
+    size_t queuedBytes() const { return queued_bytes - front_sent; }
+    // 把未写出的部分依次填入 iov (每帧帧头、内容各一项)，返回填入的项数
+    int gatherQueued(struct iovec* iov, int max_iov) const;
+    // 标记 bytes 字节已写出，写完的帧出队
+    void consumeQueued(size_t bytes);
+    // 用 writev 写到 fd，直到写完或会阻塞；返回写出的字节数，出错时返回 -1
+    ssize_t flushQueued(int fd);
 };
 
 #endif // SESSION_H
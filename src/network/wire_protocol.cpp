@@ -0,0 +1,432 @@
+#include "wire_protocol.h"
+#include "json_writer.h"
+
+const char* const json_protocol = "mahjong.json";
+const char* const binary_protocol = "mahjong.bin.1";
+
+namespace {
+
+const unsigned hidden_hand = 0x80;
+
+class ByteWriter {
+private:
+    std::string& out;
+    bool ok = true;
+
+public:
+    explicit ByteWriter(std::string& buffer) : out(buffer) {}
+
+    bool good() const { return ok; }
+    void invalid() { ok = false; }
+    size_t size() const { return out.size(); }
+
+    void u8(unsigned v) { out.push_back(static_cast<char>(v)); }
+    void u16(unsigned v) {
+        u8(v & 0xFF);
+        u8(v >> 8 & 0xFF);
+    }
+
+    // -1 .. 254，-1 写成 255
+    void small(int v) {
+        if (v < -1 || v > 254) ok = false;
+        u8(v < 0 ? 255 : static_cast<unsigned>(v));
+    }
+
+    void varint(int v) {
+        uint32_t z = (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+        while (z >= 0x80) {
+            u8((z & 0x7F) | 0x80);
+            z >>= 7;
+        }
+        u8(z);
+    }
+
+    void bytes(const std::string& s, size_t max_len, bool wide) {
+        if (s.size() > max_len) ok = false;
+        size_t n = s.size() > max_len ? max_len : s.size();
+        if (wide) u16(static_cast<unsigned>(n));
+        else u8(static_cast<unsigned>(n));
+        out.append(s.data(), n);
+    }
+
+    // 已打包的牌 (每张一字节，255 为暗牌)，直接复制
+    void packed(const uint8_t* data, size_t n) {
+        u8(static_cast<unsigned>(n));
+        out.append(reinterpret_cast<const char*>(data), n);
+    }
+
+    void tiles(const std::vector<int>& v) {
+        if (v.size() > 255) ok = false;
+        size_t n = v.size() > 255 ? 255 : v.size();
+        u8(static_cast<unsigned>(n));
+        for (size_t i = 0; i < n; ++i) small(v[i]);
+    }
+};
+
+class ByteReader {
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+    const char* error_text = nullptr;
+
+public:
+    ByteReader(const char* data, size_t size)
+        : p(reinterpret_cast<const uint8_t*>(data)), end(reinterpret_cast<const uint8_t*>(data) + size) {}
+
+    bool failed() const { return error_text != nullptr; }
+    const char* error() const { return error_text ? error_text : ""; }
+    bool atEnd() const { return p == end; }
+
+    bool fail(const char* message) {
+        if (!error_text) error_text = message;
+        return false;
+    }
+
+    bool u8(unsigned& v) {
+        if (p >= end) return fail("truncated message");
+        v = *p++;
+        return true;
+    }
+
+    bool u16(unsigned& v) {
+        unsigned lo, hi;
+        if (!u8(lo) || !u8(hi)) return false;
+        v = lo | hi << 8;
+        return true;
+    }
+
+    bool small(int& v) {
+        unsigned b;
+        if (!u8(b)) return false;
+        v = b == 255 ? -1 : static_cast<int>(b);
+        return true;
+    }
+
+    bool varint(int& v) {
+        uint32_t z = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            unsigned b;
+            if (!u8(b)) return false;
+            if (shift == 28 && b > 0x0F) return fail("varint overflow");
+            z |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                v = static_cast<int>((z >> 1) ^ (0u - (z & 1)));
+                return true;
+            }
+        }
+        return fail("varint overflow");
+    }
+
+    bool bytes(std::string& s, bool wide) {
+        unsigned n;
+        if (!(wide ? u16(n) : u8(n))) return false;
+        if (static_cast<size_t>(end - p) < n) return fail("truncated message");
+        s.assign(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return true;
+    }
+
+    template <size_t N>
+    bool packed(TileArray<N>& v, unsigned n) {
+        if (n > N) return fail("too many tiles");
+        if (static_cast<size_t>(end - p) < n) return fail("truncated message");
+        v.assignPacked(p, n);
+        p += n;
+        return true;
+    }
+
+    bool tiles(std::vector<int>& v, unsigned n) {
+        v.clear();
+        if (static_cast<size_t>(end - p) < n) return fail("truncated message");
+        for (unsigned i = 0; i < n; ++i) {
+            v.push_back(p[i] == 255 ? -1 : p[i]);
+        }
+        p += n;
+        return true;
+    }
+};
+
+void writeState(ByteWriter& w, const GameState& s, ViewLayout* layout) {
+    w.small(s.round_wind);
+    w.small(s.dealer);
+    w.small(s.current_player);
+    w.small(s.remaining_tiles);
+    w.varint(s.honba);
+    w.varint(s.riichi_sticks);
+    for (int score : s.scores) w.varint(score);
+
+    unsigned flags = 0;
+    for (int i = 0; i < 4; ++i) flags |= static_cast<unsigned>(s.riichi_status[i]) << i;
+    flags |= static_cast<unsigned>(s.can_tsumo) << 4 | static_cast<unsigned>(s.can_ron) << 5 |
+             static_cast<unsigned>(s.can_riichi) << 6 | static_cast<unsigned>(s.can_chi) << 7 |
+             static_cast<unsigned>(s.can_pon) << 8 | static_cast<unsigned>(s.can_kan) << 9;
+    w.u16(flags);
+
+    // 他家的手牌全是 -1，只写张数
+    for (int i = 0; i < 4; ++i) {
+        const HandTiles& hand = s.hands[i];
+        if (layout) layout->hand_begin[i] = w.size();
+        bool hidden = !hand.empty();
+        for (size_t k = 0; k < hand.size(); ++k) hidden = hidden && hand.data()[k] == HandTiles::hidden;
+        if (hidden) {
+            w.u8(hidden_hand | static_cast<unsigned>(hand.size()));
+        } else {
+            w.packed(hand.data(), hand.size());
+        }
+        if (layout) layout->hand_end[i] = w.size();
+    }
+    for (const RiverTiles& river : s.discards) w.packed(river.data(), river.size());
+
+    if (layout) layout->last_draw_begin = w.size();
+    w.small(s.last_draw);
+    if (layout) layout->last_draw_end = w.size();
+    w.small(s.last_discard);
+    w.small(s.last_discard_player);
+}
+
+bool readState(ByteReader& r, GameState& s) {
+    if (!r.small(s.round_wind) || !r.small(s.dealer) || !r.small(s.current_player) ||
+        !r.small(s.remaining_tiles) || !r.varint(s.honba) || !r.varint(s.riichi_sticks)) {
+        return false;
+    }
+    for (int& score : s.scores) {
+        if (!r.varint(score)) return false;
+    }
+
+    unsigned flags;
+    if (!r.u16(flags)) return false;
+    if (flags >> 10) return r.fail("unknown state flags");
+    for (int i = 0; i < 4; ++i) s.riichi_status[i] = flags >> i & 1;
+    s.can_tsumo = flags >> 4 & 1;
+    s.can_ron = flags >> 5 & 1;
+    s.can_riichi = flags >> 6 & 1;
+    s.can_chi = flags >> 7 & 1;
+    s.can_pon = flags >> 8 & 1;
+    s.can_kan = flags >> 9 & 1;
+
+    for (HandTiles& hand : s.hands) {
+        unsigned n;
+        if (!r.u8(n)) return false;
+        if (n & hidden_hand) {
+            if (!hand.assign(n & ~hidden_hand, -1)) return r.fail("too many tiles");
+        } else if (!r.packed(hand, n)) {
+            return false;
+        }
+    }
+    for (RiverTiles& river : s.discards) {
+        unsigned n;
+        if (!r.u8(n) || !r.packed(river, n)) return false;
+    }
+
+    return r.small(s.last_draw) && r.small(s.last_discard) && r.small(s.last_discard_player);
+}
+
+} // namespace
+
+WireFormat negotiateWireFormat(const std::string& offered) {
+    // 逐项比较，忽略两侧空白
+    size_t pos = 0;
+    while (pos < offered.size()) {
+        size_t comma = offered.find(',', pos);
+        if (comma == std::string::npos) comma = offered.size();
+        size_t first = pos, last = comma;
+        while (first < last && (offered[first] == ' ' || offered[first] == '\t')) first++;
+        while (last > first && (offered[last - 1] == ' ' || offered[last - 1] == '\t')) last--;
+        if (offered.compare(first, last - first, binary_protocol) == 0) return WireFormat::Binary;
+        pos = comma + 1;
+    }
+    return WireFormat::Json;
+}
+
+const char* wireProtocolName(WireFormat format) {
+    return format == WireFormat::Binary ? binary_protocol : json_protocol;
+}
+
+bool appendBinary(const GameMessage& msg, std::string& out, ViewLayout* layout) {
+    unsigned fields = messageFields(msg.type);
+    ByteWriter w(out);
+    w.u8(binary_version);
+    w.u8(static_cast<unsigned>(msg.type));
+    if (fields & RoomIdField) w.bytes(msg.room_id, 255, false);
+    if (fields & SeatField) w.small(msg.seat);
+    if (fields & ActionField) w.small(msg.action);
+    if (fields & TileField) w.small(msg.tile);
+    if (fields & TilesField) w.tiles(msg.tiles);
+    if (fields & ErrorField) w.bytes(msg.error_msg, 0xFFFF, true);
+    if (fields & StateField) writeState(w, msg.state, layout);
+    if (fields & SeqField) w.varint(msg.seq);
+    if (fields & EventsField) {
+        if (msg.events.size() > 255) w.invalid();
+        size_t n = msg.events.size() > 255 ? 255 : msg.events.size();
+        w.u8(static_cast<unsigned>(n));
+        for (size_t i = 0; i < n; ++i) {
+            const StateEvent& e = msg.events[i];
+            w.u8(static_cast<unsigned>(e.kind));
+            w.small(e.seat);
+            w.small(e.tile);
+            w.varint(e.value);
+        }
+    }
+    if (fields & TokenField) w.bytes(msg.token, 255, false);
+    return w.good();
+}
+
+bool parseBinary(const char* data, size_t size, GameMessage& msg, const char** error) {
+    ByteReader r(data, size);
+    auto report = [&]() {
+        if (error) *error = r.error();
+        return false;
+    };
+
+    unsigned version, type;
+    if (!r.u8(version)) return report();
+    if (version != binary_version) {
+        r.fail("unsupported version");
+        return report();
+    }
+    if (!r.u8(type)) return report();
+    if (type >= static_cast<unsigned>(message_type_count)) {
+        r.fail("unknown message type");
+        return report();
+    }
+
+    msg.type = static_cast<MessageType>(type);
+    msg.room_id.clear();
+    msg.seat = msg.action = msg.tile = -1;
+    msg.tiles.clear();
+    msg.error_msg.clear();
+    msg.seq = -1;
+    msg.events.clear();
+    msg.token.clear();
+    unsigned fields = messageFields(msg.type);
+    if (fields & StateField) msg.state = GameState();
+
+    unsigned count;
+    if ((fields & RoomIdField) && !r.bytes(msg.room_id, false)) return report();
+    if ((fields & SeatField) && !r.small(msg.seat)) return report();
+    if ((fields & ActionField) && !r.small(msg.action)) return report();
+    if ((fields & TileField) && !r.small(msg.tile)) return report();
+    if ((fields & TilesField) && !(r.u8(count) && r.tiles(msg.tiles, count))) return report();
+    if ((fields & ErrorField) && !r.bytes(msg.error_msg, true)) return report();
+    if ((fields & StateField) && !readState(r, msg.state)) return report();
+    if ((fields & SeqField) && !r.varint(msg.seq)) return report();
+    if (fields & EventsField) {
+        if (!r.u8(count)) return report();
+        for (unsigned i = 0; i < count; ++i) {
+            unsigned kind;
+            StateEvent e;
+            if (!r.u8(kind) || !r.small(e.seat) || !r.small(e.tile) || !r.varint(e.value)) return report();
+            if (kind > static_cast<unsigned>(StateEventKind::Sticks)) {
+                r.fail("unknown event kind");
+                return report();
+            }
+            e.kind = static_cast<StateEventKind>(kind);
+            msg.events.push_back(e);
+        }
+    }
+    if ((fields & TokenField) && !r.bytes(msg.token, false)) return report();
+    if (!r.atEnd()) {
+        r.fail("trailing bytes");
+        return report();
+    }
+    return true;
+}
+
+static GameMessage notEncodable() {
+    GameMessage error;
+    error.type = MessageType::Error;
+    error.error_msg = "message not encodable";
+    return error;
+}
+
+const std::string& encodeMessage(const GameMessage& msg, WireFormat format) {
+    if (format == WireFormat::Json) return msg.serialize();
+
+    thread_local std::string buffer;
+    buffer.clear();
+    if (!appendBinary(msg, buffer)) {
+        buffer.clear();
+        appendBinary(notEncodable(), buffer);
+    }
+    return buffer;
+}
+
+bool decodeMessage(const std::string& data, WireFormat format, GameMessage& msg, const char** error) {
+    if (format == WireFormat::Json) return msg.parseJSON(data.data(), data.size(), error);
+    return parseBinary(data.data(), data.size(), msg, error);
+}
+
+SharedMessage shareMessage(const std::string& bytes) {
+    return std::make_shared<const std::string>(bytes);
+}
+
+SharedMessage encodeShared(const GameMessage& msg, WireFormat format) {
+    // 从线程复用的缓冲区复制一次，之后只传引用
+    return shareMessage(encodeMessage(msg, format));
+}
+
+bool StateViewEncoder::reset(const GameState& state, int seq, WireFormat wire_format) {
+    format = wire_format;
+    last_draw_seat = state.current_player;
+
+    // 公共部分: 所有手牌隐藏、没有最后摸牌
+    base_msg.type = MessageType::GameState;
+    base_msg.seq = seq;
+    base_msg.state = state;
+    for (HandTiles& hand : base_msg.state.hands) hand.assign(hand.size(), -1);
+    base_msg.state.last_draw = -1;
+
+    base.clear();
+    bool ok = true;
+    if (format == WireFormat::Json) {
+        base_msg.appendJSON(base, &layout);
+    } else {
+        ok = appendBinary(base_msg, base, &layout);
+    }
+
+    // 各座位的私有部分: 自己的手牌和最后摸牌
+    for (int i = 0; i < 4 && ok; ++i) {
+        const HandTiles& hand = state.hands[i];
+        std::string& out = own_hand[i];
+        out.clear();
+        if (format == WireFormat::Json) {
+            JsonWriter w(out);
+            w.tiles(hand.data(), hand.size());
+        } else {
+            ByteWriter w(out);
+            w.packed(hand.data(), hand.size());
+        }
+    }
+    last_draw.clear();
+    if (format == WireFormat::Json) {
+        JsonWriter w(last_draw);
+        w.value(state.last_draw);
+    } else {
+        ByteWriter w(last_draw);
+        w.small(state.last_draw);
+        ok = ok && w.good();
+    }
+
+    if (!ok) {
+        base = encodeMessage(notEncodable(), format);
+    }
+    valid = ok;
+    return ok;
+}
+
+const std::string& StateViewEncoder::encodeFor(int seat) {
+    if (!valid || seat < 0 || seat >= 4) return base;
+
+    const ViewLayout& l = layout;
+    out.clear();
+    out.append(base, 0, l.hand_begin[seat]);
+    out.append(own_hand[seat]);
+    out.append(base, l.hand_end[seat], l.last_draw_begin - l.hand_end[seat]);
+    if (seat == last_draw_seat) {
+        out.append(last_draw);
+    } else {
+        out.append(base, l.last_draw_begin, l.last_draw_end - l.last_draw_begin);
+    }
+    out.append(base, l.last_draw_end, std::string::npos);
+    return out;
+}
@@ -0,0 +1,74 @@
+#ifndef WIRE_PROTOCOL_H
+#define WIRE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <string>
+#include "game_state.h"
+
+// 连接使用的消息编码，在 WebSocket 握手时按子协议确定
+enum class WireFormat {
+    Json,    // "mahjong.json": 文本帧，便于调试
+    Binary   // "mahjong.bin.1": 二进制帧，见下方格式说明
+};
+
+extern const char* const json_protocol;
+extern const char* const binary_protocol;
+const uint8_t binary_version = 1;
+
+// 从客户端提供的子协议列表 (Sec-WebSocket-Protocol，逗号分隔) 中选择
+// 优先二进制；都不认识或没有提供时使用 JSON
+WireFormat negotiateWireFormat(const std::string& offered);
+const char* wireProtocolName(WireFormat format);
+
+// 二进制格式 (版本 1)
+//   u8 版本, u8 type, 之后按 RoomId, Seat, Action, Tile, Tiles, Error, State, Seq, Events, Token 的顺序只写 type 携带的字段
+//   座位 / 动作 / 牌: u8 (255 表示 -1)
+//   room_id, token: u8 长度 + 字节；error_msg: u16 长度 + 字节；tiles: u8 个数 + 每张一个字节
+//   state: 场风, 庄家, 当前玩家, 剩余牌数 (各 u8), 本场, 立直棒, 4 家点数 (zigzag varint),
+//          u16 标志 (位 0-3 各家立直, 位 4-9 自摸 / 荣和 / 立直 / 吃 / 碰 / 杠),
+//          4 家手牌 (u8 个数，最高位为 1 表示全部是暗牌且不再写牌), 4 家牌河 (u8 个数 + 牌),
+//          最后摸牌, 最后弃牌, 弃牌者 (各 u8)
+//   seq: zigzag varint；events: u8 个数 + 每个事件 (u8 种类, u8 座位, u8 牌, zigzag varint 值)
+//   多字节整数都是小端
+// 值超出字节范围时返回 false (out 中可能已写入部分内容)
+// layout 非空时记录各家手牌和最后摸牌在 out 中的位置
+bool appendBinary(const GameMessage& msg, std::string& out, ViewLayout* layout = nullptr);
+// 检查版本、类型、长度和剩余字节；失败时 error 指向静态的错误说明
+bool parseBinary(const char* data, size_t size, GameMessage& msg, const char** error = nullptr);
+
+// 按连接的格式编码到当前线程复用的缓冲区 (每种格式各一个)，引用在本线程下一次同格式编码前有效
+// 无法编码的消息改为发送一条 Error 消息
+const std::string& encodeMessage(const GameMessage& msg, WireFormat format);
+bool decodeMessage(const std::string& data, WireFormat format, GameMessage& msg, const char** error = nullptr);
+
+// 编码好的消息: 不可变、引用计数，广播时各连接的发送队列共用同一份
+using SharedMessage = std::shared_ptr<const std::string>;
+SharedMessage shareMessage(const std::string& bytes);
+SharedMessage encodeShared(const GameMessage& msg, WireFormat format);
+
+// 同一个完整状态的各座位 GameState 快照
+// 公共部分 (他家手牌只有张数) 只编码一次，各座位只换上自己的手牌和最后摸牌，
+// 结果与按 getViewFor(seat) 复制后再 encodeMessage 的字节相同
+class StateViewEncoder {
+private:
+    WireFormat format = WireFormat::Json;
+    GameMessage base_msg;              // 复用容量
+    std::string base;
+    ViewLayout layout;
+    std::array<std::string, 4> own_hand;
+    std::string last_draw;
+    int last_draw_seat = -1;
+    bool valid = false;
+    std::string out;
+
+public:
+    // 无法编码时返回 false，之后 encodeFor 返回一条 Error 消息
+    bool reset(const GameState& state, int seq, WireFormat wire_format);
+    // 引用在下一次 reset / encodeFor 之前有效
+    const std::string& encodeFor(int seat);
+};
+
+#endif // WIRE_PROTOCOL_H
@@ -0,0 +1,1019 @@
+#include "archive_import.h"
+#include "json_reader.h"
+#include "tiles.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+static const size_t max_tag_size = 4096;     // 天凤单个标签的长度上限
+static const size_t max_line_size = 1 << 16; // mjai 单行的长度上限 (同 JsonLimits::max_size)
+static const int dora_position = 126;        // 引擎牌山中宝牌指示牌的位置
+
+static bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool detectArchiveFormat(const std::string& path, ArchiveFormat& format) {
+    if (endsWith(path, ".xml") || endsWith(path, ".mjlog")) {
+        format = ArchiveFormat::Tenhou;
+        return true;
+    }
+    if (endsWith(path, ".json") || endsWith(path, ".jsonl") || endsWith(path, ".mjson")) {
+        format = ArchiveFormat::Mjai;
+        return true;
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    int c;
+    while ((c = std::fgetc(file)) != EOF && (c == ' ' || c == '\t' || c == '\r' || c == '\n')) {
+    }
+    std::fclose(file);
+    if (c == '<') format = ArchiveFormat::Tenhou;
+    else if (c == '{') format = ArchiveFormat::Mjai;
+    else return false;
+    return true;
+}
+
+// ChunkReader 实现
+ChunkReader::ChunkReader(size_t chunk_size) : file(nullptr), buffer(std::max<size_t>(chunk_size, 1)), pos(0), end(0) {
+}
+
+ChunkReader::~ChunkReader() {
+    close();
+}
+
+bool ChunkReader::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "rb");
+    return file != nullptr;
+}
+
+void ChunkReader::close() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    pos = end = 0;
+}
+
+bool ChunkReader::fill() {
+    if (!file) return false;
+    pos = 0;
+    end = std::fread(buffer.data(), 1, buffer.size(), file);
+    return end > 0;
+}
+
+bool ChunkReader::readUntil(char delim, std::string& out, size_t max_size, bool* truncated) {
+    out.clear();
+    if (truncated) *truncated = false;
+    bool any = false;
+    while (true) {
+        if (pos == end && !fill()) return any;
+        any = true;
+        const char* start = buffer.data() + pos;
+        const char* found = static_cast<const char*>(std::memchr(start, delim, end - pos));
+        size_t length = found ? static_cast<size_t>(found - start) : end - pos;
+        size_t room = max_size > out.size() ? max_size - out.size() : 0;
+        if (length > room && truncated) *truncated = true;
+        out.append(start, std::min(length, room));
+        pos += length;
+        if (found) {
+            pos++;
+            return true;
+        }
+    }
+}
+
+void ArchiveRound::clear() {
+    dealer = 0;
+    round_wind = Wind::East;
+    honba = 0;
+    riichi_sticks = 0;
+    scores.fill(0);
+    for (TileIndexList& hand : hands) hand.clear();
+    dora_indicator = invalid_tile_index;
+    events.clear();
+    finished = false;
+    winner = -1;
+    from_player = -1;
+    deltas.fill(0);
+    unsupported.clear();
+}
+
+// 逗号分隔的整数 (天凤属性值)
+static bool parseIntList(const std::string& text, std::vector<int>& out) {
+    out.clear();
+    if (text.empty()) return true;
+    const char* p = text.c_str();
+    while (true) {
+        char* stop;
+        long value = std::strtol(p, &stop, 10);
+        if (stop == p || value < -1000000 || value > 1000000) return false;
+        out.push_back(static_cast<int>(value));
+        if (*stop == '\0') return true;
+        if (*stop != ',') return false;
+        p = stop + 1;
+    }
+}
+
+static bool parseTileList(const std::string& text, TileIndexList& out) {
+    std::vector<int> values;
+    if (!parseIntList(text, values)) return false;
+    out.clear();
+    for (int v : values) {
+        if (v < 0 || v >= 136) return false;
+        out.push_back(v);
+    }
+    return true;
+}
+
+// 天凤解析: 按 '<' / '>' 切出标签，只看本局需要的几种
+class TenhouParser : public ArchiveParser {
+private:
+    ChunkReader reader;
+    std::string text;
+    std::string tag;
+    bool pending_init;  // tag 中已经是下一局的 INIT
+
+    bool readTag(bool& truncated) {
+        if (!reader.readUntil('<', text, 0)) return false;
+        return reader.readUntil('>', tag, max_tag_size, &truncated);
+    }
+
+    static std::string tagName(const std::string& t) {
+        size_t n = 0;
+        while (n < t.size() && t[n] != ' ' && t[n] != '/') n++;
+        return t.substr(0, n);
+    }
+
+    static bool attribute(const std::string& t, const char* name, std::string& value) {
+        std::string key = std::string(" ") + name + "=\"";
+        size_t start = t.find(key);
+        if (start == std::string::npos) return false;
+        start += key.size();
+        size_t stop = t.find('"', start);
+        if (stop == std::string::npos) return false;
+        value.assign(t, start, stop - start);
+        return true;
+    }
+
+    static bool intAttribute(const std::string& t, const char* name, int& value) {
+        std::string s;
+        std::vector<int> values;
+        if (!attribute(t, name, s) || !parseIntList(s, values) || values.size() != 1) return false;
+        value = values[0];
+        return true;
+    }
+
+    // 摸牌 (T/U/V/W) 或弃牌 (D/E/F/G) 后跟牌号，返回座位
+    static int tileTag(const std::string& name, const char* letters, TileIndex& tile) {
+        if (name.size() < 2 || name.size() > 4) return -1;
+        const char* letter = std::strchr(letters, name[0]);
+        if (!letter) return -1;
+        int value = 0;
+        for (size_t i = 1; i < name.size(); ++i) {
+            if (name[i] < '0' || name[i] > '9') return -1;
+            value = value * 10 + (name[i] - '0');
+        }
+        tile = value;
+        return static_cast<int>(letter - letters);
+    }
+
+    bool parseInit(ArchiveRound& round, std::string& error) {
+        std::string s;
+        std::vector<int> seed, ten;
+        if (!attribute(tag, "seed", s) || !parseIntList(s, seed) || seed.size() != 6) {
+            error = "INIT: bad seed";
+            return false;
+        }
+        if (!attribute(tag, "ten", s) || !parseIntList(s, ten) || ten.size() != 4) {
+            error = "INIT: bad ten";
+            return false;
+        }
+        if (!intAttribute(tag, "oya", round.dealer) || round.dealer < 0 || round.dealer > 3) {
+            error = "INIT: bad oya";
+            return false;
+        }
+        if (seed[0] < 0 || seed[0] >= 16 || seed[1] < 0 || seed[2] < 0 || seed[5] < 0 || seed[5] >= 136) {
+            error = "INIT: seed out of range";
+            return false;
+        }
+        round.round_wind = static_cast<Wind>(seed[0] / 4);
+        round.honba = seed[1];
+        round.riichi_sticks = seed[2];
+        round.dora_indicator = seed[5];
+        for (int i = 0; i < 4; ++i) round.scores[i] = ten[i] * 100;
+
+        for (int seat = 0; seat < 4; ++seat) {
+            char name[] = "hai0";
+            name[3] = static_cast<char>('0' + seat);
+            if (!attribute(tag, name, s) || !parseTileList(s, round.hands[seat])) {
+                error = std::string("INIT: bad ") + name;
+                return false;
+            }
+            if (round.hands[seat].empty()) round.unsupported = "three-player game";
+        }
+        return true;
+    }
+
+    // 和牌与流局的 sc 属性: 每家 (点数, 变化) 两个数，单位 100 点
+    bool addScoreChanges(ArchiveRound& round, std::string& error) {
+        std::string s;
+        std::vector<int> sc;
+        if (!attribute(tag, "sc", s) || !parseIntList(s, sc) || sc.size() < 8) {
+            error = tagName(tag) + ": bad sc";
+            return false;
+        }
+        for (int i = 0; i < 4; ++i) round.deltas[i] += sc[i * 2 + 1] * 100;
+        return true;
+    }
+
+    bool parseTag(ArchiveRound& round, std::string& error) {
+        std::string name = tagName(tag);
+        TileIndex tile;
+        int seat;
+        if ((seat = tileTag(name, "TUVW", tile)) >= 0 || (seat = tileTag(name, "DEFG", tile)) >= 0) {
+            bool draw = std::strchr("TUVW", name[0]) != nullptr;
+            if (tile >= 136) {
+                error = name + ": bad tile";
+                return false;
+            }
+            round.events.push_back({draw ? ArchiveEventKind::Draw : ArchiveEventKind::Discard,
+                                    static_cast<uint8_t>(seat), static_cast<uint8_t>(tile), 0});
+        } else if (name == "N") {
+            if (round.unsupported.empty()) round.unsupported = "call";
+        } else if (name == "DORA") {
+            if (round.unsupported.empty()) round.unsupported = "kan dora";
+        } else if (name == "REACH") {
+            int step;
+            if (!intAttribute(tag, "who", seat) || seat < 0 || seat > 3 || !intAttribute(tag, "step", step)) {
+                error = "REACH: bad attributes";
+                return false;
+            }
+            // 宣言时记事件，宣言牌通过后 (step 2) 支付立直棒，和引擎的点数变化口径一致
+            if (step == 1) {
+                round.events.push_back({ArchiveEventKind::Riichi, static_cast<uint8_t>(seat), 0, 0});
+            } else if (step == 2) {
+                round.deltas[seat] -= 1000;
+            }
+        } else if (name == "AGARI") {
+            int from;
+            if (!intAttribute(tag, "who", seat) || seat < 0 || seat > 3 ||
+                !intAttribute(tag, "fromWho", from) || from < 0 || from > 3) {
+                error = "AGARI: bad attributes";
+                return false;
+            }
+            if (round.finished) {
+                if (round.unsupported.empty()) round.unsupported = "multiple ron";
+                return true;
+            }
+            if (!addScoreChanges(round, error)) return false;
+            round.finished = true;
+            round.winner = seat;
+            round.from_player = from == seat ? -1 : from;
+            round.events.push_back({ArchiveEventKind::Win, static_cast<uint8_t>(seat), 0, static_cast<uint8_t>(from)});
+        } else if (name == "RYUUKYOKU") {
+            std::string type;
+            if (attribute(tag, "type", type) && round.unsupported.empty()) {
+                round.unsupported = "abortive draw (" + type + ")";
+            }
+            if (!addScoreChanges(round, error)) return false;
+            round.finished = true;
+        }
+        return true;
+    }
+
+public:
+    explicit TenhouParser(size_t chunk_size) : reader(chunk_size), pending_init(false) {
+    }
+
+    bool open(const std::string& path) {
+        return reader.open(path);
+    }
+
+    bool next(ArchiveRound& round, std::string& error) override {
+        round.clear();
+        error.clear();
+        bool truncated = false;
+
+        // 找到下一局的 INIT
+        while (!pending_init) {
+            if (!readTag(truncated)) return false;
+            pending_init = !truncated && tagName(tag) == "INIT";
+        }
+        pending_init = false;
+        bool ok = parseInit(round, error);
+
+        // 读到下一个 INIT 或文件结束；出错后只跳过本局剩下的标签
+        while (readTag(truncated)) {
+            if (truncated) {
+                if (ok) error = "tag too long";
+                ok = false;
+                continue;
+            }
+            if (tagName(tag) == "INIT") {
+                pending_init = true;
+                break;
+            }
+            if (ok) ok = parseTag(round, error);
+        }
+        if (ok && !round.finished) error = "round has no result";
+        return true;
+    }
+};
+
+// mjai 的一行
+struct MjaiEvent {
+    std::string type;
+    std::string pai;
+    std::string bakaze;
+    std::string dora_marker;
+    std::string reason;
+    int actor = -1;
+    int target = -1;
+    int kyoku = 0;
+    int honba = 0;
+    int kyotaku = 0;
+    int oya = 0;
+    bool tsumogiri = false;
+    std::vector<int> scores;
+    std::vector<int> deltas;
+    std::array<std::vector<std::string>, 4> tehais;
+};
+
+static bool readTehais(JsonReader& r, std::array<std::vector<std::string>, 4>& tehais) {
+    if (!r.beginArray()) return false;
+    size_t seat = 0;
+    while (r.nextElement()) {
+        if (seat >= 4) return r.fail("more than 4 tehais");
+        std::vector<std::string>& hand = tehais[seat++];
+        if (!r.beginArray()) return false;
+        std::string tile;
+        while (r.nextElement()) {
+            if (hand.size() >= 14) return r.fail("tehai too long");
+            if (!r.readString(tile)) return false;
+            hand.push_back(tile);
+        }
+        if (r.failed()) return false;
+    }
+    return !r.failed();
+}
+
+static bool parseMjaiEvent(const std::string& line, MjaiEvent& ev, std::string& error) {
+    ev = MjaiEvent();
+    JsonReader r(line.data(), line.size());
+    if (r.beginObject()) {
+        const char* key;
+        size_t length;
+        while (r.nextKey(key, length)) {
+            bool ok;
+            if (keyIs(key, length, "type")) ok = r.readString(ev.type);
+            else if (keyIs(key, length, "actor")) ok = r.readInt(ev.actor);
+            else if (keyIs(key, length, "target")) ok = r.readInt(ev.target);
+            else if (keyIs(key, length, "pai")) ok = r.readString(ev.pai);
+            else if (keyIs(key, length, "bakaze")) ok = r.readString(ev.bakaze);
+            else if (keyIs(key, length, "dora_marker")) ok = r.readString(ev.dora_marker);
+            else if (keyIs(key, length, "reason")) ok = r.readString(ev.reason);
+            else if (keyIs(key, length, "kyoku")) ok = r.readInt(ev.kyoku);
+            else if (keyIs(key, length, "honba")) ok = r.readInt(ev.honba);
+            else if (keyIs(key, length, "kyotaku")) ok = r.readInt(ev.kyotaku);
+            else if (keyIs(key, length, "oya")) ok = r.readInt(ev.oya);
+            else if (keyIs(key, length, "tsumogiri")) ok = r.readBool(ev.tsumogiri);
+            else if (keyIs(key, length, "scores")) ok = r.readInts(ev.scores);
+            else if (keyIs(key, length, "deltas")) ok = r.readInts(ev.deltas);
+            else if (keyIs(key, length, "tehais")) ok = readTehais(r, ev.tehais);
+            else ok = r.skipValue();
+            if (!ok) break;
+        }
+    }
+    if (r.failed() || !r.finish()) {
+        error = std::string("json: ") + r.error();
+        return false;
+    }
+    if (ev.type.empty()) {
+        error = "event without type";
+        return false;
+    }
+    return true;
+}
+
+// mjai 牌名 ("1m"-"9m"、"5mr"、"E"/"S"/"W"/"N"/"P"/"F"/"C") 转为牌种 (0-33)
+static bool parseMjaiTile(const std::string& name, int& kind, bool& red) {
+    static const char honors[] = "ESWNPFC";
+    red = false;
+    if (name.size() == 1) {
+        const char* h = std::strchr(honors, name[0]);
+        if (!h || name[0] == '\0') return false;
+        kind = 27 + static_cast<int>(h - honors);
+        return true;
+    }
+    if (name.size() < 2 || name.size() > 3 || name[0] < '1' || name[0] > '9') return false;
+    const char* suit = std::strchr("mps", name[1]);
+    if (!suit || name[1] == '\0') return false;
+    if (name.size() == 3) {
+        if (name[2] != 'r' || name[0] != '5') return false;
+        red = true;
+    }
+    kind = static_cast<int>(suit - "mps") * 9 + (name[0] - '1');
+    return true;
+}
+
+static bool isMjaiSeat(int seat) {
+    return seat >= 0 && seat <= 3;
+}
+
+// mjai 解析: 每行一个事件，按 start_kyoku / end_kyoku 切分成局
+// mjai 只记牌种，这里按出现顺序给每张牌分配编号: 赤五用 0 号，其余的五先用 1-3 号
+class MjaiParser : public ArchiveParser {
+private:
+    ChunkReader reader;
+    std::string line;
+    MjaiEvent event;
+    bool pending_start;  // event 中已经是下一局的 start_kyoku
+    bool used[136];
+    std::array<TileIndexList, 4> held;  // 各家当前的手牌编号 (用于确定弃牌)
+    std::array<TileIndex, 4> drawn;     // 各家最近摸到的牌
+
+    bool readEvent(std::string& error) {
+        bool truncated;
+        while (reader.readUntil('\n', line, max_line_size, &truncated)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.find_first_not_of(" \t") == std::string::npos) continue;
+            if (truncated) {
+                event = MjaiEvent();
+                error = "line too long";
+                return true;
+            }
+            error.clear();
+            parseMjaiEvent(line, event, error);
+            return true;
+        }
+        return false;
+    }
+
+    bool allocate(const std::string& name, TileIndex& tile) {
+        int kind;
+        bool red;
+        if (!parseMjaiTile(name, kind, red)) return false;
+        static const int five_order[4] = {1, 2, 3, 0};
+        static const int plain_order[4] = {0, 1, 2, 3};
+        bool five = kind < 27 && kind % 9 == 4;
+        const int* order = five ? five_order : plain_order;
+        for (int i = 0; i < (red ? 1 : 4); ++i) {
+            int id = kind * 4 + (red ? 0 : order[i]);
+            if (!used[id]) {
+                used[id] = true;
+                tile = id;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 从手牌里找出弃掉的那张: 赤五只能是 0 号，普通的五优先不用 0 号；
+    // 同种牌有几张时按 tsumogiri 决定是不是刚摸到的那张 (立直后只能摸切，编号必须对上)
+    bool release(int seat, const std::string& name, bool tsumogiri, TileIndex& tile) {
+        int kind;
+        bool red;
+        if (!parseMjaiTile(name, kind, red)) return false;
+        bool five = kind < 27 && kind % 9 == 4;
+        TileIndexList& hand = held[seat];
+        auto best = hand.end();
+        int best_rank = 0;
+        for (auto it = hand.begin(); it != hand.end(); ++it) {
+            if (*it / 4 != kind) continue;
+            bool zero = *it % 4 == 0;
+            if (red && !zero) continue;
+            int rank = (!red && five && zero ? 2 : 0) + ((*it == drawn[seat]) != tsumogiri ? 1 : 0);
+            if (best == hand.end() || rank < best_rank) {
+                best = it;
+                best_rank = rank;
+            }
+        }
+        if (best == hand.end()) return false;
+        tile = *best;
+        hand.erase(best);
+        return true;
+    }
+
+    bool startRound(ArchiveRound& round, std::string& error) {
+        static const char winds[] = "ESWN";
+        std::fill(std::begin(used), std::end(used), false);
+        const char* wind = event.bakaze.size() == 1 ? std::strchr(winds, event.bakaze[0]) : nullptr;
+        if (!wind || event.bakaze[0] == '\0') {
+            error = "start_kyoku: bad bakaze";
+            return false;
+        }
+        if (!isMjaiSeat(event.oya) || event.honba < 0 || event.kyotaku < 0 || event.scores.size() != 4) {
+            error = "start_kyoku: bad fields";
+            return false;
+        }
+        round.round_wind = static_cast<Wind>(wind - winds);
+        round.dealer = event.oya;
+        round.honba = event.honba;
+        round.riichi_sticks = event.kyotaku;
+        for (int i = 0; i < 4; ++i) round.scores[i] = event.scores[i];
+        drawn.fill(invalid_tile_index);
+        for (int seat = 0; seat < 4; ++seat) {
+            held[seat].clear();
+            for (const std::string& name : event.tehais[seat]) {
+                TileIndex tile;
+                if (!allocate(name, tile)) {
+                    error = "start_kyoku: bad tile " + name;
+                    return false;
+                }
+                held[seat].push_back(tile);
+            }
+            round.hands[seat] = held[seat];
+        }
+        if (!event.dora_marker.empty() && !allocate(event.dora_marker, round.dora_indicator)) {
+            error = "start_kyoku: bad dora_marker " + event.dora_marker;
+            return false;
+        }
+        return true;
+    }
+
+    bool addEvent(ArchiveRound& round, std::string& error) {
+        const std::string& type = event.type;
+        if (type == "tsumo" || type == "dahai") {
+            TileIndex tile;
+            if (!isMjaiSeat(event.actor)) {
+                error = type + ": bad actor";
+                return false;
+            }
+            bool draw = type == "tsumo";
+            if (draw ? !allocate(event.pai, tile) : !release(event.actor, event.pai, event.tsumogiri, tile)) {
+                error = type + ": bad tile " + event.pai;
+                return false;
+            }
+            if (draw) {
+                held[event.actor].push_back(tile);
+                drawn[event.actor] = tile;
+            }
+            round.events.push_back({draw ? ArchiveEventKind::Draw : ArchiveEventKind::Discard,
+                                    static_cast<uint8_t>(event.actor), static_cast<uint8_t>(tile), 0});
+        } else if (type == "reach") {
+            if (!isMjaiSeat(event.actor)) {
+                error = "reach: bad actor";
+                return false;
+            }
+            round.events.push_back({ArchiveEventKind::Riichi, static_cast<uint8_t>(event.actor), 0, 0});
+        } else if (type == "reach_accepted") {
+            if (!isMjaiSeat(event.actor)) {
+                error = "reach_accepted: bad actor";
+                return false;
+            }
+            round.deltas[event.actor] -= 1000;
+        } else if (type == "hora") {
+            if (!isMjaiSeat(event.actor) || !isMjaiSeat(event.target) || event.deltas.size() != 4) {
+                error = "hora: bad fields";
+                return false;
+            }
+            if (round.finished) {
+                if (round.unsupported.empty()) round.unsupported = "multiple ron";
+                return true;
+            }
+            for (int i = 0; i < 4; ++i) round.deltas[i] += event.deltas[i];
+            round.finished = true;
+            round.winner = event.actor;
+            round.from_player = event.target == event.actor ? -1 : event.target;
+            round.events.push_back({ArchiveEventKind::Win, static_cast<uint8_t>(event.actor), 0,
+                                    static_cast<uint8_t>(event.target)});
+        } else if (type == "ryukyoku") {
+            if (!event.reason.empty() && event.reason != "fanpai" && round.unsupported.empty()) {
+                round.unsupported = "abortive draw (" + event.reason + ")";
+            }
+            if (event.deltas.size() == 4) {
+                for (int i = 0; i < 4; ++i) round.deltas[i] += event.deltas[i];
+            }
+            round.finished = true;
+        } else if (type == "chi" || type == "pon" || type == "daiminkan" || type == "ankan" || type == "kakan") {
+            if (round.unsupported.empty()) round.unsupported = "call";
+        } else if (type == "dora") {
+            if (round.unsupported.empty()) round.unsupported = "kan dora";
+        }
+        return true;
+    }
+
+public:
+    explicit MjaiParser(size_t chunk_size) : reader(chunk_size), pending_start(false), used() {
+    }
+
+    bool open(const std::string& path) {
+        return reader.open(path);
+    }
+
+    bool next(ArchiveRound& round, std::string& error) override {
+        round.clear();
+        error.clear();
+
+        // 局外的行: 格式错误的单独算一条坏记录，其余 (start_game 等) 跳过
+        while (!pending_start) {
+            if (!readEvent(error)) return false;
+            if (!error.empty()) return true;
+            pending_start = event.type == "start_kyoku";
+        }
+        pending_start = false;
+        bool ok = startRound(round, error);
+
+        // 读到 end_kyoku；下一局的 start_kyoku 提前出现说明本局不完整
+        bool ended = false;
+        std::string line_error;
+        while (readEvent(line_error)) {
+            if (!line_error.empty()) {
+                if (ok) error = line_error;
+                ok = false;
+                continue;
+            }
+            if (event.type == "start_kyoku") {
+                pending_start = true;
+                break;
+            }
+            if (event.type == "end_kyoku") {
+                ended = true;
+                break;
+            }
+            if (ok) ok = addEvent(round, error);
+        }
+        if (ok && !ended) error = "round has no end_kyoku";
+        else if (ok && !round.finished) error = "round has no result";
+        return true;
+    }
+};
+
+std::unique_ptr<ArchiveParser> openArchive(const std::string& path, ArchiveFormat format, size_t chunk_size) {
+    if (format == ArchiveFormat::Tenhou) {
+        std::unique_ptr<TenhouParser> parser(new TenhouParser(chunk_size));
+        if (!parser->open(path)) return nullptr;
+        return parser;
+    }
+    std::unique_ptr<MjaiParser> parser(new MjaiParser(chunk_size));
+    if (!parser->open(path)) return nullptr;
+    return parser;
+}
+
+// ArchiveScript 实现
+void ArchiveScript::reset(const ArchiveRound* r) {
+    round = r;
+    cursor = 0;
+    divergence.clear();
+    std::fill(std::begin(last), std::end(last), -1);
+}
+
+static const char* eventName(ArchiveEventKind kind) {
+    switch (kind) {
+        case ArchiveEventKind::Draw: return "draw";
+        case ArchiveEventKind::Discard: return "discard";
+        case ArchiveEventKind::Riichi: return "riichi";
+        case ArchiveEventKind::Win: return "win";
+    }
+    return "?";
+}
+
+static std::string describeEvent(const ArchiveRound* round, size_t index) {
+    if (!round || index >= round->events.size()) return "end of log";
+    const ArchiveEvent& e = round->events[index];
+    std::ostringstream ss;
+    ss << eventName(e.kind) << " by seat " << (int)e.seat;
+    if (e.kind == ArchiveEventKind::Draw || e.kind == ArchiveEventKind::Discard) ss << " " << getTileName(e.tile);
+    return ss.str();
+}
+
+static const ArchiveEvent* peekEvent(const ArchiveScript& script) {
+    if (!script.round || script.cursor >= script.round->events.size()) return nullptr;
+    return &script.round->events[script.cursor];
+}
+
+int ArchiveScript::action(int seat, TileIndex drawn, int fallback) {
+    int& given = last[static_cast<int>(DecisionKind::Action)];
+    given = fallback;
+    if (!divergence.empty()) return fallback;
+
+    const ArchiveEvent* e = peekEvent(*this);
+    if (!e || e->kind != ArchiveEventKind::Draw || e->seat != seat || e->tile != drawn) {
+        std::ostringstream ss;
+        ss << "event #" << cursor << ": engine drew " << getTileName(drawn) << " for seat " << seat
+           << ", log has " << describeEvent(round, cursor);
+        divergence = ss.str();
+        return fallback;
+    }
+    cursor++;
+
+    e = peekEvent(*this);
+    if (e && e->seat == seat) {
+        if (e->kind == ArchiveEventKind::Win && e->from == seat) {
+            cursor++;
+            return given = static_cast<int>(Action::Win);
+        }
+        if (e->kind == ArchiveEventKind::Riichi) {
+            cursor++;
+            return given = static_cast<int>(Action::Riichi);
+        }
+        if (e->kind == ArchiveEventKind::Discard) {
+            cursor++;
+            return given = e->tile;
+        }
+    }
+    std::ostringstream ss;
+    ss << "event #" << cursor << ": seat " << seat << " to act, log has " << describeEvent(round, cursor);
+    divergence = ss.str();
+    return fallback;
+}
+
+int ArchiveScript::riichiDiscard(int seat, int fallback) {
+    int& given = last[static_cast<int>(DecisionKind::RiichiDiscard)];
+    given = fallback;
+    if (!divergence.empty()) return fallback;
+
+    const ArchiveEvent* e = peekEvent(*this);
+    if (!e || e->kind != ArchiveEventKind::Discard || e->seat != seat) {
+        std::ostringstream ss;
+        ss << "event #" << cursor << ": seat " << seat << " to discard after riichi, log has "
+           << describeEvent(round, cursor);
+        divergence = ss.str();
+        return fallback;
+    }
+    cursor++;
+    return given = e->tile;
+}
+
+int ArchiveScript::response(int seat, int from_seat, bool can_ron) {
+    int& given = last[static_cast<int>(DecisionKind::Response)];
+    given = static_cast<int>(Action::Pass);
+    if (!divergence.empty()) return given;
+
+    // 记录中只有和牌会打断摸打，其余情况一律过
+    const ArchiveEvent* e = peekEvent(*this);
+    if (!e || e->kind != ArchiveEventKind::Win || e->seat != seat || e->from != from_seat) return given;
+    if (!can_ron) {
+        std::ostringstream ss;
+        ss << "event #" << cursor << ": engine does not allow seat " << seat << " to ron";
+        divergence = ss.str();
+        return given;
+    }
+    cursor++;
+    return given = static_cast<int>(Action::Win);
+}
+
+// ArchivePlayer 实现
+ArchivePlayer::ArchivePlayer(ArchiveScript* s) : Player("Archive"), script(s) {
+}
+
+int ArchivePlayer::decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) {
+    (void)can_ankan;
+    size_t index = script->cursor;
+    int action = script->action(seat, drawn_tile, drawn_tile);
+    if (!script->divergence.empty()) return action;
+
+    const char* problem = nullptr;
+    if (action == static_cast<int>(Action::Win) && !can_tsumo) problem = "tsumo";
+    else if (action == static_cast<int>(Action::Riichi) && !can_riichi) problem = "riichi";
+    else if (action < 136 && !canDiscard(action)) problem = "discard";
+    if (problem) {
+        std::ostringstream ss;
+        ss << "event #" << index << ": engine does not allow seat " << seat << " to " << problem;
+        script->divergence = ss.str();
+        return script->last[static_cast<int>(DecisionKind::Action)] = drawn_tile;
+    }
+    return action;
+}
+
+int ArchivePlayer::decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) {
+    (void)discard;
+    (void)can_chi;
+    (void)can_pon;
+    (void)can_kan;
+    return script->response(seat, from_seat, can_ron);
+}
+
+TileIndex ArchivePlayer::selectRiichiDiscard(TileIndex drawn_tile) {
+    return script->riichiDiscard(seat, drawn_tile);
+}
+
+bool buildArchiveWall(const ArchiveRound& round, TileIndexList& wall, std::string& error) {
+    wall.assign(136, invalid_tile_index);
+    bool used[136] = {};
+    auto place = [&](int position, TileIndex tile) {
+        if (tile < 0 || tile >= 136 || used[tile]) return false;
+        used[tile] = true;
+        wall[position] = tile;
+        return true;
+    };
+
+    for (int seat = 0; seat < 4; ++seat) {
+        const TileIndexList& hand = round.hands[seat];
+        if (hand.size() != 13) {
+            error = "seat " + std::to_string(seat) + " starts with " + std::to_string(hand.size()) + " tiles";
+            return false;
+        }
+        for (int k = 0; k < 13; ++k) {
+            if (!place(seat * 13 + k, hand[k])) {
+                error = "tile " + std::string(getTileName(hand[k])) + " dealt twice";
+                return false;
+            }
+        }
+    }
+
+    // 引擎在 52-121 之间依次摸牌
+    int position = 52;
+    for (const ArchiveEvent& e : round.events) {
+        if (e.kind != ArchiveEventKind::Draw) continue;
+        if (position >= dora_position - 4) {
+            error = "more draws than the live wall holds";
+            return false;
+        }
+        if (!place(position++, e.tile)) {
+            error = "tile " + std::string(getTileName(e.tile)) + " drawn twice";
+            return false;
+        }
+    }
+    if (round.dora_indicator != invalid_tile_index && !place(dora_position, round.dora_indicator)) {
+        error = "dora indicator already in play";
+        return false;
+    }
+
+    TileIndex next = 0;
+    for (TileIndex& tile : wall) {
+        if (tile != invalid_tile_index) continue;
+        while (used[next]) next++;
+        used[next] = true;
+        tile = next;
+    }
+    return true;
+}
+
+bool replayArchiveRound(const ArchiveRound& source, const TileIndexList& wall, Table& table, ArchiveScript& script,
+                        ReplayRound& out, std::string& reason) {
+    script.reset(&source);
+    out.seed = 0;
+    out.dealer = source.dealer;
+    out.round_wind = source.round_wind;
+    out.honba = source.honba;
+    out.riichi_sticks = source.riichi_sticks;
+    out.scores = source.scores;
+    out.wall = wall;
+    out.decisions.clear();
+
+    // 记录引擎实际执行的决策，并确认引擎没有改掉记录中的动作
+    GameCallbacks callbacks;
+    callbacks.onDecision = [&out, &script](int seat, DecisionKind kind, int options, int action) {
+        out.decisions.push_back({static_cast<uint8_t>(seat), static_cast<uint8_t>(kind),
+                                 static_cast<uint8_t>(options), static_cast<uint8_t>(action)});
+        int given = script.last[static_cast<int>(kind)];
+        if (action != given && script.divergence.empty()) {
+            std::ostringstream ss;
+            ss << "event #" << script.cursor << ": engine executed " << action << " instead of " << given
+               << " for seat " << seat;
+            script.divergence = ss.str();
+        }
+    };
+    table.setCallbacks(callbacks);
+
+    table.setDealer(source.dealer);
+    table.setRoundWind(source.round_wind);
+    table.setHonba(source.honba);
+    table.setRiichiSticks(source.riichi_sticks);
+    for (int i = 0; i < 4; ++i) {
+        if (table.getPlayer(i)) table.getPlayer(i)->setScore(source.scores[i]);
+    }
+    table.setNextWall(wall);
+
+    out.result = table.playRound();
+
+    if (!script.divergence.empty()) {
+        reason = script.divergence;
+        return false;
+    }
+    if (script.cursor != source.events.size()) {
+        std::ostringstream ss;
+        ss << "round ended after " << script.cursor << " of " << source.events.size() << " events, log has "
+           << describeEvent(&source, script.cursor);
+        reason = ss.str();
+        return false;
+    }
+    if (out.result.winner != source.winner || out.result.from_player != source.from_player) {
+        std::ostringstream ss;
+        ss << "result differs: log winner=" << source.winner << " from=" << source.from_player
+           << ", engine winner=" << out.result.winner << " from=" << out.result.from_player;
+        reason = ss.str();
+        return false;
+    }
+    return true;
+}
+
+ImportReport importArchives(const std::vector<std::string>& paths, int num_threads, const ImportSink& sink,
+                            size_t max_issues, size_t chunk_size) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = static_cast<int>(std::min<size_t>(num_threads, std::max<size_t>(paths.size(), 1)));
+
+    ImportReport report;
+    report.files = paths.size();
+
+    std::atomic<size_t> next_file(0);
+    std::mutex report_mutex;
+    std::mutex sink_mutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // 每个线程独占一张牌桌和四个导入玩家，按原子计数领取文件；文件内逐局流式处理
+    auto worker = [&]() {
+        Table table;
+        ArchiveScript script;
+        ArchivePlayer players[4] = {ArchivePlayer(&script), ArchivePlayer(&script),
+                                    ArchivePlayer(&script), ArchivePlayer(&script)};
+        for (int i = 0; i < 4; ++i) {
+            table.setPlayer(i, &players[i]);
+        }
+
+        ImportReport local;
+        std::vector<ImportIssue> issues;
+        ArchiveRound round;
+        ReplayRound converted;
+        TileIndexList wall;
+        std::string error;
+
+        auto note = [&](const std::string& file, size_t index, const std::string& reason) {
+            if (issues.size() < max_issues) issues.push_back({file, index, reason});
+        };
+
+        while (true) {
+            size_t file_index = next_file.fetch_add(1, std::memory_order_relaxed);
+            if (file_index >= paths.size()) break;
+            const std::string& path = paths[file_index];
+
+            ArchiveFormat format;
+            std::unique_ptr<ArchiveParser> parser;
+            if (!detectArchiveFormat(path, format) || !(parser = openArchive(path, format, chunk_size))) {
+                local.unreadable++;
+                note(path, 0, "cannot open or detect format");
+                continue;
+            }
+
+            size_t index = 0;
+            while (parser->next(round, error)) {
+                size_t current = index++;
+                local.rounds++;
+                if (!error.empty()) {
+                    local.malformed++;
+                    note(path, current, error);
+                    continue;
+                }
+                if (!round.unsupported.empty()) {
+                    local.unsupported++;
+                    continue;
+                }
+                if (!buildArchiveWall(round, wall, error)) {
+                    local.malformed++;
+                    note(path, current, error);
+                    continue;
+                }
+                if (!replayArchiveRound(round, wall, table, script, converted, error)) {
+                    local.diverged++;
+                    note(path, current, error);
+                    continue;
+                }
+
+                local.imported++;
+                if (converted.result.deltas != round.deltas) local.score_mismatches++;
+                if (sink) {
+                    std::lock_guard<std::mutex> lock(sink_mutex);
+                    sink(converted);
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(report_mutex);
+        report.unreadable += local.unreadable;
+        report.rounds += local.rounds;
+        report.imported += local.imported;
+        report.malformed += local.malformed;
+        report.unsupported += local.unsupported;
+        report.diverged += local.diverged;
+        report.score_mismatches += local.score_mismatches;
+        report.issues.insert(report.issues.end(), issues.begin(), issues.end());
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report.seconds = elapsed.count();
+    std::sort(report.issues.begin(), report.issues.end(), [](const ImportIssue& a, const ImportIssue& b) {
+        return a.file != b.file ? a.file < b.file : a.round < b.round;
+    });
+    if (report.issues.size() > max_issues) report.issues.resize(max_issues);
+    return report;
+}
@@ -0,0 +1,159 @@
+#ifndef ARCHIVE_IMPORT_H
+#define ARCHIVE_IMPORT_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "player.h"
+#include "replay_log.h"
+
+// 外部牌谱格式
+enum class ArchiveFormat {
+    Tenhou,  // 天凤 mjlog XML: <INIT>、<T36/>、<D36/>、<REACH>、<AGARI>、<RYUUKYOKU> 等标签
+    Mjai     // mjai JSON lines: 每行一个事件 {"type":"tsumo","actor":0,"pai":"5m"}
+};
+
+// 按扩展名 (.xml / .mjlog 为天凤，.json / .jsonl / .mjson 为 mjai) 判断，否则看第一个非空白字符
+bool detectArchiveFormat(const std::string& path, ArchiveFormat& format);
+
+// 按固定大小的块读文件，只保留当前块和正在拼接的一条记录
+class ChunkReader {
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    size_t pos;
+    size_t end;
+
+    bool fill();
+
+public:
+    explicit ChunkReader(size_t chunk_size = 1 << 16);
+    ~ChunkReader();
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader& operator=(const ChunkReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // 把到 delim 之前的内容写入 out (不含 delim)，返回 false 表示已经没有内容
+    // 最后一段没有 delim 时也返回 true；超过 max_size 的部分丢弃并设置 truncated
+    bool readUntil(char delim, std::string& out, size_t max_size, bool* truncated = nullptr);
+};
+
+// 外部牌谱中的事件 (只保留引擎能表示的部分)
+enum class ArchiveEventKind : uint8_t {
+    Draw,     // 摸牌
+    Discard,  // 弃牌
+    Riichi,   // 立直宣言 (之后的弃牌是宣言牌)
+    Win       // 和牌 (from 为放铳者，自摸时等于 seat)
+};
+
+struct ArchiveEvent {
+    ArchiveEventKind kind;
+    uint8_t seat;
+    uint8_t tile;
+    uint8_t from;
+};
+
+// 解析出的一局: 配牌、宝牌指示牌和事件，转换时据此拼出引擎的牌山
+struct ArchiveRound {
+    int dealer = 0;
+    Wind round_wind = Wind::East;
+    int honba = 0;
+    int riichi_sticks = 0;
+    std::array<int, 4> scores{};
+    std::array<TileIndexList, 4> hands;  // 各座位的 13 张配牌
+    TileIndex dora_indicator = invalid_tile_index;
+    std::vector<ArchiveEvent> events;
+
+    // 记录中的结果
+    bool finished = false;
+    int winner = -1;
+    int from_player = -1;
+    std::array<int, 4> deltas{};
+
+    // 引擎无法表示的内容 (鸣牌、途中流局、一炮多响)，为空表示可以导入
+    std::string unsupported;
+
+    void clear();
+};
+
+// 逐局读取外部牌谱 (拉取式，内存中只有当前一局)
+class ArchiveParser {
+public:
+    virtual ~ArchiveParser() = default;
+    // 读下一局，返回 false 表示文件已读完
+    // 格式错误时 error 非空，这一局被跳过，之后可以继续读
+    virtual bool next(ArchiveRound& round, std::string& error) = 0;
+};
+
+std::unique_ptr<ArchiveParser> openArchive(const std::string& path, ArchiveFormat format,
+                                           size_t chunk_size = 1 << 16);
+
+// 导入时按记录给出决策: 引擎每次询问时对照记录的下一个事件
+struct ArchiveScript {
+    const ArchiveRound* round = nullptr;
+    size_t cursor = 0;
+    std::string divergence;  // 第一次不一致的描述 (空表示一致)
+    int last[3];             // 每种决策 (DecisionKind) 最近一次给出的动作，与引擎实际执行的比较
+
+    void reset(const ArchiveRound* r);
+    int action(int seat, TileIndex drawn, int fallback);
+    int riichiDiscard(int seat, int fallback);
+    int response(int seat, int from_seat, bool can_ron);
+};
+
+// 按外部牌谱给出决策的玩家
+class ArchivePlayer : public Player {
+private:
+    ArchiveScript* script;
+
+public:
+    ArchivePlayer(ArchiveScript* s);
+
+    int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override;
+    int decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) override;
+    TileIndex selectRiichiDiscard(TileIndex drawn_tile) override;
+};
+
+// 拼出引擎的牌山: 配牌按座位放在前 52 张，之后依次是记录中的摸牌，宝牌指示牌放在王牌中的位置，
+// 其余的牌按编号补齐；牌重复或摸牌超过牌山时返回 false
+bool buildArchiveWall(const ArchiveRound& round, TileIndexList& wall, std::string& error);
+
+// 在 Table 上用拼好的牌山按记录的动作重放一局，把引擎的决策和结果写入 out
+// table 的四个座位须是使用同一个 script 的 ArchivePlayer；引擎与记录不一致时返回 false 并写入 reason
+bool replayArchiveRound(const ArchiveRound& source, const TileIndexList& wall, Table& table, ArchiveScript& script,
+                        ReplayRound& out, std::string& reason);
+
+struct ImportIssue {
+    std::string file;
+    size_t round;        // 文件中的局序号
+    std::string reason;
+};
+
+struct ImportReport {
+    size_t files = 0;
+    size_t unreadable = 0;        // 打不开或无法判断格式的文件
+    size_t rounds = 0;            // 读到的局数 (含出错的)
+    size_t imported = 0;
+    size_t malformed = 0;         // 格式错误，跳过
+    size_t unsupported = 0;       // 引擎无法表示，跳过
+    size_t diverged = 0;          // 引擎重放与记录不一致，跳过
+    size_t score_mismatches = 0;  // 已导入但点数变化与记录不同 (赤宝牌、宝牌等规则差异)
+    std::vector<ImportIssue> issues;  // 最多保留 max_issues 条
+    double seconds = 0;
+};
+
+// 导入成功的局交给 sink (加锁后依次调用)
+using ImportSink = std::function<void(const ReplayRound&)>;
+
+// 多线程导入 (num_threads <= 0 时使用全部核心)，每个线程按原子计数领取文件，逐块读取、逐局转换
+ImportReport importArchives(const std::vector<std::string>& paths, int num_threads = 0,
+                            const ImportSink& sink = nullptr, size_t max_issues = 16,
+                            size_t chunk_size = 1 << 16);
+
+#endif // ARCHIVE_IMPORT_H
@@ -0,0 +1,875 @@
+#include "hand_history.h"
+#include "player.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>  // x86-64 的基本指令集，不需要额外的编译选项
+#endif
+
+static const size_t meta_size = 28;
+static const size_t column_buffer_size = 1 << 16;
+
+static const HistoryColumn round_columns[RoundColumn::Count] = {
+    {"yaku", ColumnType::Mask64},
+    {"han", ColumnType::U8},
+    {"fu", ColumnType::U8},
+    {"score", ColumnType::I32},
+    {"winner", ColumnType::I8},
+    {"winner_wind", ColumnType::I8},
+    {"from", ColumnType::I8},
+    {"dealer", ColumnType::U8},
+    {"round_wind", ColumnType::U8},
+    {"honba", ColumnType::U8},
+    {"riichi", ColumnType::U8},
+    {"turns", ColumnType::U8},
+};
+
+static const HistoryColumn decision_columns[DecisionColumn::Count] = {
+    {"round", ColumnType::I32},
+    {"seat", ColumnType::U8},
+    {"kind", ColumnType::U8},
+    {"options", ColumnType::U8},
+    {"action", ColumnType::U8},
+    {"turn", ColumnType::U8},
+};
+
+static const char* const table_names[2] = {"rounds", "decisions"};
+
+// 与 Yaku 枚举同序，供查询条件按名字指定役种
+static const char* const yaku_names[] = {
+    "Richii", "Tanyao", "Tsumo", "YakuhaiSelfWind", "YakuhaiRoundWind", "YakuhaiHaku", "YakuhaiHatsu",
+    "YakuhaiChun", "Pinfu", "Iipeikou", "Chankan", "Rinshan", "Haitei", "Houtei", "Ippatsu",
+    "DoubleRichii", "SanshokuDoukou", "Sankantsu", "Toitoi", "Sanankou", "Shousangen", "Honroutou", "Chiitoitsu",
+    "Honchan", "Ittsuu", "Sanshoku", "Ryanpeikou", "Junchan", "Honitsu", "Chinitsu",
+    "Daisangen", "Suuankou", "Tsuuiisou", "Ryuuisou", "Chinroutou", "KokushiMuso", "Shousuushii", "Suukantsu",
+    "Chuuren", "SuuankouTanki", "KokushiMusoJusanmen", "JunseiChuuren", "Daisuushii",
+};
+static_assert(sizeof(yaku_names) / sizeof(yaku_names[0]) == static_cast<size_t>(Yaku::Daisuushii) + 1,
+              "yaku_names must follow the Yaku enum");
+
+const HistoryColumn* getHistoryColumns(HistoryTable table, int& count) {
+    if (table == HistoryTable::Rounds) {
+        count = RoundColumn::Count;
+        return round_columns;
+    }
+    count = DecisionColumn::Count;
+    return decision_columns;
+}
+
+int findHistoryColumn(HistoryTable table, const std::string& name) {
+    int count;
+    const HistoryColumn* columns = getHistoryColumns(table, count);
+    for (int i = 0; i < count; ++i) {
+        if (name == columns[i].name) return i;
+    }
+    return -1;
+}
+
+static size_t columnWidth(ColumnType type) {
+    switch (type) {
+        case ColumnType::I8:
+        case ColumnType::U8: return 1;
+        case ColumnType::I32: return 4;
+        case ColumnType::Mask64: return 8;
+    }
+    return 1;
+}
+
+static std::string columnPath(const std::string& dir, int table, const char* column, const char* suffix) {
+    return dir + "/" + table_names[table] + "." + column + suffix;
+}
+
+static void put64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static uint64_t get64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static int64_t readValue(ColumnType type, const uint8_t* data, uint64_t row) {
+    switch (type) {
+        case ColumnType::I8: return static_cast<int8_t>(data[row]);
+        case ColumnType::U8: return data[row];
+        case ColumnType::I32: return static_cast<int32_t>(get32(data + row * 4));
+        case ColumnType::Mask64: return static_cast<int64_t>(get64(data + row * 8));
+    }
+    return 0;
+}
+
+// HistoryWriter 实现
+HistoryWriter::HistoryWriter() : rows{0, 0}, opened(false) {
+}
+
+HistoryWriter::~HistoryWriter() {
+    close();
+}
+
+bool HistoryWriter::open(const std::string& path) {
+    close();
+    if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    dir = path;
+
+    for (int t = 0; t < 2; ++t) {
+        int count;
+        const HistoryColumn* defs = getHistoryColumns(static_cast<HistoryTable>(t), count);
+        columns[t].assign(count, ColumnFile{nullptr, nullptr, ColumnType::U8, {}, {}, 0});
+        for (int c = 0; c < count; ++c) {
+            ColumnFile& column = columns[t][c];
+            column.type = defs[c].type;
+            column.file = std::fopen(columnPath(dir, t, defs[c].name, ".col").c_str(), "wb");
+            column.stats_file = std::fopen(columnPath(dir, t, defs[c].name, ".stats").c_str(), "wb");
+        }
+        rows[t] = 0;
+    }
+    opened = true;
+
+    for (const std::vector<ColumnFile>& table : columns) {
+        for (const ColumnFile& column : table) {
+            if (!column.file || !column.stats_file) {
+                close();
+                return false;
+            }
+        }
+    }
+    // 先写一份空的 meta，覆盖目录中旧的存储
+    if (!writeMeta()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void HistoryWriter::close() {
+    if (!opened) return;
+    flush();
+    for (std::vector<ColumnFile>& table : columns) {
+        for (ColumnFile& column : table) {
+            if (column.file) std::fclose(column.file);
+            if (column.stats_file) std::fclose(column.stats_file);
+        }
+        table.clear();
+    }
+    opened = false;
+}
+
+void HistoryWriter::append(HistoryTable table, int column, int64_t value) {
+    int t = static_cast<int>(table);
+    ColumnFile& c = columns[t][column];
+    uint64_t v = static_cast<uint64_t>(value);
+    switch (c.type) {
+        case ColumnType::I8:
+        case ColumnType::U8:
+            c.buffer.push_back(static_cast<uint8_t>(v));
+            break;
+        case ColumnType::I32:
+            for (int i = 0; i < 4; ++i) c.buffer.push_back(static_cast<uint8_t>(v >> (8 * i)));
+            break;
+        case ColumnType::Mask64:
+            put64(c.buffer, v);
+            break;
+    }
+
+    size_t block = rows[t] / history_block_rows;
+    if (block == c.stats.size()) {
+        c.stats.push_back({value, value});
+    } else if (c.type == ColumnType::Mask64) {
+        c.stats[block].min &= value;
+        c.stats[block].max |= value;
+    } else {
+        c.stats[block].min = std::min(c.stats[block].min, value);
+        c.stats[block].max = std::max(c.stats[block].max, value);
+    }
+
+    if (c.buffer.size() >= column_buffer_size) {
+        std::fwrite(c.buffer.data(), 1, c.buffer.size(), c.file);
+        c.buffer.clear();
+    }
+}
+
+void HistoryWriter::writeRound(const ReplayRound& round) {
+    if (!opened) return;
+
+    // 决策表: 每个 Action 决策前都有一次摸牌
+    uint64_t round_row = rows[static_cast<int>(HistoryTable::Rounds)];
+    int turn = 0;
+    int riichi = 0;
+    for (const ReplayDecision& d : round.decisions) {
+        if (d.kind == static_cast<uint8_t>(DecisionKind::Action)) {
+            turn++;
+            if (d.action == static_cast<uint8_t>(Action::Riichi)) riichi |= 1 << d.seat;
+        }
+        append(HistoryTable::Decisions, DecisionColumn::Round, static_cast<int64_t>(round_row));
+        append(HistoryTable::Decisions, DecisionColumn::Seat, d.seat);
+        append(HistoryTable::Decisions, DecisionColumn::Kind, d.kind);
+        append(HistoryTable::Decisions, DecisionColumn::Options, d.options);
+        append(HistoryTable::Decisions, DecisionColumn::Action, d.action);
+        append(HistoryTable::Decisions, DecisionColumn::Turn, std::min(turn, 255));
+        rows[static_cast<int>(HistoryTable::Decisions)]++;
+    }
+
+    const GameResult& r = round.result;
+    uint64_t yaku = 0;
+    for (Yaku y : r.yaku) {
+        yaku |= 1ull << static_cast<int>(y);
+    }
+    append(HistoryTable::Rounds, RoundColumn::Yaku, static_cast<int64_t>(yaku));
+    append(HistoryTable::Rounds, RoundColumn::Han, std::min(std::max(r.han, 0), 255));
+    append(HistoryTable::Rounds, RoundColumn::Fu, std::min(std::max(r.fu, 0), 255));
+    append(HistoryTable::Rounds, RoundColumn::Score, r.score);
+    append(HistoryTable::Rounds, RoundColumn::Winner, r.winner);
+    append(HistoryTable::Rounds, RoundColumn::WinnerWind, r.winner >= 0 ? (r.winner - round.dealer + 4) % 4 : -1);
+    append(HistoryTable::Rounds, RoundColumn::From, r.winner >= 0 ? r.from_player : -1);
+    append(HistoryTable::Rounds, RoundColumn::Dealer, round.dealer);
+    append(HistoryTable::Rounds, RoundColumn::RoundWind, static_cast<int>(round.round_wind));
+    append(HistoryTable::Rounds, RoundColumn::Honba, std::min(round.honba, 255));
+    append(HistoryTable::Rounds, RoundColumn::Riichi, riichi);
+    append(HistoryTable::Rounds, RoundColumn::Turns, std::min(turn, 255));
+    rows[static_cast<int>(HistoryTable::Rounds)]++;
+}
+
+bool HistoryWriter::writeMeta() {
+    std::vector<uint8_t> meta(history_magic, history_magic + 4);
+    meta.push_back(static_cast<uint8_t>(history_version));
+    meta.push_back(static_cast<uint8_t>(history_version >> 8));
+    meta.push_back(0);
+    meta.push_back(0);
+    for (int i = 0; i < 4; ++i) meta.push_back(static_cast<uint8_t>(history_block_rows >> (8 * i)));
+    put64(meta, rows[0]);
+    put64(meta, rows[1]);
+
+    // 写完整个文件再改名，读取方不会看到写了一半的 meta
+    std::string path = dir + "/history.meta";
+    std::string temp = path + ".tmp";
+    std::FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(meta.data(), 1, meta.size(), file) == meta.size();
+    ok = std::fclose(file) == 0 && ok;
+    return ok && std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+void HistoryWriter::flush() {
+    if (!opened) return;
+
+    // 先写列和块统计，最后更新 meta 中的行数
+    std::vector<uint8_t> encoded;
+    for (int t = 0; t < 2; ++t) {
+        size_t full_blocks = rows[t] / history_block_rows;
+        for (ColumnFile& c : columns[t]) {
+            if (!c.buffer.empty()) {
+                std::fwrite(c.buffer.data(), 1, c.buffer.size(), c.file);
+                c.buffer.clear();
+            }
+            std::fflush(c.file);
+
+            // 未写定的块 (含最后一个不满的块) 整段重写
+            if (c.stats_written < c.stats.size()) {
+                encoded.clear();
+                for (size_t b = c.stats_written; b < c.stats.size(); ++b) {
+                    put64(encoded, static_cast<uint64_t>(c.stats[b].min));
+                    put64(encoded, static_cast<uint64_t>(c.stats[b].max));
+                }
+                std::fseek(c.stats_file, static_cast<long>(c.stats_written * 16), SEEK_SET);
+                std::fwrite(encoded.data(), 1, encoded.size(), c.stats_file);
+                std::fflush(c.stats_file);
+                c.stats_written = full_blocks;
+            }
+        }
+    }
+    writeMeta();
+}
+
+// HistoryRecorder 实现
+HistoryRecorder::HistoryRecorder(Table* t, HistoryWriter* w)
+    : table(t), writer(w), forward(t->getCallbacks()), recorded(0) {
+    GameCallbacks callbacks = forward;
+
+    callbacks.onRoundStart = [this]() {
+        current.dealer = table->getDealer();
+        current.round_wind = table->getRoundWind();
+        current.honba = table->getHonba();
+        current.decisions.clear();
+        if (forward.onRoundStart) forward.onRoundStart();
+    };
+
+    callbacks.onDecision = [this](int seat, DecisionKind kind, int options, int action) {
+        current.decisions.push_back({static_cast<uint8_t>(seat), static_cast<uint8_t>(kind),
+                                     static_cast<uint8_t>(options), static_cast<uint8_t>(action)});
+        if (forward.onDecision) forward.onDecision(seat, kind, options, action);
+    };
+
+    callbacks.onGameEnd = [this](const GameResult& result) {
+        current.result = result;
+        writer->writeRound(current);
+        recorded++;
+        if (forward.onGameEnd) forward.onGameEnd(result);
+    };
+
+    table->setCallbacks(callbacks);
+}
+
+HistoryRecorder::~HistoryRecorder() {
+    table->setCallbacks(forward);
+}
+
+// HandHistory 实现
+HandHistory::HandHistory() : rows{0, 0} {
+}
+
+HandHistory::~HandHistory() {
+    close();
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    out.clear();
+    uint8_t chunk[1 << 14];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        out.insert(out.end(), chunk, chunk + n);
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool HandHistory::open(const std::string& path) {
+    close();
+
+    std::vector<uint8_t> meta;
+    if (!readFile(path + "/history.meta", meta) || meta.size() != meta_size ||
+        std::memcmp(meta.data(), history_magic, 4) != 0 ||
+        (meta[4] | (meta[5] << 8)) != history_version || get32(meta.data() + 8) != history_block_rows) {
+        return false;
+    }
+    rows[0] = get64(meta.data() + 12);
+    rows[1] = get64(meta.data() + 20);
+
+    std::vector<uint8_t> stats;
+    for (int t = 0; t < 2; ++t) {
+        int count;
+        const HistoryColumn* defs = getHistoryColumns(static_cast<HistoryTable>(t), count);
+        size_t blocks = (rows[t] + history_block_rows - 1) / history_block_rows;
+        for (int c = 0; c < count; ++c) {
+            columns[t].push_back(ColumnView{nullptr, 0, defs[c].type, {}});
+            ColumnView& view = columns[t].back();
+
+            // 块统计: 读入内存 (每 4096 行 16 字节)
+            if (!readFile(columnPath(path, t, defs[c].name, ".stats"), stats) || stats.size() < blocks * 16) {
+                close();
+                return false;
+            }
+            view.stats.resize(blocks);
+            for (size_t b = 0; b < blocks; ++b) {
+                view.stats[b].min = static_cast<int64_t>(get64(stats.data() + b * 16));
+                view.stats[b].max = static_cast<int64_t>(get64(stats.data() + b * 16 + 8));
+            }
+
+            // 列数据: 只映射 meta 记录的行数
+            view.size = rows[t] * columnWidth(view.type);
+            int fd = ::open(columnPath(path, t, defs[c].name, ".col").c_str(), O_RDONLY);
+            if (fd < 0) {
+                close();
+                return false;
+            }
+            struct stat st;
+            bool ok = fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) >= view.size;
+            void* mapped = nullptr;
+            if (ok && view.size > 0) {
+                mapped = mmap(nullptr, view.size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ok = mapped != MAP_FAILED;
+            }
+            ::close(fd);
+            if (!ok) {
+                view.size = 0;
+                close();
+                return false;
+            }
+            if (mapped) {
+                madvise(mapped, view.size, MADV_SEQUENTIAL);
+                view.data = static_cast<const uint8_t*>(mapped);
+            }
+        }
+    }
+    return true;
+}
+
+void HandHistory::close() {
+    for (std::vector<ColumnView>& table : columns) {
+        for (ColumnView& view : table) {
+            if (view.data) munmap(const_cast<uint8_t*>(view.data), view.size);
+        }
+        table.clear();
+    }
+    rows[0] = rows[1] = 0;
+}
+
+ColumnType HandHistory::getColumnType(HistoryTable table, int column) const {
+    return columns[static_cast<int>(table)][column].type;
+}
+
+const uint8_t* HandHistory::getColumnData(HistoryTable table, int column) const {
+    return columns[static_cast<int>(table)][column].data;
+}
+
+const std::vector<BlockStats>& HandHistory::getBlockStats(HistoryTable table, int column) const {
+    return columns[static_cast<int>(table)][column].stats;
+}
+
+int64_t HandHistory::getValue(HistoryTable table, int column, uint64_t row) const {
+    const ColumnView& view = columns[static_cast<int>(table)][column];
+    return readValue(view.type, view.data, row);
+}
+
+// 查询条件解析
+static bool parseYakuMask(const std::string& text, int64_t& mask) {
+    mask = 0;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t stop = text.find('+', start);
+        if (stop == std::string::npos) stop = text.size();
+        std::string name = text.substr(start, stop - start);
+        const char* const* found = std::find_if(std::begin(yaku_names), std::end(yaku_names),
+                                                [&name](const char* n) { return name == n; });
+        if (found == std::end(yaku_names)) return false;
+        mask |= static_cast<int64_t>(1ull << (found - std::begin(yaku_names)));
+        start = stop + 1;
+    }
+    return true;
+}
+
+bool parseHistoryFilter(HistoryTable table, const std::string& text, HistoryFilter& filter, std::string& error) {
+    static const struct {
+        const char* text;
+        FilterOp op;
+    } ops[] = {
+        {"==", FilterOp::Eq}, {"!=", FilterOp::Ne}, {"<=", FilterOp::Le}, {">=", FilterOp::Ge},
+        {"<", FilterOp::Lt}, {">", FilterOp::Gt}, {"=", FilterOp::Eq}, {"&", FilterOp::HasAll},
+        {"|", FilterOp::HasAny},
+    };
+
+    size_t pos = text.find_first_of("=!<>&|");
+    if (pos == std::string::npos || pos == 0) {
+        error = "expected <column><op><value>: " + text;
+        return false;
+    }
+    std::string name = text.substr(0, pos);
+    filter.column = findHistoryColumn(table, name);
+    if (filter.column < 0) {
+        error = "unknown column: " + name;
+        return false;
+    }
+
+    size_t op_length = 0;
+    for (const auto& op : ops) {
+        size_t n = std::strlen(op.text);
+        if (text.compare(pos, n, op.text) == 0) {
+            filter.op = op.op;
+            op_length = n;
+            break;
+        }
+    }
+    if (op_length == 0) {
+        error = "unknown operator in " + text;
+        return false;
+    }
+    std::string value = text.substr(pos + op_length);
+
+    int count;
+    ColumnType type = getHistoryColumns(table, count)[filter.column].type;
+    bool ordered = filter.op != FilterOp::Eq && filter.op != FilterOp::Ne &&
+                   filter.op != FilterOp::HasAll && filter.op != FilterOp::HasAny;
+    bool bitwise = filter.op == FilterOp::HasAll || filter.op == FilterOp::HasAny;
+    if ((ordered && type == ColumnType::Mask64) ||
+        (bitwise && type != ColumnType::Mask64 && type != ColumnType::U8)) {
+        error = "operator not supported on column " + name;
+        return false;
+    }
+
+    char* stop = nullptr;
+    long long number = value.empty() ? 0 : std::strtoll(value.c_str(), &stop, 0);
+    if (!value.empty() && *stop == '\0') {
+        filter.value = number;
+    } else if (!(table == HistoryTable::Rounds && filter.column == RoundColumn::Yaku &&
+                 parseYakuMask(value, filter.value))) {
+        error = "bad value: " + value;
+        return false;
+    }
+    return true;
+}
+
+// 查询
+namespace {
+
+enum class BlockMatch { None, Some, All };
+
+// 每个条件都化为三种比较之一，结果可以取反:
+//   MaskEq: (x & mask) == target (相等、含全部位、含任一位取反)
+//   Lt / Gt: x < target / x > target (其余大小比较取反)
+enum class Kernel { MaskEq, Lt, Gt };
+
+struct ScanPlan {
+    Kernel kernel;
+    bool invert;
+    int64_t mask;
+    int64_t target;
+};
+
+struct PreparedFilter {
+    const uint8_t* data;
+    const std::vector<BlockStats>* stats;
+    ColumnType type;
+    FilterOp op;
+    int64_t value;
+    ScanPlan plan;
+};
+
+bool matchValue(FilterOp op, int64_t x, int64_t v) {
+    switch (op) {
+        case FilterOp::Eq: return x == v;
+        case FilterOp::Ne: return x != v;
+        case FilterOp::Lt: return x < v;
+        case FilterOp::Le: return x <= v;
+        case FilterOp::Gt: return x > v;
+        case FilterOp::Ge: return x >= v;
+        case FilterOp::HasAll: return (x & v) == v;
+        case FilterOp::HasAny: return (x & v) != 0;
+    }
+    return false;
+}
+
+// 由块内的最小 / 最大值 (位掩码列为按位与 / 按位或) 判断整块是否可以跳过或全部命中
+BlockMatch matchBlock(FilterOp op, bool mask_column, int64_t v, int64_t lo, int64_t hi) {
+    if (lo == hi) return matchValue(op, lo, v) ? BlockMatch::All : BlockMatch::None;
+    if (mask_column) {
+        switch (op) {
+            case FilterOp::HasAll:
+                if ((hi & v) != v) return BlockMatch::None;
+                if ((lo & v) == v) return BlockMatch::All;
+                break;
+            case FilterOp::HasAny:
+                if ((hi & v) == 0) return BlockMatch::None;
+                if ((lo & v) != 0) return BlockMatch::All;
+                break;
+            case FilterOp::Eq:
+                if ((v & ~hi) != 0 || (lo & ~v) != 0) return BlockMatch::None;
+                break;
+            case FilterOp::Ne:
+                if ((v & ~hi) != 0 || (lo & ~v) != 0) return BlockMatch::All;
+                break;
+            default:
+                break;
+        }
+        return BlockMatch::Some;
+    }
+    switch (op) {
+        case FilterOp::Eq:
+            if (v < lo || v > hi) return BlockMatch::None;
+            break;
+        case FilterOp::Ne:
+            if (v < lo || v > hi) return BlockMatch::All;
+            break;
+        case FilterOp::Lt:
+            if (lo >= v) return BlockMatch::None;
+            if (hi < v) return BlockMatch::All;
+            break;
+        case FilterOp::Le:
+            if (lo > v) return BlockMatch::None;
+            if (hi <= v) return BlockMatch::All;
+            break;
+        case FilterOp::Gt:
+            if (hi <= v) return BlockMatch::None;
+            if (lo > v) return BlockMatch::All;
+            break;
+        case FilterOp::Ge:
+            if (hi < v) return BlockMatch::None;
+            if (lo >= v) return BlockMatch::All;
+            break;
+        default:
+            break;
+    }
+    return BlockMatch::Some;
+}
+
+ScanPlan makePlan(FilterOp op, int64_t v) {
+    switch (op) {
+        case FilterOp::Eq: return {Kernel::MaskEq, false, -1, v};
+        case FilterOp::Ne: return {Kernel::MaskEq, true, -1, v};
+        case FilterOp::Lt: return {Kernel::Lt, false, 0, v};
+        case FilterOp::Ge: return {Kernel::Lt, true, 0, v};
+        case FilterOp::Gt: return {Kernel::Gt, false, 0, v};
+        case FilterOp::Le: return {Kernel::Gt, true, 0, v};
+        case FilterOp::HasAll: return {Kernel::MaskEq, false, v, v};
+        case FilterOp::HasAny: return {Kernel::MaskEq, true, v, 0};
+    }
+    return {Kernel::MaskEq, false, -1, v};
+}
+
+bool planMatches(const ScanPlan& plan, int64_t x) {
+    bool r;
+    switch (plan.kernel) {
+        case Kernel::MaskEq: r = (x & plan.mask) == plan.target; break;
+        case Kernel::Lt: r = x < plan.target; break;
+        default: r = x > plan.target; break;
+    }
+    return r != plan.invert;
+}
+
+// 逐行比较，从第 from 行 (64 的倍数) 到 count
+void scanScalar(ColumnType type, const uint8_t* data, size_t from, size_t count, const ScanPlan& plan,
+                uint64_t* bits) {
+    for (size_t w = from / 64; w * 64 < count; ++w) {
+        size_t end = std::min(count, w * 64 + 64);
+        uint64_t word = 0;
+        for (size_t i = w * 64; i < end; ++i) {
+            if (planMatches(plan, readValue(type, data, i))) word |= 1ull << (i - w * 64);
+        }
+        bits[w] &= word;
+    }
+}
+
+#if defined(__SSE2__)
+// 8 位列: 每次 16 行；无符号列翻转最高位后按有符号比较
+template <Kernel K>
+size_t scan8(const uint8_t* data, size_t count, bool is_signed, const ScanPlan& plan, uint64_t* bits) {
+    const __m128i bias = _mm_set1_epi8(K != Kernel::MaskEq && !is_signed ? static_cast<char>(0x80) : 0);
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(plan.mask));
+    const __m128i target = _mm_xor_si128(_mm_set1_epi8(static_cast<char>(plan.target)), bias);
+    const uint64_t flip = plan.invert ? ~0ull : 0;
+    size_t words = count / 64;
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int i = 0; i < 64; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + w * 64 + i));
+            __m128i m;
+            if (K == Kernel::MaskEq) m = _mm_cmpeq_epi8(_mm_and_si128(v, mask), target);
+            else if (K == Kernel::Lt) m = _mm_cmplt_epi8(_mm_xor_si128(v, bias), target);
+            else m = _mm_cmpgt_epi8(_mm_xor_si128(v, bias), target);
+            word |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(m))) << i;
+        }
+        bits[w] &= word ^ flip;
+    }
+    return words * 64;
+}
+
+// 32 位列: 每次 4 行
+template <Kernel K>
+size_t scan32(const uint8_t* data, size_t count, const ScanPlan& plan, uint64_t* bits) {
+    const __m128i mask = _mm_set1_epi32(static_cast<int32_t>(plan.mask));
+    const __m128i target = _mm_set1_epi32(static_cast<int32_t>(plan.target));
+    const uint64_t flip = plan.invert ? ~0ull : 0;
+    size_t words = count / 64;
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int i = 0; i < 64; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + (w * 64 + i) * 4));
+            __m128i m;
+            if (K == Kernel::MaskEq) m = _mm_cmpeq_epi32(_mm_and_si128(v, mask), target);
+            else if (K == Kernel::Lt) m = _mm_cmplt_epi32(v, target);
+            else m = _mm_cmpgt_epi32(v, target);
+            word |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(m))) << i;
+        }
+        bits[w] &= word ^ flip;
+    }
+    return words * 64;
+}
+
+// 64 位位掩码列: 每次 2 行，两个 32 位半边都相等才算相等
+size_t scan64(const uint8_t* data, size_t count, const ScanPlan& plan, uint64_t* bits) {
+    const __m128i mask = _mm_set1_epi64x(plan.mask);
+    const __m128i target = _mm_set1_epi64x(plan.target);
+    const uint64_t flip = plan.invert ? ~0ull : 0;
+    size_t words = count / 64;
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t word = 0;
+        for (int i = 0; i < 64; i += 2) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + (w * 64 + i) * 8));
+            __m128i m = _mm_cmpeq_epi32(_mm_and_si128(v, mask), target);
+            m = _mm_and_si128(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+            word |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(m))) << i;
+        }
+        bits[w] &= word ^ flip;
+    }
+    return words * 64;
+}
+#endif
+
+// 比较 count 行，结果与 bits 按位与；整 64 行用 SIMD，剩下的逐行
+void scanColumn(const PreparedFilter& f, const uint8_t* data, size_t count, uint64_t* bits) {
+    size_t done = 0;
+#if defined(__SSE2__)
+    const ScanPlan& plan = f.plan;
+    switch (f.type) {
+        case ColumnType::I8:
+        case ColumnType::U8: {
+            bool is_signed = f.type == ColumnType::I8;
+            if (plan.kernel == Kernel::MaskEq) done = scan8<Kernel::MaskEq>(data, count, is_signed, plan, bits);
+            else if (plan.kernel == Kernel::Lt) done = scan8<Kernel::Lt>(data, count, is_signed, plan, bits);
+            else done = scan8<Kernel::Gt>(data, count, is_signed, plan, bits);
+            break;
+        }
+        case ColumnType::I32:
+            if (plan.kernel == Kernel::MaskEq) done = scan32<Kernel::MaskEq>(data, count, plan, bits);
+            else if (plan.kernel == Kernel::Lt) done = scan32<Kernel::Lt>(data, count, plan, bits);
+            else done = scan32<Kernel::Gt>(data, count, plan, bits);
+            break;
+        case ColumnType::Mask64:
+            if (plan.kernel == Kernel::MaskEq) done = scan64(data, count, plan, bits);
+            break;
+    }
+#endif
+    scanScalar(f.type, data, done, count, f.plan, bits);
+}
+
+// 列类型能表示的取值范围，条件在整个范围上已经确定时不必扫描
+bool typeRange(ColumnType type, int64_t& lo, int64_t& hi) {
+    switch (type) {
+        case ColumnType::I8: lo = -128; hi = 127; return true;
+        case ColumnType::U8: lo = 0; hi = 255; return true;
+        case ColumnType::I32: lo = INT32_MIN; hi = INT32_MAX; return true;
+        case ColumnType::Mask64: return false;
+    }
+    return false;
+}
+
+} // namespace
+
+HistoryQueryResult queryHistory(const HandHistory& history, HistoryTable table,
+                                const std::vector<HistoryFilter>& filters, size_t max_rows, int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    HistoryQueryResult result;
+    result.rows = history.getRowCount(table);
+    result.blocks = (result.rows + history_block_rows - 1) / history_block_rows;
+    auto start = std::chrono::steady_clock::now();
+
+    // 整理条件: 在列类型的取值范围上恒真的去掉，恒假的直接返回
+    std::vector<PreparedFilter> prepared;
+    bool never = false;
+    for (const HistoryFilter& f : filters) {
+        ColumnType type = history.getColumnType(table, f.column);
+        int64_t value = f.value;
+        int64_t lo, hi;
+        if (f.op == FilterOp::HasAll || f.op == FilterOp::HasAny) {
+            if (type == ColumnType::U8) {
+                if (f.op == FilterOp::HasAll && (value & ~0xFF) != 0) never = true;
+                value &= 0xFF;
+                if (f.op == FilterOp::HasAny && value == 0) never = true;
+            }
+        } else if (typeRange(type, lo, hi)) {
+            BlockMatch m = matchBlock(f.op, false, value, lo, hi);
+            if (m == BlockMatch::None) never = true;
+            if (m != BlockMatch::Some) continue;
+        }
+        prepared.push_back({history.getColumnData(table, f.column), &history.getBlockStats(table, f.column),
+                            type, f.op, value, makePlan(f.op, value)});
+    }
+    if (never) {
+        result.blocks_skipped = result.blocks;
+        return result;
+    }
+
+    std::atomic<size_t> next_block(0);
+    std::mutex result_mutex;
+
+    auto worker = [&]() {
+        uint64_t bits[history_block_rows / 64];
+        std::vector<char> needs_scan(prepared.size());
+        HistoryQueryResult local;
+
+        while (true) {
+            size_t block = next_block.fetch_add(1, std::memory_order_relaxed);
+            if (block >= result.blocks) break;
+            uint64_t first = static_cast<uint64_t>(block) * history_block_rows;
+            size_t count = static_cast<size_t>(std::min<uint64_t>(history_block_rows, result.rows - first));
+
+            // 先看块统计
+            bool skip = false;
+            size_t scans = 0;
+            for (size_t k = 0; k < prepared.size() && !skip; ++k) {
+                const PreparedFilter& f = prepared[k];
+                const BlockStats& s = (*f.stats)[block];
+                BlockMatch m = matchBlock(f.op, f.type == ColumnType::Mask64, f.value, s.min, s.max);
+                skip = m == BlockMatch::None;
+                needs_scan[k] = m == BlockMatch::Some;
+                if (needs_scan[k]) scans++;
+            }
+            if (skip) {
+                local.blocks_skipped++;
+                continue;
+            }
+
+            size_t words = (count + 63) / 64;
+            std::fill(bits, bits + words, ~0ull);
+            if (count % 64) bits[words - 1] = (1ull << (count % 64)) - 1;
+            if (scans == 0) {
+                local.blocks_full++;
+            } else {
+                for (size_t k = 0; k < prepared.size(); ++k) {
+                    if (!needs_scan[k]) continue;
+                    const PreparedFilter& f = prepared[k];
+                    size_t width = columnWidth(f.type);
+                    scanColumn(f, f.data + first * width, count, bits);
+                    local.bytes_scanned += count * width;
+                    // 已经没有命中的行就不必再看其余的列
+                    uint64_t any = 0;
+                    for (size_t w = 0; w < words; ++w) any |= bits[w];
+                    if (!any) break;
+                }
+            }
+
+            for (size_t w = 0; w < words; ++w) {
+                uint64_t word = bits[w];
+                local.matches += __builtin_popcountll(word);
+                while (word && local.sample.size() < max_rows) {
+                    local.sample.push_back(first + w * 64 + __builtin_ctzll(word));
+                    word &= word - 1;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result.matches += local.matches;
+        result.blocks_skipped += local.blocks_skipped;
+        result.blocks_full += local.blocks_full;
+        result.bytes_scanned += local.bytes_scanned;
+        result.sample.insert(result.sample.end(), local.sample.begin(), local.sample.end());
+    };
+
+    // 每个线程领取的块号递增，所以各线程的前 max_rows 个命中合起来一定包含全局的前 max_rows 个
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    std::sort(result.sample.begin(), result.sample.end());
+    if (result.sample.size() > max_rows) result.sample.resize(max_rows);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
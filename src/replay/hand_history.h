@@ -0,0 +1,191 @@
+#ifndef HAND_HISTORY_H
+#define HAND_HISTORY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "table.h"
+#include "replay_log.h"
+
+// 牌局历史的列式存储 (一个目录，小端序):
+//   history.meta       "MJHS" + u16 版本 + u16 保留 + u32 每块行数 + u64 局数 + u64 决策数
+//   <表>.<列>.col      该列的定长值按行连续存放，直接映射后扫描
+//   <表>.<列>.stats    每块一对 i64: 数值列为最小 / 最大值，位掩码列为按位与 / 按位或
+// meta 在 flush 时最后更新 (写临时文件后改名)，列文件中超出 meta 行数的部分 (写入时崩溃) 被忽略
+const char history_magic[4] = {'M', 'J', 'H', 'S'};
+const uint16_t history_version = 1;
+const uint32_t history_block_rows = 4096;
+
+enum class HistoryTable {
+    Rounds,     // 每局一行
+    Decisions   // 每个决策一行
+};
+
+enum class ColumnType : uint8_t {
+    I8,
+    U8,
+    I32,
+    Mask64
+};
+
+struct HistoryColumn {
+    const char* name;
+    ColumnType type;
+};
+
+// 局表的列号
+namespace RoundColumn {
+    const int Yaku       = 0;   // Mask64 役种位掩码 (1 << Yaku)
+    const int Han        = 1;   // U8
+    const int Fu         = 2;   // U8
+    const int Score      = 3;   // I32 得点 (不含本场和立直棒)
+    const int Winner     = 4;   // I8 赢家座位 (-1 流局)
+    const int WinnerWind = 5;   // I8 赢家自风 (0 为庄家，-1 流局)
+    const int From       = 6;   // I8 放铳者 (-1 自摸或流局)
+    const int Dealer     = 7;   // U8
+    const int RoundWind  = 8;   // U8
+    const int Honba      = 9;   // U8
+    const int Riichi     = 10;  // U8 宣言立直的座位位掩码
+    const int Turns      = 11;  // U8 本局摸牌次数
+    const int Count      = 12;
+}
+
+// 决策表的列号
+namespace DecisionColumn {
+    const int Round   = 0;  // I32 所属局的行号
+    const int Seat    = 1;  // U8
+    const int Kind    = 2;  // U8 DecisionKind
+    const int Options = 3;  // U8 DecisionOption 位
+    const int Action  = 4;  // U8 0-135 弃牌 或 Action
+    const int Turn    = 5;  // U8 决策时本局已摸牌次数
+    const int Count   = 6;
+}
+
+const HistoryColumn* getHistoryColumns(HistoryTable table, int& count);
+int findHistoryColumn(HistoryTable table, const std::string& name);  // 找不到返回 -1
+
+// 每块的统计
+struct BlockStats {
+    int64_t min;  // 位掩码列为按位与
+    int64_t max;  // 位掩码列为按位或
+};
+
+// 列式存储写入 (每列追加写，带缓冲)
+class HistoryWriter {
+private:
+    struct ColumnFile {
+        std::FILE* file;
+        std::FILE* stats_file;
+        ColumnType type;
+        std::vector<uint8_t> buffer;
+        std::vector<BlockStats> stats;
+        size_t stats_written;  // 已经写定的整块数
+    };
+
+    std::string dir;
+    std::vector<ColumnFile> columns[2];
+    uint64_t rows[2];
+    bool opened;
+
+    void append(HistoryTable table, int column, int64_t value);
+    bool writeMeta();
+
+public:
+    HistoryWriter();
+    ~HistoryWriter();
+    HistoryWriter(const HistoryWriter&) = delete;
+    HistoryWriter& operator=(const HistoryWriter&) = delete;
+
+    // 新建 (清空) 存储目录
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return opened; }
+
+    // 一局的结果和决策 (决策前的摸牌次数由 Action 决策的个数得出)
+    void writeRound(const ReplayRound& round);
+    void flush();
+
+    uint64_t getRowCount(HistoryTable table) const { return rows[static_cast<int>(table)]; }
+};
+
+// 记录 Table 打的每一局到列式存储
+// 挂接到 Table 的回调上，原有回调仍会被调用
+class HistoryRecorder {
+private:
+    Table* table;
+    HistoryWriter* writer;
+    ReplayRound current;
+    GameCallbacks forward;  // 挂接前的回调
+    size_t recorded;
+
+public:
+    HistoryRecorder(Table* t, HistoryWriter* w);
+    ~HistoryRecorder();
+
+    size_t getRecordedCount() const { return recorded; }
+};
+
+// 只读映射的列式存储
+class HandHistory {
+private:
+    struct ColumnView {
+        const uint8_t* data;
+        size_t size;
+        ColumnType type;
+        std::vector<BlockStats> stats;
+    };
+
+    std::vector<ColumnView> columns[2];
+    uint64_t rows[2];
+
+public:
+    HandHistory();
+    ~HandHistory();
+    HandHistory(const HandHistory&) = delete;
+    HandHistory& operator=(const HandHistory&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    uint64_t getRowCount(HistoryTable table) const { return rows[static_cast<int>(table)]; }
+    ColumnType getColumnType(HistoryTable table, int column) const;
+    const uint8_t* getColumnData(HistoryTable table, int column) const;
+    const std::vector<BlockStats>& getBlockStats(HistoryTable table, int column) const;
+    int64_t getValue(HistoryTable table, int column, uint64_t row) const;
+};
+
+enum class FilterOp {
+    Eq, Ne, Lt, Le, Gt, Ge,  // 数值比较 (位掩码列只能用 Eq / Ne)
+    HasAll,                  // 含有 value 的全部位 (U8 和位掩码列)
+    HasAny                   // 含有 value 的任一位
+};
+
+struct HistoryFilter {
+    int column;
+    FilterOp op;
+    int64_t value;
+};
+
+// 解析 "score>=12000"、"winner_wind!=0"、"yaku&Chinitsu"、"riichi|5" 这样的条件
+// 运算符: == != < <= > >= & (含全部位) | (含任一位)；yaku 列的值可以写役名，多个役用 + 连接
+bool parseHistoryFilter(HistoryTable table, const std::string& text, HistoryFilter& filter, std::string& error);
+
+struct HistoryQueryResult {
+    uint64_t rows = 0;            // 表的总行数
+    uint64_t matches = 0;
+    size_t blocks = 0;
+    size_t blocks_skipped = 0;    // 按块统计整块排除
+    size_t blocks_full = 0;       // 按块统计整块命中，不必扫描
+    uint64_t bytes_scanned = 0;
+    std::vector<uint64_t> sample; // 按行号顺序的前 max_rows 个命中
+    double seconds = 0;
+};
+
+// 多线程扫描 (num_threads <= 0 时使用全部核心)，所有条件同时成立的行为命中
+// 每个线程按原子计数领取块，先用块统计排除或整块接受，其余的块逐列用 SIMD 比较得出位图
+HistoryQueryResult queryHistory(const HandHistory& history, HistoryTable table,
+                                const std::vector<HistoryFilter>& filters, size_t max_rows = 0,
+                                int num_threads = 0);
+
+#endif // HAND_HISTORY_H
@@ -0,0 +1,284 @@
+#include "replay_log.h"
+#include "player.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t header_size = 8;
+
+static void put8(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void put16(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+static uint32_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void encodeReplayRound(const ReplayRound& round, std::vector<uint8_t>& out) {
+    size_t length_pos = out.size();
+    put32(out, 0);  // 长度占位
+
+    put32(out, round.seed);
+    put8(out, round.dealer);
+    put8(out, static_cast<uint32_t>(round.round_wind));
+    put8(out, round.honba);
+    put8(out, round.riichi_sticks);
+    for (int score : round.scores) {
+        put32(out, static_cast<uint32_t>(score));
+    }
+    for (int i = 0; i < 136; ++i) {
+        put8(out, i < (int)round.wall.size() ? round.wall[i] : invalid_tile_index);
+    }
+
+    put16(out, round.decisions.size());
+    for (const ReplayDecision& d : round.decisions) {
+        put8(out, d.seat);
+        put8(out, d.kind);
+        put8(out, d.options);
+        put8(out, d.action);
+    }
+
+    const GameResult& r = round.result;
+    put8(out, static_cast<uint8_t>(static_cast<int8_t>(r.winner)));
+    put8(out, r.is_tsumo ? 1 : 0);
+    put8(out, static_cast<uint8_t>(static_cast<int8_t>(r.from_player)));
+    put8(out, r.han);
+    put8(out, r.fu);
+    put32(out, static_cast<uint32_t>(r.score));
+    for (int delta : r.deltas) {
+        put32(out, static_cast<uint32_t>(delta));
+    }
+    put8(out, r.yaku.size());
+    for (Yaku y : r.yaku) {
+        put8(out, static_cast<uint32_t>(y));
+    }
+
+    uint32_t length = out.size() - length_pos - 4;
+    for (int i = 0; i < 4; ++i) {
+        out[length_pos + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+}
+
+bool decodeReplayRound(const uint8_t* data, size_t size, ReplayRound& round) {
+    // 固定部分: 种子 + 庄家 + 场风 + 本场 + 立直棒 + 点数 + 牌山 + 决策数
+    if (size < 4 + 4 + 16 + 136 + 2) return false;
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+
+    round.seed = get32(p); p += 4;
+    round.dealer = *p++;
+    int wind = *p++;
+    if (round.dealer > 3 || wind > 3) return false;
+    round.round_wind = static_cast<Wind>(wind);
+    round.honba = *p++;
+    round.riichi_sticks = *p++;
+    for (int& score : round.scores) {
+        score = static_cast<int32_t>(get32(p)); p += 4;
+    }
+
+    round.wall.resize(136);
+    for (int i = 0; i < 136; ++i) {
+        round.wall[i] = *p++;
+        if (round.wall[i] >= 136) return false;
+    }
+
+    size_t count = get16(p); p += 2;
+    if ((size_t)(end - p) < count * 4) return false;
+    round.decisions.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        ReplayDecision& d = round.decisions[i];
+        d.seat = p[0];
+        d.kind = p[1];
+        if (d.kind > static_cast<int>(DecisionKind::RiichiDiscard)) return false;
+        d.options = p[2];
+        d.action = p[3];
+        p += 4;
+    }
+
+    if (end - p < 26) return false;
+    GameResult& r = round.result;
+    r.winner = static_cast<int8_t>(*p++);
+    r.is_tsumo = *p++ != 0;
+    r.from_player = static_cast<int8_t>(*p++);
+    r.han = *p++;
+    r.fu = *p++;
+    r.score = static_cast<int32_t>(get32(p)); p += 4;
+    for (int& delta : r.deltas) {
+        delta = static_cast<int32_t>(get32(p)); p += 4;
+    }
+    size_t yaku_count = *p++;
+    if ((size_t)(end - p) < yaku_count) return false;
+    r.yaku.resize(yaku_count);
+    for (size_t i = 0; i < yaku_count; ++i) {
+        if (*p > static_cast<int>(Yaku::Daisuushii)) return false;
+        r.yaku[i] = static_cast<Yaku>(*p++);
+    }
+    return p == end;
+}
+
+// ReplayWriter 实现
+ReplayWriter::ReplayWriter() : file(nullptr) {
+}
+
+ReplayWriter::~ReplayWriter() {
+    close();
+}
+
+bool ReplayWriter::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    buffer.clear();
+    for (char c : replay_magic) put8(buffer, static_cast<uint8_t>(c));
+    put16(buffer, replay_version);
+    put16(buffer, 0);
+    return true;
+}
+
+void ReplayWriter::close() {
+    if (file) {
+        flush();
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void ReplayWriter::writeRound(const ReplayRound& round) {
+    if (!file) return;
+    encodeReplayRound(round, buffer);
+    if (buffer.size() >= (1 << 16)) {
+        flush();
+    }
+}
+
+void ReplayWriter::flush() {
+    if (file && !buffer.empty()) {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        buffer.clear();
+    }
+}
+
+// ReplayRecorder 实现
+ReplayRecorder::ReplayRecorder(Table* t, ReplayWriter* w)
+    : table(t), writer(w), forward(t->getCallbacks()), recorded(0) {
+    GameCallbacks callbacks = forward;
+
+    callbacks.onRoundStart = [this]() {
+        current.seed = table->getRoundSeed();
+        current.dealer = table->getDealer();
+        current.round_wind = table->getRoundWind();
+        current.honba = table->getHonba();
+        current.riichi_sticks = table->getRiichiSticks();
+        for (int i = 0; i < 4; ++i) {
+            Player* player = table->getPlayer(i);
+            current.scores[i] = player ? player->getScore() : 0;
+        }
+        current.wall = table->getWall();
+        current.decisions.clear();
+        if (forward.onRoundStart) forward.onRoundStart();
+    };
+
+    callbacks.onDecision = [this](int seat, DecisionKind kind, int options, int action) {
+        ReplayDecision d;
+        d.seat = static_cast<uint8_t>(seat);
+        d.kind = static_cast<uint8_t>(kind);
+        d.options = static_cast<uint8_t>(options);
+        d.action = static_cast<uint8_t>(action);
+        current.decisions.push_back(d);
+        if (forward.onDecision) forward.onDecision(seat, kind, options, action);
+    };
+
+    callbacks.onGameEnd = [this](const GameResult& result) {
+        current.result = result;
+        writer->writeRound(current);
+        recorded++;
+        if (forward.onGameEnd) forward.onGameEnd(result);
+    };
+
+    table->setCallbacks(callbacks);
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    table->setCallbacks(forward);
+}
+
+// ReplayLog 实现
+ReplayLog::ReplayLog() : data(nullptr), size(0), truncated(false) {
+}
+
+ReplayLog::~ReplayLog() {
+    close();
+}
+
+bool ReplayLog::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < header_size) {
+        ::close(fd);
+        return false;
+    }
+    size = st.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = static_cast<const uint8_t*>(mapped);
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    if (std::memcmp(data, replay_magic, 4) != 0 || get16(data + 4) != replay_version) {
+        close();
+        return false;
+    }
+
+    // 顺着长度前缀跳一遍，建立索引
+    size_t pos = header_size;
+    while (pos + 4 <= size) {
+        uint32_t length = get32(data + pos);
+        if (length > size - pos - 4) break;
+        offsets.push_back(pos + 4);
+        lengths.push_back(length);
+        pos += 4 + length;
+    }
+    truncated = (pos != size);
+    return true;
+}
+
+void ReplayLog::close() {
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    offsets.clear();
+    lengths.clear();
+    truncated = false;
+}
+
+bool ReplayLog::readRound(size_t index, ReplayRound& round) const {
+    if (index >= offsets.size()) return false;
+    return decodeReplayRound(data + offsets[index], lengths[index], round);
+}
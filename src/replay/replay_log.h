@@ -0,0 +1,104 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "table.h"
+
+// 牌谱文件格式 (小端序):
+//   文件头: "MJRP" + u16 版本 + u16 保留
+//   每局:   u32 记录长度 + 记录内容
+//   记录:   u32 种子, u8 庄家, u8 场风, u8 本场, u8 立直棒, i32[4] 开局点数, u8[136] 牌山,
+//           u16 决策数, 决策 (每条 4 字节: 座位, 决策类型, 可选动作, 动作),
+//           i8 赢家, u8 自摸, i8 放铳者, u8 番, u8 符, i32 得点, i32[4] 点数变化, u8 役数, u8[] 役
+const char replay_magic[4] = {'M', 'J', 'R', 'P'};
+const uint16_t replay_version = 2;
+
+// 一次决策
+struct ReplayDecision {
+    uint8_t seat;
+    uint8_t kind;         // DecisionKind
+    uint8_t options;      // DecisionOption 位
+    uint8_t action;       // 0-135 弃牌 或 Action
+};
+
+// 一局的完整记录
+struct ReplayRound {
+    uint32_t seed;
+    int dealer;
+    Wind round_wind;
+    int honba;
+    int riichi_sticks;
+    std::array<int, 4> scores;  // 开局时各家点数
+    TileIndexList wall;
+    std::vector<ReplayDecision> decisions;
+    GameResult result;
+};
+
+// 编码 / 解码一局 (解码失败返回 false)
+void encodeReplayRound(const ReplayRound& round, std::vector<uint8_t>& out);
+bool decodeReplayRound(const uint8_t* data, size_t size, ReplayRound& round);
+
+// 牌谱写入 (顺序写，带缓冲)
+class ReplayWriter {
+private:
+    std::FILE* file;
+    std::vector<uint8_t> buffer;
+
+public:
+    ReplayWriter();
+    ~ReplayWriter();
+
+    // 新建 (截断) 文件
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    void writeRound(const ReplayRound& round);
+    void flush();
+};
+
+// 记录 Table 打的每一局
+// 挂接到 Table 的回调上，原有回调仍会被调用
+class ReplayRecorder {
+private:
+    Table* table;
+    ReplayWriter* writer;
+    ReplayRound current;
+    GameCallbacks forward;  // 挂接前的回调
+    size_t recorded;
+
+public:
+    ReplayRecorder(Table* t, ReplayWriter* w);
+    ~ReplayRecorder();
+
+    size_t getRecordedCount() const { return recorded; }
+};
+
+// 只读映射的牌谱文件，打开时建立每局的偏移索引
+class ReplayLog {
+private:
+    const uint8_t* data;
+    size_t size;
+    std::vector<uint64_t> offsets;  // 每局记录内容的起始位置
+    std::vector<uint32_t> lengths;
+    bool truncated;                 // 文件尾部有不完整的记录
+
+public:
+    ReplayLog();
+    ~ReplayLog();
+    ReplayLog(const ReplayLog&) = delete;
+    ReplayLog& operator=(const ReplayLog&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    size_t getRoundCount() const { return offsets.size(); }
+    bool isTruncated() const { return truncated; }
+    bool readRound(size_t index, ReplayRound& round) const;
+};
+
+#endif // REPLAY_LOG_H
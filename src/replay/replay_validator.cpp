@@ -0,0 +1,192 @@
+#include "replay_validator.h"
+#include "scoring.h"
+#include "tiles.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+// ReplayScript 实现
+void ReplayScript::reset(const std::vector<ReplayDecision>* d) {
+    decisions = d;
+    cursor = 0;
+    divergence.clear();
+}
+
+static const char* kindName(int kind) {
+    switch (static_cast<DecisionKind>(kind)) {
+        case DecisionKind::Action: return "action";
+        case DecisionKind::Response: return "response";
+        case DecisionKind::RiichiDiscard: return "riichi discard";
+    }
+    return "?";
+}
+
+int ReplayScript::next(int seat, DecisionKind kind, int options, int fallback) {
+    // 已经分歧后不再取记录，尽快把这一局走完
+    if (!divergence.empty()) return fallback;
+
+    if (!decisions || cursor >= decisions->size()) {
+        std::ostringstream ss;
+        ss << "decision #" << cursor << ": engine asked seat " << seat << " but log has no more decisions";
+        divergence = ss.str();
+        return fallback;
+    }
+
+    const ReplayDecision& d = (*decisions)[cursor];
+    if (d.seat != seat || d.kind != static_cast<int>(kind) || d.options != options) {
+        std::ostringstream ss;
+        ss << "decision #" << cursor << ": engine asked seat " << seat
+           << " " << kindName(static_cast<int>(kind)) << " options=" << options
+           << ", log has seat " << (int)d.seat
+           << " " << kindName(d.kind) << " options=" << (int)d.options;
+        divergence = ss.str();
+        return fallback;
+    }
+
+    cursor++;
+    return d.action;
+}
+
+// ReplayPlayer 实现
+ReplayPlayer::ReplayPlayer(ReplayScript* s) : Player("Replay"), script(s) {
+}
+
+int ReplayPlayer::decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) {
+    int options = (can_tsumo ? DecisionOption::Tsumo : 0) |
+                  (can_ankan ? DecisionOption::Ankan : 0) |
+                  (can_riichi ? DecisionOption::Riichi : 0);
+    int action = script->next(seat, DecisionKind::Action, options, drawn_tile);
+    // 记录中的弃牌必须在手里，否则说明牌山或手牌已经和记录时不同
+    if (action < 136 && !canDiscard(action) && script->divergence.empty()) {
+        std::ostringstream ss;
+        ss << "decision #" << script->cursor - 1 << ": seat " << seat
+           << " cannot discard " << getTileName(action);
+        script->divergence = ss.str();
+        return drawn_tile;
+    }
+    return action;
+}
+
+int ReplayPlayer::decideResponse(TileIndex, int, bool can_chi, bool can_pon, bool can_kan, bool can_ron) {
+    int options = (can_chi ? DecisionOption::Chi : 0) |
+                  (can_pon ? DecisionOption::Pon : 0) |
+                  (can_kan ? DecisionOption::Kan : 0) |
+                  (can_ron ? DecisionOption::Ron : 0);
+    return script->next(seat, DecisionKind::Response, options, static_cast<int>(Action::Pass));
+}
+
+TileIndex ReplayPlayer::selectRiichiDiscard(TileIndex drawn_tile) {
+    return script->next(seat, DecisionKind::RiichiDiscard, 0, drawn_tile);
+}
+
+static std::string describeResult(const GameResult& r) {
+    std::ostringstream ss;
+    ss << "winner=" << r.winner << " from=" << r.from_player
+       << " tsumo=" << r.is_tsumo << " han=" << r.han << " fu=" << r.fu
+       << " score=" << r.score << " deltas=" << r.deltas[0] << "/" << r.deltas[1]
+       << "/" << r.deltas[2] << "/" << r.deltas[3] << " yaku=[" << getYakuNames(r.yaku) << "]";
+    return ss.str();
+}
+
+bool replayRound(const ReplayRound& round, Table& table, ReplayScript& script, std::string& reason) {
+    script.reset(&round.decisions);
+    table.setDealer(round.dealer);
+    table.setRoundWind(round.round_wind);
+    table.setHonba(round.honba);
+    table.setRiichiSticks(round.riichi_sticks);
+    for (int i = 0; i < 4; ++i) {
+        if (table.getPlayer(i)) table.getPlayer(i)->setScore(round.scores[i]);
+    }
+    table.setNextWall(round.wall);
+
+    GameResult result = table.playRound();
+
+    if (!script.divergence.empty()) {
+        reason = script.divergence;
+        return false;
+    }
+    if (script.cursor != round.decisions.size()) {
+        std::ostringstream ss;
+        ss << "round ended after " << script.cursor << " of " << round.decisions.size() << " decisions";
+        reason = ss.str();
+        return false;
+    }
+
+    const GameResult& expected = round.result;
+    if (result.winner != expected.winner || result.from_player != expected.from_player ||
+        result.is_tsumo != expected.is_tsumo || result.yaku != expected.yaku ||
+        result.han != expected.han || result.fu != expected.fu || result.score != expected.score ||
+        result.deltas != expected.deltas) {
+        reason = "result differs: log {" + describeResult(expected) + "} engine {" + describeResult(result) + "}";
+        return false;
+    }
+    return true;
+}
+
+ReplayReport validateReplay(const ReplayLog& log, int num_threads, size_t max_mismatches) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    ReplayReport report;
+    report.rounds = log.getRoundCount();
+
+    std::atomic<size_t> next_round(0);
+    std::atomic<size_t> failed(0);
+    std::mutex mismatch_mutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // 每个线程独占一张牌桌和四个回放玩家，按原子计数领取局号
+    auto worker = [&]() {
+        Table table;
+        ReplayScript script;
+        ReplayPlayer players[4] = {ReplayPlayer(&script), ReplayPlayer(&script),
+                                   ReplayPlayer(&script), ReplayPlayer(&script)};
+        for (int i = 0; i < 4; ++i) {
+            table.setPlayer(i, &players[i]);
+        }
+
+        ReplayRound round;
+        std::string reason;
+        while (true) {
+            size_t index = next_round.fetch_add(1, std::memory_order_relaxed);
+            if (index >= report.rounds) break;
+
+            bool ok;
+            if (!log.readRound(index, round)) {
+                ok = false;
+                reason = "corrupt record";
+            } else {
+                ok = replayRound(round, table, script, reason);
+            }
+
+            if (!ok) {
+                failed.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(mismatch_mutex);
+                if (report.mismatches.size() < max_mismatches) {
+                    report.mismatches.push_back({index, reason});
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report.seconds = elapsed.count();
+    std::sort(report.mismatches.begin(), report.mismatches.end(),
+              [](const ReplayMismatch& a, const ReplayMismatch& b) { return a.round < b.round; });
+    report.failed = failed.load();
+    report.passed = report.rounds - report.failed;
+    return report;
+}
@@ -0,0 +1,53 @@
+#ifndef REPLAY_VALIDATOR_H
+#define REPLAY_VALIDATOR_H
+
+#include <string>
+#include <vector>
+#include "player.h"
+#include "replay_log.h"
+
+// 一局回放中共享的决策流
+// 四个 ReplayPlayer 按记录顺序依次取用，顺序或可选动作不一致即视为分歧
+struct ReplayScript {
+    const std::vector<ReplayDecision>* decisions = nullptr;
+    size_t cursor = 0;
+    std::string divergence;  // 第一次分歧的描述 (空表示一致)
+
+    void reset(const std::vector<ReplayDecision>* d);
+    int next(int seat, DecisionKind kind, int options, int fallback);
+};
+
+// 按牌谱给出决策的玩家
+class ReplayPlayer : public Player {
+private:
+    ReplayScript* script;
+
+public:
+    ReplayPlayer(ReplayScript* s);
+
+    int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override;
+    int decideResponse(TileIndex discard, int from_seat, bool can_chi, bool can_pon, bool can_kan, bool can_ron) override;
+    TileIndex selectRiichiDiscard(TileIndex drawn_tile) override;
+};
+
+// 回放时发现的不一致
+struct ReplayMismatch {
+    size_t round;
+    std::string reason;
+};
+
+struct ReplayReport {
+    size_t rounds = 0;
+    size_t passed = 0;
+    size_t failed = 0;
+    std::vector<ReplayMismatch> mismatches;  // 最多保留 max_mismatches 条
+    double seconds = 0;
+};
+
+// 用当前引擎重新模拟一局并与记录比较，不一致时写入 reason
+bool replayRound(const ReplayRound& round, Table& table, ReplayScript& script, std::string& reason);
+
+// 多线程回放整个牌谱文件 (num_threads <= 0 时使用全部核心)
+ReplayReport validateReplay(const ReplayLog& log, int num_threads = 0, size_t max_mismatches = 16);
+
+#endif // REPLAY_VALIDATOR_H
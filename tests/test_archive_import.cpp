@@ -0,0 +1,476 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "table.h"
+#include "simple_ai.h"
+#include "archive_import.h"
+#include "replay_log.h"
+#include "replay_validator.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// 自对局记录下来的一局，之后写成天凤和 mjai 两种格式
+struct GameLog {
+    int dealer;
+    int round_wind;
+    int honba;
+    int sticks;
+    std::array<int, 4> scores;
+    TileIndexList wall;
+    struct Event {
+        char kind;  // T 摸牌, D 弃牌, R 立直宣言, A 立直成立, N 鸣牌 / 暗杠
+        int seat;
+        int tile;
+    };
+    std::vector<Event> events;
+    std::vector<ReplayDecision> decisions;
+    GameResult result;
+    std::array<int, 4> log_deltas;  // 记录里的点数变化 (不含立直棒支付)
+    bool has_call = false;
+};
+
+static std::vector<GameLog> playGames(int rounds, uint32_t seed) {
+    Table table;
+    SimpleAI players[4] = {SimpleAI("A"), SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    std::vector<GameLog> logs;
+    GameLog* log = nullptr;
+    int pending_riichi = -1;
+    auto accept = [&]() {
+        if (pending_riichi >= 0) log->events.push_back({'A', pending_riichi, 0});
+        pending_riichi = -1;
+    };
+
+    GameCallbacks callbacks;
+    callbacks.onDraw = [&](int seat, TileIndex tile) {
+        accept();
+        log->events.push_back({'T', seat, tile});
+    };
+    callbacks.onDiscard = [&](int seat, TileIndex tile) { log->events.push_back({'D', seat, tile}); };
+    callbacks.onMeld = [&](int seat, int, TileIndex) {
+        accept();
+        log->events.push_back({'N', seat, 0});
+        log->has_call = true;
+    };
+    callbacks.onDecision = [&](int seat, DecisionKind kind, int options, int action) {
+        log->decisions.push_back({static_cast<uint8_t>(seat), static_cast<uint8_t>(kind),
+                                  static_cast<uint8_t>(options), static_cast<uint8_t>(action)});
+        if (kind == DecisionKind::Action && action == static_cast<int>(Action::Riichi)) {
+            log->events.push_back({'R', seat, 0});
+            pending_riichi = seat;
+        }
+        if (kind == DecisionKind::Action && action == static_cast<int>(Action::Ankan)) {
+            log->events.push_back({'N', seat, 0});
+            log->has_call = true;
+        }
+    };
+    callbacks.onGameEnd = [&](const GameResult& result) {
+        // 宣言牌被荣和时立直不成立
+        if (result.winner >= 0 && result.from_player == pending_riichi) pending_riichi = -1;
+        accept();
+        // 头跳时被截和的荣和宣言不会出现在牌谱里，导入后是过
+        for (ReplayDecision& d : log->decisions) {
+            if (d.kind == static_cast<uint8_t>(DecisionKind::Response) && d.seat != result.winner &&
+                d.action == static_cast<uint8_t>(Action::Win)) {
+                d.action = static_cast<uint8_t>(Action::Pass);
+            }
+        }
+        log->result = result;
+        log->log_deltas = result.deltas;
+        for (const GameLog::Event& e : log->events) {
+            if (e.kind == 'A') log->log_deltas[e.seat] += 1000;
+        }
+    };
+    table.setCallbacks(callbacks);
+
+    std::mt19937 rng(seed);
+    for (int r = 0; r < rounds; ++r) {
+        logs.emplace_back();
+        log = &logs.back();
+        log->dealer = r % 4;
+        log->round_wind = (r / 4) % 2;
+        log->honba = r % 3;
+        log->sticks = r % 2;
+        for (int i = 0; i < 4; ++i) log->scores[i] = 25000 + 100 * (r % 7) * (i - 1);
+        log->wall.resize(136);
+        std::iota(log->wall.begin(), log->wall.end(), 0);
+        std::shuffle(log->wall.begin(), log->wall.end(), rng);
+
+        table.setDealer(log->dealer);
+        table.setRoundWind(static_cast<Wind>(log->round_wind));
+        table.setHonba(log->honba);
+        table.setRiichiSticks(log->sticks);
+        for (int i = 0; i < 4; ++i) players[i].setScore(log->scores[i]);
+        table.setNextWall(log->wall);
+        pending_riichi = -1;
+        table.playRound();
+    }
+    return logs;
+}
+
+static std::string tileList(const TileIndexList& wall, int start) {
+    std::string s;
+    for (int k = 0; k < 13; ++k) {
+        if (k) s += ",";
+        s += std::to_string(wall[start + k]);
+    }
+    return s;
+}
+
+static void writeTenhou(const std::vector<GameLog>& logs, size_t begin, size_t end, const std::string& path) {
+    std::ofstream out(path);
+    out << "<mjloggm ver=\"2.3\"><SHUFFLE seed=\"mt19937ar\" ref=\"\"/><GO type=\"169\" lobby=\"0\"/>"
+        << "<UN n0=\"A\" n1=\"B\" n2=\"C\" n3=\"D\" dan=\"0,0,0,0\"/><TAIKYOKU oya=\"0\"/>\n";
+    for (size_t r = begin; r < end; ++r) {
+        const GameLog& log = logs[r];
+        out << "<INIT seed=\"" << log.round_wind * 4 + log.dealer << "," << log.honba << "," << log.sticks
+            << ",3,4," << log.wall[126] << "\" ten=\"";
+        for (int i = 0; i < 4; ++i) out << (i ? "," : "") << log.scores[i] / 100;
+        out << "\" oya=\"" << log.dealer << "\"";
+        for (int i = 0; i < 4; ++i) out << " hai" << i << "=\"" << tileList(log.wall, i * 13) << "\"";
+        out << "/>";
+        for (const GameLog::Event& e : log.events) {
+            if (e.kind == 'T') out << "<" << "TUVW"[e.seat] << e.tile << "/>";
+            else if (e.kind == 'D') out << "<" << "DEFG"[e.seat] << e.tile << "/>";
+            else if (e.kind == 'R') out << "<REACH who=\"" << e.seat << "\" step=\"1\"/>";
+            else if (e.kind == 'A') out << "<REACH who=\"" << e.seat << "\" ten=\"250,250,250,250\" step=\"2\"/>";
+            else if (e.kind == 'N') out << "<N who=\"" << e.seat << "\" m=\"42031\" />";
+        }
+        std::ostringstream sc;
+        for (int i = 0; i < 4; ++i) sc << (i ? "," : "") << log.scores[i] / 100 << "," << log.log_deltas[i] / 100;
+        const GameResult& result = log.result;
+        if (result.winner >= 0) {
+            int from = result.from_player < 0 ? result.winner : result.from_player;
+            out << "<AGARI ba=\"" << log.honba << "," << log.sticks << "\" hai=\"0\" machi=\"0\" ten=\"30,"
+                << result.score << ",0\" yaku=\"1,1\" doraHai=\"0\" who=\"" << result.winner << "\" fromWho=\""
+                << from << "\" sc=\"" << sc.str() << "\" />\n";
+        } else {
+            out << "<RYUUKYOKU ba=\"" << log.honba << "," << log.sticks << "\" sc=\"" << sc.str() << "\" />\n";
+        }
+    }
+    out << "</mjloggm>\n";
+}
+
+static std::string mjaiTile(TileIndex tile) {
+    int kind = tile / 4;
+    if (kind >= 27) return std::string(1, "ESWNPFC"[kind - 27]);
+    std::string s = std::to_string(kind % 9 + 1) + "mps"[kind / 9];
+    if (kind % 9 == 4 && tile % 4 == 0) s += "r";
+    return s;
+}
+
+static std::string mjaiInts(const std::array<int, 4>& values) {
+    std::string s = "[";
+    for (int i = 0; i < 4; ++i) s += (i ? "," : "") + std::to_string(values[i]);
+    return s + "]";
+}
+
+static void writeMjai(const std::vector<GameLog>& logs, size_t begin, size_t end, const std::string& path) {
+    std::ofstream out(path);
+    out << "{\"type\":\"start_game\",\"names\":[\"A\",\"B\",\"C\",\"D\"]}\n";
+    for (size_t r = begin; r < end; ++r) {
+        const GameLog& log = logs[r];
+        out << "{\"type\":\"start_kyoku\",\"bakaze\":\"" << "ESWN"[log.round_wind] << "\",\"dora_marker\":\""
+            << mjaiTile(log.wall[126]) << "\",\"kyoku\":" << log.dealer + 1 << ",\"honba\":" << log.honba
+            << ",\"kyotaku\":" << log.sticks << ",\"oya\":" << log.dealer << ",\"scores\":" << mjaiInts(log.scores)
+            << ",\"tehais\":[";
+        for (int i = 0; i < 4; ++i) {
+            out << (i ? "," : "") << "[";
+            for (int k = 0; k < 13; ++k) out << (k ? "," : "") << "\"" << mjaiTile(log.wall[i * 13 + k]) << "\"";
+            out << "]";
+        }
+        out << "]}\n";
+        int drawn[4] = {-1, -1, -1, -1};
+        for (const GameLog::Event& e : log.events) {
+            if (e.kind == 'T') {
+                drawn[e.seat] = e.tile;
+                out << "{\"type\":\"tsumo\",\"actor\":" << e.seat << ",\"pai\":\"" << mjaiTile(e.tile) << "\"}\n";
+            } else if (e.kind == 'D') {
+                out << "{\"type\":\"dahai\",\"actor\":" << e.seat << ",\"pai\":\"" << mjaiTile(e.tile)
+                    << "\",\"tsumogiri\":" << (e.tile == drawn[e.seat] ? "true" : "false") << "}\n";
+            } else if (e.kind == 'R') {
+                out << "{\"type\":\"reach\",\"actor\":" << e.seat << "}\n";
+            } else if (e.kind == 'A') {
+                out << "{\"type\":\"reach_accepted\",\"actor\":" << e.seat << "}\n";
+            } else if (e.kind == 'N') {
+                out << "{\"type\":\"pon\",\"actor\":" << e.seat << ",\"target\":0,\"pai\":\"E\","
+                    << "\"consumed\":[\"E\",\"E\"]}\n";
+            }
+        }
+        const GameResult& result = log.result;
+        if (result.winner >= 0) {
+            int from = result.from_player < 0 ? result.winner : result.from_player;
+            out << "{\"type\":\"hora\",\"actor\":" << result.winner << ",\"target\":" << from
+                << ",\"deltas\":" << mjaiInts(log.log_deltas) << "}\n";
+        } else {
+            out << "{\"type\":\"ryukyoku\",\"reason\":\"fanpai\",\"deltas\":" << mjaiInts(log.log_deltas) << "}\n";
+        }
+        out << "{\"type\":\"end_kyoku\"}\n";
+    }
+    out << "{\"type\":\"end_game\"}\n";
+}
+
+static void writeText(const std::string& path, const std::string& text) {
+    std::ofstream out(path);
+    out << text;
+}
+
+// 按牌种比较 (mjai 只记牌种，同种牌的编号按出现顺序重新分配)
+static std::string wallKey(const TileIndexList& wall) {
+    std::string key;
+    for (int i = 0; i < 52; ++i) key += static_cast<char>(wall[i] / 4);
+    return key;
+}
+
+static bool sameDecisions(const std::vector<ReplayDecision>& a, const std::vector<ReplayDecision>& b, bool by_kind) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        int x = a[i].action, y = b[i].action;
+        if (by_kind && x < 136 && y < 136) {
+            x /= 4;
+            y /= 4;
+        }
+        if (a[i].seat != b[i].seat || a[i].kind != b[i].kind || a[i].options != b[i].options || x != y) return false;
+    }
+    return true;
+}
+
+// Test the two parsers on small hand-written records
+int testParsers() {
+    std::cout << "\n=== Testing parsers ===" << std::endl;
+
+    std::string tenhou =
+        "<mjloggm ver=\"2.3\"><GO type=\"169\" lobby=\"0\"/><UN n0=\"a\" n1=\"b\" n2=\"c\" n3=\"d\"/>"
+        "<INIT seed=\"5,1,2,3,4,130\" ten=\"250,240,260,250\" oya=\"1\" "
+        "hai0=\"0,1,2,3,4,5,6,7,8,9,10,11,12\" hai1=\"13,14,15,16,17,18,19,20,21,22,23,24,25\" "
+        "hai2=\"26,27,28,29,30,31,32,33,34,35,36,37,38\" hai3=\"39,40,41,42,43,44,45,46,47,48,49,50,51\"/>"
+        "<U100/><REACH who=\"1\" step=\"1\"/><E13/><REACH who=\"1\" ten=\"250,230,260,250\" step=\"2\"/>"
+        "<V101/><F26/><W102/><AGARI who=\"3\" fromWho=\"3\" sc=\"250,-10,230,-20,260,-10,250,40\"/>"
+        "<INIT seed=\"0,0,0,1,1,0\"";  // 截断的下一局
+    writeText("test_archive_small.xml", tenhou);
+
+    ArchiveFormat format;
+    TEST_ASSERT(detectArchiveFormat("test_archive_small.xml", format) && format == ArchiveFormat::Tenhou,
+                "format from extension");
+    std::unique_ptr<ArchiveParser> parser = openArchive("test_archive_small.xml", format, 7);
+    TEST_ASSERT(parser != nullptr, "open tenhou record");
+
+    ArchiveRound round;
+    std::string error;
+    TEST_ASSERT(parser->next(round, error) && error.empty(), "first round parses across 7-byte chunks");
+    TEST_ASSERT(round.dealer == 1 && round.round_wind == Wind::South && round.honba == 1 &&
+                round.riichi_sticks == 2 && round.dora_indicator == 130, "INIT seed fields");
+    TEST_ASSERT(round.scores == (std::array<int, 4>{25000, 24000, 26000, 25000}) &&
+                round.hands[3].size() == 13 && round.hands[3][0] == 39, "INIT scores and hands");
+    TEST_ASSERT(round.events.size() == 7 && round.events[1].kind == ArchiveEventKind::Riichi &&
+                round.events[2].kind == ArchiveEventKind::Discard && round.events[2].tile == 13 &&
+                round.events[6].kind == ArchiveEventKind::Win && round.events[6].from == 3,
+                "draws, discards, riichi and win in order");
+    TEST_ASSERT(round.finished && round.winner == 3 && round.from_player == -1 &&
+                round.deltas == (std::array<int, 4>{-1000, -3000, -1000, 4000}),
+                "tsumo result, riichi stick included in deltas");
+    TEST_ASSERT(parser->next(round, error) && !error.empty(), "truncated round reported as malformed");
+    TEST_ASSERT(!parser->next(round, error), "end of file");
+
+    std::string mjai =
+        "{\"type\":\"start_game\"}\n"
+        "{\"type\":\"start_kyoku\",\"bakaze\":\"E\",\"kyoku\":3,\"honba\":0,\"kyotaku\":0,\"oya\":2,"
+        "\"dora_marker\":\"5pr\",\"scores\":[25000,25000,25000,25000],\"tehais\":["
+        "[\"5m\",\"5m\",\"5mr\",\"5m\",\"1m\",\"1m\",\"1m\",\"1m\",\"2m\",\"2m\",\"2m\",\"2m\",\"E\"],"
+        "[\"3m\",\"3m\",\"3m\",\"3m\",\"4m\",\"4m\",\"4m\",\"4m\",\"6m\",\"6m\",\"6m\",\"6m\",\"S\"],"
+        "[\"7m\",\"7m\",\"7m\",\"7m\",\"8m\",\"8m\",\"8m\",\"8m\",\"9m\",\"9m\",\"9m\",\"9m\",\"W\"],"
+        "[\"1p\",\"1p\",\"1p\",\"1p\",\"2p\",\"2p\",\"2p\",\"2p\",\"3p\",\"3p\",\"3p\",\"3p\",\"N\"]]}\r\n"
+        "{\"type\":\"tsumo\",\"actor\":2,\"pai\":\"C\"}\n"
+        "{\"type\":\"dahai\",\"actor\":2,\"pai\":\"C\",\"tsumogiri\":true}\n"
+        "{\"type\":\"tsumo\",\"actor\":3,\"pai\":\"5p\"}\n"
+        "{\"type\":\"dahai\",\"actor\":3,\"pai\":\"N\",\"tsumogiri\":false}\n"
+        "{\"type\":\"ryukyoku\",\"reason\":\"fanpai\",\"deltas\":[0,0,0,0]}\n"
+        "{\"type\":\"end_kyoku\"}\n"
+        "not json\n"
+        "{\"type\":\"start_kyoku\",\"bakaze\":\"E\",\"kyoku\":1,\"honba\":0,\"kyotaku\":0,\"oya\":0,"
+        "\"scores\":[25000,25000,25000,25000],\"tehais\":[[],[],[],[]]}\n"
+        "{\"type\":\"pon\",\"actor\":1}\n"
+        "{\"type\":\"ryukyoku\",\"reason\":\"kyushukyuhai\"}\n"
+        "{\"type\":\"end_kyoku\"}\n";
+    writeText("test_archive_small", mjai);
+
+    TEST_ASSERT(detectArchiveFormat("test_archive_small", format) && format == ArchiveFormat::Mjai,
+                "format from content");
+    parser = openArchive("test_archive_small", format, 5);
+    TEST_ASSERT(parser && parser->next(round, error) && error.empty(), "mjai round parses across 5-byte chunks");
+    TEST_ASSERT(round.dealer == 2 && round.round_wind == Wind::East && round.hands[0].size() == 13,
+                "start_kyoku fields");
+    TEST_ASSERT(round.hands[0][0] == 17 && round.hands[0][1] == 18 && round.hands[0][2] == 16 &&
+                round.hands[0][3] == 19, "plain fives take copies 1-3, red five takes copy 0");
+    TEST_ASSERT(round.dora_indicator == 52 && round.events.size() == 4 && round.events[2].tile == 53 &&
+                round.events[3].tile == 108 + 12, "ids follow the order tiles appear");
+    TEST_ASSERT(round.finished && round.winner == -1 && round.unsupported.empty(), "exhaustive draw");
+    TEST_ASSERT(parser->next(round, error) && !error.empty(), "bad json line reported");
+    TEST_ASSERT(parser->next(round, error) && error.empty() && round.unsupported == "call",
+                "call marks the round unsupported");
+    TEST_ASSERT(!parser->next(round, error), "end of file");
+
+    std::remove("test_archive_small.xml");
+    std::remove("test_archive_small");
+    return 0;
+}
+
+// Test importing self-play records written in both formats
+int testImport() {
+    std::cout << "\n=== Testing import ===" << std::endl;
+
+    const int rounds = 80;
+    std::vector<GameLog> logs = playGames(rounds, 2025);
+    size_t calls = 0;
+    std::map<std::string, const GameLog*> by_wall;
+    for (const GameLog& log : logs) {
+        if (log.has_call) calls++;
+        else by_wall[wallKey(log.wall)] = &log;
+    }
+    size_t clean = rounds - calls;
+    std::cout << "  " << clean << " of " << rounds << " rounds without calls" << std::endl;
+    TEST_ASSERT(clean >= 10 && calls >= 10, "self-play has rounds with and without calls");
+
+    std::vector<std::string> paths = {"test_archive_a.mjlog", "test_archive_b.xml", "test_archive_c.jsonl",
+                                      "test_archive_d.mjson"};
+    writeTenhou(logs, 0, rounds / 2, paths[0]);
+    writeTenhou(logs, rounds / 2, rounds, paths[1]);
+    writeMjai(logs, 0, rounds / 2, paths[2]);
+    writeMjai(logs, rounds / 2, rounds, paths[3]);
+
+    ReplayWriter writer;
+    TEST_ASSERT(writer.open("test_archive_import.mjr"), "open output log");
+    size_t matched = 0, exact = 0, unmatched = 0;
+    ImportSink sink = [&](const ReplayRound& round) {
+        writer.writeRound(round);
+        auto it = by_wall.find(wallKey(round.wall));
+        if (it == by_wall.end() || !sameDecisions(round.decisions, it->second->decisions, true) ||
+            round.result.deltas != it->second->result.deltas) {
+            unmatched++;
+            return;
+        }
+        const GameLog& log = *it->second;
+        matched++;
+        if (std::equal(log.wall.begin(), log.wall.begin() + 52, round.wall.begin()) &&
+            sameDecisions(round.decisions, log.decisions, false)) {
+            exact++;
+        }
+    };
+
+    // 很小的块，让标签和行频繁跨越块边界
+    ImportReport report = importArchives(paths, 2, sink, 16, 64);
+    writer.close();
+    for (const ImportIssue& issue : report.issues) {
+        std::cout << "  " << issue.file << " round " << issue.round << ": " << issue.reason << std::endl;
+    }
+    std::cout << "  " << report.imported << " imported, " << report.unsupported << " unsupported in "
+              << report.seconds << "s" << std::endl;
+
+    TEST_ASSERT(report.files == 4 && report.unreadable == 0 && report.rounds == 2 * rounds, "every round read");
+    TEST_ASSERT(report.malformed == 0 && report.diverged == 0 && report.score_mismatches == 0,
+                "no malformed, diverged or mismatched rounds");
+    TEST_ASSERT(report.unsupported == 2 * calls && report.imported == 2 * clean,
+                "rounds with calls skipped, the rest imported");
+    TEST_ASSERT(unmatched == 0 && matched == 2 * clean, "imported rounds reproduce the original decisions");
+    TEST_ASSERT(exact >= clean, "tenhou rounds keep the original tile ids");
+
+    ReplayLog log;
+    TEST_ASSERT(log.open("test_archive_import.mjr") && log.getRoundCount() == 2 * clean, "imported rounds written");
+    ReplayReport replay = validateReplay(log, 2);
+    TEST_ASSERT(replay.failed == 0 && replay.passed == 2 * clean, "imported log replays cleanly");
+    log.close();
+
+    for (const std::string& path : paths) std::remove(path.c_str());
+    std::remove("test_archive_import.mjr");
+    return 0;
+}
+
+// Test malformed and unsupported records are counted and skipped
+int testMalformed() {
+    std::cout << "\n=== Testing malformed records ===" << std::endl;
+
+    std::vector<GameLog> logs = playGames(8, 77);
+    size_t clean = 0;
+    for (const GameLog& log : logs) {
+        if (!log.has_call) clean++;
+    }
+    writeTenhou(logs, 0, logs.size(), "test_archive_good.xml");
+
+    // 坏数据夹在正常的局之间
+    std::string junk =
+        "<mjloggm ver=\"2.3\">"
+        "<INIT seed=\"0,0,0\" ten=\"250,250,250,250\" oya=\"0\" hai0=\"\" hai1=\"\" hai2=\"\" hai3=\"\"/>"
+        "<T5/><D5/>"
+        "<INIT seed=\"0,0,0,1,1,130\" ten=\"250,250,250,250\" oya=\"0\" hai0=\"0,1,2,3,4,5,6,7,8,9,10,11,12\" "
+        "hai1=\"13,14,15,16,17,18,19,20,21,22,23,24,25\" hai2=\"26,27,28,29,30,31,32,33,34,35,36,37,38\" "
+        "hai3=\"39,40,41,42,43,44,45,46,47,48,49,50,51\"/><T3/><D3/>"
+        "<RYUUKYOKU sc=\"250,0,250,0,250,0,250,0\"/>"
+        "<INIT seed=\"0,0,0,1,1,130\" ten=\"250,250,250,250\" oya=\"0\" hai0=\"0,1,2,3,4,5,6,7,8,9,10,11,12\" "
+        "hai1=\"13,14,15,16,17,18,19,20,21,22,23,24,25\" hai2=\"26,27,28,29,30,31,32,33,34,35,36,37,38\" "
+        "hai3=\"39,40,41,42,43,44,45,46,47,48,49,50,51\"/><T60/><D0/>"
+        "<RYUUKYOKU type=\"yao9\" sc=\"250,0,250,0,250,0,250,0\"/>"
+        "<INIT seed=\"0,0,0,1,1,130\" ten=\"250,250,250,250\" oya=\"0\" hai0=\"0,1,2,3,4,5,6,7,8,9,10,11,12\" "
+        "hai1=\"13,14,15,16,17,18,19,20,21,22,23,24,25\" hai2=\"26,27,28,29,30,31,32,33,34,35,36,37,38\" "
+        "hai3=\"39,40,41,42,43,44,45,46,47,48,49,50,51\"/><T60/><D60/><U61/><D61/>"
+        "<RYUUKYOKU sc=\"250,0,250,0,250,0,250,0\"/>"
+        "<INIT seed=\"0,0,0,1,1,130\" ten=\"250,250,250,250\" oya=\"0\" hai0=\"0,1,2,3,4,5,6,7,8,9,10,11,12\" "
+        "hai1=\"13,14,15,16,17,18,19,20,21,22,23,24,25\" hai2=\"26,27,28,29,30,31,32,33,34,35,36,37,38\" "
+        "hai3=\"39,40,41,42,43,44,45,46,47,48,49,50,51\"/><T60/><D60/>"
+        "</mjloggm>";
+    writeText("test_archive_junk.xml", junk);
+    writeText("test_archive_unknown.txt", "hello\n");
+
+    std::vector<std::string> paths = {"test_archive_good.xml", "test_archive_junk.xml", "test_archive_unknown.txt",
+                                      "test_archive_missing.xml"};
+    size_t sunk = 0;
+    ImportReport report = importArchives(paths, 3, [&](const ReplayRound&) { sunk++; }, 4);
+    for (const ImportIssue& issue : report.issues) {
+        std::cout << "  " << issue.file << " round " << issue.round << ": " << issue.reason << std::endl;
+    }
+
+    TEST_ASSERT(report.unreadable == 2, "unknown and missing files counted as unreadable");
+    TEST_ASSERT(report.rounds == logs.size() + 5, "junk rounds counted");
+    // 坏 seed、摸到已发出的牌、没有结果各一局；途中流局一局；弃牌座位和摸牌不符一局
+    TEST_ASSERT(report.malformed == 3, "malformed rounds skipped");
+    TEST_ASSERT(report.diverged == 1, "round that disagrees with the engine diverges");
+    TEST_ASSERT(report.unsupported == logs.size() - clean + 1, "abortive draw unsupported");
+    TEST_ASSERT(report.imported == clean && sunk == clean, "good rounds still imported");
+    TEST_ASSERT(report.issues.size() == 4, "issue list capped");
+
+    std::remove("test_archive_good.xml");
+    std::remove("test_archive_junk.xml");
+    std::remove("test_archive_unknown.txt");
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testParsers();
+    failed += testImport();
+    failed += testMalformed();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All archive import tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <chrono>
+#include <future>
+#include <vector>
+#include "batch_runner.h"
+#include "mcts_ai.h"
+#include "replay_validator.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// 用快速模拟策略逐条回答，并统计批大小
+class PolicyEvaluator : public DecisionEvaluator {
+public:
+    long calls = 0;
+    long requests = 0;
+
+    void evaluate(const DecisionRequest* batch, size_t count, int* actions) override {
+        calls++;
+        requests += count;
+        for (size_t i = 0; i < count; ++i) actions[i] = MctsAI::rolloutPolicy(*batch[i].state);
+    }
+};
+
+// Test that every batched round replays identically on Table
+int testMatchesTable() {
+    std::cout << "\n=== Testing batched rounds against Table ===" << std::endl;
+
+    BatchRunnerConfig config;
+    config.num_tables = 32;
+    config.seed = 99;
+    BatchRunner runner(config);
+
+    std::vector<std::vector<ReplayDecision>> decisions(config.num_tables);
+    runner.onDecision = [&](int table, int seat, DecisionKind kind, int options, int action) {
+        decisions[table].push_back({static_cast<uint8_t>(seat), static_cast<uint8_t>(kind),
+                                    static_cast<uint8_t>(options), static_cast<uint8_t>(action)});
+    };
+
+    Table table;
+    ReplayScript script;
+    ReplayPlayer players[4] = {ReplayPlayer(&script), ReplayPlayer(&script),
+                               ReplayPlayer(&script), ReplayPlayer(&script)};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    int mismatches = 0, wins = 0;
+    std::string reason;
+    runner.onRoundEnd = [&](int index, uint32_t seed, const GameSnapshot& state, const GameResult& result) {
+        ReplayRound round;
+        round.seed = seed;
+        round.dealer = state.dealer;
+        round.round_wind = Wind::East;
+        round.honba = 0;
+        round.riichi_sticks = 0;
+        round.scores.fill(config.start_score);
+        round.wall.resize(136);
+        BatchRunner::shuffleWall(seed, round.wall.data());
+        round.decisions.swap(decisions[index]);
+        round.result = result;
+        if (!replayRound(round, table, script, reason)) {
+            if (mismatches++ == 0) std::cout << "  " << reason << std::endl;
+        }
+        if (result.winner >= 0) wins++;
+        decisions[index].clear();
+    };
+
+    PolicyEvaluator evaluator;
+    BatchRunnerStats stats = runner.run(evaluator, 300);
+    std::cout << "  rounds: " << stats.rounds << ", wins: " << wins << ", decisions: " << stats.decisions
+              << ", batches: " << stats.batches << std::endl;
+    TEST_ASSERT(stats.rounds == 300 && runner.isDone(), "all rounds finished");
+    TEST_ASSERT(mismatches == 0, "Table reproduces every batched round");
+    TEST_ASSERT(evaluator.requests == stats.decisions, "one answer per request");
+
+    return 0;
+}
+
+// Test that batches stay full while enough rounds remain
+int testBatching() {
+    std::cout << "\n=== Testing batch sizes ===" << std::endl;
+
+    BatchRunnerConfig config;
+    config.num_tables = 200;
+    config.fast_scoring = true;
+    BatchRunner runner(config);
+
+    PolicyEvaluator evaluator;
+    auto start = std::chrono::steady_clock::now();
+    BatchRunnerStats stats = runner.run(evaluator, 2000);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double average = static_cast<double>(stats.decisions) / stats.batches;
+    std::cout << "  " << stats.decisions << " decisions in " << stats.batches << " batches (avg "
+              << average << "), " << static_cast<long>(stats.rounds / elapsed.count()) << " rounds/s" << std::endl;
+    TEST_ASSERT(stats.max_batch == 200, "a batch holds one request per table");
+    TEST_ASSERT(average > 150, "batches stay mostly full");
+
+    return 0;
+}
+
+// Test the collect / resume protocol with the evaluator on another thread
+int testAsyncProtocol() {
+    std::cout << "\n=== Testing collect / resume ===" << std::endl;
+
+    BatchRunnerConfig config;
+    config.num_tables = 16;
+    config.seed = 5;
+
+    std::vector<long> sync_deltas, async_deltas;
+    auto recorder = [](std::vector<long>& out) {
+        return [&out](int, uint32_t, const GameSnapshot&, const GameResult& result) {
+            out.push_back(result.deltas[0] + 10 * result.deltas[1] + 100 * result.deltas[2]);
+        };
+    };
+
+    BatchRunner sync_runner(config);
+    sync_runner.onRoundEnd = recorder(sync_deltas);
+    PolicyEvaluator evaluator;
+    sync_runner.run(evaluator, 100);
+
+    BatchRunner async_runner(config);
+    async_runner.onRoundEnd = recorder(async_deltas);
+    async_runner.start(100);
+    PolicyEvaluator remote;
+    while (true) {
+        const std::vector<DecisionRequest>& requests = async_runner.collect();
+        if (requests.empty()) break;
+        std::vector<int> actions(requests.size());
+        std::async(std::launch::async, [&]() {
+            remote.evaluate(requests.data(), requests.size(), actions.data());
+        }).get();
+        async_runner.resume(actions.data());
+    }
+
+    TEST_ASSERT(async_runner.isDone() && async_deltas.size() == 100, "async driver finishes all rounds");
+    TEST_ASSERT(async_deltas == sync_deltas, "same seed gives the same rounds");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testMatchesTable();
+    failed += testBatching();
+    failed += testAsyncProtocol();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All batch runner tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
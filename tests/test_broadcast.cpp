@@ -0,0 +1,191 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "wire_protocol.h"
+#include "session.h"
+#include "room.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// 解析服务器发出的 WebSocket 帧 (不加掩码)，返回完整的帧数
+static size_t parseFrames(const std::string& data, std::vector<std::string>& payloads, std::vector<int>& opcodes) {
+    size_t pos = 0;
+    while (pos + 2 <= data.size()) {
+        size_t header = 2;
+        uint64_t size = static_cast<uint8_t>(data[pos + 1]);
+        if (size == 126) {
+            header = 4;
+            if (pos + header > data.size()) break;
+            size = static_cast<uint8_t>(data[pos + 2]) << 8 | static_cast<uint8_t>(data[pos + 3]);
+        } else if (size == 127) {
+            header = 10;
+            if (pos + header > data.size()) break;
+            size = 0;
+            for (int i = 0; i < 8; ++i) size = size << 8 | static_cast<uint8_t>(data[pos + 2 + i]);
+        }
+        if (pos + header + size > data.size()) break;
+        opcodes.push_back(static_cast<uint8_t>(data[pos]));
+        payloads.push_back(data.substr(pos + header, size));
+        pos += header + size;
+    }
+    return pos;
+}
+
+// Test a broadcast is encoded once and shared by every queue
+int testShared() {
+    std::cout << "\n=== Testing shared buffers ===" << std::endl;
+
+    Session a(1), b(2), c(3);
+    b.setWireFormat(WireFormat::Binary);
+    c.setWireFormat(WireFormat::Binary);
+    Room room("SHARED");
+    room.addPlayer(&a);
+    room.addPlayer(&b);
+    room.addPlayer(&c);
+
+    GameMessage msg;
+    msg.type = MessageType::PlayerAction;
+    msg.seat = 2;
+    msg.action = 138;
+    msg.tile = 57;
+    room.broadcast(msg);
+
+    struct iovec iov_a[4], iov_b[4], iov_c[4];
+    TEST_ASSERT(a.gatherQueued(iov_a, 4) == 2 && b.gatherQueued(iov_b, 4) == 2 && c.gatherQueued(iov_c, 4) == 2,
+                "each queue holds header and payload");
+    TEST_ASSERT(iov_b[1].iov_base == iov_c[1].iov_base, "same format shares one payload");
+    TEST_ASSERT(iov_a[1].iov_base != iov_b[1].iov_base &&
+                std::string(static_cast<char*>(iov_a[1].iov_base), iov_a[1].iov_len) == msg.toJSON(),
+                "JSON connection gets the JSON encoding");
+    TEST_ASSERT(static_cast<char*>(iov_a[0].iov_base)[0] == static_cast<char>(0x81) &&
+                static_cast<char*>(iov_b[0].iov_base)[0] == static_cast<char>(0x82),
+                "text and binary frame headers");
+
+    // 观众再多，内容也只有一份: 每个连接只多一个帧头
+    SharedMessage payload = shareMessage(std::string(4096, 'x'));
+    std::vector<std::unique_ptr<Session>> audience;
+    size_t queued = 0;
+    for (int i = 0; i < 1000; ++i) {
+        audience.push_back(std::make_unique<Session>(100 + i));
+        audience.back()->send(payload);
+        queued += audience.back()->queuedBytes();
+    }
+    TEST_ASSERT(payload.use_count() == 1001, "1000 queues reference one buffer");
+    TEST_ASSERT(queued == 1000 * (4096 + 4), "queued bytes count header and payload");
+    audience.clear();
+    TEST_ASSERT(payload.use_count() == 1, "references released with the queues");
+
+    // 设置了回调时直接交给回调
+    std::vector<std::string> received;
+    Session callback(9);
+    callback.setSendCallback([&](const std::string& m) { received.push_back(m); });
+    callback.send(payload);
+    TEST_ASSERT(received.size() == 1 && received[0] == *payload && callback.queuedFrames() == 0,
+                "callback receives the bytes");
+
+    room.removePlayer(&a);
+    room.removePlayer(&b);
+    room.removePlayer(&c);
+
+    return 0;
+}
+
+// Test partial writes resume in the middle of headers and payloads
+int testPartial() {
+    std::cout << "\n=== Testing partial writes ===" << std::endl;
+
+    Session session(1);
+    session.send(std::string("hello"));
+    session.send(std::string(300, 'y'));
+    size_t total = session.queuedBytes();
+    TEST_ASSERT(total == 2 + 5 + 4 + 300, "queued size");
+
+    session.consumeQueued(1);
+    struct iovec iov[8];
+    TEST_ASSERT(session.gatherQueued(iov, 8) == 4 && iov[0].iov_len == 1, "resume inside the first header");
+    session.consumeQueued(3);
+    TEST_ASSERT(session.gatherQueued(iov, 1) == 1 && iov[0].iov_len == 3 &&
+                std::string(static_cast<char*>(iov[0].iov_base), 3) == "llo", "resume inside the payload");
+    session.consumeQueued(3);
+    TEST_ASSERT(session.queuedFrames() == 1 && session.queuedBytes() == 304, "finished frame dequeued");
+    session.consumeQueued(304);
+    TEST_ASSERT(session.queuedFrames() == 0 && session.queuedBytes() == 0, "queue drained");
+
+    return 0;
+}
+
+// Test writev to a socket with a small buffer delivers every frame intact
+int testSocket() {
+    std::cout << "\n=== Testing socket ===" << std::endl;
+
+    int fds[2];
+    TEST_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "socketpair");
+    int small = 4096;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    Session session(1);
+    session.setWireFormat(WireFormat::Binary);
+    std::vector<std::string> sent;
+    for (int i = 0; i < 300; ++i) {
+        size_t size = i % 50 == 0 ? 70000 : i % 7 == 0 ? 200 : 5 + i % 100;
+        sent.push_back(std::string(size, static_cast<char>('a' + i % 26)));
+        session.send(sent.back());
+    }
+
+    std::string received;
+    char chunk[8192];
+    int flushes = 0;
+    bool failed = false;
+    while (session.queuedFrames() > 0 && !failed) {
+        if (session.flushQueued(fds[0]) < 0) failed = true;
+        flushes++;
+        ssize_t n;
+        while ((n = recv(fds[1], chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) received.append(chunk, n);
+    }
+    ssize_t n;
+    while ((n = recv(fds[1], chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) received.append(chunk, n);
+    close(fds[0]);
+    close(fds[1]);
+    TEST_ASSERT(!failed, "no write errors");
+    std::cout << "  " << received.size() << " bytes in " << flushes << " flushes" << std::endl;
+
+    std::vector<std::string> payloads;
+    std::vector<int> opcodes;
+    size_t parsed = parseFrames(received, payloads, opcodes);
+    TEST_ASSERT(parsed == received.size() && payloads == sent, "every frame arrives intact and in order");
+    bool binary = true;
+    for (int opcode : opcodes) binary = binary && opcode == 0x82;
+    TEST_ASSERT(binary, "binary frames");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testShared();
+    failed += testPartial();
+    failed += testSocket();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All broadcast tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include "types.h"
+#include "constants.h"
+#include "tiles.h"
+#include "shanten.h"
+#include "call_options.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// TileIndex helper: tile * 4 + instance (0-3)
+inline TileIndex TI(Tile tile, int instance = 0) { return tile * 4 + instance; }
+
+static int countOptions(const CallEvaluation &eval, MeldType type) {
+    int n = 0;
+    for (const CallOption &o : eval.options) {
+        if (o.type == type) n++;
+    }
+    return n;
+}
+
+// Test red five variants and kuikae
+int testVariants() {
+    std::cout << "\n=== Testing call variants ===" << std::endl;
+
+    // 3m 4m 赤5m 5m 5m ... 被打出第四张 5m
+    Hand hand({TI(_3m), TI(_4m), TI(_5m, 0), TI(_5m, 1), TI(_5m, 3), TI(_1p), TI(_2p),
+               TI(_3p), TI(_7s), TI(_8s), TI(EastWind), TI(EastWind, 1), TI(Chun)}, Wind::East, Wind::East);
+    TileCounts visible = hand.getTileCounts();
+    visible[_5m]++;
+
+    CallEvaluation eval;
+    evaluateCalls(hand, TI(_5m, 2), true, visible, eval);
+    int pon_variants = 0, red_pon = 0;
+    for (const CallOption &o : eval.options) {
+        if (o.type != MeldType::Pon || o.discard != _1p) continue;
+        pon_variants++;
+        if (o.tiles[0] == TI(_5m, 0)) red_pon++;
+    }
+    TEST_ASSERT(pon_variants == 2 && red_pon == 1, "pon with and without the red five");
+    TEST_ASSERT(countOptions(eval, MeldType::Minkan) == 1, "one daiminkan");
+
+    bool kuikae = false;
+    for (const CallOption &o : eval.options) {
+        if (o.type != MeldType::Minkan && o.discard == _5m) kuikae = true;
+    }
+    TEST_ASSERT(!kuikae, "called kind is never discarded");
+
+    // 吃 6m: 只有 4m5m6m，5m 有赤与不赤两种，食替禁止打 3m
+    evaluateCalls(hand, TI(_6m), true, visible, eval);
+    int chi_shapes[2] = {0, 0};
+    bool suji = false;
+    for (const CallOption &o : eval.options) {
+        if (o.type != MeldType::Chi) continue;
+        bool red = o.tiles[0] == TI(_5m, 0) || o.tiles[1] == TI(_5m, 0);
+        chi_shapes[red]++;
+        if (o.discard == _3m) suji = true;
+    }
+    TEST_ASSERT(chi_shapes[0] > 0 && chi_shapes[1] > 0 && chi_shapes[0] == chi_shapes[1],
+                "chi with red and plain five");
+    TEST_ASSERT(!suji, "suji kuikae excluded");
+
+    evaluateCalls(hand, TI(_6m), false, visible, eval);
+    TEST_ASSERT(eval.options.empty(), "no chi unless allowed");
+
+    evaluateCalls(hand, TI(EastWind, 2), true, visible, eval);
+    TEST_ASSERT(countOptions(eval, MeldType::Pon) > 0 && countOptions(eval, MeldType::Chi) == 0, "honor: pon only");
+
+    return 0;
+}
+
+// Test incremental results against full recomputation
+int testAgainstFullShanten() {
+    std::cout << "\n=== Testing against full recomputation ===" << std::endl;
+
+    std::mt19937 rng(4242);
+    int options = 0, mismatches = 0;
+    for (int i = 0; i < 400; ++i) {
+        TileIndexList wall;
+        for (int t = 0; t < 136; ++t) wall.push_back(t);
+        std::shuffle(wall.begin(), wall.end(), rng);
+        Hand hand(TileIndexList(wall.begin(), wall.begin() + 13), Wind::East, Wind::South);
+        TileCounts counts = hand.getTileCounts();
+        // 挑一张和手牌相邻或相同的牌作为弃牌，保证有鸣牌选择
+        TileIndex discard = invalid_tile_index;
+        for (int j = 13; j < 136 && discard == invalid_tile_index; ++j) {
+            Tile t = wall[j] / 4;
+            if (counts[t] >= 2 || (t < 27 && ((t % 9 > 0 && counts[t - 1]) || (t % 9 < 8 && counts[t + 1]))))
+                discard = wall[j];
+        }
+        if (discard == invalid_tile_index) continue;
+
+        TileCounts visible = counts;
+        visible[discard / 4]++;
+        for (int j = 13; j < 30; ++j) visible[wall[j] / 4]++;  // 牌河中可见的牌
+        for (int t = 0; t < 34; ++t) visible[t] = std::min(visible[t], 4);
+
+        CallEvaluation eval;
+        evaluateCalls(hand, discard, true, visible, eval);
+        int base_ukeire = 0;
+        calcUkeire(counts, 0, true, visible, base_ukeire);
+        if (eval.shanten != calcShanten(counts, 0, true) || eval.ukeire != base_ukeire) mismatches++;
+
+        for (const CallOption &o : eval.options) {
+            TileCounts after = counts;
+            for (TileIndex t : o.tiles) {
+                if (t != invalid_tile_index) after[t / 4]--;
+            }
+            if (o.discard != invalid_tile) after[o.discard]--;
+            int ukeire = 0;
+            TileMask mask = calcUkeire(after, 1, false, visible, ukeire);
+            if (o.shanten != calcShanten(after, 1, false) || o.ukeire != ukeire || o.ukeire_mask != mask)
+                mismatches++;
+            options++;
+        }
+    }
+    std::cout << "  options checked: " << options << std::endl;
+    TEST_ASSERT(options > 1000, "enough call options generated");
+    TEST_ASSERT(mismatches == 0, "incremental shanten / ukeire match full recomputation");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testVariants();
+    failed += testAgainstFullShanten();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All call option tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <cstring>
+#include <random>
+#include "constants.h"
+#include "danger_tracker.h"
+#include "simple_ai.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// TileIndex helper: tile * 4 + instance (0-3)
+inline TileIndex TI(Tile tile, int instance = 0) { return tile * 4 + instance; }
+
+// Test genbutsu, suji, kabe, honors and riichi passes
+int testKnownValues() {
+    std::cout << "\n=== Testing known danger values ===" << std::endl;
+
+    DangerTracker tracker;
+    TEST_ASSERT(tracker.getDanger(0, _5m) == 11 && tracker.getDanger(0, _1m) == 5 && tracker.getDanger(0, Chun) == 4,
+                "initial values");
+
+    tracker.onDiscard(1, TI(_4m));
+    TEST_ASSERT(tracker.getDanger(1, _4m) == 0, "genbutsu is safe");
+    TEST_ASSERT(tracker.getDanger(1, _1m) == 1 && tracker.getDanger(1, _7m) == 3, "suji of 4m");
+    TEST_ASSERT(tracker.getDanger(0, _1m) == 5, "other seats unaffected");
+    TEST_ASSERT(tracker.getDanger(0, _4m) == 11 && tracker.getDanger(0, _5m) == 11, "one visible copy keeps shape");
+
+    tracker.onDiscard(3, TI(Chun));
+    tracker.onReveal(TI(Chun, 1));
+    TEST_ASSERT(tracker.getDanger(0, Chun) == 2, "honor with two visible");
+
+    for (int i = 0; i < 4; ++i) tracker.onReveal(TI(_2p, i));
+    TEST_ASSERT(tracker.getDanger(0, _2p) == 0, "all four visible");
+    TEST_ASSERT(tracker.getDanger(0, _1p) == 1 && tracker.getDanger(0, _4p) == 7 && tracker.getDanger(0, _3p) == 7,
+                "kabe on 2p removes ryanmen through it");
+
+    tracker.onRiichi(2);
+    tracker.onDiscard(3, TI(_5s));
+    TEST_ASSERT(tracker.getDanger(2, _5s) == 0 && tracker.getDanger(0, _5s) == 11, "passed tile is safe against riichi");
+    TEST_ASSERT(tracker.getSafeMask(2) == (1ULL << _5s), "safe mask");
+
+    tracker.reset();
+    TEST_ASSERT(tracker.getDanger(1, _4m) == 11 && !tracker.isRiichi(2), "reset");
+
+    return 0;
+}
+
+// Test incremental updates against a full rebuild after every event
+int testIncremental() {
+    std::cout << "\n=== Testing incremental updates ===" << std::endl;
+
+    std::mt19937 rng(42);
+    int mismatches = 0, events = 0;
+    for (int round = 0; round < 200; ++round) {
+        DangerTracker tracker;
+        for (int e = 0; e < 80; ++e) {
+            int kind = rng() % 10;
+            if (kind == 0) {
+                tracker.onRiichi(rng() % 4);
+            } else if (kind < 3) {
+                tracker.onReveal(rng() % 136);
+            } else {
+                tracker.onDiscard(rng() % 4, rng() % 136);
+            }
+            events++;
+
+            DangerTracker rebuilt = tracker;
+            rebuilt.rebuild();
+            for (int seat = 0; seat < 4; ++seat) {
+                if (std::memcmp(tracker.getDangerTable(seat), rebuilt.getDangerTable(seat), 34) != 0) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    std::cout << "  events: " << events << std::endl;
+    TEST_ASSERT(mismatches == 0, "incremental tables match rebuild");
+
+    return 0;
+}
+
+// Test that SimpleAI with a tracker deals in less often
+int testDefense() {
+    std::cout << "\n=== Testing defensive SimpleAI ===" << std::endl;
+
+    Table table;
+    table.setSeed(3);
+    SimpleAI players[4] = {SimpleAI("D0"), SimpleAI("A1"), SimpleAI("D2"), SimpleAI("A3")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    DangerTracker tracker;
+    DangerTrackerHook hook(&table, &tracker);
+    players[0].setDangerTracker(&tracker);
+    players[2].setDangerTracker(&tracker);
+
+    int deal_ins[4] = {0, 0, 0, 0};
+    for (int r = 0; r < 300; ++r) {
+        table.setDealer(r % 4);
+        GameResult result = table.playRound();
+        if (result.from_player >= 0) deal_ins[result.from_player]++;
+    }
+    int defenders = deal_ins[0] + deal_ins[2], attackers = deal_ins[1] + deal_ins[3];
+    std::cout << "  deal-ins: defenders " << defenders << ", attackers " << attackers << std::endl;
+    TEST_ASSERT(defenders < attackers, "defenders deal in less");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testKnownValues();
+    failed += testIncremental();
+    failed += testDefense();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All danger tracker tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,227 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include "player.h"
+#include "snapshot.h"
+#include "deal_sampler.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static void shuffledWall(std::array<TileIndex, 136>& wall, uint32_t seed) {
+    for (int i = 0; i < 136; ++i) wall[i] = i;
+    std::mt19937 rng(seed);
+    std::shuffle(wall.begin(), wall.end(), rng);
+}
+
+// 打几手牌，让牌河和牌山指针都动起来
+static void playSome(GameSnapshot& snapshot, int steps) {
+    for (int i = 0; i < steps && !snapshot.isFinished(); ++i) {
+        if (snapshot.phase == SnapshotPhase::Response) {
+            snapshot.apply(static_cast<int>(Action::Pass));
+        } else {
+            snapshot.apply(snapshot.drawn);
+        }
+    }
+}
+
+static bool sameSample(const DealSample& a, const DealSample& b, const HiddenInfo& info) {
+    for (int s = 0; s < 4; ++s) {
+        if (!std::equal(a.hands[s], a.hands[s] + info.hand_size[s], b.hands[s])) return false;
+    }
+    return std::equal(a.wall, a.wall + info.wall_slot_count, b.wall);
+}
+
+// Test that every sample is consistent with what the seat can see
+int testConsistency() {
+    std::cout << "\n=== Testing sample consistency ===" << std::endl;
+
+    std::array<TileIndex, 136> wall;
+    shuffledWall(wall, 5);
+    GameSnapshot root;
+    dealSnapshot(root, wall.data(), 0, Wind::East, 0, 0, {25000, 25000, 25000, 25000});
+    playSome(root, 22);
+
+    HiddenInfo info;
+    DealSampler sampler;
+    TEST_ASSERT(buildHiddenInfo(root, 2, info) && sampler.reset(info), "hidden info built");
+    TEST_ASSERT(info.hand_size[2] == 0 && info.hand_size[0] == 13, "own seat excluded, opponent sizes counted");
+
+    TileIndex wall_buffer[136];
+    DealSample deal;
+    bool changed = false;
+    for (uint64_t index = 0; index < 200; ++index) {
+        GameSnapshot sim = root;
+        sampler.sample(11, index, deal);
+        sampler.apply(deal, sim, wall_buffer);
+
+        bool same_self = std::equal(sim.seats[2].tiles, sim.seats[2].tiles + 3, root.seats[2].tiles);
+        bool same_sizes = true;
+        for (int seat = 0; seat < 4; ++seat) {
+            int a = 0, b = 0;
+            for (int t = 0; t < 34; ++t) { a += sim.seats[seat].counts[t]; b += root.seats[seat].counts[t]; }
+            same_sizes = same_sizes && a == b;
+            changed = changed || sim.seats[seat].tiles[1] != root.seats[seat].tiles[1];
+        }
+        TEST_ASSERT(same_self && same_sizes, "own hand and opponent hand sizes preserved");
+
+        // 手牌、牌河、摸牌和牌山中每张牌恰好出现一次，宝牌指示牌不动
+        std::array<int, 136> seen;
+        seen.fill(0);
+        for (const SeatSnapshot& s : sim.seats) {
+            for (TileIndex t = 0; t < 136; ++t) if (s.hasTile(t)) seen[t]++;
+            for (int i = 0; i < s.river_len; ++i) seen[s.river[i]]++;
+        }
+        if (sim.drawn < 136) seen[sim.drawn]++;
+        for (int i = sim.wall_pointer; i < 136; ++i) seen[sim.wall[i]]++;
+        bool unique = true;
+        for (int c : seen) unique = unique && c == 1;
+        TEST_ASSERT(unique, "every tile appears exactly once");
+        TEST_ASSERT(sim.wall[sim.dead_wall_start + 4] == root.wall[root.dead_wall_start + 4], "dora indicator kept");
+    }
+    TEST_ASSERT(changed, "opponent hands are resampled");
+    TEST_ASSERT(root.wall == wall.data(), "root wall untouched");
+
+    return 0;
+}
+
+// Test that samples depend only on (seed, index), across threads too
+int testReproducible() {
+    std::cout << "\n=== Testing reproducibility ===" << std::endl;
+
+    std::array<TileIndex, 136> wall;
+    shuffledWall(wall, 9);
+    GameSnapshot root;
+    dealSnapshot(root, wall.data(), 1, Wind::East, 0, 0, {25000, 25000, 25000, 25000});
+    playSome(root, 10);
+
+    HiddenInfo info;
+    DealSampler sampler;
+    TEST_ASSERT(buildHiddenInfo(root, 0, info) && sampler.reset(info), "hidden info built");
+
+    const int count = 256;
+    std::vector<DealSample> sequential(count), threaded(count);
+    for (int i = 0; i < count; ++i) sampler.sample(77, i, sequential[i]);
+
+    DealSample again;
+    sampler.sample(77, 5, again);
+    TEST_ASSERT(sameSample(again, sequential[5], info), "same (seed, index) gives the same sample");
+    sampler.sample(78, 5, again);
+    TEST_ASSERT(!sameSample(again, sequential[5], info), "different seed gives a different sample");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = t; i < count; i += 4) sampler.sample(77, i, threaded[i]);
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    bool equal = true;
+    for (int i = 0; i < count; ++i) equal = equal && sameSample(sequential[i], threaded[i], info);
+    TEST_ASSERT(equal, "threaded sampling matches sequential sampling");
+
+    return 0;
+}
+
+// Test that riichi seats are always dealt a tenpai hand
+int testRiichiTenpai() {
+    std::cout << "\n=== Testing riichi constraint ===" << std::endl;
+
+    std::array<TileIndex, 136> wall;
+    shuffledWall(wall, 13);
+    GameSnapshot root;
+    dealSnapshot(root, wall.data(), 0, Wind::East, 0, 0, {25000, 25000, 25000, 25000});
+    playSome(root, 30);
+    root.seats[1].riichi = 2;
+    root.seats[3].riichi = 2;
+
+    HiddenInfo info;
+    DealSampler sampler;
+    TEST_ASSERT(buildHiddenInfo(root, 0, info) && sampler.reset(info), "hidden info built");
+    TEST_ASSERT(info.tenpai[1] && info.tenpai[3] && !info.tenpai[2], "riichi seats flagged");
+
+    TileIndex wall_buffer[136];
+    DealSample deal;
+    int constrained = 0, furiten = 0;
+    bool all_tenpai = true;
+    const int samples = 2000;
+    for (int index = 0; index < samples; ++index) {
+        GameSnapshot sim = root;
+        sampler.sample(3, index, deal);
+        sampler.apply(deal, sim, wall_buffer);
+        if (!deal.constrained) continue;
+        constrained++;
+        all_tenpai = all_tenpai && sim.seats[1].wait_mask != 0 && sim.seats[3].wait_mask != 0;
+        if (sim.seats[1].isFuriten()) furiten++;
+    }
+    std::cout << "  constrained: " << constrained << "/" << samples << ", furiten: " << furiten << std::endl;
+    TEST_ASSERT(constrained > samples * 9 / 10, "tenpai construction almost always succeeds");
+    TEST_ASSERT(all_tenpai, "riichi seats are tenpai");
+    TEST_ASSERT(furiten < constrained / 20, "riichi hands rarely wait on their own discards");
+
+    return 0;
+}
+
+// Test that unconstrained tiles are spread evenly
+int testUniform() {
+    std::cout << "\n=== Testing uniformity ===" << std::endl;
+
+    std::array<TileIndex, 136> wall;
+    shuffledWall(wall, 21);
+    GameSnapshot root;
+    dealSnapshot(root, wall.data(), 0, Wind::East, 0, 0, {25000, 25000, 25000, 25000});
+
+    HiddenInfo info;
+    DealSampler sampler;
+    TEST_ASSERT(buildHiddenInfo(root, 0, info) && sampler.reset(info), "hidden info built");
+
+    // 每张看不到的牌落在 1 家手牌中的概率应为 13 / unseen
+    const int samples = 20000;
+    std::array<int, 136> in_hand;
+    in_hand.fill(0);
+    DealSample deal;
+    auto start = std::chrono::steady_clock::now();
+    for (int index = 0; index < samples; ++index) {
+        sampler.sample(99, index, deal);
+        for (int i = 0; i < info.hand_size[1]; ++i) in_hand[deal.hands[1][i]]++;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << samples << " samples in " << ms << " ms" << std::endl;
+
+    double expected = samples * 13.0 / sampler.getUnseenCount();
+    int outliers = 0;
+    for (TileIndex t = 0; t < 136; ++t) {
+        if (!(info.unseen[t >> 6] >> (t & 63) & 1)) continue;
+        if (std::abs(in_hand[t] - expected) > expected * 0.15) outliers++;
+    }
+    TEST_ASSERT(outliers == 0, "each unseen tile lands in a hand with equal probability");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testConsistency();
+    failed += testReproducible();
+    failed += testRiichiTenpai();
+    failed += testUniform();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All deal sampler tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <climits>
+#include "player.h"
+#include "mcts_ai.h"
+#include "endgame_solver.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// 用 rollout 策略打到只剩 remaining 张，停在某家摸牌后的决策点
+static bool playUntil(GameSnapshot& snapshot, const std::array<TileIndex, 136>& wall, int remaining) {
+    dealSnapshot(snapshot, wall.data(), 0, Wind::East, 0, 0, {25000, 25000, 25000, 25000});
+    snapshot.fast_scoring = true;
+    while (!snapshot.isFinished() &&
+           !(snapshot.phase == SnapshotPhase::Action && snapshot.getRemainingTiles() <= remaining)) {
+        snapshot.apply(MctsAI::rolloutPolicy(snapshot));
+    }
+    return !snapshot.isFinished();
+}
+
+static void shuffledWall(std::array<TileIndex, 136>& wall, uint32_t seed) {
+    for (int i = 0; i < 136; ++i) wall[i] = i;
+    std::mt19937 rng(seed);
+    std::shuffle(wall.begin(), wall.end(), rng);
+}
+
+// 不去重、不剪枝的参照: 展开每一个合法动作
+static int bruteForce(const GameSnapshot& s, int seat, bool adversarial) {
+    if (s.isFinished()) return s.deltas[seat];
+    if (!adversarial && s.getDecisionSeat() != seat) {
+        return bruteForce(stepSnapshot(s, MctsAI::rolloutPolicy(s)), seat, adversarial);
+    }
+    bool maximizing = s.getDecisionSeat() == seat;
+    int best = maximizing ? INT_MIN : INT_MAX;
+    for (int action = 0; action <= static_cast<int>(Action::Pass); ++action) {
+        if (!s.getLegalActions().allows(action)) continue;
+        int value = bruteForce(stepSnapshot(s, action), seat, adversarial);
+        best = maximizing ? std::max(best, value) : std::min(best, value);
+    }
+    return best;
+}
+
+// Replay the returned line and check it reaches the returned value
+static bool lineReaches(const GameSnapshot& root, const EndgameResult& result) {
+    GameSnapshot s = root;
+    for (int action : result.line) {
+        if (s.isFinished() || !s.getLegalActions().allows(action)) return false;
+        s.apply(action);
+    }
+    return s.isFinished() && s.deltas[result.seat] == result.value;
+}
+
+// Test against exhaustive search on short endings
+int testAgainstBruteForce() {
+    std::cout << "\n=== Testing against brute force ===" << std::endl;
+
+    int positions = 0, mismatches = 0, bad_lines = 0;
+    std::array<TileIndex, 136> wall;
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        shuffledWall(wall, seed);
+        GameSnapshot root;
+        if (!playUntil(root, wall, 3)) continue;
+        positions++;
+
+        EndgameConfig config;
+        config.num_threads = 1;
+        config.opponents = EndgameOpponents::Adversarial;
+        EndgameResult adversarial = solveEndgame(root, config);
+        config.opponents = EndgameOpponents::Policy;
+        EndgameResult policy = solveEndgame(root, config);
+
+        int seat = root.getDecisionSeat();
+        if (adversarial.value != bruteForce(root, seat, true)) mismatches++;
+        if (policy.value != bruteForce(root, seat, false)) mismatches++;
+        if (!lineReaches(root, adversarial) || !lineReaches(root, policy)) bad_lines++;
+    }
+    std::cout << "  positions: " << positions << std::endl;
+    TEST_ASSERT(positions >= 5, "enough unfinished endings");
+    TEST_ASSERT(mismatches == 0, "solver values match brute force");
+    TEST_ASSERT(bad_lines == 0, "optimal lines reach the solved value");
+
+    return 0;
+}
+
+// Test longer endings, root values and threading
+int testLongEndings() {
+    std::cout << "\n=== Testing longer endings ===" << std::endl;
+
+    int positions = 0;
+    std::array<TileIndex, 136> wall;
+    for (uint32_t seed = 1; seed <= 12 && positions < 2; ++seed) {
+        shuffledWall(wall, seed);
+        GameSnapshot root;
+        if (!playUntil(root, wall, 20)) continue;
+        positions++;
+
+        EndgameConfig config;
+        config.num_threads = 1;
+        EndgameResult single = solveEndgame(root, config);
+        config.num_threads = 3;
+        EndgameResult threaded = solveEndgame(root, config);
+        std::cout << "  seed " << seed << ": value " << single.value << ", " << single.nodes << " nodes in "
+                  << single.seconds << " s, line of " << single.line.size() << std::endl;
+
+        int best = INT_MIN;
+        for (const EndgameMove& move : single.moves) best = std::max(best, move.value);
+        TEST_ASSERT(single.solved && threaded.solved, "20 remaining tiles solved");
+        TEST_ASSERT(best == single.value && threaded.value == single.value, "root value is the best move value");
+        TEST_ASSERT(lineReaches(root, single), "line reaches the value");
+
+        // 剩得不多时，他家对抗的值不会高于他家按策略行动的值
+        GameSnapshot late = root;
+        while (!late.isFinished() && !(late.phase == SnapshotPhase::Action && late.getRemainingTiles() <= 5)) {
+            late.apply(MctsAI::rolloutPolicy(late));
+        }
+        if (late.isFinished()) continue;
+        config.seat = late.getDecisionSeat();
+        EndgameResult policy = solveEndgame(late, config);
+        config.opponents = EndgameOpponents::Adversarial;
+        EndgameResult adversarial = solveEndgame(late, config);
+        config.seat = -1;
+        config.opponents = EndgameOpponents::Policy;
+        TEST_ASSERT(adversarial.solved && adversarial.value <= policy.value, "adversarial value is a lower bound");
+    }
+    TEST_ASSERT(positions > 0, "found long endings");
+
+    // 节点上限
+    shuffledWall(wall, 2);
+    GameSnapshot root;
+    if (playUntil(root, wall, 20)) {
+        EndgameConfig config;
+        config.num_threads = 1;
+        config.opponents = EndgameOpponents::Adversarial;
+        config.node_limit = 1000;
+        EndgameResult limited = solveEndgame(root, config);
+        TEST_ASSERT(!limited.solved && limited.line.empty(), "node limit stops the search");
+    }
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testAgainstBruteForce();
+    failed += testLongEndings();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All endgame solver tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
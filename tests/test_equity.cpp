@@ -0,0 +1,180 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "player.h"
+#include "equity.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static const char* riichi_position =
+    "# 东一局，1 家立直\n"
+    "wind E\n"
+    "dealer 0\n"
+    "sticks 1\n"
+    "scores 25000 24000 25000 25000\n"
+    "remaining 50\n"
+    "turn 2\n"
+    "dora 3m\n"
+    "hand 0 1230m456p789s112z    # 0m 为赤五\n"
+    "river 0 9p1z\n"
+    "river 1 19m2z7p\n"
+    "river 2 8s3z\n"
+    "river 3 4z\n"
+    "riichi 1\n";
+
+static bool sameResult(const EquityResult& a, const EquityResult& b) {
+    return a.samples == b.samples && a.win == b.win && a.deal_in == b.deal_in && a.draw == b.draw && a.delta == b.delta;
+}
+
+// Test the text position format
+int testParse() {
+    std::cout << "\n=== Testing position parsing ===" << std::endl;
+
+    EquityPosition position;
+    std::string error;
+    TEST_ASSERT(parsePosition(riichi_position, position, error), "riichi position parses");
+    const GameSnapshot& s = position.snapshot;
+    TEST_ASSERT(s.current == 2 && s.riichi_sticks == 1 && s.getRemainingTiles() == 50, "header fields");
+    TEST_ASSERT(s.seats[0].hasTile(16) && s.seats[0].counts[4] == 1, "0m is the red five");
+    TEST_ASSERT(s.seats[0].wait_mask == 0 && s.seats[1].river_len == 4 && s.seats[1].riichi == 2, "seats filled");
+    TEST_ASSERT(position.wall[s.dead_wall_start + 4] / 4 == 2, "dora indicator placed in the dead wall");
+
+    const HiddenInfo& hidden = position.hidden;
+    TEST_ASSERT(hidden.hand_size[0] == 0 && hidden.hand_size[1] == 13 && hidden.hand_size[3] == 13, "hidden hand sizes");
+    TEST_ASSERT(hidden.tenpai[1] && !hidden.tenpai[2], "riichi seat must be tenpai");
+    int unseen = 0;
+    for (int i = 0; i < 3; ++i) unseen += __builtin_popcountll(hidden.unseen[i]);
+    TEST_ASSERT(unseen == 136 - 13 - 9 - 1, "unseen tiles exclude hand, rivers and dora");
+
+    TEST_ASSERT(!parsePosition("hand 0 5555m123p456s11z\n", position, error), "five copies rejected");
+    TEST_ASSERT(!parsePosition("hand 0 123m\n", position, error), "short hand rejected");
+    TEST_ASSERT(!parsePosition("hand 0 123m456p789s1122z\nriichi 0\nmeld 0 pon 555z\n", position, error),
+                "riichi with melds rejected");
+    TEST_ASSERT(!parsePosition("turn 5\n", position, error), "bad seat rejected");
+    TEST_ASSERT(!parsePosition("hand 0 123x\n", position, error), "bad tiles rejected");
+    std::cout << "  last error: " << error << std::endl;
+
+    TEST_ASSERT(parsePosition("remaining 40\nmeld 2 pon 555z\nmeld 2 kan 1111p\nhand 2 ?\nturn 2\ndrawn 9s\n", position, error),
+                "melds parse");
+    TEST_ASSERT(position.hidden.hand_size[2] == 7 && position.snapshot.kan_count == 1 &&
+                position.snapshot.fast_scoring && position.drawn / 4 == 26, "melds shrink the hand");
+
+    return 0;
+}
+
+// Test the simulated probabilities
+int testRun() {
+    std::cout << "\n=== Testing equity simulation ===" << std::endl;
+
+    EquityPosition position;
+    std::string error;
+    TEST_ASSERT(parsePosition(riichi_position, position, error), "riichi position parses");
+
+    EquityConfig config;
+    config.num_threads = 1;
+    config.target_ci = 0;
+    config.max_samples = 3000;
+    config.seed = 5;
+    EquityResult result = runEquity(position, config);
+    std::cout << "  " << result.samples << " rounds in " << result.seconds << " s" << std::endl;
+
+    double total = result.draw, deal_ins = 0, deltas = 0;
+    for (int s = 0; s < 4; ++s) {
+        total += result.win[s];
+        deal_ins += result.deal_in[s];
+        deltas += result.delta[s];
+        std::cout << "  seat " << s << ": win " << result.win[s] << " deal-in " << result.deal_in[s]
+                  << " delta " << result.delta[s] << std::endl;
+    }
+    TEST_ASSERT(result.samples == 3000 && !result.converged, "runs to the sample limit");
+    TEST_ASSERT(std::abs(total - 1.0) < 1e-9, "outcomes sum to one");
+    TEST_ASSERT(deal_ins <= 1.0 - result.draw + 1e-9, "deal-ins are a subset of wins");
+    TEST_ASSERT(deltas <= 1000 + 1e-6 && deltas >= -1e-6, "point deltas balance up to the riichi stick");
+    TEST_ASSERT(result.win[1] > result.win[2] && result.win[1] > result.win[3], "riichi seat wins most often");
+
+    // 固定样本数时多线程只改变执行顺序
+    config.num_threads = 3;
+    EquityResult threaded = runEquity(position, config);
+    config.num_threads = 1;
+    EquityResult again = runEquity(position, config);
+    TEST_ASSERT(sameResult(result, again), "same seed reproduces the result");
+    TEST_ASSERT(threaded.samples == result.samples && std::abs(threaded.win[1] - result.win[1]) < 1e-9 &&
+                std::abs(threaded.delta[0] - result.delta[0]) < 1e-6, "threaded run covers the same samples");
+
+    // 置信区间足够窄时提前结束
+    config.target_ci = 0.03;
+    config.min_samples = 200;
+    config.max_samples = 100000;
+    EquityResult early = runEquity(position, config);
+    std::cout << "  early stop after " << early.samples << " rounds, max ci " << early.max_ci << std::endl;
+    TEST_ASSERT(early.converged && early.samples < 100000 && early.max_ci <= 0.03, "stops once confident");
+
+    config.policy = tsumogiriPolicy;
+    config.target_ci = 0;
+    config.max_samples = 500;
+    EquityResult baseline = runEquity(position, config);
+    TEST_ASSERT(baseline.samples == 500, "alternative policy runs");
+
+    TEST_ASSERT(parsePosition("remaining 30\nmeld 3 chi 406s\nriichi 1\nturn 3\n", position, error), "open hand parses");
+    config.policy = nullptr;
+    EquityResult open = runEquity(position, config);
+    TEST_ASSERT(open.samples == 500 && open.win[1] > 0, "simulates an open hand with a hidden riichi");
+
+    return 0;
+}
+
+// Test positions taken from a game in progress
+int testFromSnapshot() {
+    std::cout << "\n=== Testing positions from snapshots ===" << std::endl;
+
+    std::array<TileIndex, 136> wall;
+    for (int i = 0; i < 136; ++i) wall[i] = i;
+    std::mt19937 rng(17);
+    std::shuffle(wall.begin(), wall.end(), rng);
+    GameSnapshot snapshot;
+    dealSnapshot(snapshot, wall.data(), 0, Wind::East, 0, 0, {25000, 25000, 25000, 25000});
+    for (int i = 0; i < 12 && !snapshot.isFinished(); ++i) {
+        snapshot.apply(snapshot.phase == SnapshotPhase::Response ? static_cast<int>(Action::Pass) : snapshot.drawn);
+    }
+
+    EquityPosition position;
+    TEST_ASSERT(positionFromSnapshot(snapshot, position), "position built");
+    int hidden_hands = 0;
+    for (int s = 0; s < 4; ++s) hidden_hands += position.hidden.hand_size[s];
+    TEST_ASSERT(hidden_hands == 0 && !position.resume, "all hands known, continue from the same phase");
+    TEST_ASSERT(position.hidden.wall_slot_count == 136 - snapshot.wall_pointer - 1, "unseen wall slots");
+
+    EquityConfig config;
+    config.num_threads = 2;
+    config.target_ci = 0;
+    config.max_samples = 500;
+    EquityResult result = runEquity(position, config);
+    TEST_ASSERT(result.samples == 500, "simulates from a snapshot");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testParse();
+    failed += testRun();
+    failed += testFromSnapshot();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All equity tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
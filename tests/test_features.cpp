@@ -0,0 +1,210 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "table.h"
+#include "simple_ai.h"
+#include "snapshot.h"
+#include "constants.h"
+#include "feature_encoder.h"
+#include "feature_writer.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static const char* shard_prefix = "test_features";
+
+// 在摸牌决策时分别从 Table 和快照编码，比较两者
+class EncodingProbe : public SimpleAI {
+public:
+    long compared = 0;
+    long mismatches = 0;
+    long bad_layout = 0;
+
+    EncodingProbe(const std::string& name) : SimpleAI(name) {}
+
+    int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override {
+        int options = (can_tsumo ? DecisionOption::Tsumo : 0) |
+                      (can_ankan ? DecisionOption::Ankan : 0) |
+                      (can_riichi ? DecisionOption::Riichi : 0);
+        Observation from_table, from_snapshot;
+        observeTable(*table, seat, DecisionKind::Action, options, from_table);
+
+        GameSnapshot snapshot;
+        if (captureSnapshot(*table, snapshot)) {
+            observeSnapshot(snapshot, from_snapshot);
+            uint8_t a[feature_size], b[feature_size];
+            float f[feature_size];
+            encodeFeatures(from_table, a);
+            encodeFeatures(from_snapshot, b);
+            encodeFeatures(from_table, f);
+            compared++;
+            if (std::memcmp(a, b, sizeof(a)) != 0) mismatches++;
+
+            // 手牌 14 张，摸到的牌一张，float 与 uint8 数值相同
+            int hand = 0, drawn = 0;
+            for (int t = 0; t < 34; ++t) {
+                for (int n = 0; n < 4; ++n) hand += a[(PlaneHand + n) * 34 + t];
+                drawn += a[PlaneDrawn * 34 + t];
+            }
+            bool same = true;
+            for (int i = 0; i < feature_size; ++i) same = same && f[i] == a[i];
+            if (hand != 14 || drawn != 1 || a[PlaneDrawn * 34 + drawn_tile / 4] != 1 || !same ||
+                a[PlaneKind * 34] != 1 || a[PlaneRemaining * 34] != table->getRemainingTiles()) {
+                bad_layout++;
+            }
+        }
+        return SimpleAI::decideAction(drawn_tile, can_tsumo, can_ankan, can_riichi);
+    }
+};
+
+// Test that Table and snapshot views encode to the same planes
+int testTableMatchesSnapshot() {
+    std::cout << "\n=== Testing Table / snapshot encoding ===" << std::endl;
+
+    Table table;
+    table.setSeed(8);
+    EncodingProbe players[4] = {EncodingProbe("A"), EncodingProbe("B"), EncodingProbe("C"), EncodingProbe("D")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+    for (int r = 0; r < 40; ++r) {
+        table.setDealer(r % 4);
+        table.setHonba(r % 3);
+        table.playRound();
+    }
+
+    long compared = 0, mismatches = 0, bad_layout = 0;
+    for (const EncodingProbe& p : players) {
+        compared += p.compared;
+        mismatches += p.mismatches;
+        bad_layout += p.bad_layout;
+    }
+    std::cout << "  compared " << compared << " positions" << std::endl;
+    TEST_ASSERT(compared > 1000, "encoded many positions");
+    TEST_ASSERT(mismatches == 0, "Table and snapshot encodings agree");
+    TEST_ASSERT(bad_layout == 0, "planes follow the documented layout");
+
+    return 0;
+}
+
+// Test a hand-built observation plane by plane
+int testLayout() {
+    std::cout << "\n=== Testing plane layout ===" << std::endl;
+
+    Observation obs;
+    std::memset(&obs, 0, sizeof(obs));
+    obs.seat = 2;
+    obs.kind = DecisionKind::Response;
+    obs.hand[_5p] = 3;
+    obs.drawn = invalid_tile_index;
+    obs.target = _5p * 4 + 3;
+    obs.river[1][Chun] = 2;
+    obs.melds[3][_7s] = 3;
+    obs.dora[_1m] = 1;
+    obs.riichi[1] = true;
+    obs.scores[0] = 31000;
+    obs.scores[3] = -5000;
+    obs.round_wind = Wind::South;
+    obs.seat_wind = Wind::West;
+    obs.remaining = 40;
+    obs.riichi_sticks = 2;
+
+    uint8_t out[feature_size];
+    encodeFeatures(obs, out);
+    auto at = [&](int plane, int tile) { return out[plane * 34 + tile]; };
+    TEST_ASSERT(at(PlaneHand, _5p) && at(PlaneHand + 2, _5p) && !at(PlaneHand + 3, _5p), "hand thermometer");
+    TEST_ASSERT(at(PlaneTarget, _5p) == 1 && at(PlaneRiver + 1, Chun) == 2 && at(PlaneMeld + 3, _7s) == 3,
+                "target, river and meld planes");
+    TEST_ASSERT(at(PlaneDora, _1m) == 1 && at(PlaneRiichi + 1, 20) == 1 && at(PlaneRiichi, 20) == 0, "dora and riichi");
+    TEST_ASSERT(at(PlaneRoundWind, SouthWind) == 1 && at(PlaneSeatWind, WestWind) == 1, "wind planes");
+    TEST_ASSERT(at(PlaneScore, 0) == 31 && at(PlaneScore + 3, 0) == 0 && at(PlaneRemaining, 33) == 40 &&
+                at(PlaneSticks, 5) == 2 && at(PlaneDealer, 0) == 0, "scalar planes");
+    TEST_ASSERT(at(PlaneKind + 1, 0) == 1 && at(PlaneKind, 0) == 0, "decision kind plane");
+
+    return 0;
+}
+
+// Test sharded output of a recorded self-play session
+int testShards() {
+    std::cout << "\n=== Testing sharded output ===" << std::endl;
+
+    FeatureShardWriter writer;
+    TEST_ASSERT(writer.open(shard_prefix, 1000), "open first shard");
+
+    Table table;
+    table.setSeed(21);
+    SimpleAI players[4] = {SimpleAI("A"), SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    long decisions = 0;
+    std::vector<int> outcomes;  // 每次决策者本局的得失点
+    size_t round_start = 0;
+    GameCallbacks callbacks;
+    callbacks.onDecision = [&](int seat, DecisionKind, int, int) {
+        decisions++;
+        outcomes.push_back(seat);
+    };
+    callbacks.onGameEnd = [&](const GameResult& result) {
+        for (size_t i = round_start; i < outcomes.size(); ++i) outcomes[i] = result.deltas[outcomes[i]];
+        round_start = outcomes.size();
+    };
+    table.setCallbacks(callbacks);
+
+    {
+        FeatureRecorder recorder(&table, &writer);
+        for (int r = 0; r < 60; ++r) {
+            table.setDealer(r % 4);
+            table.playRound();
+        }
+    }
+    writer.close();
+    std::cout << "  " << writer.getRecordCount() << " records in " << writer.getShardCount() << " shards" << std::endl;
+    TEST_ASSERT(writer.getRecordCount() == decisions, "one record per decision");
+    TEST_ASSERT(writer.getShardCount() == (decisions + 999) / 1000, "shards rotate every 1000 records");
+
+    // 读回所有分片: 文件头、记录数和每条记录的得失点
+    long read = 0, bad = 0;
+    for (int s = 0; s < writer.getShardCount(); ++s) {
+        std::string path = FeatureShardWriter::shardPath(shard_prefix, s);
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return 1;
+        uint8_t header[16];
+        bool header_ok = std::fread(header, 1, 16, f) == 16 && std::memcmp(header, "MJFT", 4) == 0 &&
+                         header[6] == NumFeaturePlanes && (header[8] | header[9] << 8) == feature_record_size;
+        if (!header_ok) bad++;
+        std::vector<uint8_t> rec(feature_record_size);
+        while (std::fread(rec.data(), 1, rec.size(), f) == rec.size()) {
+            const uint8_t* tail = rec.data() + feature_size;
+            int32_t outcome = static_cast<int32_t>(tail[4] | tail[5] << 8 | tail[6] << 16 | (uint32_t)tail[7] << 24);
+            if (read >= (long)outcomes.size() || outcome != outcomes[read]) bad++;
+            read++;
+        }
+        std::fclose(f);
+        std::remove(path.c_str());
+    }
+    TEST_ASSERT(read == decisions && bad == 0, "shards read back with outcomes");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testTableMatchesSnapshot();
+    failed += testLayout();
+    failed += testShards();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All feature tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
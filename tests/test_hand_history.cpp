@@ -0,0 +1,319 @@
+#include <iostream>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "table.h"
+#include "player.h"
+#include "simple_ai.h"
+#include "replay_log.h"
+#include "hand_history.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static const char* store_path = "test_hand_history.db";
+static const char* log_path = "test_hand_history.mjr";
+
+static void removeStore() {
+    const char* tables[2] = {"rounds", "decisions"};
+    for (int t = 0; t < 2; ++t) {
+        int count;
+        const HistoryColumn* columns = getHistoryColumns(static_cast<HistoryTable>(t), count);
+        for (int c = 0; c < count; ++c) {
+            std::string base = std::string(store_path) + "/" + tables[t] + "." + columns[c].name;
+            std::remove((base + ".col").c_str());
+            std::remove((base + ".stats").c_str());
+        }
+    }
+    std::remove((std::string(store_path) + "/history.meta").c_str());
+    rmdir(store_path);
+}
+
+// 逐行比较，作为查询结果的参照
+static bool matchRow(const HandHistory& history, HistoryTable table, const std::vector<HistoryFilter>& filters,
+                     uint64_t row) {
+    for (const HistoryFilter& f : filters) {
+        int64_t x = history.getValue(table, f.column, row);
+        int64_t v = f.value;
+        bool ok = false;
+        switch (f.op) {
+            case FilterOp::Eq: ok = x == v; break;
+            case FilterOp::Ne: ok = x != v; break;
+            case FilterOp::Lt: ok = x < v; break;
+            case FilterOp::Le: ok = x <= v; break;
+            case FilterOp::Gt: ok = x > v; break;
+            case FilterOp::Ge: ok = x >= v; break;
+            case FilterOp::HasAll: ok = (x & v) == v; break;
+            case FilterOp::HasAny: ok = (x & v) != 0; break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// 查询结果与逐行比较一致 (命中数和前 max_rows 个行号)
+static bool checkQuery(const HandHistory& history, HistoryTable table, const std::vector<std::string>& texts,
+                       int threads, HistoryQueryResult& result) {
+    std::vector<HistoryFilter> filters;
+    for (const std::string& text : texts) {
+        HistoryFilter f;
+        std::string error;
+        if (!parseHistoryFilter(table, text, f, error)) return false;
+        filters.push_back(f);
+    }
+    const size_t max_rows = 25;
+    result = queryHistory(history, table, filters, max_rows, threads);
+
+    uint64_t matches = 0;
+    std::vector<uint64_t> sample;
+    for (uint64_t row = 0; row < history.getRowCount(table); ++row) {
+        if (!matchRow(history, table, filters, row)) continue;
+        matches++;
+        if (sample.size() < max_rows) sample.push_back(row);
+    }
+    return result.matches == matches && result.sample == sample;
+}
+
+// Test filter parsing
+int testParseFilter() {
+    std::cout << "\n=== Testing filter parsing ===" << std::endl;
+
+    HistoryFilter f;
+    std::string error;
+    TEST_ASSERT(parseHistoryFilter(HistoryTable::Rounds, "score>=12000", f, error) &&
+                f.column == RoundColumn::Score && f.op == FilterOp::Ge && f.value == 12000, "score>=12000");
+    TEST_ASSERT(parseHistoryFilter(HistoryTable::Rounds, "winner_wind!=0", f, error) &&
+                f.column == RoundColumn::WinnerWind && f.op == FilterOp::Ne && f.value == 0, "winner_wind!=0");
+    TEST_ASSERT(parseHistoryFilter(HistoryTable::Rounds, "yaku&Chinitsu+Richii", f, error) &&
+                f.op == FilterOp::HasAll &&
+                f.value == static_cast<int64_t>((1ull << static_cast<int>(Yaku::Chinitsu)) |
+                                                (1ull << static_cast<int>(Yaku::Richii))), "yaku names to mask");
+    TEST_ASSERT(parseHistoryFilter(HistoryTable::Rounds, "riichi|0x5", f, error) &&
+                f.op == FilterOp::HasAny && f.value == 5, "riichi|0x5");
+    TEST_ASSERT(parseHistoryFilter(HistoryTable::Decisions, "action=141", f, error) &&
+                f.column == DecisionColumn::Action && f.op == FilterOp::Eq, "single = on decisions");
+
+    TEST_ASSERT(!parseHistoryFilter(HistoryTable::Rounds, "points>1", f, error), "unknown column rejected");
+    TEST_ASSERT(!parseHistoryFilter(HistoryTable::Rounds, "yaku>3", f, error), "ordering on mask rejected");
+    TEST_ASSERT(!parseHistoryFilter(HistoryTable::Rounds, "score&4", f, error), "bit test on I32 rejected");
+    TEST_ASSERT(!parseHistoryFilter(HistoryTable::Rounds, "yaku&Chinitsu+", f, error), "bad yaku name rejected");
+    TEST_ASSERT(!parseHistoryFilter(HistoryTable::Rounds, "han>=x", f, error), "bad number rejected");
+
+    return 0;
+}
+
+// Test every operator on every column against a row-by-row scan
+int testQuery() {
+    std::cout << "\n=== Testing queries ===" << std::endl;
+
+    // 局数不是块的整数倍；honba 按局号递增，让块统计能排除或整块接受
+    const int rounds = history_block_rows * 3 + 777;
+    std::mt19937 rng(7);
+    HistoryWriter writer;
+    TEST_ASSERT(writer.open(store_path), "create store");
+    for (int i = 0; i < rounds; ++i) {
+        ReplayRound round;
+        round.dealer = i * 4 / rounds;
+        round.round_wind = static_cast<Wind>(rng() % 2);
+        round.honba = i / 5000;
+        int seat = static_cast<int>(rng() % 4);
+        int draws = 8 + static_cast<int>(rng() % 60);
+        for (int d = 0; d < draws; ++d) {
+            round.decisions.push_back({static_cast<uint8_t>(seat), 0, 0, static_cast<uint8_t>(rng() % 136)});
+            if (rng() % 40 == 0) {
+                round.decisions.push_back({static_cast<uint8_t>(seat), 0, DecisionOption::Riichi,
+                                           static_cast<uint8_t>(Action::Riichi)});
+            }
+            seat = (seat + 1) % 4;
+        }
+        GameResult& r = round.result;
+        r.winner = static_cast<int>(rng() % 5) - 1;
+        if (r.winner >= 0) {
+            r.is_tsumo = rng() % 2 == 0;
+            r.from_player = r.is_tsumo ? -1 : (r.winner + 1 + static_cast<int>(rng() % 3)) % 4;
+            for (int y = 0; y <= static_cast<int>(Yaku::Daisuushii); ++y) {
+                if (y != static_cast<int>(Yaku::Chinitsu) && rng() % 9 == 0) r.yaku.push_back(static_cast<Yaku>(y));
+            }
+            // 后半段才出现清一色
+            if (i > rounds / 2 && rng() % 3 == 0) r.yaku.push_back(Yaku::Chinitsu);
+            r.han = 1 + static_cast<int>(rng() % 13);
+            r.fu = 20 + 10 * static_cast<int>(rng() % 6);
+            r.score = 1000 + 100 * static_cast<int>(rng() % 480);
+        } else {
+            r.is_tsumo = false;
+            r.from_player = -1;
+            r.han = r.fu = r.score = 0;
+        }
+        writer.writeRound(round);
+    }
+    writer.close();
+
+    HandHistory history;
+    TEST_ASSERT(history.open(store_path), "mmap store");
+    TEST_ASSERT(history.getRowCount(HistoryTable::Rounds) == static_cast<uint64_t>(rounds), "round count");
+    TEST_ASSERT(history.getRowCount(HistoryTable::Decisions) > static_cast<uint64_t>(rounds) * 8, "decision rows");
+
+    HistoryQueryResult result;
+    TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {"yaku&Chinitsu", "score>12000", "winner_wind!=0"}, 4,
+                           result) && result.matches > 0, "chinitsu above 12000 as non-dealer");
+    std::cout << "  " << result.matches << " matches, " << result.blocks_skipped << "/" << result.blocks
+              << " blocks skipped" << std::endl;
+    TEST_ASSERT(result.blocks_skipped >= 1, "blocks without chinitsu skipped");
+
+    TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {"honba==2"}, 2, result) &&
+                result.blocks_skipped == 2 && result.blocks_full == 1, "min/max skips and accepts blocks");
+    TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {"honba>=0"}, 2, result) &&
+                result.matches == static_cast<uint64_t>(rounds) && result.bytes_scanned == 0,
+                "always-true filter needs no scan");
+    TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {"honba<-1"}, 2, result) && result.matches == 0,
+                "always-false filter");
+
+    // 每个列的每种运算
+    const char* ops[] = {"==", "!=", "<", "<=", ">", ">="};
+    int count;
+    const HistoryColumn* columns = getHistoryColumns(HistoryTable::Rounds, count);
+    for (int c = 0; c < count; ++c) {
+        std::string name = columns[c].name;
+        int64_t sample = history.getValue(HistoryTable::Rounds, c, 4321);
+        for (const char* op : ops) {
+            std::string text = name + op + std::to_string(sample);
+            if (columns[c].type == ColumnType::Mask64 && std::string(op) != "==" && std::string(op) != "!=") continue;
+            TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {text}, 3, result), text);
+        }
+        if (columns[c].type == ColumnType::U8 || columns[c].type == ColumnType::Mask64) {
+            TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {name + "&3"}, 3, result), name + "&3");
+            TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {name + "|6"}, 3, result), name + "|6");
+        }
+    }
+    TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {"riichi&256"}, 1, result) && result.matches == 0,
+                "bit outside U8 never set");
+    TEST_ASSERT(checkQuery(history, HistoryTable::Rounds, {"yaku|Chinitsu+Honitsu", "han>=6", "from!=-1"}, 3,
+                           result), "ron with chinitsu or honitsu");
+    TEST_ASSERT(checkQuery(history, HistoryTable::Decisions, {"action==141", "turn<=6"}, 4, result) &&
+                result.matches > 0, "early riichi declarations");
+    TEST_ASSERT(checkQuery(history, HistoryTable::Decisions, {"round>=10000", "seat==2"}, 4, result),
+                "decisions of later rounds");
+
+    return 0;
+}
+
+// Test recording self-play alongside the replay log
+int testRecorder() {
+    std::cout << "\n=== Testing recorder ===" << std::endl;
+
+    const int rounds = 30;
+    {
+        ReplayWriter replay;
+        HistoryWriter writer;
+        TEST_ASSERT(replay.open(log_path) && writer.open(store_path), "open replay log and store");
+
+        Table table;
+        table.setSeed(99);
+        SimpleAI players[4] = {SimpleAI("A"), SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+        for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+        ReplayRecorder replay_recorder(&table, &replay);
+        HistoryRecorder recorder(&table, &writer);
+        for (int i = 0; i < rounds; ++i) {
+            table.setDealer(i % 4);
+            table.playRound();
+        }
+        TEST_ASSERT(recorder.getRecordedCount() == rounds, "recorded every round");
+    }
+
+    ReplayLog log;
+    HandHistory history;
+    TEST_ASSERT(log.open(log_path) && log.getRoundCount() == rounds, "replay log written");
+    TEST_ASSERT(history.open(store_path) && history.getRowCount(HistoryTable::Rounds) == rounds, "store written");
+
+    uint64_t decision_row = 0;
+    bool same = true;
+    for (int i = 0; i < rounds && same; ++i) {
+        ReplayRound round;
+        log.readRound(i, round);
+        const GameResult& r = round.result;
+        uint64_t yaku = 0;
+        for (Yaku y : r.yaku) yaku |= 1ull << static_cast<int>(y);
+        same = history.getValue(HistoryTable::Rounds, RoundColumn::Yaku, i) == static_cast<int64_t>(yaku) &&
+               history.getValue(HistoryTable::Rounds, RoundColumn::Winner, i) == r.winner &&
+               history.getValue(HistoryTable::Rounds, RoundColumn::Score, i) == r.score &&
+               history.getValue(HistoryTable::Rounds, RoundColumn::Han, i) == r.han &&
+               history.getValue(HistoryTable::Rounds, RoundColumn::Dealer, i) == round.dealer;
+        for (const ReplayDecision& d : round.decisions) {
+            same = same && history.getValue(HistoryTable::Decisions, DecisionColumn::Round, decision_row) == i &&
+                   history.getValue(HistoryTable::Decisions, DecisionColumn::Action, decision_row) == d.action;
+            decision_row++;
+        }
+    }
+    TEST_ASSERT(same, "columns match the replay log");
+    TEST_ASSERT(decision_row == history.getRowCount(HistoryTable::Decisions), "one row per decision");
+
+    return 0;
+}
+
+// Test that readers only see flushed rows
+int testFlush() {
+    std::cout << "\n=== Testing flush ===" << std::endl;
+
+    HistoryWriter writer;
+    TEST_ASSERT(writer.open(store_path), "create store");
+    {
+        HandHistory history;
+        TEST_ASSERT(history.open(store_path) && history.getRowCount(HistoryTable::Rounds) == 0, "empty store");
+        HistoryQueryResult result = queryHistory(history, HistoryTable::Rounds, {}, 10, 2);
+        TEST_ASSERT(result.matches == 0 && result.blocks == 0, "query on empty store");
+    }
+
+    ReplayRound round;
+    round.dealer = 1;
+    round.round_wind = Wind::East;
+    round.honba = 0;
+    round.result = {2, false, 0, {Yaku::Richii}, 1, 30, 1000, {0, 0, 0, 0}};
+    for (int i = 0; i < 100; ++i) writer.writeRound(round);
+    writer.flush();
+    for (int i = 0; i < 5000; ++i) writer.writeRound(round);
+
+    // 没有 flush 的行不可见
+    HandHistory history;
+    TEST_ASSERT(history.open(store_path) && history.getRowCount(HistoryTable::Rounds) == 100, "only flushed rows");
+    HistoryFilter f;
+    std::string error;
+    TEST_ASSERT(parseHistoryFilter(HistoryTable::Rounds, "winner_wind==1", f, error), "parse");
+    TEST_ASSERT(queryHistory(history, HistoryTable::Rounds, {f}, 0, 1).matches == 100, "flushed rows queryable");
+    history.close();
+
+    writer.close();
+    TEST_ASSERT(history.open(store_path) && history.getRowCount(HistoryTable::Rounds) == 5100, "close flushes");
+    TEST_ASSERT(history.getBlockStats(HistoryTable::Rounds, RoundColumn::Score).size() == 2, "two blocks of stats");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testParseFilter();
+    failed += testQuery();
+    failed += testRecorder();
+    failed += testFlush();
+
+    removeStore();
+    std::remove(log_path);
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All hand history tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,240 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include "game_state.h"
+#include "json_reader.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static bool parse(const std::string& text, GameMessage& msg, const char** error = nullptr) {
+    return msg.parseJSON(text.data(), text.size(), error);
+}
+
+static GameState sampleState() {
+    GameState state;
+    state.round_wind = 1;
+    state.dealer = 2;
+    state.current_player = 3;
+    state.remaining_tiles = 57;
+    state.hands[0] = {0, 4, 8, 135};
+    state.hands[1] = {-1, -1};
+    state.discards[2] = {100, 12};
+    state.scores = {25000, 33000, -1200, 18000};
+    state.riichi_status = {false, true, false, false};
+    state.can_pon = true;
+    state.last_discard = 12;
+    return state;
+}
+
+static bool sameState(const GameState& a, const GameState& b) {
+    return a.round_wind == b.round_wind && a.dealer == b.dealer && a.current_player == b.current_player &&
+           a.remaining_tiles == b.remaining_tiles && a.honba == b.honba && a.riichi_sticks == b.riichi_sticks &&
+           a.hands == b.hands && a.discards == b.discards && a.scores == b.scores &&
+           a.riichi_status == b.riichi_status && a.can_tsumo == b.can_tsumo && a.can_ron == b.can_ron &&
+           a.can_riichi == b.can_riichi && a.can_chi == b.can_chi && a.can_pon == b.can_pon &&
+           a.can_kan == b.can_kan && a.last_draw == b.last_draw && a.last_discard == b.last_discard &&
+           a.last_discard_player == b.last_discard_player;
+}
+
+// Test writer output parses back to the same message
+int testRoundTrip() {
+    std::cout << "\n=== Testing round trip ===" << std::endl;
+
+    int mismatches = 0;
+    for (int t = 0; t < message_type_count; ++t) {
+        GameMessage msg;
+        msg.type = static_cast<MessageType>(t);
+        msg.room_id = "ROOM\"7\"\\\xe4\xb8\x9c";
+        msg.seat = 2;
+        msg.action = 139;
+        msg.tile = 0;
+        msg.tiles = {1, 2, 135};
+        msg.error_msg = "line\nbreak";
+        msg.state = sampleState();
+        msg.seq = 41;
+        msg.events = {{StateEventKind::Discard, 1, 77, 0}, {StateEventKind::Call, 2, 77, 138}};
+
+        GameMessage parsed;
+        if (!parse(msg.toJSON(), parsed)) {
+            mismatches++;
+            continue;
+        }
+        // 重新写出的结果相同；该类型不带的字段保持默认值
+        std::string again = parsed.toJSON();
+        if (again != msg.toJSON() || parsed.type != msg.type) mismatches++;
+        if (msg.type == MessageType::GameState && !sameState(parsed.state, msg.state)) mismatches++;
+        if (msg.type == MessageType::YourTurn && (!parsed.room_id.empty() || parsed.action != -1)) mismatches++;
+    }
+    TEST_ASSERT(mismatches == 0, "every message type round trips");
+
+    GameState state = sampleState();
+    TEST_ASSERT(sameState(GameState::fromJSON(state.toJSON()), state), "GameState round trips");
+
+    return 0;
+}
+
+// Test key order, unknown keys and escapes
+int testFields() {
+    std::cout << "\n=== Testing fields ===" << std::endl;
+
+    GameMessage msg;
+    TEST_ASSERT(parse(" { \"tile\" : 42 , \"extra\":{\"a\":[1,-2.5e+3,\"x\",null,true,{}]},\"action\":7,"
+                      "\"room_id\":\"skip me\",\"type\":4 } ", msg) &&
+                msg.type == MessageType::Action && msg.action == 7 && msg.tile == 42 && msg.room_id.empty(),
+                "type after fields, unknown keys skipped, unused fields not decoded");
+
+    TEST_ASSERT(parse("{\"\\u0074ype\":1,\"room_id\":\"A\\u00e9\\ud83c\\udc04\\/\"}", msg) &&
+                msg.type == MessageType::JoinRoom && msg.room_id == "A\xc3\xa9\xf0\x9f\x80\x84/",
+                "escaped key and unicode escapes");
+    TEST_ASSERT(parse("{\"token\":\"abc\",\"type\":1,\"room_id\":\"R2\"}", msg) &&
+                msg.type == MessageType::JoinRoom && msg.room_id == "R2" && msg.token == "abc",
+                "join carries the seat token");
+
+    // 复用同一个消息对象时不残留上一条的字段
+    TEST_ASSERT(parse("{\"type\":3}", msg) && msg.type == MessageType::Ready && msg.room_id.empty() &&
+                msg.token.empty(),
+                "fields reset between messages");
+
+    GameMessage bad = GameMessage::fromJSON("{\"type\":");
+    TEST_ASSERT(bad.type == MessageType::Error && !bad.error_msg.empty(), "fromJSON reports errors as Error");
+
+    return 0;
+}
+
+// Test malformed and hostile input is rejected
+int testRejects() {
+    std::cout << "\n=== Testing rejects ===" << std::endl;
+
+    const char* cases[] = {
+        "", "{", "}", "[1]", "{}", "null",
+        "{\"type\":1,}", "{\"type\":1 \"seat\":1}", "{,\"type\":1}", "{\"type\"1}",
+        "{\"type\":01}", "{\"type\":1.5}", "{\"type\":-}", "{\"type\":1e}", "{\"type\":99}", "{\"type\":-1}",
+        "{\"type\":1,\"type\":1}", "{\"type\":4,\"tile\":1,\"tile\":2}",
+        "{\"type\":4,\"tile\":2147483648}", "{\"type\":4,\"tile\":99999999999999999999}",
+        "{\"type\":1,\"room_id\":\"a\x01\"}", "{\"type\":1,\"room_id\":\"a\\x\"}", "{\"type\":1,\"room_id\":\"a\\u12\"}",
+        "{\"type\":1,\"room_id\":\"\\ud83c\"}", "{\"type\":1,\"room_id\":\"\\udc04\"}", "{\"type\":1,\"room_id\":\"abc}",
+        "{\"type\":1,\"room_id\":7}", "{\"type\":4,\"tile\":\"7\"}", "{\"type\":11,\"tiles\":[1,]}",
+        "{\"type\":0,\"x\":tru}", "{\"type\":0,\"x\":nul}", "{\"type\":0} x", "{\"type\":0}{}",
+        "{\"type\":10,\"state\":{\"scores\":[1,2,3]}}", "{\"type\":15,\"events\":[[9,0,0,0]]}",
+        "{\"type\":15,\"events\":[[0,0,0]]}", "{\"type\":16,\"seq\":true}", "{\"type\":10,\"state\":{\"hands\":[[],[],[],[],[]]}}",
+        "{\"type\":10,\"state\":{\"hands\":[[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15]]}}",
+        "{\"type\":10,\"state\":{\"discards\":[[],[300]]}}", "{\"type\":10,\"state\":{\"hands\":[[-2]]}}",
+    };
+    int accepted = 0;
+    for (const char* text : cases) {
+        GameMessage msg;
+        const char* error = nullptr;
+        if (parse(text, msg, &error) || !error || !*error) {
+            std::cout << "  accepted: " << text << std::endl;
+            accepted++;
+        }
+    }
+    TEST_ASSERT(accepted == 0, "malformed messages rejected with an error");
+
+    // 限制
+    GameMessage msg;
+    const char* error = nullptr;
+    std::string deep = "{\"type\":0,\"x\":" + std::string(100, '[') + std::string(100, ']') + "}";
+    TEST_ASSERT(!parse(deep, msg, &error) && std::string(error) == "nesting too deep", "depth limit");
+
+    std::string big = "{\"type\":0,\"x\":\"" + std::string(70000, 'a') + "\"}";
+    TEST_ASSERT(!parse(big, msg, &error) && std::string(error) == "message too large", "size limit");
+
+    std::string many = "{\"type\":11,\"tiles\":[";
+    for (int i = 0; i < 300; ++i) many += i ? ",1" : "1";
+    many += "]}";
+    TEST_ASSERT(!parse(many, msg, &error) && std::string(error) == "array too long", "array limit");
+
+    std::string long_id = "{\"type\":1,\"room_id\":\"" + std::string(2000, 'r') + "\"}";
+    TEST_ASSERT(!parse(long_id, msg, &error) && std::string(error) == "string too long", "string limit");
+
+    JsonLimits strict;
+    strict.max_string = 8;
+    std::string id = "{\"type\":1,\"room_id\":\"ROOM1234\"}";
+    TEST_ASSERT(msg.parseJSON(id.data(), id.size(), strict) && msg.room_id == "ROOM1234", "custom limits");
+
+    return 0;
+}
+
+// Test truncated and mutated input never crashes and never reads past the end
+int testFuzz() {
+    std::cout << "\n=== Testing fuzz ===" << std::endl;
+
+    GameMessage source;
+    source.type = MessageType::GameState;
+    source.state = sampleState();
+    std::string text = source.toJSON();
+
+    int accepted_prefixes = 0;
+    for (size_t n = 0; n < text.size(); ++n) {
+        // 复制到刚好大小的缓冲区，越界读会被 sanitizer 发现
+        std::string prefix(text.data(), n);
+        GameMessage msg;
+        if (parse(prefix, msg)) accepted_prefixes++;
+    }
+    TEST_ASSERT(accepted_prefixes == 0, "every truncation rejected");
+
+    std::mt19937 rng(7);
+    const char alphabet[] = "{}[],:\"\\u0123456789-+.eEtrufalsn ";
+    int parsed = 0;
+    for (int i = 0; i < 20000; ++i) {
+        std::string mutated = text;
+        int edits = 1 + rng() % 4;
+        for (int e = 0; e < edits; ++e) {
+            size_t pos = rng() % mutated.size();
+            mutated[pos] = alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        GameMessage msg;
+        if (parse(mutated, msg)) parsed++;
+    }
+    std::cout << "  " << parsed << " of 20000 mutations still valid" << std::endl;
+    TEST_ASSERT(true, "mutated messages handled");
+
+    return 0;
+}
+
+// Test parse speed of the hot client message
+int testSpeed() {
+    std::cout << "\n=== Testing speed ===" << std::endl;
+
+    std::string action = "{\"type\":4,\"action\":138,\"tile\":57}";
+    GameMessage msg;
+    const int rounds = 200000;
+    long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        if (parse(action, msg)) sum += msg.tile;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  Action message: " << seconds * 1e9 / rounds << " ns" << std::endl;
+    TEST_ASSERT(sum == 57L * rounds, "all parses succeeded");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testRoundTrip();
+    failed += testFields();
+    failed += testRejects();
+    failed += testFuzz();
+    failed += testSpeed();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All JSON reader tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
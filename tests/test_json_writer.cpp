@@ -0,0 +1,194 @@
+#include <iostream>
+#include <chrono>
+#include <climits>
+#include <string>
+#include "game_state.h"
+#include "json_writer.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static std::string formatted(int v) {
+    char text[12];
+    return std::string(text, formatInt(v, text));
+}
+
+static GameState sampleState() {
+    GameState state;
+    state.round_wind = 1;
+    state.dealer = 2;
+    state.current_player = 3;
+    state.remaining_tiles = 57;
+    state.honba = 1;
+    state.riichi_sticks = 2;
+    state.hands[0] = {0, 4, 8, 135};
+    state.hands[1] = {-1, -1};
+    state.discards[2] = {100, 12};
+    state.scores = {25000, 33000, -1200, 18000};
+    state.riichi_status = {false, true, false, false};
+    state.can_ron = true;
+    state.last_draw = 135;
+    state.last_discard = 12;
+    state.last_discard_player = 2;
+    return state;
+}
+
+// Test integer formatting
+int testIntegers() {
+    std::cout << "\n=== Testing integer formatting ===" << std::endl;
+
+    const int values[] = {0, 1, 9, 10, 99, 100, 101, 999, 1000, 25000, 123456789, INT_MAX, -1, -10, -99, -100,
+                          -25000, INT_MIN};
+    int wrong = 0;
+    for (int v : values) {
+        if (formatted(v) != std::to_string(v)) wrong++;
+    }
+    for (int v = -20000; v <= 20000; ++v) {
+        if (formatted(v) != std::to_string(v)) wrong++;
+    }
+    TEST_ASSERT(wrong == 0, "integers match std::to_string");
+
+    return 0;
+}
+
+// Test string escaping and nesting
+int testWriter() {
+    std::cout << "\n=== Testing writer ===" << std::endl;
+
+    std::string out;
+    JsonWriter w(out);
+    w.beginObject();
+    w.field("a", std::string("x\"y\\z\n\t\r"));
+    w.field("b", std::string("\x01\x1f ok"));
+    w.key("c");
+    w.beginArray();
+    w.beginArray();
+    w.endArray();
+    w.value(true);
+    w.beginObject();
+    w.field("d", -5);
+    w.endObject();
+    w.endArray();
+    w.key("e");
+    w.values(nullptr, 0);
+    w.endObject();
+    TEST_ASSERT(out == "{\"a\":\"x\\\"y\\\\z\\n\\t\\r\",\"b\":\"\\u0001\\u001f ok\",\"c\":[[],true,{\"d\":-5}],\"e\":[]}",
+                "escaping, commas and nesting");
+
+    // 追加而不是覆盖
+    std::string prefix = "xx";
+    JsonWriter w2(prefix);
+    w2.value(std::string("\xe4\xb8\x9c"));  // UTF-8 原样输出
+    TEST_ASSERT(prefix == "xx\"\xe4\xb8\x9c\"", "appends to existing content");
+
+    return 0;
+}
+
+// Test GameState output keeps the existing format
+int testGameState() {
+    std::cout << "\n=== Testing GameState ===" << std::endl;
+
+    GameState state = sampleState();
+    std::string expected =
+        "{\"round_wind\":1,\"dealer\":2,\"current_player\":3,\"remaining_tiles\":57,\"honba\":1,"
+        "\"riichi_sticks\":2,\"hands\":[[0,4,8,135],[-1,-1],[],[]],\"discards\":[[],[],[100,12],[]],"
+        "\"scores\":[25000,33000,-1200,18000],\"riichi_status\":[false,true,false,false],"
+        "\"can_tsumo\":false,\"can_ron\":true,\"can_riichi\":false,\"can_chi\":false,\"can_pon\":false,"
+        "\"can_kan\":false,\"last_draw\":135,\"last_discard\":12,\"last_discard_player\":2}";
+    TEST_ASSERT(state.toJSON() == expected, "GameState JSON format");
+
+    return 0;
+}
+
+// Test GameMessage only writes the fields of its type
+int testMessages() {
+    std::cout << "\n=== Testing GameMessage ===" << std::endl;
+
+    GameMessage msg;
+    msg.type = MessageType::YourTurn;
+    msg.seat = 1;
+    msg.tile = 42;
+    msg.room_id = "unused";
+    TEST_ASSERT(msg.toJSON() == "{\"type\":11,\"seat\":1,\"tile\":42,\"tiles\":[]}", "YourTurn fields");
+
+    msg = GameMessage();
+    msg.type = MessageType::RoomCreated;
+    msg.room_id = "R1";
+    msg.seat = 0;
+    msg.token = "t0";
+    TEST_ASSERT(msg.toJSON() == "{\"type\":5,\"room_id\":\"R1\",\"seat\":0,\"token\":\"t0\"}", "RoomCreated fields");
+
+    msg = GameMessage();
+    msg.type = MessageType::Error;
+    msg.error_msg = "bad \"room\"";
+    TEST_ASSERT(msg.toJSON() == "{\"type\":14,\"error_msg\":\"bad \\\"room\\\"\"}", "Error fields");
+
+    msg = GameMessage();
+    msg.type = MessageType::GameStart;
+    TEST_ASSERT(msg.toJSON() == "{\"type\":9}", "GameStart has no fields");
+
+    msg = GameMessage();
+    msg.type = MessageType::GameState;
+    msg.state = sampleState();
+    TEST_ASSERT(msg.toJSON() == "{\"type\":10,\"state\":" + msg.state.toJSON() + ",\"seq\":-1}", "GameState message nests state");
+
+    // 线程缓冲区复用: 内容正确，容量稳定后地址不变
+    const std::string& first = msg.serialize();
+    const char* data = first.data();
+    size_t capacity = first.capacity();
+    GameMessage small;
+    small.type = MessageType::PlayerLeft;
+    small.seat = 3;
+    const std::string& second = small.serialize();
+    TEST_ASSERT(&first == &second && second == "{\"type\":8,\"seat\":3}", "serialize reuses the thread buffer");
+    TEST_ASSERT(msg.serialize().data() == data && second.capacity() == capacity, "no reallocation on reuse");
+
+    return 0;
+}
+
+// Test reused buffer against a fresh string per message
+int testSpeed() {
+    std::cout << "\n=== Testing speed ===" << std::endl;
+
+    GameMessage msg;
+    msg.type = MessageType::GameState;
+    msg.state = sampleState();
+    const int rounds = 20000;
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) total += msg.serialize().size();
+    double buffered = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) total += msg.toJSON().size();
+    double fresh = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << rounds << " GameState messages: " << buffered * 1e9 / rounds << " ns reused buffer, "
+              << fresh * 1e9 / rounds << " ns new string" << std::endl;
+    TEST_ASSERT(total == size_t(rounds) * 2 * msg.serialize().size(), "same output on both paths");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testIntegers();
+    failed += testWriter();
+    failed += testGameState();
+    failed += testMessages();
+    failed += testSpeed();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All JSON writer tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,363 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "table.h"
+#include "simple_ai.h"
+#include "constants.h"
+#include "legal_actions.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// TileIndex helper: tile * 4 + instance (0-3)
+inline TileIndex TI(Tile tile, int instance = 0) { return tile * 4 + instance; }
+
+static LegalHand makeHand(const TileIndexList& tiles, bool is_riichi = false) {
+    Hand hand(tiles, Wind::East, Wind::East);
+    LegalHand out = {};
+    for (TileIndex tile : tiles) {
+        out.tiles[tile >> 6] |= 1ULL << (tile & 63);
+        out.counts[tile / 4]++;
+    }
+    out.wait_mask = hand.getWaitMask();
+    out.is_menzen = true;
+    out.is_riichi = is_riichi;
+    out.score = 25000;
+    return out;
+}
+
+static const int Win = static_cast<int>(Action::Win);
+static const int Chi = static_cast<int>(Action::Chi);
+static const int Pon = static_cast<int>(Action::Pon);
+static const int Kan = static_cast<int>(Action::Kan);
+static const int Ankan = static_cast<int>(Action::Ankan);
+static const int Riichi = static_cast<int>(Action::Riichi);
+static const int Pass = static_cast<int>(Action::Pass);
+
+// Test the action after a draw
+int testTurnActions() {
+    std::cout << "\n=== Testing turn actions ===" << std::endl;
+
+    // 1m2m3m 4m5m6m 7m8m9m 1p1p1p 2p, 听 2p
+    TileIndexList tiles = {TI(_1m), TI(_2m), TI(_3m), TI(_4m), TI(_5m), TI(_6m),
+                           TI(_7m), TI(_8m), TI(_9m), TI(_1p), TI(_1p, 1), TI(_1p, 2), TI(_2p)};
+    LegalHand hand = makeHand(tiles);
+    LegalActions legal;
+
+    computeTurnActions(hand, TI(_2p, 1), 40, 0, legal);
+    TEST_ASSERT(legal.allows(Win) && (legal.getOptions() & DecisionOption::Tsumo), "tsumo on the wait");
+    TEST_ASSERT(legal.allows(Riichi) && legal.riichi != 0, "tenpai menzen hand may riichi");
+    bool all_discards = legal.canDiscard(TI(_2p, 1));
+    for (TileIndex tile : tiles) all_discards = all_discards && legal.canDiscard(tile);
+    TEST_ASSERT(all_discards && !legal.canDiscard(TI(_5s)), "every held tile and the drawn tile are discards");
+    TEST_ASSERT(!legal.allows(Pass) && !legal.allows(Chi) && !legal.allows(Ankan), "no response actions on a turn");
+
+    computeTurnActions(hand, TI(_1p, 3), 40, 0, legal);
+    TEST_ASSERT(legal.ankan == (1ULL << _1p), "fourth 1p marks an ankan");
+    TEST_ASSERT(!legal.allows(Ankan) && !(legal.getOptions() & DecisionOption::Ankan),
+                "ankan not offered until the table can carry it out");
+    TEST_ASSERT(!legal.allows(Win), "1p does not complete the hand");
+
+    computeTurnActions(hand, TI(_1p, 3), 0, 0, legal);
+    TEST_ASSERT(legal.ankan == 0 && !legal.allows(Riichi), "no kan or riichi from the last tile");
+    computeTurnActions(hand, TI(_1p, 3), 40, 4, legal);
+    TEST_ASSERT(legal.ankan == 0, "no fifth kan");
+
+    hand.score = 900;
+    computeTurnActions(hand, TI(_5s), 40, 0, legal);
+    TEST_ASSERT(!legal.allows(Riichi), "riichi needs 1000 points");
+
+    return 0;
+}
+
+// Test riichi restrictions
+int testRiichi() {
+    std::cout << "\n=== Testing riichi restrictions ===" << std::endl;
+
+    // 1m2m3m 4m5m6m 7m8m9m 1p1p1p 2p + 5s: 只有打 5s 或 2p 才听牌
+    TileIndexList tiles = {TI(_1m), TI(_2m), TI(_3m), TI(_4m), TI(_5m), TI(_6m),
+                           TI(_7m), TI(_8m), TI(_9m), TI(_1p), TI(_1p, 1), TI(_1p, 2), TI(_2p)};
+    LegalHand hand = makeHand(tiles);
+    LegalActions legal;
+    computeTurnActions(hand, TI(_5s), 40, 0, legal);
+    TEST_ASSERT(legal.riichi == ((1ULL << _5s) | (1ULL << _2p)), "riichi discards are 5s and 2p");
+    restrictToRiichiDiscards(legal);
+    TEST_ASSERT(legal.canDiscard(TI(_5s)) && legal.canDiscard(TI(_2p)), "declaration tiles stay legal");
+    TEST_ASSERT(!legal.canDiscard(TI(_1m)) && !legal.allows(Riichi) && legal.getOptions() == 0,
+                "other tiles and actions are dropped");
+
+    // 立直后只能摸切
+    LegalHand riichi = makeHand(tiles, true);
+    computeTurnActions(riichi, TI(_5s), 40, 0, legal);
+    TEST_ASSERT(legal.canDiscard(TI(_5s)) && !legal.canDiscard(TI(_1m)), "riichi hand only discards the drawn tile");
+    TEST_ASSERT(!legal.allows(Riichi), "no second riichi");
+
+    // 立直后暗杠: 1p1p1p2p 听 2p3p，杠 1p 后只听 2p，改变了听牌
+    computeTurnActions(riichi, TI(_1p, 3), 40, 0, legal);
+    TEST_ASSERT(legal.ankan == 0, "ankan changing the wait is illegal in riichi");
+
+    // 5p5p5p 1s 单骑: 杠 5p 后仍只听 1s
+    TileIndexList shape = {TI(_1m), TI(_2m), TI(_3m), TI(_4m), TI(_5m), TI(_6m), TI(_7m),
+                           TI(_8m), TI(_9m), TI(_5p), TI(_5p, 1), TI(_5p, 2), TI(_1s)};
+    LegalHand kept = makeHand(shape, true);
+    computeTurnActions(kept, TI(_5p, 3), 40, 0, legal);
+    TEST_ASSERT(legal.ankan == (1ULL << _5p), "ankan keeping the wait is legal in riichi");
+    computeTurnActions(kept, TI(_9s), 40, 0, legal);
+    TEST_ASSERT(legal.ankan == 0, "riichi ankan must use the drawn tile");
+
+    return 0;
+}
+
+// Test responses to a discard
+int testResponses() {
+    std::cout << "\n=== Testing responses ===" << std::endl;
+
+    // 2m3m4m5m 7m7m 1p1p1p 3s4s NN
+    TileIndexList tiles = {TI(_2m), TI(_3m), TI(_4m), TI(_5m), TI(_7m), TI(_7m, 1), TI(_1p),
+                           TI(_1p, 1), TI(_1p, 2), TI(_3s), TI(_4s), TI(NorthWind), TI(NorthWind, 1)};
+    LegalHand hand = makeHand(tiles);
+    LegalActions legal;
+
+    computeResponseActions(hand, TI(_3m, 1), true, 40, 0, legal);
+    TEST_ASSERT(legal.chi == (ChiShape::Low | ChiShape::Mid), "3m: 4m5m and 2m4m");
+    TEST_ASSERT(legal.allows(Chi) && legal.allows(Pass) && !legal.allows(Pon), "chi and pass only");
+
+    computeResponseActions(hand, TI(_3m, 1), false, 40, 0, legal);
+    TEST_ASSERT(!legal.any(), "only the next seat may chi");
+
+    computeResponseActions(hand, TI(_6m), true, 40, 0, legal);
+    TEST_ASSERT(legal.chi == (ChiShape::Mid | ChiShape::High), "6m: 5m7m and 4m5m");
+
+    computeResponseActions(hand, TI(_1p, 3), false, 40, 0, legal);
+    TEST_ASSERT(legal.allows(Pon) && legal.allows(Kan) && !legal.allows(Chi), "1p: pon and daiminkan");
+    computeResponseActions(hand, TI(_1p, 3), false, 40, 4, legal);
+    TEST_ASSERT(legal.allows(Pon) && !legal.allows(Kan), "no fifth kan");
+    computeResponseActions(hand, TI(_1p, 3), false, 0, 0, legal);
+    TEST_ASSERT(!legal.any(), "no calls on the last discard");
+
+    computeResponseActions(hand, TI(NorthWind, 2), true, 40, 0, legal);
+    TEST_ASSERT(legal.allows(Pon) && legal.chi == 0, "honors cannot be chi'd");
+
+    // 听牌: 1m2m3m 4m5m6m 7m8m9m 1p1p1p 2p
+    TileIndexList tenpai = {TI(_1m), TI(_2m), TI(_3m), TI(_4m), TI(_5m), TI(_6m),
+                            TI(_7m), TI(_8m), TI(_9m), TI(_1p), TI(_1p, 1), TI(_1p, 2), TI(_2p)};
+    LegalHand waiting = makeHand(tenpai);
+    computeResponseActions(waiting, TI(_2p, 1), false, 40, 0, legal);
+    TEST_ASSERT(legal.allows(Win) && (legal.getOptions() & DecisionOption::Ron), "ron on the wait");
+    waiting.is_furiten = true;
+    computeResponseActions(waiting, TI(_2p, 1), false, 40, 0, legal);
+    TEST_ASSERT(!legal.allows(Win), "furiten blocks ron");
+    waiting.is_furiten = false;
+    waiting.is_riichi = true;
+    computeResponseActions(waiting, TI(_1p, 3), true, 40, 0, legal);
+    TEST_ASSERT(!legal.allows(Pon) && !legal.allows(Kan), "riichi blocks calls");
+
+    return 0;
+}
+
+// Test kakan from a real pon
+int testKakan() {
+    std::cout << "\n=== Testing kakan ===" << std::endl;
+
+    SimpleAI player("P");
+    player.initHand({TI(_1m), TI(_2m), TI(_3m), TI(_4m), TI(_5m), TI(_6m), TI(_7m),
+                     TI(_8m), TI(_9m), TI(Haku), TI(Haku, 1), TI(_2p), TI(_3p)}, Wind::East, Wind::East);
+    player.getHand()->callPon(TI(Haku, 2), TI(_9m), 0);
+
+    LegalHand hand;
+    fillLegalHand(player, hand);
+    TEST_ASSERT(hand.pon_mask == (1ULL << Haku) && !hand.is_menzen, "pon recorded in the hand");
+
+    LegalActions legal;
+    computeTurnActions(hand, TI(Haku, 3), 40, 0, legal);
+    TEST_ASSERT(legal.kakan == (1ULL << Haku) && legal.ankan == 0 && !legal.allows(Ankan), "fourth haku marks a kakan");
+    TEST_ASSERT(!legal.allows(Riichi), "open hand cannot riichi");
+
+    return 0;
+}
+
+// 有牌可杠时总是宣言暗杠，否则摸切的玩家
+class KanPlayer : public SimpleAI {
+public:
+    int attempts = 0;
+    int offered = 0;
+
+    KanPlayer() : SimpleAI("Kan") {}
+
+    int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool) override {
+        if (can_ankan) offered++;
+        if (can_tsumo) return Win;
+        if (table->getLegalActions(seat).ankan == 0) return drawn_tile;
+        attempts++;
+        return Ankan;
+    }
+};
+
+// Test that an ankan request through Table keeps the hand and wall intact
+int testTableAnkan() {
+    std::cout << "\n=== Testing ankan through table ===" << std::endl;
+
+    // 按顺序的牌山: 庄家配到 1m x4 2m x4 3m x4 4m，第一张摸到 5p
+    TileIndexList wall;
+    for (TileIndex tile = 0; tile < 136; ++tile) wall.push_back(tile);
+
+    Table table;
+    KanPlayer dealer;
+    SimpleAI others[3] = {SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    table.setPlayer(0, &dealer);
+    for (int i = 0; i < 3; ++i) table.setPlayer(i + 1, &others[i]);
+    table.setDealer(0);
+    table.setNextWall(wall);
+
+    std::vector<int> actions;
+    GameCallbacks callbacks;
+    callbacks.onDecision = [&](int seat, DecisionKind kind, int, int action) {
+        if (seat == 0 && kind == DecisionKind::Action) actions.push_back(action);
+    };
+    int draws = 0;
+    callbacks.onDraw = [&](int, TileIndex) { draws++; };
+    table.setCallbacks(callbacks);
+    table.playRound();
+
+    TEST_ASSERT(dealer.attempts > 0 && dealer.offered == 0, "ankan requested but never offered");
+    TEST_ASSERT(!actions.empty() && actions[0] == TI(_5p) && dealer.getDiscards()[0] == TI(_5p),
+                "ankan request executed as tsumogiri");
+    TEST_ASSERT(table.getKanCount() == 0 && table.getDoraCount() == 1, "no rinshan draw or kan dora");
+    TEST_ASSERT(draws == table.getWallPointer() - 52, "every draw came from the live wall");
+    const Hand* hand = dealer.getHand();
+    TEST_ASSERT(hand->getTiles().size() == 13 && hand->getTileCounts()[_1m] == 4 && hand->getOpenMelds().empty(),
+                "four 1m still concealed in a 13-tile hand");
+
+    return 0;
+}
+
+// 随机返回任意动作编码的玩家，记录每个决策点看到的合法动作
+class ChaosPlayer : public Player {
+public:
+    std::mt19937 rng;
+    std::vector<LegalActions> seen;
+    std::vector<int> chosen;
+    int option_mismatches = 0;
+
+    ChaosPlayer(uint32_t seed) : Player("Chaos"), rng(seed) {}
+
+    int pick(const LegalActions& legal) {
+        // 一半时间给合法动作，一半时间给任意编码
+        int action;
+        if (rng() % 2) {
+            action = rng() % 143;
+        } else {
+            do { action = rng() % 143; } while (!legal.allows(action));
+        }
+        seen.push_back(legal);
+        chosen.push_back(action);
+        return action;
+    }
+
+    int decideAction(TileIndex, bool can_tsumo, bool can_ankan, bool can_riichi) override {
+        const LegalActions& legal = table->getLegalActions(seat);
+        int options = (can_tsumo ? DecisionOption::Tsumo : 0) | (can_ankan ? DecisionOption::Ankan : 0) |
+                      (can_riichi ? DecisionOption::Riichi : 0);
+        if (options != legal.getOptions()) option_mismatches++;
+        return pick(legal);
+    }
+    int decideResponse(TileIndex, int, bool, bool, bool, bool) override {
+        return pick(table->getLegalActions(seat));
+    }
+    TileIndex selectRiichiDiscard(TileIndex) override {
+        return pick(table->getLegalActions(seat));
+    }
+};
+
+// Test that Table executes exactly the legal actions
+int testTableValidation() {
+    std::cout << "\n=== Testing table validation ===" << std::endl;
+
+    Table table;
+    table.setSeed(99);
+    ChaosPlayer players[4] = {ChaosPlayer(1), ChaosPlayer(2), ChaosPlayer(3), ChaosPlayer(4)};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    struct Step { int seat; DecisionKind kind; int action; };
+    std::vector<Step> steps;
+    GameCallbacks callbacks;
+    callbacks.onDecision = [&](int seat, DecisionKind kind, int, int action) { steps.push_back({seat, kind, action}); };
+    table.setCallbacks(callbacks);
+
+    int stale = 0;
+    for (int seat = 0; seat < 4; ++seat) {
+        if (table.getLegalActions(seat).any() || table.getLegalActions(seat).getOptions()) stale++;
+    }
+    TEST_ASSERT(stale == 0, "no legal actions before the first decision");
+
+    size_t decisions = 0;
+    int mismatches = 0, option_mismatches = 0;
+    for (int r = 0; r < 50; ++r) {
+        for (ChaosPlayer& p : players) { p.seen.clear(); p.chosen.clear(); }
+        steps.clear();
+        table.setDealer(r % 4);
+        table.playRound();
+        for (int seat = 0; seat < 4; ++seat) {
+            if (table.getLegalActions(seat).any()) stale++;
+        }
+
+        // 逐个决策比对: 合法的选择原样执行，不合法的改为摸切 / 过
+        std::vector<size_t> cursor(4, 0);
+        for (const Step& step : steps) {
+            ChaosPlayer& p = players[step.seat];
+            size_t& i = cursor[step.seat];
+            if (i >= p.chosen.size()) { mismatches++; continue; }
+            const LegalActions& legal = p.seen[i];
+            int chosen = p.chosen[i++];
+            if (!legal.allows(chosen)) {
+                if (step.action == chosen) mismatches++;
+            } else if (chosen == static_cast<int>(Action::Riichi) && step.kind == DecisionKind::Action &&
+                       step.action != chosen) {
+                // 宣言牌不合法时整个立直改为摸切
+                if (i >= p.chosen.size() || p.seen[i].allows(p.chosen[i])) mismatches++;
+                i++;
+            } else if (step.action != chosen) {
+                mismatches++;
+            }
+        }
+        for (int seat = 0; seat < 4; ++seat) {
+            if (cursor[seat] != players[seat].chosen.size()) mismatches++;
+            decisions += players[seat].chosen.size();
+        }
+    }
+    for (const ChaosPlayer& p : players) option_mismatches += p.option_mismatches;
+
+    std::cout << "  decisions: " << decisions << std::endl;
+    TEST_ASSERT(decisions > 1000, "chaos players made decisions");
+    TEST_ASSERT(option_mismatches == 0, "decideAction flags match the legal mask");
+    TEST_ASSERT(stale == 0, "legal actions cleared after each decision");
+    TEST_ASSERT(mismatches == 0, "table executes legal choices and only those");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testTurnActions();
+    failed += testRiichi();
+    failed += testResponses();
+    failed += testKakan();
+    failed += testTableAnkan();
+    failed += testTableValidation();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All legal action tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include "table.h"
+#include "match.h"
+#include "simple_ai.h"
+#include "scoring.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// Test tsumo payment split
+int testTsumoPayments() {
+    std::cout << "\n=== Testing tsumo payments ===" << std::endl;
+
+    AgariResult dealer = calcScore(3, 30, true, true);
+    TEST_ASSERT(dealer.non_dealer_payment == 2000 && dealer.total_points == 6000, "dealer 3han30fu tsumo: 2000 all");
+
+    AgariResult child = calcScore(3, 30, false, true);
+    TEST_ASSERT(child.dealer_payment == 2000 && child.non_dealer_payment == 1000, "non-dealer 3han30fu tsumo: 1000/2000");
+
+    return 0;
+}
+
+// Test that every round conserves points (scores + riichi sticks on the table)
+int testPointConservation() {
+    std::cout << "\n=== Testing point conservation ===" << std::endl;
+
+    Table table;
+    table.setSeed(7);
+    SimpleAI players[4] = {SimpleAI("A"), SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    int bad_rounds = 0, rounds = 0;
+    GameCallbacks callbacks;
+    callbacks.onGameEnd = [&](const GameResult& result) {
+        int total = table.getRiichiSticks() * 1000;
+        for (int i = 0; i < 4; ++i) total += players[i].getScore();
+        if (total != 100000) bad_rounds++;
+        rounds++;
+    };
+    table.setCallbacks(callbacks);
+
+    Match match(&table);
+    for (int m = 0; m < 5; ++m) {
+        const MatchResult& result = match.play(m % 4);
+        int total = 0;
+        for (int score : result.scores) total += score;
+        TEST_ASSERT(total == 100000, "final scores sum to 100000");
+        TEST_ASSERT(table.getRiichiSticks() == 0, "leftover riichi sticks paid out");
+    }
+    TEST_ASSERT(bad_rounds == 0, "points conserved in every round");
+    std::cout << "  rounds: " << rounds << std::endl;
+
+    return 0;
+}
+
+// Test match length and ranking
+int testMatchFlow() {
+    std::cout << "\n=== Testing match flow ===" << std::endl;
+
+    Table table;
+    table.setSeed(11);
+    SimpleAI players[4] = {SimpleAI("A"), SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    MatchRules rules;
+    rules.length = MatchLength::Tonpuusen;
+    Match match(&table, rules);
+
+    for (int m = 0; m < 10; ++m) {
+        const MatchResult& result = match.play();
+        TEST_ASSERT(result.busted || result.rounds_played >= 4, "tonpuusen plays at least four rounds");
+
+        int rank_mask = 0;
+        for (int seat = 0; seat < 4; ++seat) rank_mask |= 1 << result.ranks[seat];
+        TEST_ASSERT(rank_mask == 0xF, "ranks are a permutation");
+        for (int seat = 0; seat < 4; ++seat) {
+            for (int other = 0; other < 4; ++other) {
+                if (result.ranks[seat] < result.ranks[other])
+                    TEST_ASSERT(result.scores[seat] >= result.scores[other], "higher rank has no fewer points");
+            }
+        }
+        TEST_ASSERT(table.getRoundWind() <= Wind::South, "tonpuusen ends by South extension");
+    }
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testTsumoPayments();
+    failed += testPointConservation();
+    failed += testMatchFlow();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All match tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
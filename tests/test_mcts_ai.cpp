@@ -0,0 +1,138 @@
+#include <iostream>
+#include <random>
+#include "table.h"
+#include "simple_ai.h"
+#include "mcts_ai.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// 记录每次 decideAction 返回值的 MCTS 玩家
+class CheckedMcts : public MctsAI {
+public:
+    std::vector<int> returned;
+    GameSnapshot first;
+    bool has_first = false;
+
+    CheckedMcts(const MctsConfig& cfg) : MctsAI("MCTS", cfg) {}
+
+    int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override {
+        if (!has_first) has_first = captureSnapshot(*table, first);
+        int action = MctsAI::decideAction(drawn_tile, can_tsumo, can_ankan, can_riichi);
+        returned.push_back(action);
+        return action;
+    }
+};
+
+static MctsConfig smallConfig(int threads) {
+    MctsConfig config;
+    config.num_threads = threads;
+    config.time_budget_ms = 0;
+    config.max_playouts = 48;
+    config.seed = 42;
+    return config;
+}
+
+// Test that determinization keeps visible information and a consistent tile set
+int testDeterminize() {
+    std::cout << "\n=== Testing determinization ===" << std::endl;
+
+    Table table;
+    table.setSeed(8);
+    CheckedMcts mcts(smallConfig(1));
+    SimpleAI others[3] = {SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    table.setPlayer(0, &mcts);
+    for (int i = 0; i < 3; ++i) table.setPlayer(i + 1, &others[i]);
+    table.setDealer(0);
+    table.playRound();
+    TEST_ASSERT(mcts.has_first, "captured a root position");
+
+    std::mt19937 rng(3);
+    TileIndex wall_buffer[136];
+    GameSnapshot root = mcts.first;
+    bool changed = false;
+    for (int trial = 0; trial < 50; ++trial) {
+        GameSnapshot sim = root;
+        MctsAI::determinize(sim, 0, wall_buffer, rng);
+
+        // 自己的手牌不变，他家张数不变
+        bool same_self = true, same_sizes = true;
+        for (int i = 0; i < 3; ++i) same_self = same_self && sim.seats[0].tiles[i] == root.seats[0].tiles[i];
+        for (int seat = 1; seat < 4; ++seat) {
+            int a = 0, b = 0;
+            for (int t = 0; t < 34; ++t) { a += sim.seats[seat].counts[t]; b += root.seats[seat].counts[t]; }
+            same_sizes = same_sizes && a == b;
+            changed = changed || sim.seats[seat].tiles[0] != root.seats[seat].tiles[0];
+        }
+        TEST_ASSERT(same_self && same_sizes, "own hand and opponent hand sizes preserved");
+
+        // 所有位置上的牌不重复
+        std::array<int, 136> seen;
+        seen.fill(0);
+        for (const SeatSnapshot& s : sim.seats) {
+            for (TileIndex t = 0; t < 136; ++t) if (s.hasTile(t)) seen[t]++;
+            for (int i = 0; i < s.river_len; ++i) seen[s.river[i]]++;
+        }
+        seen[sim.drawn]++;
+        for (int i = sim.wall_pointer; i < 136; ++i) seen[sim.wall[i]]++;
+        bool unique = true;
+        for (int c : seen) unique = unique && c == 1;
+        TEST_ASSERT(unique, "every tile appears exactly once");
+    }
+    TEST_ASSERT(changed, "opponent hands are resampled");
+    TEST_ASSERT(root.wall == table.getWall().data(), "root wall untouched");
+
+    return 0;
+}
+
+// Test that the search only returns legal actions and plays full rounds
+int testPlaysLegalMoves() {
+    std::cout << "\n=== Testing legal play ===" << std::endl;
+
+    Table table;
+    table.setSeed(21);
+    CheckedMcts mcts(smallConfig(2));
+    SimpleAI others[3] = {SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    table.setPlayer(0, &mcts);
+    for (int i = 0; i < 3; ++i) table.setPlayer(i + 1, &others[i]);
+
+    std::vector<int> executed;
+    GameCallbacks callbacks;
+    callbacks.onDecision = [&](int seat, DecisionKind kind, int options, int action) {
+        if (seat == 0 && kind == DecisionKind::Action) executed.push_back(action);
+    };
+    table.setCallbacks(callbacks);
+
+    for (int r = 0; r < 8; ++r) {
+        mcts.returned.clear();
+        executed.clear();
+        table.setDealer(r % 4);
+        table.playRound();
+        TEST_ASSERT(mcts.returned == executed, "every action was executed as chosen");
+    }
+    TEST_ASSERT(mcts.getLastStats().size() > 1, "search keeps per-move statistics");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testDeterminize();
+    failed += testPlaysLegalMoves();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All MCTS tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <cstdio>
+#include <vector>
+#include "table.h"
+#include "simple_ai.h"
+#include "replay_log.h"
+#include "replay_validator.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static const char* log_path = "test_replay.mjr";
+
+// 录制若干局到临时文件
+static size_t recordRounds(int rounds, uint32_t seed) {
+    ReplayWriter writer;
+    if (!writer.open(log_path)) return 0;
+
+    Table table;
+    table.setSeed(seed);
+    SimpleAI players[4] = {SimpleAI("A"), SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    ReplayRecorder recorder(&table, &writer);
+    for (int i = 0; i < rounds; ++i) {
+        table.setDealer(i % 4);
+        table.playRound();
+    }
+    return recorder.getRecordedCount();
+}
+
+// Test encode/decode round trip
+int testRoundTrip() {
+    std::cout << "\n=== Testing encode/decode ===" << std::endl;
+
+    ReplayRound round;
+    round.seed = 12345;
+    round.dealer = 2;
+    round.round_wind = Wind::South;
+    round.honba = 1;
+    round.riichi_sticks = 2;
+    round.scores = {25000, 24000, 26000, 23000};
+    for (int i = 0; i < 136; ++i) round.wall.push_back(135 - i);
+    round.decisions.push_back({2, 0, DecisionOption::Tsumo, static_cast<uint8_t>(Action::Win)});
+    round.result = {2, true, -1, {Yaku::Tsumo, Yaku::Pinfu}, 2, 20, 2100, {-800, -800, 4400, -800}};
+
+    std::vector<uint8_t> bytes;
+    encodeReplayRound(round, bytes);
+
+    ReplayRound decoded;
+    TEST_ASSERT(decodeReplayRound(bytes.data() + 4, bytes.size() - 4, decoded), "decode encoded round");
+    TEST_ASSERT(decoded.seed == 12345 && decoded.dealer == 2 && decoded.round_wind == Wind::South, "header fields");
+    TEST_ASSERT(decoded.honba == 1 && decoded.riichi_sticks == 2 && decoded.scores == round.scores, "table state preserved");
+    TEST_ASSERT(decoded.wall == round.wall, "wall preserved");
+    TEST_ASSERT(decoded.decisions.size() == 1 && decoded.decisions[0].action == 136, "decisions preserved");
+    TEST_ASSERT(decoded.result.yaku == round.result.yaku && decoded.result.score == 2100 &&
+                decoded.result.deltas == round.result.deltas, "result preserved");
+    TEST_ASSERT(!decodeReplayRound(bytes.data() + 4, bytes.size() - 5, decoded), "reject truncated record");
+
+    return 0;
+}
+
+// Test record then verify with the same engine
+int testRecordAndVerify() {
+    std::cout << "\n=== Testing record + verify ===" << std::endl;
+
+    size_t recorded = recordRounds(40, 2024);
+    TEST_ASSERT(recorded == 40, "recorded 40 rounds");
+
+    ReplayLog log;
+    TEST_ASSERT(log.open(log_path), "mmap replay log");
+    TEST_ASSERT(log.getRoundCount() == 40 && !log.isTruncated(), "index has 40 rounds");
+
+    ReplayReport report = validateReplay(log, 4);
+    TEST_ASSERT(report.passed == 40 && report.failed == 0, "all rounds reproduce");
+
+    return 0;
+}
+
+// Test that a tampered result is reported as divergence
+int testDetectDivergence() {
+    std::cout << "\n=== Testing divergence detection ===" << std::endl;
+
+    ReplayLog log;
+    TEST_ASSERT(log.open(log_path), "mmap replay log");
+    ReplayRound round;
+    TEST_ASSERT(log.readRound(0, round), "read first round");
+
+    Table table;
+    ReplayScript script;
+    ReplayPlayer players[4] = {ReplayPlayer(&script), ReplayPlayer(&script),
+                               ReplayPlayer(&script), ReplayPlayer(&script)};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    std::string reason;
+    TEST_ASSERT(replayRound(round, table, script, reason), "untouched round matches");
+
+    ReplayRound bad_score = round;
+    bad_score.result.score += 100;
+    TEST_ASSERT(!replayRound(bad_score, table, script, reason), "score change detected");
+
+    ReplayRound bad_options = round;
+    bad_options.decisions[0].options ^= DecisionOption::Tsumo;
+    TEST_ASSERT(!replayRound(bad_options, table, script, reason), "option mismatch detected");
+    std::cout << "  reason: " << reason << std::endl;
+
+    ReplayRound bad_wall = round;
+    std::swap(bad_wall.wall[52], bad_wall.wall[53]);
+    TEST_ASSERT(!replayRound(bad_wall, table, script, reason), "wall change detected");
+    std::cout << "  reason: " << reason << std::endl;
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testRoundTrip();
+    failed += testRecordAndVerify();
+    failed += testDetectDivergence();
+
+    std::remove(log_path);
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All replay tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
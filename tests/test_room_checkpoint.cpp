@@ -0,0 +1,367 @@
+#include <iostream>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "session.h"
+#include "room.h"
+#include "room_checkpoint.h"
+#include <sys/resource.h>
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static const char* checkpoint_path = "test_room_checkpoint.bin";
+
+// 一局中途写检查点的房间: 一个人类座位，收到第 checkpoint_at 条消息时写检查点
+struct CheckpointedRoom {
+    std::unique_ptr<Room> room;
+    std::unique_ptr<Session> session;
+    int messages = 0;
+    std::vector<int> checkpoint_at;
+    std::vector<size_t> written;  // 每次写检查点编码的字节数
+    CheckpointWriter* writer = nullptr;
+    GameResult result{};
+    std::array<int, 4> scores{};
+
+    CheckpointedRoom(const std::string& id, std::vector<int> at, CheckpointWriter* w)
+        : checkpoint_at(at), writer(w) {
+        room = std::make_unique<Room>(id);
+        session = std::make_unique<Session>(1);
+        session->setName("alice");
+        session->setSendCallback([this](const std::string&) {
+            ++messages;
+            for (int at : checkpoint_at) {
+                if (messages == at) written.push_back(writer->write(*room));
+            }
+        });
+        room->addPlayer(session.get());
+        room->startGame();
+    }
+
+    void play() {
+        result = room->playRound();
+        for (int i = 0; i < 4; ++i) scores[i] = room->getCurrentState().scores[i];
+    }
+};
+
+static bool sameResult(const GameResult& a, const GameResult& b) {
+    return a.winner == b.winner && a.from_player == b.from_player && a.is_tsumo == b.is_tsumo &&
+           a.yaku == b.yaku && a.han == b.han && a.fu == b.fu && a.score == b.score && a.deltas == b.deltas;
+}
+
+// 打一局并在第 at 条消息时写检查点，直到检查点落在局中且至少有 min_decisions 个决策 (牌山随机)
+static std::unique_ptr<CheckpointedRoom> playCheckpointed(const std::string& id, int at, size_t min_decisions,
+                                                          std::vector<RoomCheckpoint>& checkpoints) {
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        CheckpointWriter writer;
+        if (!writer.open(checkpoint_path)) break;
+        auto original = std::make_unique<CheckpointedRoom>(id, std::vector<int>{at}, &writer);
+        original->play();
+        writer.close();
+        if (readCheckpoint(checkpoint_path, checkpoints) && checkpoints.size() == 1 && checkpoints[0].in_round &&
+            checkpoints[0].round.decisions.size() >= min_decisions) {
+            return original;
+        }
+    }
+    return nullptr;
+}
+
+// Test encoding and incremental writes
+int testWriter() {
+    std::cout << "\n=== Testing writer ===" << std::endl;
+
+    CheckpointWriter writer;
+    TEST_ASSERT(writer.open(checkpoint_path), "open checkpoint file");
+
+    Room waiting("WAIT");
+    Session a(1), b(2);
+    a.setName("alice");
+    b.setName("bob");
+    waiting.addPlayer(&a);
+    size_t first = writer.write(waiting);
+    TEST_ASSERT(first > 0 && writer.write(waiting) == 0, "unchanged room writes nothing");
+    waiting.addPlayer(&b);
+    TEST_ASSERT(writer.write(waiting) > 0, "seat change writes a new base");
+
+    // 一局打到一半写检查点: 开局后第一次写基准 (带牌山)，之后只追加新的决策
+    CheckpointedRoom playing("ROOM7", {3, 4, 5, 6, 7, 8, 9, 10, 11, 12}, &writer);
+    playing.play();
+    TEST_ASSERT(playing.written.size() == 10 && playing.written[0] > 136, "mid-round base carries the wall");
+    size_t updates = 0, empty = 0;
+    for (size_t i = 1; i < playing.written.size(); ++i) {
+        if (playing.written[i] == 0) empty++;
+        updates += playing.written[i];
+    }
+    std::cout << "  base " << playing.written[0] << " bytes, 9 updates " << updates << " bytes" << std::endl;
+    TEST_ASSERT(empty > 0 && updates < playing.written[0], "updates only append new decisions");
+    const RoomCheckpoint& after = playing.room->getCheckpoint();
+    TEST_ASSERT(!after.in_round && after.state == RoomState::Finished, "round finished");
+    size_t finished = writer.write(*playing.room);
+    TEST_ASSERT(finished > 0 && finished < playing.written[0], "finished room base has no wall");
+
+    waiting.removePlayer(&a);
+    waiting.removePlayer(&b);
+    writer.removeRoom("WAIT");
+    writer.close();
+
+    std::vector<RoomCheckpoint> rooms;
+    bool truncated = true;
+    TEST_ASSERT(readCheckpoint(checkpoint_path, rooms, &truncated) && !truncated, "read back");
+    TEST_ASSERT(rooms.size() == 1 && rooms[0].room_id == "ROOM7" && rooms[0].state == RoomState::Finished &&
+                rooms[0].names[0] == "alice" && rooms[0].seats[0] == SeatKind::Human &&
+                rooms[0].tokens[0] == playing.room->getSeatToken(0) && !rooms[0].tokens[0].empty() &&
+                rooms[0].seats[1] == SeatKind::AI && rooms[0].round.scores == playing.scores,
+                "latest base wins, removed room dropped");
+    TEST_ASSERT(rooms[0].sync_seq == playing.room->getSyncSeq(), "sync sequence saved");
+
+    // 尾部写了一半的记录被忽略；损坏的文件头拒绝
+    std::FILE* file = std::fopen(checkpoint_path, "ab");
+    std::fputc(0x7F, file);
+    std::fputc(0x00, file);
+    std::fclose(file);
+    TEST_ASSERT(readCheckpoint(checkpoint_path, rooms, &truncated) && truncated && rooms.size() == 1,
+                "truncated tail ignored");
+    file = std::fopen(checkpoint_path, "r+b");
+    std::fputc('X', file);
+    std::fclose(file);
+    TEST_ASSERT(!readCheckpoint(checkpoint_path, rooms) && rooms.empty(), "bad header rejected");
+    TEST_ASSERT(!readCheckpoint("missing_checkpoint.bin", rooms), "missing file rejected");
+
+    return 0;
+}
+
+// Test restoring a room checkpointed mid-round finishes the round exactly like the original
+int testResume() {
+    std::cout << "\n=== Testing resume ===" << std::endl;
+
+    const int count = 200;
+    CheckpointWriter writer;
+    TEST_ASSERT(writer.open(checkpoint_path), "open checkpoint file");
+    std::vector<std::unique_ptr<CheckpointedRoom>> originals;
+    size_t base_bytes = 0, update_bytes = 0;
+    int updates = 0;
+    for (int i = 0; i < count; ++i) {
+        // 开局后写一次基准，局中再写一次 (只追加决策)
+        originals.push_back(std::make_unique<CheckpointedRoom>("ROOM" + std::to_string(i),
+                                                               std::vector<int>{3, 10 + i % 60}, &writer));
+        originals.back()->play();
+        const std::vector<size_t>& written = originals.back()->written;
+        base_bytes += written[0];
+        if (written.size() == 2 && written[1] > 0) {
+            update_bytes += written[1];
+            updates++;
+        }
+    }
+    writer.close();
+    std::cout << "  bases: " << base_bytes << " bytes, " << updates << " updates: " << update_bytes << " bytes"
+              << std::endl;
+
+    std::vector<RoomCheckpoint> checkpoints;
+    TEST_ASSERT(readCheckpoint(checkpoint_path, checkpoints) && checkpoints.size() == count, "read all rooms");
+    size_t in_round = 0;
+    for (const RoomCheckpoint& checkpoint : checkpoints) {
+        if (checkpoint.in_round) in_round++;
+    }
+    TEST_ASSERT(in_round > count / 2, "most rooms checkpointed mid-round");
+    TEST_ASSERT(updates > 0 && update_bytes * count < base_bytes * updates, "updates smaller than bases");
+
+    RestoreReport report;
+    std::vector<std::unique_ptr<Room>> restored = restoreRooms(checkpoints, 4, &report);
+    std::cout << "  restored " << report.rooms << " rooms (" << report.in_round << " mid-round, " << report.decisions
+              << " decisions) in " << report.seconds * 1000 << " ms" << std::endl;
+    TEST_ASSERT(restored.size() == count && report.rooms == count && report.failed == 0 && report.dropped == 0,
+                "every room restored");
+
+    int mismatches = 0, resumed = 0;
+    for (int i = 0; i < count; ++i) {
+        Room& room = *restored[i];
+        const CheckpointedRoom& original = *originals[i];
+        if (room.getId() != original.room->getId()) mismatches++;
+        if (!checkpoints[i].in_round) continue;
+        GameResult result = room.playRound();
+        GameState state = room.getCurrentState();
+        if (!sameResult(result, original.result) || state.scores != original.scores) mismatches++;
+        resumed++;
+    }
+    TEST_ASSERT(resumed == static_cast<int>(in_round) && mismatches == 0, "resumed rounds end like the originals");
+
+    return 0;
+}
+
+// Test a player rejoining a restored room gets nothing until the replay reaches the checkpoint
+int testRejoin() {
+    std::cout << "\n=== Testing rejoin ===" << std::endl;
+
+    std::vector<RoomCheckpoint> checkpoints;
+    std::unique_ptr<CheckpointedRoom> original = playCheckpointed("ROOM1", 30, 1, checkpoints);
+    TEST_ASSERT(original, "mid-round checkpoint");
+    int original_seq = original->room->getSyncSeq();
+    size_t decisions = checkpoints[0].round.decisions.size();
+
+    Room room("ROOM1");
+    TEST_ASSERT(room.restore(checkpoints[0]) && room.getState() == RoomState::Playing && room.isReplaying(),
+                "restored and waiting to replay");
+    TEST_ASSERT(!room.restore(checkpoints[0]), "restore only into a fresh room");
+
+    const std::string& token = checkpoints[0].tokens[0];
+    TEST_ASSERT(token.size() == 32 && token == original->room->getSeatToken(0) && checkpoints[0].tokens[1].empty(),
+                "human seat has a saved token");
+    TEST_ASSERT(room.getSeatToken(0) == token, "token restored");
+
+    Session stranger(5), alice(6);
+    stranger.setName("alice");
+    alice.setName("alice");
+    std::string guess = token;
+    guess[0] = guess[0] == '0' ? '1' : '0';
+    TEST_ASSERT(!room.addPlayer(&stranger) && !room.rejoin(&stranger, "") && !room.rejoin(&stranger, guess),
+                "same name without the token cannot take the seat");
+
+    std::vector<GameMessage> received;
+    size_t replayed_decisions = 0;
+    bool early = false;
+    alice.setSendCallback([&](const std::string& data) {
+        GameMessage msg;
+        decodeMessage(data, WireFormat::Json, msg);
+        // 重放完之前不应收到任何消息
+        if (room.isReplaying()) early = true;
+        if (received.empty()) replayed_decisions = room.getCheckpoint().round.decisions.size();
+        received.push_back(msg);
+    });
+    TEST_ASSERT(room.rejoin(&alice, token) && alice.getSeat() == 0 && room.getPlayerCount() == 1, "owner rejoins");
+    room.handleSyncRequest(&alice, 12);
+    TEST_ASSERT(received.empty(), "sync request waits for the replay");
+
+    GameResult result = room.playRound();
+    TEST_ASSERT(!early && replayed_decisions >= decisions, "nothing sent during the replay");
+    TEST_ASSERT(!received.empty() && received[0].type == MessageType::GameState && received[0].seq > original_seq,
+                "first message is a snapshot with a newer sequence");
+    TEST_ASSERT(sameResult(result, original->result), "round ends like the original");
+
+    // 对局中断线保留座位，可以再回来
+    room.removePlayer(&alice);
+    TEST_ASSERT(room.getPlayerCount() == 0 && !room.rejoin(&stranger, "") &&
+                room.rejoin(&alice, token), "disconnect keeps the seat");
+    room.removePlayer(&alice);
+
+    return 0;
+}
+
+// Test decisions that disagree with the engine are dropped
+int testCorrupt() {
+    std::cout << "\n=== Testing corrupt decisions ===" << std::endl;
+
+    std::vector<RoomCheckpoint> checkpoints;
+    TEST_ASSERT(playCheckpointed("ROOM2", 50, 10, checkpoints), "mid-round checkpoint");
+    size_t decisions = checkpoints[0].round.decisions.size();
+    TEST_ASSERT(checkDecisions(checkpoints[0]) == decisions, "recorded decisions agree with the engine");
+
+    checkpoints[0].round.decisions[5].options ^= 0x7F;
+    TEST_ASSERT(checkDecisions(checkpoints[0]) == 5, "stops at the first disagreement");
+    RestoreReport report;
+    std::vector<std::unique_ptr<Room>> restored = restoreRooms(checkpoints, 0, &report);
+    TEST_ASSERT(restored[0] && report.dropped == decisions - 5 && report.decisions == 5, "later decisions dropped");
+    TEST_ASSERT(restored[0]->getCheckpoint().round.decisions.size() == 5, "restored prefix");
+
+    checkpoints[0].round.wall.resize(100);
+    restored = restoreRooms(checkpoints, 1, &report);
+    TEST_ASSERT(!restored[0] && report.failed == 1, "bad wall rejected");
+
+    std::remove(checkpoint_path);
+    return 0;
+}
+
+// Test a recorded ankan the table cannot execute does not break the restored room
+int testAnkanDecision() {
+    std::cout << "\n=== Testing ankan decision ===" << std::endl;
+
+    std::vector<RoomCheckpoint> checkpoints;
+    TEST_ASSERT(playCheckpointed("ROOM3", 50, 1, checkpoints), "mid-round checkpoint");
+    // 顺序牌山: 庄家手里四张 1m，第一个决策是暗杠
+    ReplayRound& round = checkpoints[0].round;
+    for (int i = 0; i < 136; ++i) round.wall[i] = static_cast<TileIndex>(i);
+    round.dealer = 0;
+    round.decisions = {{0, static_cast<uint8_t>(DecisionKind::Action), DecisionOption::Ankan,
+                        static_cast<uint8_t>(Action::Ankan)}};
+    TEST_ASSERT(checkDecisions(checkpoints[0]) == 0, "ankan decision disagrees with the engine");
+
+    RestoreReport report;
+    std::vector<std::unique_ptr<Room>> restored = restoreRooms(checkpoints, 1, &report);
+    TEST_ASSERT(restored[0] && report.dropped == 1, "ankan decision dropped");
+    restored[0]->playRound();
+    TEST_ASSERT(!restored[0]->getCheckpoint().in_round, "restored round plays to the end");
+
+    std::remove(checkpoint_path);
+    return 0;
+}
+
+// Test a failed write is reported, leaves only complete records and is retried
+int testWriteFailure() {
+    std::cout << "\n=== Testing write failure ===" << std::endl;
+
+    Room first("ROOM8"), second("ROOM9");
+    Session a(1), b(2);
+    first.addPlayer(&a);
+    second.addPlayer(&b);
+
+    CheckpointWriter writer;
+    TEST_ASSERT(writer.open(checkpoint_path), "open checkpoint file");
+    writer.write(first);
+    TEST_ASSERT(writer.flush(), "first room written");
+
+    // 文件大小上限只比已写入的多几个字节: 第二个房间的基准只能写进一半
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit saved;
+    getrlimit(RLIMIT_FSIZE, &saved);
+    rlimit limited = saved;
+    std::FILE* file = std::fopen(checkpoint_path, "rb");
+    std::fseek(file, 0, SEEK_END);
+    limited.rlim_cur = static_cast<rlim_t>(std::ftell(file)) + 8;
+    std::fclose(file);
+    setrlimit(RLIMIT_FSIZE, &limited);
+
+    writer.write(second);
+    bool failed = !writer.flush();
+    std::vector<RoomCheckpoint> rooms;
+    bool truncated = true;
+    bool rolled_back = readCheckpoint(checkpoint_path, rooms, &truncated) && !truncated && rooms.size() == 1;
+    setrlimit(RLIMIT_FSIZE, &saved);
+    TEST_ASSERT(failed, "failed write reported");
+    TEST_ASSERT(rolled_back, "file rolled back to the last complete record");
+
+    TEST_ASSERT(writer.flush() && writer.close(), "retry succeeds");
+    TEST_ASSERT(readCheckpoint(checkpoint_path, rooms, &truncated) && !truncated && rooms.size() == 2 &&
+                rooms[1].room_id == "ROOM9", "retried record read back");
+
+    first.removePlayer(&a);
+    second.removePlayer(&b);
+    std::remove(checkpoint_path);
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testWriter();
+    failed += testResume();
+    failed += testRejoin();
+    failed += testCorrupt();
+    failed += testAnkanDecision();
+    failed += testWriteFailure();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All room checkpoint tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include "types.h"
+#include "constants.h"
+#include "shanten.h"
+#include "table.h"
+#include "simple_ai.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static TileCounts countsOf(std::initializer_list<Tile> tiles) {
+    TileCounts counts;
+    counts.fill(0);
+    for (Tile t : tiles) counts[t]++;
+    return counts;
+}
+
+// Test known shapes
+int testKnownShapes() {
+    std::cout << "\n=== Testing known shapes ===" << std::endl;
+
+    TileCounts kanchan = countsOf({_1m, _2m, _3m, _4m, _5m, _6m, _7m, _8m, _9m, _1p, _1p, _3p, _5p});
+    TEST_ASSERT(calcShanten(kanchan, 0, true) == 0, "pair + kanchan is tenpai");
+
+    TileCounts agari = countsOf({_1m, _2m, _3m, _4m, _5m, _6m, _7m, _8m, _9m, _1p, _1p, _3p, _4p, _5p});
+    TEST_ASSERT(calcShanten(agari, 0, true) == -1, "complete hand is -1");
+
+    TileCounts kokushi = countsOf({_1m, _9m, _1p, _9p, _1s, _9s, EastWind, SouthWind, WestWind, NorthWind, Haku, Hatsu, Hatsu});
+    TEST_ASSERT(calcShanten(kokushi, 0, true) == 0, "kokushi tenpai");
+    TEST_ASSERT(calcShanten(kokushi, 0, false) > 0, "kokushi needs menzen");
+
+    TileCounts chiitoi = countsOf({_1m, _1m, _4m, _4m, _7p, _7p, _2s, _2s, _9s, _9s, Haku, Haku, Chun});
+    TEST_ASSERT(calcShanten(chiitoi, 0, true) == 0, "chiitoitsu tenpai");
+
+    // 副露 3 组后只剩 4 张
+    TileCounts open = countsOf({_2m, _3m, _5p, _5p});
+    TEST_ASSERT(calcShanten(open, 3, false) == 0, "open hand tenpai");
+
+    int count = 0;
+    TileCounts visible = kanchan;
+    TileMask ukeire = calcUkeire(kanchan, 0, true, visible, count);
+    TEST_ASSERT(ukeire == (1ULL << _4p) && count == 4, "kanchan waits on four 4p");
+
+    return 0;
+}
+
+// Test shanten against wait masks and one-step consistency on random hands
+int testRandomConsistency() {
+    std::cout << "\n=== Testing random hands ===" << std::endl;
+
+    std::mt19937 rng(1234);
+    TileIndexList wall;
+    for (int i = 0; i < 136; ++i) wall.push_back(i);
+
+    int tenpai_mismatch = 0, step_mismatch = 0;
+    for (int i = 0; i < 300; ++i) {
+        std::shuffle(wall.begin(), wall.end(), rng);
+        TileCounts counts;
+        counts.fill(0);
+        // 一半手牌偏向同一门，制造低向听
+        for (int j = 0; j < 13; ++j) counts[wall[j] / 4]++;
+        if (i % 2) {
+            counts.fill(0);
+            int n = 0;
+            for (int j = 0; n < 13; ++j) {
+                Tile t = wall[j] / 4;
+                if (t < 18) { counts[t]++; n++; }
+            }
+        }
+
+        int s = calcShanten(counts, 0, true);
+        if ((s == 0) != (calcWaitMask(counts, true) != 0)) tenpai_mismatch++;
+
+        // 摸一张打一张最多前进一步，且有效牌存在时确实能前进
+        int best = 99;
+        for (int draw = 0; draw < 34; ++draw) {
+            if (counts[draw] >= 4) continue;
+            counts[draw]++;
+            for (int d = 0; d < 34; ++d) {
+                if (counts[d] == 0) continue;
+                counts[d]--;
+                best = std::min(best, calcShanten(counts, 0, true));
+                counts[d]++;
+            }
+            counts[draw]--;
+        }
+        if (s > 0 && best != s - 1) step_mismatch++;
+    }
+    TEST_ASSERT(tenpai_mismatch == 0, "shanten 0 exactly when wait mask is non-empty");
+    TEST_ASSERT(step_mismatch == 0, "one exchange improves shanten by exactly one");
+
+    return 0;
+}
+
+// Test SimpleAI returns real tiles and stays cheap
+int testSimpleAIDiscards() {
+    std::cout << "\n=== Testing SimpleAI discards ===" << std::endl;
+
+    Table table;
+    table.setSeed(17);
+    long decisions = 0, fallbacks = 0, wins = 0;
+    std::vector<int> chosen;
+    GameCallbacks callbacks;
+    callbacks.onDecision = [&](int seat, DecisionKind kind, int options, int action) {
+        if (kind != DecisionKind::Action || action >= 136) return;
+        decisions++;
+        // Table 把不合法的弃牌改成摸切；SimpleAI 不应该触发
+        if (action != chosen[seat]) fallbacks++;
+    };
+    table.setCallbacks(callbacks);
+
+    // 在决策前记录 SimpleAI 的选择
+    class Probe : public SimpleAI {
+    public:
+        int* out;
+        Probe(int* o) : SimpleAI("P"), out(o) {}
+        int decideAction(TileIndex d, bool t, bool a, bool r) override {
+            return *out = SimpleAI::decideAction(d, t, a, r);
+        }
+    };
+    chosen.assign(4, -1);
+    Probe probes[4] = {Probe(&chosen[0]), Probe(&chosen[1]), Probe(&chosen[2]), Probe(&chosen[3])};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &probes[i]);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < 100; ++r) {
+        table.setDealer(r % 4);
+        if (table.playRound().winner >= 0) wins++;
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  decisions: " << decisions << ", wins: " << wins << "/100"
+              << ", " << elapsed.count() / decisions << " us per turn" << std::endl;
+    TEST_ASSERT(fallbacks == 0, "every discard is a tile actually held");
+    TEST_ASSERT(wins >= 20, "shanten-driven discards win rounds");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testKnownShapes();
+    failed += testRandomConsistency();
+    failed += testSimpleAIDiscards();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All shanten tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,173 @@
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include "table.h"
+#include "simple_ai.h"
+#include "snapshot.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+struct RecordedDecision {
+    int seat;
+    DecisionKind kind;
+    int options;
+    int action;
+};
+
+// 在本局第 capture_at 次摸牌决策时截取快照的 SimpleAI
+class SnapshotProbe : public SimpleAI {
+public:
+    int* turn_counter = nullptr;
+    int capture_at = 0;
+    bool captured = false;
+    GameSnapshot snapshot;
+
+    SnapshotProbe(const std::string& name) : SimpleAI(name) {}
+
+    int decideAction(TileIndex drawn_tile, bool can_tsumo, bool can_ankan, bool can_riichi) override {
+        if ((*turn_counter)++ == capture_at) {
+            captured = captureSnapshot(*table, snapshot);
+        }
+        return SimpleAI::decideAction(drawn_tile, can_tsumo, can_ankan, can_riichi);
+    }
+};
+
+// Test that stepping a captured snapshot with the recorded decisions reproduces the round
+int testFollowTable() {
+    std::cout << "\n=== Testing snapshot follows Table ===" << std::endl;
+
+    Table table;
+    table.setSeed(314);
+    SnapshotProbe players[4] = {SnapshotProbe("A"), SnapshotProbe("B"), SnapshotProbe("C"), SnapshotProbe("D")};
+    int turn_counter = 0;
+    for (int i = 0; i < 4; ++i) {
+        players[i].turn_counter = &turn_counter;
+        table.setPlayer(i, &players[i]);
+    }
+
+    std::vector<RecordedDecision> decisions;
+    GameCallbacks callbacks;
+    callbacks.onDecision = [&](int seat, DecisionKind kind, int options, int action) {
+        decisions.push_back({seat, kind, options, action});
+    };
+    table.setCallbacks(callbacks);
+
+    int rounds = 0, mismatches = 0, wins = 0, riichi_rounds = 0;
+    for (int r = 0; r < 200; ++r) {
+        int capture_at = r % 40;
+        for (SnapshotProbe& p : players) {
+            p.capture_at = capture_at;
+            p.captured = false;
+        }
+        turn_counter = 0;
+        decisions.clear();
+        table.setDealer(r % 4);
+        table.setHonba(r % 3);
+        table.setRiichiSticks(r % 2);
+        GameResult expected = table.playRound();
+
+        const GameSnapshot* captured = nullptr;
+        size_t first = 0;
+        for (SnapshotProbe& p : players) {
+            if (p.captured) captured = &p.snapshot;
+        }
+        if (!captured) continue;  // 本局在截取前已经结束
+        // 截取时的决策是这一局的第 capture_at 个 Action
+        int actions = 0;
+        for (first = 0; first < decisions.size(); ++first) {
+            if (decisions[first].kind == DecisionKind::Action && actions++ == capture_at) break;
+        }
+
+        GameSnapshot snapshot = *captured;
+        bool ok = true;
+        for (size_t i = first; i < decisions.size() && ok; ++i) {
+            const RecordedDecision& d = decisions[i];
+            ok = !snapshot.isFinished() && snapshot.getDecisionSeat() == d.seat &&
+                 snapshot.getDecisionKind() == d.kind && snapshot.getOptions() == d.options;
+            // 纯函数版本与原地版本结果一致
+            GameSnapshot stepped = stepSnapshot(snapshot, d.action);
+            ok = ok && snapshot.apply(d.action) == d.action &&
+                 std::memcmp(&stepped, &snapshot, sizeof(snapshot)) == 0;
+            if (d.kind == DecisionKind::RiichiDiscard) riichi_rounds++;
+        }
+        GameResult actual = snapshot.getResult();
+        ok = ok && snapshot.isFinished() && actual.winner == expected.winner &&
+             actual.from_player == expected.from_player && actual.is_tsumo == expected.is_tsumo &&
+             actual.yaku == expected.yaku && actual.han == expected.han && actual.fu == expected.fu &&
+             actual.score == expected.score && actual.deltas == expected.deltas &&
+             snapshot.riichi_sticks == table.getRiichiSticks();
+        for (int seat = 0; seat < 4; ++seat) {
+            ok = ok && snapshot.seats[seat].score == players[seat].getScore();
+        }
+        if (!ok) mismatches++;
+        if (expected.winner >= 0) wins++;
+        rounds++;
+    }
+    std::cout << "  rounds: " << rounds << ", wins: " << wins << ", riichi declarations: " << riichi_rounds << std::endl;
+    TEST_ASSERT(rounds > 100, "captured most rounds");
+    TEST_ASSERT(mismatches == 0, "snapshot reproduces every captured round");
+
+    return 0;
+}
+
+// Test copy-on-write wall sharing
+int testWallSharing() {
+    std::cout << "\n=== Testing shared wall ===" << std::endl;
+
+    Table table;
+    table.setSeed(5);
+    SnapshotProbe players[4] = {SnapshotProbe("A"), SnapshotProbe("B"), SnapshotProbe("C"), SnapshotProbe("D")};
+    int turn_counter = 0;
+    for (int i = 0; i < 4; ++i) {
+        players[i].turn_counter = &turn_counter;
+        players[i].capture_at = 0;
+        table.setPlayer(i, &players[i]);
+    }
+    table.setDealer(0);
+    table.playRound();
+    TEST_ASSERT(players[0].captured, "captured at dealer's first draw");
+
+    GameSnapshot base = players[0].snapshot;
+    TEST_ASSERT(base.wall == table.getWall().data(), "snapshot shares the table's wall");
+
+    GameSnapshot copy = base;
+    TEST_ASSERT(copy.wall == base.wall, "clone shares the wall");
+
+    WallStore store;
+    TileIndex* wall = store.fork(copy);
+    std::swap(wall[copy.wall_pointer], wall[copy.wall_pointer + 1]);
+    TEST_ASSERT(copy.wall != base.wall && base.wall[base.wall_pointer] == table.getWall()[base.wall_pointer],
+                "forked wall leaves the original untouched");
+
+    // 两个快照摸同一巡的下一张牌会不同
+    GameSnapshot a = stepSnapshot(base, base.drawn);
+    GameSnapshot b = stepSnapshot(copy, copy.drawn);
+    while (a.phase == SnapshotPhase::Response) a.apply(static_cast<int>(Action::Pass));
+    while (b.phase == SnapshotPhase::Response) b.apply(static_cast<int>(Action::Pass));
+    TEST_ASSERT(a.isFinished() || a.drawn != b.drawn, "next draw comes from the forked wall");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testFollowTable();
+    failed += testWallSharing();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All snapshot tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "game_state.h"
+#include "wire_protocol.h"
+#include "session.h"
+#include "room.h"
+#include "server.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// 模拟客户端: 收到快照就替换，收到增量就按序号应用
+struct SyncClient {
+    Session session;
+    Room* room = nullptr;
+    int seat = -1;
+    GameState state;
+    int seq = -1;
+    int snapshots = 0;
+    int deltas = 0;
+    int gaps = 0;
+    int errors = 0;
+    int mismatches = 0;
+    size_t bytes = 0;
+
+    SyncClient(int id, WireFormat format) : session(id) {
+        session.setWireFormat(format);
+        session.setSendCallback([this](const std::string& data) { receive(data); });
+    }
+
+    void receive(const std::string& data) {
+        GameMessage msg;
+        if (!decodeMessage(data, session.getWireFormat(), msg)) {
+            errors++;
+            return;
+        }
+        if (msg.type == MessageType::GameState) {
+            bytes += data.size();
+            state = msg.state;
+            seq = msg.seq;
+            snapshots++;
+        } else if (msg.type == MessageType::StateDelta) {
+            bytes += data.size();
+            deltas++;
+            if (msg.seq != seq + 1) {
+                gaps++;
+                return;
+            }
+            for (const StateEvent& event : msg.events) {
+                if (!applyStateEvent(state, event)) errors++;
+            }
+            seq += static_cast<int>(msg.events.size());
+        } else {
+            return;
+        }
+        if (seq != room->getSyncSeq()) mismatches++;
+        if (!matchesTable()) mismatches++;
+    }
+
+    // 和从牌桌重新收集的状态比较 (摸打中的当前玩家和最后一张牌不在牌桌状态里)
+    bool matchesTable() const {
+        GameState expected = room->getCurrentState().getViewFor(seat);
+        return state.hands == expected.hands && state.discards == expected.discards &&
+               state.scores == expected.scores && state.riichi_status == expected.riichi_status &&
+               state.riichi_sticks == expected.riichi_sticks && state.honba == expected.honba &&
+               state.remaining_tiles == expected.remaining_tiles && state.dealer == expected.dealer;
+    }
+};
+
+// Test delta clients track the table through whole rounds
+int testRounds() {
+    std::cout << "\n=== Testing rounds ===" << std::endl;
+
+    int errors = 0, gaps = 0, mismatches = 0, final_mismatches = 0, full_deltas = 0;
+    size_t delta_bytes = 0, full_bytes = 0, json_bytes = 0;
+    int delta_messages = 0, full_messages = 0;
+    for (int game = 0; game < 20; ++game) {
+        Room room("SYNC" + std::to_string(game));
+        SyncClient delta(1, WireFormat::Binary), full(2, WireFormat::Binary), json(3, WireFormat::Json);
+        SyncClient* clients[] = {&delta, &full, &json};
+        for (SyncClient* client : clients) {
+            room.addPlayer(&client->session);
+            client->room = &room;
+            client->seat = client->session.getSeat();
+        }
+        room.handleSyncRequest(&delta.session, -1);
+        room.handleSyncRequest(&json.session, -1);
+
+        room.startGame();
+        room.playRound();
+
+        for (SyncClient* client : clients) {
+            errors += client->errors;
+            gaps += client->gaps;
+            mismatches += client->mismatches;
+        }
+        full_deltas += full.deltas;
+        delta_bytes += delta.bytes;
+        full_bytes += full.bytes;
+        json_bytes += json.bytes;
+        delta_messages += delta.snapshots + delta.deltas;
+        full_messages += full.snapshots;
+
+        // 增量累积出的状态和快照完全一致
+        GameState rebuilt = delta.state;
+        room.broadcastState(delta.seat);
+        if (rebuilt.toJSON() != delta.state.toJSON() || delta.seq != room.getSyncSeq()) final_mismatches++;
+    }
+
+    TEST_ASSERT(errors == 0, "every message decodes and every event applies");
+    TEST_ASSERT(gaps == 0, "sequence numbers are contiguous");
+    TEST_ASSERT(mismatches == 0, "clients match the table after every update");
+    TEST_ASSERT(final_mismatches == 0, "accumulated deltas equal a fresh snapshot");
+    TEST_ASSERT(full_deltas == 0, "full mode only receives snapshots");
+
+    std::cout << "  delta: " << delta_messages << " messages, " << delta_bytes << " bytes; full: "
+              << full_messages << " messages, " << full_bytes << " bytes ("
+              << static_cast<double>(full_bytes) / delta_bytes << "x); delta as JSON: " << json_bytes
+              << " bytes" << std::endl;
+    TEST_ASSERT(delta_bytes * 5 < full_bytes, "deltas at least 5x smaller than snapshots");
+
+    return 0;
+}
+
+// Test resync requests and gaps
+int testResync() {
+    std::cout << "\n=== Testing resync ===" << std::endl;
+
+    Room room("RESYNC");
+    SyncClient client(1, WireFormat::Binary);
+    room.addPlayer(&client.session);
+    client.room = &room;
+    client.seat = client.session.getSeat();
+    room.handleSyncRequest(&client.session, -1);
+    TEST_ASSERT(client.snapshots == 0 && client.deltas == 0, "nothing sent before the game");
+
+    room.startGame();
+    room.playRound();
+    TEST_ASSERT(client.snapshots == 1 && client.deltas > 0, "one snapshot at round start, then deltas");
+
+    // 客户端报告较早的序号: 只补发缺少的事件
+    int current = room.getSyncSeq();
+    GameState expected = client.state;
+    client.seq -= 3;
+    room.handleSyncRequest(&client.session, client.seq);
+    TEST_ASSERT(client.seq == current && client.gaps == 0, "missing events resent as a delta");
+
+    // 太早或不合法的序号: 重发快照
+    int snapshots = client.snapshots;
+    room.handleSyncRequest(&client.session, 1 << 20);
+    TEST_ASSERT(client.snapshots == snapshots + 1 && client.seq == current, "unknown sequence gets a snapshot");
+    room.handleSyncRequest(&client.session, -1);
+    TEST_ASSERT(client.snapshots == snapshots + 2 && client.state.toJSON() == expected.toJSON(),
+                "explicit request gets a snapshot");
+
+    // 已经是最新的: 不发送
+    int deltas = client.deltas;
+    room.handleSyncRequest(&client.session, current);
+    TEST_ASSERT(client.deltas == deltas && client.snapshots == snapshots + 2, "up to date client gets nothing");
+
+    return 0;
+}
+
+// Test event application and per-seat hiding
+int testEvents() {
+    std::cout << "\n=== Testing events ===" << std::endl;
+
+    GameState state;
+    state.hands[0] = {4, 40};
+    state.hands[1].assign(2, -1);
+    state.remaining_tiles = 10;
+
+    TEST_ASSERT(applyStateEvent(state, {StateEventKind::Draw, 0, 20, 0}) &&
+                state.hands[0] == HandTiles({4, 20, 40}) && state.remaining_tiles == 9 &&
+                state.current_player == 0 && state.last_draw == 20, "draw inserts in order");
+    TEST_ASSERT(applyStateEvent(state, {StateEventKind::Discard, 0, 4, 0}) &&
+                state.hands[0] == HandTiles({20, 40}) && state.discards[0] == RiverTiles({4}) &&
+                state.last_discard == 4 && state.last_discard_player == 0, "discard moves the tile to the river");
+    TEST_ASSERT(!applyStateEvent(state, {StateEventKind::Discard, 0, 99, 0}), "discarding a missing tile fails");
+
+    StateEvent hidden = viewEventFor({StateEventKind::Draw, 1, 77, 0}, 0);
+    TEST_ASSERT(hidden.tile == -1 && viewEventFor({StateEventKind::Draw, 1, 77, 0}, 1).tile == 77,
+                "other seats' draws are hidden");
+    TEST_ASSERT(applyStateEvent(state, hidden) && state.hands[1].size() == 3 &&
+                applyStateEvent(state, {StateEventKind::Discard, 1, 77, 0}) && state.hands[1].size() == 2 &&
+                state.discards[1] == RiverTiles({77}), "hidden hands track their size");
+
+    TEST_ASSERT(applyStateEvent(state, {StateEventKind::Riichi, 1, -1, 0}) && state.riichi_status[1] &&
+                applyStateEvent(state, {StateEventKind::Score, 1, -1, 24000}) && state.scores[1] == 24000 &&
+                applyStateEvent(state, {StateEventKind::Sticks, -1, -1, 1}) && state.riichi_sticks == 1,
+                "riichi, score and sticks");
+    TEST_ASSERT(!applyStateEvent(state, {StateEventKind::Score, 4, -1, 0}), "bad seat rejected");
+
+    GameState full;
+    full.hands[0].assign(max_hand_tiles, 8);
+    TEST_ASSERT(!applyStateEvent(full, {StateEventKind::Draw, 0, 9, 0}) && full.hands[0].size() == max_hand_tiles,
+                "draw into a full hand rejected");
+
+    return 0;
+}
+
+// Test client actions arrive between decisions and are played at the seat's next decision
+int testActions() {
+    std::cout << "\n=== Testing client actions ===" << std::endl;
+
+    int turns = 0, mismatches = 0, illegal = 0;
+    for (int game = 0; game < 5; ++game) {
+        GameServer server;
+        Session session(1);
+        session.setWireFormat(WireFormat::Json);
+        std::vector<int> expected, played;
+        session.setSendCallback([&](const std::string& data) {
+            GameMessage msg;
+            if (!decodeMessage(data, WireFormat::Json, msg)) return;
+            int seat = session.getSeat();
+            if (msg.type == MessageType::YourTurn) {
+                // 第一巡打一张不在手里的牌 (不合法，应摸切)，之后打手里第一张不是刚摸到的牌
+                std::vector<int> hand = session.getRoom()->getCurrentState().hands[seat].toVector();
+                GameMessage action;
+                action.type = MessageType::Action;
+                action.action = msg.tile;
+                if (expected.empty()) {
+                    while (action.action == msg.tile ||
+                           std::find(hand.begin(), hand.end(), action.action) != hand.end()) {
+                        action.action = (action.action + 1) % 136;
+                    }
+                    expected.push_back(msg.tile);
+                    illegal++;
+                } else {
+                    for (int tile : hand) {
+                        if (tile != msg.tile) { action.action = tile; break; }
+                    }
+                    expected.push_back(action.action);
+                }
+                action.tile = action.action;
+                server.handleMessage(&session, action.toJSON());
+            } else if (msg.type == MessageType::PlayerAction && msg.seat == seat && msg.action < 136) {
+                played.push_back(msg.tile);
+            }
+        });
+
+        GameMessage create;
+        create.type = MessageType::CreateRoom;
+        server.handleMessage(&session, create.toJSON());
+        Room* room = session.getRoom();
+        TEST_ASSERT(room, "room created");
+        GameMessage ready;
+        ready.type = MessageType::Ready;
+        server.handleMessage(&session, ready.toJSON());
+        room->playRound();
+
+        turns += static_cast<int>(played.size());
+        if (played != expected) mismatches++;
+    }
+
+    std::cout << "  " << turns << " human discards" << std::endl;
+    TEST_ASSERT(turns > 10 && illegal == 5, "human seat took turns");
+    TEST_ASSERT(mismatches == 0, "legal actions played, illegal ones replaced by tsumogiri");
+
+    return 0;
+}
+
+// Test a riichi request is only accepted with a legal declaration tile
+int testRiichiAction() {
+    std::cout << "\n=== Testing riichi action ===" << std::endl;
+
+    // 顺序牌山: 庄家 1111222233334m 摸 5p (52)，打 5p 或 4m (12) 都能立直，100 不在手里
+    TileIndexList wall(136);
+    for (int i = 0; i < 136; ++i) wall[i] = static_cast<TileIndex>(i);
+    const int riichi = static_cast<int>(Action::Riichi);
+    struct Case { TileIndex tile; int action; TileIndex declared; };
+    const Case cases[] = {{52, riichi, 52}, {12, riichi, 12}, {100, 52, -1}, {invalid_tile_index, 52, -1}};
+
+    for (const Case& c : cases) {
+        Table table;
+        HumanPlayer human(nullptr, "alice");
+        SimpleAI ai[3] = {SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+        table.setPlayer(0, &human);
+        for (int i = 0; i < 3; ++i) table.setPlayer(i + 1, &ai[i]);
+        table.setDealer(0);
+        table.setNextWall(wall);
+
+        int action = -1;
+        TileIndex declared = -1;
+        GameCallbacks callbacks;
+        callbacks.onDecision = [&](int seat, DecisionKind kind, int, int chosen) {
+            if (seat != 0) return;
+            if (kind == DecisionKind::Action && action < 0) action = chosen;
+            if (kind == DecisionKind::RiichiDiscard && declared < 0) declared = chosen;
+        };
+        table.setCallbacks(callbacks);
+        human.setAction(riichi, c.tile);
+        table.playRound();
+
+        TEST_ASSERT(action == c.action && declared == c.declared,
+                    "riichi with tile " << c.tile << (c.declared < 0 ? " rejected" : " accepted"));
+    }
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testEvents();
+    failed += testRounds();
+    failed += testResync();
+    failed += testActions();
+    failed += testRiichiAction();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All state sync tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include "tournament.h"
+#include "simple_ai.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+static std::unique_ptr<Player> makeAI(int entrant) {
+    return std::unique_ptr<Player>(new SimpleAI("AI-" + std::to_string(entrant)));
+}
+
+static TournamentConfig smallConfig(SeatRotation rotation, int threads) {
+    TournamentConfig config;
+    config.games = 6;
+    config.rules.length = MatchLength::Tonpuusen;
+    config.rotation = rotation;
+    config.base_seed = 99;
+    config.num_threads = threads;
+    return config;
+}
+
+// Test seat rotation and seed schedules
+int testSchedule() {
+    std::cout << "\n=== Testing seat rotation / seeds ===" << std::endl;
+
+    Tournament fixed(smallConfig(SeatRotation::Fixed, 1), makeAI);
+    TEST_ASSERT(fixed.getTotalMatches() == 6, "fixed seating: one match per game");
+
+    Tournament cycle(smallConfig(SeatRotation::Cycle, 1), makeAI);
+    TEST_ASSERT(cycle.getTotalMatches() == 24, "cycle: four matches per game");
+    TEST_ASSERT(cycle.getSeed(0) == cycle.getSeed(3) && cycle.getSeed(3) != cycle.getSeed(4),
+                "rotations of one game share the wall seed");
+
+    Tournament all(smallConfig(SeatRotation::All, 1), makeAI);
+    TEST_ASSERT(all.getTotalMatches() == 144, "all: 24 seatings per game");
+
+    TournamentConfig random_config = smallConfig(SeatRotation::Cycle, 1);
+    random_config.seeds = SeedSchedule::Random;
+    Tournament random(random_config, makeAI);
+    TEST_ASSERT(random.getSeed(8) == random.getSeed(11) && random.getSeed(4) != random.getSeed(8),
+                "random schedule is per game and order independent");
+
+    TournamentReport report = cycle.run();
+    for (int e = 0; e < 4; ++e) {
+        const EntrantStats& stats = report.entrants[e];
+        TEST_ASSERT(stats.matches == 24, "every entrant plays every match");
+        for (int seat = 0; seat < 4; ++seat) {
+            TEST_ASSERT(stats.seat_counts[seat] == 6, "cycle balances seats");
+        }
+    }
+
+    return 0;
+}
+
+// Test that multi-threaded results equal single-threaded ones
+int testThreadsAgree() {
+    std::cout << "\n=== Testing thread count independence ===" << std::endl;
+
+    TournamentReport single = Tournament(smallConfig(SeatRotation::Cycle, 1), makeAI).run();
+    TournamentReport multi = Tournament(smallConfig(SeatRotation::Cycle, 4), makeAI).run();
+    TEST_ASSERT(multi.threads == 4 && multi.matches == single.matches, "same number of matches");
+
+    for (int e = 0; e < 4; ++e) {
+        const EntrantStats& a = single.entrants[e];
+        const EntrantStats& b = multi.entrants[e];
+        TEST_ASSERT(a.rank_counts == b.rank_counts && a.score_sum == b.score_sum &&
+                    a.wins == b.wins && a.deal_ins == b.deal_ins && a.rounds == b.rounds,
+                    "entrant stats independent of scheduling");
+    }
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testSchedule();
+    failed += testThreadsAgree();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All tournament tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include "types.h"
+#include "constants.h"
+#include "tiles.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// TileIndex helper: tile * 4 + instance (0-3)
+inline TileIndex TI(Tile tile, int instance = 0) { return tile * 4 + instance; }
+
+// 参考实现: 逐张用回溯解析判断
+static TileMask referenceWaitMask(const Hand &hand) {
+    TileMask mask = 0;
+    TileCounts counts = hand.getTileCounts();
+    for (Tile tile = 0; tile < 34; ++tile) {
+        if (counts[tile] >= 4) continue;  // 第五张不存在
+        TileIndex draw = tile * 4 + counts[tile];
+        if (!hand.parseWinningHand(draw).empty() || hand.isChiitoitsu(draw) || hand.isKokushiMuso(draw))
+            mask |= 1ULL << tile;
+    }
+    return mask;
+}
+
+// 从一副和了型中拿掉一张，得到必定听牌的手牌
+static TileIndexList randomTenpaiHand(std::mt19937 &rng) {
+    std::array<int, 34> used; used.fill(0);
+    TileIndexList tiles;
+    auto take = [&](Tile t) { tiles.push_back(t * 4 + used[t]++); };
+    auto room = [&](Tile t, int n) { return used[t] + n <= 4; };
+
+    std::uniform_int_distribution<int> any(0, 33), seq_start(0, 20);
+    while (tiles.size() < 12) {
+        if (rng() % 2) {
+            Tile t = any(rng);
+            if (room(t, 3)) { take(t); take(t); take(t); }
+        } else {
+            int s = seq_start(rng);
+            Tile t = s / 7 * 9 + s % 7;
+            if (room(t, 1) && room(t + 1, 1) && room(t + 2, 1)) { take(t); take(t + 1); take(t + 2); }
+        }
+    }
+    while (tiles.size() < 14) {
+        Tile t = any(rng);
+        if (room(t, 2)) { take(t); take(t); }
+    }
+    tiles.erase(tiles.begin() + rng() % tiles.size());
+    std::shuffle(tiles.begin(), tiles.end(), rng);
+    return tiles;
+}
+
+// Test special shapes
+int testSpecialShapes() {
+    std::cout << "\n=== Testing special shapes ===" << std::endl;
+
+    Hand kokushi({TI(_1m), TI(_9m), TI(_1p), TI(_9p), TI(_1s), TI(_9s),
+                  TI(EastWind), TI(SouthWind), TI(WestWind), TI(NorthWind), TI(Haku), TI(Hatsu), TI(Chun)}, Wind::East, Wind::East);
+    TEST_ASSERT(kokushi.getWaitMask() == referenceWaitMask(kokushi), "Kokushi 13-sided wait matches reference");
+    TEST_ASSERT(!kokushi.isWinningHand(TI(_5m)), "Kokushi does not win on 5m");
+
+    Hand chiitoi({TI(_1m), TI(_1m, 1), TI(_2m), TI(_2m, 1), TI(_3m), TI(_3m, 1),
+                  TI(_4m), TI(_4m, 1), TI(_5m), TI(_5m, 1), TI(_6m), TI(_6m, 1), TI(_7m)}, Wind::East, Wind::East);
+    TEST_ASSERT(chiitoi.getWaitMask() == referenceWaitMask(chiitoi), "Chiitoitsu / ryanpeikou wait matches reference");
+
+    Hand chuuren({TI(_1m), TI(_1m, 1), TI(_1m, 2), TI(_2m), TI(_3m), TI(_4m), TI(_5m),
+                  TI(_6m), TI(_7m), TI(_8m), TI(_9m), TI(_9m, 1), TI(_9m, 2)}, Wind::East, Wind::East);
+    TEST_ASSERT(chuuren.getWaitMask() == 0x1FF, "Junsei Chuuren waits on all nine");
+
+    return 0;
+}
+
+// Test random tenpai and random hands against the reference parser
+int testRandomHands() {
+    std::cout << "\n=== Testing random hands ===" << std::endl;
+
+    std::mt19937 rng(20240601);
+    int mismatches = 0, tenpai = 0;
+    for (int i = 0; i < 3000; ++i) {
+        TileIndexList tiles;
+        if (i % 2) {
+            tiles = randomTenpaiHand(rng);
+        } else {
+            TileIndexList wall;
+            for (int t = 0; t < 136; ++t) wall.push_back(t);
+            std::shuffle(wall.begin(), wall.end(), rng);
+            tiles.assign(wall.begin(), wall.begin() + 13);
+        }
+        Hand hand(tiles, Wind::East, Wind::South);
+        TileMask expected = referenceWaitMask(hand);
+        // 参考实现跳过第五张，掩码只看牌型，比较时同样去掉
+        TileCounts counts = hand.getTileCounts();
+        TileMask actual = hand.getWaitMask();
+        for (Tile t = 0; t < 34; ++t)
+            if (counts[t] >= 4) actual &= ~(1ULL << t);
+        if (actual != expected) mismatches++;
+        if (expected) tenpai++;
+    }
+    std::cout << "  tenpai hands: " << tenpai << std::endl;
+    TEST_ASSERT(tenpai >= 1500, "generator produces tenpai hands");
+    TEST_ASSERT(mismatches == 0, "wait mask matches reference on 3000 hands");
+
+    return 0;
+}
+
+// Test that the mask follows hand changes
+int testUpdateAfterDiscard() {
+    std::cout << "\n=== Testing update after discard ===" << std::endl;
+
+    // 1m2m3m 4m5m6m 7m8m9m 1p1p1p 2p, 听 2p
+    Hand hand({TI(_1m), TI(_2m), TI(_3m), TI(_4m), TI(_5m), TI(_6m),
+               TI(_7m), TI(_8m), TI(_9m), TI(_1p), TI(_1p, 1), TI(_1p, 2), TI(_2p)}, Wind::East, Wind::East);
+    TEST_ASSERT(hand.isWinningHand(TI(_2p, 1)), "waits on 2p");
+
+    // 摸 3p 打 1m -> 2m..9m 1p1p1p 2p3p
+    hand.drawAndDiscard(TI(_3p), TI(_1m));
+    TEST_ASSERT(!hand.isWinningHand(TI(_2p, 1)), "no longer waits on 2p");
+    TEST_ASSERT(hand.getWaitMask() == referenceWaitMask(hand), "mask recomputed after discard");
+
+    return 0;
+}
+
+// Test riichi discard candidates against per-discard wait masks
+int testRiichiDiscards() {
+    std::cout << "\n=== Testing riichi discards ===" << std::endl;
+
+    std::mt19937 rng(77);
+    int mismatches = 0, riichi = 0;
+    for (int i = 0; i < 2000; ++i) {
+        TileIndexList tiles = randomTenpaiHand(rng);
+        if (i % 2) {
+            // 打乱一张，制造一向听或不听的手牌
+            tiles[rng() % tiles.size()] = (tiles[0] + 1 + rng() % 8) % 136;
+            std::sort(tiles.begin(), tiles.end());
+            if (std::adjacent_find(tiles.begin(), tiles.end()) != tiles.end()) continue;
+        }
+        Hand hand(tiles, Wind::East, Wind::South);
+        TileIndex draw = invalid_tile_index;
+        for (TileIndex t = rng() % 136; draw == invalid_tile_index; t = (t + 1) % 136)
+            if (!hand.hasTileIndex(t)) draw = t;
+
+        TileCounts counts = hand.getTileCounts(); counts[draw / 4]++;
+        TileMask expected = 0;
+        for (Tile t = 0; t < 34; ++t) {
+            if (counts[t] == 0) continue;
+            counts[t]--;
+            if (calcWaitMask(counts, true)) expected |= 1ULL << t;
+            counts[t]++;
+        }
+        if (hand.getRiichiDiscards(draw) != expected) mismatches++;
+        if (expected) riichi++;
+    }
+    std::cout << "  hands with riichi discards: " << riichi << std::endl;
+    TEST_ASSERT(mismatches == 0, "riichi discards match exhaustive check");
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testSpecialShapes();
+    failed += testRandomHands();
+    failed += testUpdateAfterDiscard();
+    failed += testRiichiDiscards();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All wait mask tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
@@ -0,0 +1,293 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "wire_protocol.h"
+#include "session.h"
+#include "room.h"
+
+// Test helper macros
+#define TEST_ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "FAILED: " << msg << std::endl; \
+        return 1; \
+    } else { \
+        std::cout << "PASSED: " << msg << std::endl; \
+    }
+
+// 对局中段的视角: 自己 14 张，他家 13 张暗牌，每家牌河 12 张
+static GameState midGameView() {
+    GameState state;
+    state.round_wind = 1;
+    state.dealer = 3;
+    state.current_player = 0;
+    state.remaining_tiles = 22;
+    state.honba = 2;
+    state.riichi_sticks = 1;
+    for (int i = 0; i < 14; ++i) state.hands[0].push_back(i * 9 + 3);
+    for (int s = 1; s < 4; ++s) state.hands[s].assign(13, -1);
+    for (int s = 0; s < 4; ++s) {
+        for (int i = 0; i < 12; ++i) state.discards[s].push_back((s * 31 + i * 11) % 136);
+    }
+    state.scores = {31300, 18700, 24000, 25000};
+    state.riichi_status = {false, false, true, false};
+    state.can_tsumo = true;
+    state.can_riichi = true;
+    state.last_draw = 120;
+    state.last_discard = 77;
+    state.last_discard_player = 3;
+    return state;
+}
+
+static GameMessage fullMessage(MessageType type) {
+    GameMessage msg;
+    msg.type = type;
+    msg.room_id = "ROOM12";
+    msg.seat = 3;
+    msg.action = 142;
+    msg.tile = 135;
+    msg.tiles = {0, 5, 135};
+    msg.error_msg = "oops";
+    msg.state = midGameView();
+    msg.seq = 300;
+    msg.events = {{StateEventKind::Draw, 0, 120, 0}, {StateEventKind::Score, 2, -1, -1000},
+                  {StateEventKind::Sticks, -1, -1, 2}};
+    msg.token = "0123456789abcdef";
+    return msg;
+}
+
+// Test every message type survives a binary round trip
+int testRoundTrip() {
+    std::cout << "\n=== Testing round trip ===" << std::endl;
+
+    int mismatches = 0;
+    for (int t = 0; t < message_type_count; ++t) {
+        GameMessage msg = fullMessage(static_cast<MessageType>(t));
+        std::string bytes;
+        GameMessage decoded;
+        if (!appendBinary(msg, bytes) || !parseBinary(bytes.data(), bytes.size(), decoded)) {
+            mismatches++;
+            continue;
+        }
+        // JSON 写出只包含该类型的字段，可以用来比较
+        if (decoded.toJSON() != msg.toJSON()) mismatches++;
+    }
+    TEST_ASSERT(mismatches == 0, "every message type round trips");
+
+    GameMessage msg;
+    msg.type = MessageType::PlayerAction;
+    msg.seat = 1;
+    msg.action = -1;
+    msg.tile = 254;
+    std::string bytes;
+    TEST_ASSERT(appendBinary(msg, bytes) && bytes.size() == 5, "PlayerAction is 5 bytes");
+
+    msg.tile = 255;
+    bytes.clear();
+    TEST_ASSERT(!appendBinary(msg, bytes), "out of range tile rejected");
+    TEST_ASSERT(encodeMessage(msg, WireFormat::Binary) == encodeMessage([] {
+        GameMessage error;
+        error.type = MessageType::Error;
+        error.error_msg = "message not encodable";
+        return error;
+    }(), WireFormat::Binary), "unencodable message replaced by an error");
+
+    return 0;
+}
+
+// Test the binary state is much smaller than JSON
+int testSize() {
+    std::cout << "\n=== Testing size ===" << std::endl;
+
+    GameMessage msg;
+    msg.type = MessageType::GameState;
+    msg.state = midGameView();
+    std::string json = msg.toJSON();
+    std::string bytes;
+    TEST_ASSERT(appendBinary(msg, bytes), "state encodes");
+    std::cout << "  GameState: " << json.size() << " bytes JSON, " << bytes.size() << " bytes binary ("
+              << static_cast<double>(json.size()) / bytes.size() << "x)" << std::endl;
+    TEST_ASSERT(bytes.size() * 4 < json.size(), "binary at least 4x smaller");
+
+    GameMessage decoded;
+    TEST_ASSERT(parseBinary(bytes.data(), bytes.size(), decoded) && decoded.state.hands[2].size() == 13 &&
+                decoded.state.hands[2][0] == -1 && decoded.state.scores[0] == 31300,
+                "hidden hands and scores decode");
+
+    return 0;
+}
+
+// Test malformed frames are rejected
+int testRejects() {
+    std::cout << "\n=== Testing rejects ===" << std::endl;
+
+    GameMessage msg = fullMessage(MessageType::GameState);
+    std::string bytes;
+    appendBinary(msg, bytes);
+
+    int accepted = 0;
+    for (size_t n = 0; n < bytes.size(); ++n) {
+        std::string prefix(bytes.data(), n);
+        GameMessage decoded;
+        const char* error = nullptr;
+        if (parseBinary(prefix.data(), prefix.size(), decoded, &error) || !error || !*error) accepted++;
+    }
+    TEST_ASSERT(accepted == 0, "every truncation rejected");
+
+    GameMessage decoded;
+    const char* error = nullptr;
+    std::string extra = bytes + '\0';
+    TEST_ASSERT(!parseBinary(extra.data(), extra.size(), decoded, &error) && std::string(error) == "trailing bytes",
+                "trailing bytes rejected");
+
+    std::string version = bytes;
+    version[0] = 2;
+    TEST_ASSERT(!parseBinary(version.data(), version.size(), decoded, &error) &&
+                std::string(error) == "unsupported version", "unknown version rejected");
+
+    std::string type = bytes;
+    type[1] = static_cast<char>(message_type_count);
+    TEST_ASSERT(!parseBinary(type.data(), type.size(), decoded, &error), "unknown type rejected");
+
+    const char overflow[] = {1, 10, 0, 0, 0, 0, 1, static_cast<char>(0xFF), static_cast<char>(0xFF),
+                             static_cast<char>(0xFF), static_cast<char>(0xFF), 0x7F};
+    TEST_ASSERT(!parseBinary(overflow, sizeof(overflow), decoded, &error) && std::string(error) == "varint overflow",
+                "varint overflow rejected");
+
+    return 0;
+}
+
+// 各家手牌都可见的完整状态
+static GameState fullState() {
+    GameState state = midGameView();
+    for (int s = 1; s < 4; ++s) {
+        state.hands[s].clear();
+        for (int i = 0; i < 13; ++i) state.hands[s].push_back(s * 4 + i * 10);
+    }
+    return state;
+}
+
+// Test shared-base views match copying and encoding each seat's view
+int testViews() {
+    std::cout << "\n=== Testing views ===" << std::endl;
+
+    GameState empty_hand = fullState();
+    empty_hand.hands[2].clear();
+    empty_hand.current_player = 2;
+    GameState no_player = fullState();
+    no_player.current_player = -1;
+    GameState states[] = {fullState(), empty_hand, no_player, GameState()};
+
+    int mismatches = 0;
+    StateViewEncoder views;
+    for (WireFormat format : {WireFormat::Json, WireFormat::Binary}) {
+        for (const GameState& state : states) {
+            TEST_ASSERT(views.reset(state, 123, format), "state encodes");
+            for (int seat = 0; seat < 4; ++seat) {
+                GameMessage msg;
+                msg.type = MessageType::GameState;
+                msg.seq = 123;
+                msg.state = state.getViewFor(seat);
+                if (views.encodeFor(seat) != encodeMessage(msg, format)) mismatches++;
+            }
+        }
+    }
+    TEST_ASSERT(mismatches == 0, "spliced views equal per-seat copies");
+
+    GameState out_of_range = fullState();
+    out_of_range.last_draw = 300;
+    GameMessage decoded;
+    TEST_ASSERT(!views.reset(out_of_range, 1, WireFormat::Binary) &&
+                decodeMessage(views.encodeFor(0), WireFormat::Binary, decoded) && decoded.type == MessageType::Error,
+                "unencodable state becomes an error");
+
+    // 每次事件四个座位的快照: 逐座位复制编码 vs 公共部分编码一次
+    GameState state = fullState();
+    const int rounds = 20000;
+    for (WireFormat format : {WireFormat::Json, WireFormat::Binary}) {
+        size_t copied = 0, shared = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (int seat = 0; seat < 4; ++seat) {
+                GameMessage msg;
+                msg.type = MessageType::GameState;
+                msg.seq = r;
+                msg.state = state.getViewFor(seat);
+                copied += encodeMessage(msg, format).size();
+            }
+        }
+        double copy_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            views.reset(state, r, format);
+            for (int seat = 0; seat < 4; ++seat) shared += views.encodeFor(seat).size();
+        }
+        double shared_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "  " << (format == WireFormat::Json ? "JSON" : "binary") << " 4 views: copy "
+                  << copy_time * 1e9 / rounds << " ns, shared " << shared_time * 1e9 / rounds << " ns ("
+                  << copy_time / shared_time << "x)" << std::endl;
+        TEST_ASSERT(copied == shared, "same bytes sent");
+    }
+
+    return 0;
+}
+
+// Test handshake negotiation and per-connection encoding
+int testConnections() {
+    std::cout << "\n=== Testing connections ===" << std::endl;
+
+    TEST_ASSERT(negotiateWireFormat("mahjong.json, mahjong.bin.1") == WireFormat::Binary, "binary preferred");
+    TEST_ASSERT(negotiateWireFormat("mahjong.json") == WireFormat::Json, "json kept");
+    TEST_ASSERT(negotiateWireFormat("") == WireFormat::Json, "json by default");
+    TEST_ASSERT(negotiateWireFormat("mahjong.bin.10,chat") == WireFormat::Json, "exact protocol names only");
+    TEST_ASSERT(std::string(wireProtocolName(WireFormat::Binary)) == "mahjong.bin.1", "protocol name");
+
+    Session text_session(1), binary_session(2);
+    binary_session.setWireFormat(WireFormat::Binary);
+    std::vector<std::string> text_received, binary_received;
+    text_session.setSendCallback([&](const std::string& m) { text_received.push_back(m); });
+    binary_session.setSendCallback([&](const std::string& m) { binary_received.push_back(m); });
+
+    Room room("R1");
+    room.addPlayer(&text_session);
+    room.addPlayer(&binary_session);
+
+    GameMessage msg;
+    msg.type = MessageType::PlayerAction;
+    msg.seat = 0;
+    msg.action = 57;
+    msg.tile = 57;
+    room.broadcast(msg);
+
+    GameMessage from_text, from_binary;
+    TEST_ASSERT(text_received.size() == 1 && binary_received.size() == 1, "both connections received");
+    TEST_ASSERT(decodeMessage(text_received[0], WireFormat::Json, from_text) &&
+                decodeMessage(binary_received[0], WireFormat::Binary, from_binary) &&
+                from_text.toJSON() == msg.toJSON() && from_binary.toJSON() == msg.toJSON(),
+                "each connection decodes its own format");
+    room.removePlayer(&text_session);
+    room.removePlayer(&binary_session);
+
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+
+    failed += testRoundTrip();
+    failed += testSize();
+    failed += testRejects();
+    failed += testViews();
+    failed += testConnections();
+
+    std::cout << "\n=== Test Summary ===" << std::endl;
+    if (failed == 0) {
+        std::cout << "All wire protocol tests passed!" << std::endl;
+    } else {
+        std::cout << failed << " test(s) failed!" << std::endl;
+    }
+
+    return failed;
+}
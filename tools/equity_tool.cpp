@@ -0,0 +1,173 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "equity.h"
+#include "endgame_solver.h"
+#include "mcts_ai.h"
+#include "replay_log.h"
+
+// 局面胜率估算: 蒙特卡洛模拟到本局结束，统计各家和牌 / 放铳 / 流局概率和点数变化期望
+//   equity_tool <position.txt> [options]                文本局面 (格式见 equity.h)
+//   equity_tool --replay <file> <round> <step> [options] 牌谱第 round 局执行 step 个决策后的局面
+// options: -j threads  -n 最多模拟次数  -m 最少模拟次数  -c 置信区间半宽  -s seed
+//          -p rollout|tsumogiri  --fast (不解析役种)
+//          --solve [policy|adversarial]  牌谱局面的牌山已知，改为完全搜索到本局结束 (只用于 --replay)
+
+static int usage() {
+    std::cerr << "usage: equity_tool <position.txt> [options]\n"
+              << "       equity_tool --replay <file> <round> <step> [options]\n"
+              << "options: -j threads -n max_samples -m min_samples -c target_ci -s seed "
+                 "-p rollout|tsumogiri --fast --solve [policy|adversarial]" << std::endl;
+    return 2;
+}
+
+static bool loadText(const std::string& path, EquityPosition& position) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "cannot open " << path << std::endl;
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string error;
+    if (!parsePosition(text.str(), position, error)) {
+        std::cerr << path << ": " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool loadReplay(const std::string& path, long round_index, long step, GameSnapshot& snapshot,
+                       ReplayRound& round) {
+    ReplayLog log;
+    if (!log.open(path) || !log.readRound(static_cast<size_t>(round_index), round)) {
+        std::cerr << path << ": cannot read round " << round_index << std::endl;
+        return false;
+    }
+    if (step < 0 || step > static_cast<long>(round.decisions.size())) {
+        std::cerr << "round " << round_index << " has " << round.decisions.size() << " decisions" << std::endl;
+        return false;
+    }
+
+    // 快照和 Table 按同样的规则推进，直接重放记录的决策
+    dealSnapshot(snapshot, round.wall.data(), round.dealer, round.round_wind, round.honba,
+                 round.riichi_sticks, round.scores);
+    for (long i = 0; i < step && !snapshot.isFinished(); ++i) {
+        snapshot.apply(round.decisions[i].action);
+    }
+    if (snapshot.isFinished()) {
+        std::cerr << "round already finished after " << step << " decisions" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static int solve(const GameSnapshot& snapshot, const EndgameConfig& config) {
+    int limit = config.opponents == EndgameOpponents::Adversarial ? 8 : 24;
+    if (snapshot.getRemainingTiles() > limit) {
+        std::cerr << snapshot.getRemainingTiles() << " tiles left, exact solving supports up to " << limit
+                  << " with these opponents" << std::endl;
+        return 1;
+    }
+    EndgameResult result = solveEndgame(snapshot, config);
+    std::cout << (result.solved ? "solved" : "node limit reached") << " in " << std::fixed << std::setprecision(2)
+              << result.seconds << " s (" << result.nodes << " nodes), " << snapshot.getRemainingTiles()
+              << " tiles left" << std::endl;
+    if (!result.solved) return 1;
+    std::cout << "seat " << result.seat << " value " << std::showpos << result.value << std::noshowpos << std::endl;
+    for (const EndgameMove& move : result.moves) {
+        std::cout << "  action " << move.action << ": " << std::showpos << move.value << std::noshowpos << std::endl;
+    }
+    std::cout << "line:";
+    for (int action : result.line) std::cout << " " << action;
+    std::cout << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+
+    EquityPosition position;
+    EquityConfig config;
+    EndgameConfig solver;
+    GameSnapshot snapshot;
+    ReplayRound round;  // 快照的牌山指向它
+    bool replay = false, exact = false;
+    int next = 2;
+    std::string source = argv[1];
+    if (source == "--replay") {
+        if (argc < 5) return usage();
+        if (!loadReplay(argv[2], std::atol(argv[3]), std::atol(argv[4]), snapshot, round)) return 1;
+        positionFromSnapshot(snapshot, position);
+        replay = true;
+        next = 5;
+    } else if (!loadText(source, position)) {
+        return 1;
+    }
+
+    for (int i = next; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            config.num_threads = std::atoi(argv[++i]);
+        } else if (arg == "-n" && i + 1 < argc) {
+            config.max_samples = std::atol(argv[++i]);
+        } else if (arg == "-m" && i + 1 < argc) {
+            config.min_samples = std::atol(argv[++i]);
+        } else if (arg == "-c" && i + 1 < argc) {
+            config.target_ci = std::atof(argv[++i]);
+        } else if (arg == "-s" && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "-p" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "rollout") config.policy = MctsAI::rolloutPolicy;
+            else if (policy == "tsumogiri") config.policy = tsumogiriPolicy;
+            else return usage();
+        } else if (arg == "--fast") {
+            config.fast_scoring = true;
+        } else if (arg == "--solve") {
+            exact = true;
+            if (i + 1 < argc && std::string(argv[i + 1]) == "adversarial") {
+                solver.opponents = EndgameOpponents::Adversarial;
+                i++;
+            } else if (i + 1 < argc && std::string(argv[i + 1]) == "policy") {
+                i++;
+            }
+        } else {
+            return usage();
+        }
+    }
+
+    if (exact) {
+        if (!replay) return usage();
+        solver.num_threads = config.num_threads;
+        solver.policy = config.policy;
+        snapshot.fast_scoring = config.fast_scoring;
+        return solve(snapshot, solver);
+    }
+
+    EquityResult result = runEquity(position, config);
+    if (result.samples == 0) {
+        std::cerr << "position is inconsistent: not enough unseen tiles" << std::endl;
+        return 1;
+    }
+
+    int threads = config.num_threads > 0 ? config.num_threads : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << result.samples << " rounds in " << std::fixed << std::setprecision(2) << result.seconds << " s ("
+              << static_cast<long>(result.samples / std::max(result.seconds, 1e-9)) << " rounds/s, "
+              << threads << " threads), " << (result.converged ? "converged" : "sample limit reached")
+              << ", max ci +/-" << std::setprecision(2) << result.max_ci * 100 << "%" << std::endl;
+    std::cout << "seat      win  deal-in        delta" << std::endl;
+    for (int s = 0; s < 4; ++s) {
+        std::cout << std::setw(4) << s << std::setprecision(1)
+                  << std::setw(8) << result.win[s] * 100 << "%"
+                  << std::setw(8) << result.deal_in[s] * 100 << "%"
+                  << std::setw(9) << std::showpos << static_cast<long>(result.delta[s]) << std::noshowpos
+                  << " +/-" << static_cast<long>(result.delta_ci[s]) << std::endl;
+    }
+    std::cout << "draw" << std::setw(8) << result.draw * 100 << "%" << std::endl;
+    return 0;
+}
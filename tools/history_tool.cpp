@@ -0,0 +1,173 @@
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "table.h"
+#include "simple_ai.h"
+#include "replay_log.h"
+#include "hand_history.h"
+
+// 牌局历史的列式存储
+//   history_tool record <dir> <rounds> [seed]     自对局写入存储
+//   history_tool import <dir> <log.mjr>...        从牌谱文件建立存储
+//   history_tool query <dir> [-d] [-j threads] [-n rows] <filter>...
+//   history_tool columns
+// 条件形如 score>12000、winner_wind!=0、yaku&Chinitsu，全部成立的行为命中；-d 查询决策表
+
+static int usage() {
+    std::cerr << "usage: history_tool record <dir> <rounds> [seed]" << std::endl;
+    std::cerr << "       history_tool import <dir> <log.mjr>..." << std::endl;
+    std::cerr << "       history_tool query <dir> [-d] [-j threads] [-n rows] <filter>..." << std::endl;
+    std::cerr << "       history_tool columns" << std::endl;
+    return 2;
+}
+
+static const char* typeName(ColumnType type) {
+    switch (type) {
+        case ColumnType::I8: return "i8";
+        case ColumnType::U8: return "u8";
+        case ColumnType::I32: return "i32";
+        case ColumnType::Mask64: return "mask64";
+    }
+    return "?";
+}
+
+static int listColumns() {
+    const char* tables[2] = {"rounds", "decisions"};
+    for (int t = 0; t < 2; ++t) {
+        int count;
+        const HistoryColumn* columns = getHistoryColumns(static_cast<HistoryTable>(t), count);
+        std::cout << tables[t] << ":";
+        for (int c = 0; c < count; ++c) {
+            std::cout << " " << columns[c].name << "(" << typeName(columns[c].type) << ")";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+static int record(const std::string& dir, int rounds, uint32_t seed) {
+    HistoryWriter writer;
+    if (!writer.open(dir)) {
+        std::cerr << "cannot create " << dir << std::endl;
+        return 1;
+    }
+
+    Table table;
+    table.setSeed(seed);
+    SimpleAI players[4] = {SimpleAI("A"), SimpleAI("B"), SimpleAI("C"), SimpleAI("D")};
+    for (int i = 0; i < 4; ++i) table.setPlayer(i, &players[i]);
+
+    HistoryRecorder recorder(&table, &writer);
+    for (int i = 0; i < rounds; ++i) {
+        table.setDealer(i % 4);
+        table.playRound();
+    }
+    writer.close();
+    std::cout << "recorded " << recorder.getRecordedCount() << " rounds to " << dir << std::endl;
+    return 0;
+}
+
+static int import(const std::string& dir, const std::vector<std::string>& logs) {
+    HistoryWriter writer;
+    if (!writer.open(dir)) {
+        std::cerr << "cannot create " << dir << std::endl;
+        return 1;
+    }
+
+    ReplayRound round;
+    for (const std::string& path : logs) {
+        ReplayLog log;
+        if (!log.open(path)) {
+            std::cerr << "cannot open " << path << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < log.getRoundCount(); ++i) {
+            if (log.readRound(i, round)) writer.writeRound(round);
+        }
+    }
+    writer.close();
+    std::cout << "imported " << writer.getRowCount(HistoryTable::Rounds) << " rounds, "
+              << writer.getRowCount(HistoryTable::Decisions) << " decisions to " << dir << std::endl;
+    return 0;
+}
+
+static int query(int argc, char** argv) {
+    std::string dir = argv[0];
+    HistoryTable table = HistoryTable::Rounds;
+    int threads = 0;
+    size_t max_rows = 10;
+    std::vector<std::string> texts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-d") {
+            table = HistoryTable::Decisions;
+        } else if (arg == "-j" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "-n" && i + 1 < argc) {
+            max_rows = static_cast<size_t>(std::atol(argv[++i]));
+        } else {
+            texts.push_back(arg);
+        }
+    }
+
+    std::vector<HistoryFilter> filters;
+    for (const std::string& text : texts) {
+        HistoryFilter f;
+        std::string error;
+        if (!parseHistoryFilter(table, text, f, error)) {
+            std::cerr << error << std::endl;
+            return 2;
+        }
+        filters.push_back(f);
+    }
+
+    HandHistory history;
+    if (!history.open(dir)) {
+        std::cerr << "cannot open " << dir << std::endl;
+        return 1;
+    }
+    HistoryQueryResult result = queryHistory(history, table, filters, max_rows, threads);
+
+    std::cout << result.matches << " / " << result.rows << " rows match" << std::endl;
+    std::cout << "  blocks: " << result.blocks << " total, " << result.blocks_skipped << " skipped, "
+              << result.blocks_full << " accepted from stats" << std::endl;
+    std::cout << "  scanned " << result.bytes_scanned << " bytes in " << result.seconds * 1000 << " ms";
+    if (result.seconds > 0) {
+        std::cout << " (" << result.bytes_scanned / result.seconds / 1e9 << " GB/s)";
+    }
+    std::cout << std::endl;
+
+    int count;
+    const HistoryColumn* columns = getHistoryColumns(table, count);
+    for (uint64_t row : result.sample) {
+        std::cout << "  #" << row;
+        for (int c = 0; c < count; ++c) {
+            int64_t value = history.getValue(table, c, row);
+            std::cout << " " << columns[c].name << "=";
+            if (columns[c].type == ColumnType::Mask64) {
+                std::cout << "0x" << std::hex << value << std::dec;
+            } else {
+                std::cout << value;
+            }
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+    std::string command = argv[1];
+
+    if (command == "columns") return listColumns();
+    if (command == "record" && argc >= 4) {
+        uint32_t seed = argc >= 5 ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10)) : 1;
+        return record(argv[2], std::atoi(argv[3]), seed);
+    }
+    if (command == "import" && argc >= 4) {
+        return import(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+    }
+    if (command == "query" && argc >= 3) return query(argc - 2, argv + 2);
+    return usage();
+}
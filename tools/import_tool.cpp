@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "archive_import.h"
+#include "replay_log.h"
+
+// 外部牌谱导入
+//   import_tool [-j threads] [-o out.mjr] <file>...
+// 逐块读取天凤 (.xml/.mjlog) 或 mjai (.json/.jsonl/.mjson) 牌谱，在引擎上重放后写成本项目的牌谱格式
+
+static int usage() {
+    std::cerr << "usage: import_tool [-j threads] [-o out.mjr] <file>..." << std::endl;
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    std::string output;
+    int threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) return usage();
+
+    ReplayWriter writer;
+    if (!output.empty() && !writer.open(output)) {
+        std::cerr << "cannot open " << output << std::endl;
+        return 1;
+    }
+    ImportSink sink;
+    if (writer.isOpen()) {
+        sink = [&writer](const ReplayRound& round) { writer.writeRound(round); };
+    }
+
+    ImportReport report = importArchives(paths, threads, sink);
+    writer.close();
+
+    std::cout << report.files << " files, " << report.rounds << " rounds: " << report.imported << " imported, "
+              << report.unsupported << " unsupported, " << report.malformed << " malformed, "
+              << report.diverged << " diverged";
+    if (report.seconds > 0) {
+        std::cout << " (" << static_cast<long>(report.rounds / report.seconds) << " rounds/s)";
+    }
+    std::cout << std::endl;
+    if (report.unreadable > 0) {
+        std::cout << "  " << report.unreadable << " unreadable files" << std::endl;
+    }
+    if (report.score_mismatches > 0) {
+        std::cout << "  " << report.score_mismatches << " imported rounds score differently under engine rules"
+                  << std::endl;
+    }
+    for (const ImportIssue& issue : report.issues) {
+        std::cout << "  " << issue.file << " round " << issue.round << ": " << issue.reason << std::endl;
+    }
+    if (!output.empty()) {
+        std::cout << "wrote " << report.imported << " rounds to " << output << std::endl;
+    }
+    return report.unreadable > 0 ? 1 : 0;
+}
@@ -1,6 +1,7 @@
-import { useState, useCallback, useMemo } from 'react';
-import { GameState, ServerMessage, MessageType, Action } from '../types';
+import { useState, useCallback, useMemo, useRef } from 'react';
+import { GameState, ServerMessage, ClientMessage, MessageType, Action } from '../types';
 import { useWebSocket } from './useWebSocket';
+import { applyStateEvents } from '../sync';
 
 type GamePhase = 'lobby' | 'waiting' | 'playing' | 'finished';
 
@@ -55,6 +56,10 @@ export function useGame(serverUrl: string): UseGameReturn {
   const [hand, setHand] = useState<number[]>([]);
   const [messages, setMessages] = useState<string[]>([]);
 
+  // 增量同步: 当前状态和它的序号 (-1 表示没有)
+  const syncRef = useRef<{ seq: number; state: GameState | null }>({ seq: -1, state: null });
+  const sendRef = useRef<(message: ClientMessage) => void>();
+
   const addMessage = useCallback((msg: string) => {
     setMessages(prev => [...prev.slice(-50), msg]);
   }, []);
@@ -62,16 +67,20 @@ export function useGame(serverUrl: string): UseGameReturn {
   const handleMessage = useCallback((message: ServerMessage) => {
     switch (message.type) {
       case MessageType.RoomCreated:
+        saveSeatToken(message.roomId, message.token);
         setRoomId(message.roomId || null);
         setSeat(message.seat || 0);
         setPhase('waiting');
+        sendRef.current?.({ type: MessageType.SyncRequest, seq: -1 });
         addMessage(`房间 ${message.roomId} 已创建，你的座位是 ${getSeatName(message.seat || 0)}`);
         break;
 
       case MessageType.RoomJoined:
+        saveSeatToken(message.roomId, message.token);
         setRoomId(message.roomId || null);
         setSeat(message.seat || 0);
         setPhase('waiting');
+        sendRef.current?.({ type: MessageType.SyncRequest, seq: -1 });
         addMessage(`已加入房间 ${message.roomId}，你的座位是 ${getSeatName(message.seat || 0)}`);
         break;
 
@@ -104,10 +113,29 @@ export function useGame(serverUrl: string): UseGameReturn {
 
       case MessageType.GameState:
         if (message.state) {
+          syncRef.current = { seq: message.seq ?? -1, state: message.state };
           setGameState(message.state);
         }
         break;
 
+      case MessageType.StateDelta: {
+        const sync = syncRef.current;
+        const events = message.events ?? [];
+        if (!sync.state || message.seq !== sync.seq + 1) {
+          // 断档: 告诉服务器已有的序号，由它补发事件或快照
+          sendRef.current?.({ type: MessageType.SyncRequest, seq: sync.state ? sync.seq : -1 });
+          break;
+        }
+        const next = applyStateEvents(sync.state, events);
+        if (!next) {
+          sendRef.current?.({ type: MessageType.SyncRequest, seq: -1 });
+          break;
+        }
+        syncRef.current = { seq: sync.seq + events.length, state: next };
+        setGameState(next);
+        break;
+      }
+
       case MessageType.GameEnd:
         setPhase('finished');
         addMessage(`游戏结束！${getSeatName(message.winner || 0)} 获胜`);
@@ -125,15 +153,17 @@ export function useGame(serverUrl: string): UseGameReturn {
     }
   }, [addMessage]);
 
-  const { connected, createRoom, joinRoom: wsJoinRoom, leaveRoom: wsLeaveRoom, ready, sendAction } = useWebSocket({
+  const { connected, send, createRoom, joinRoom: wsJoinRoom, leaveRoom: wsLeaveRoom, ready, sendAction } = useWebSocket({
     url: serverUrl,
     onMessage: handleMessage,
     onConnect: () => addMessage('已连接到服务器'),
     onDisconnect: () => addMessage('与服务器断开连接'),
   });
+  sendRef.current = send;
 
   const joinRoom = useCallback((id: string) => {
-    wsJoinRoom(id);
+    // 对局中的房间只能凭之前拿到的座位凭证回到原来的座位
+    wsJoinRoom(id, loadSeatToken(id));
   }, [wsJoinRoom]);
 
   const leaveRoom = useCallback(() => {
@@ -142,6 +172,7 @@ export function useGame(serverUrl: string): UseGameReturn {
     setRoomId(null);
     setSeat(-1);
     setGameState(null);
+    syncRef.current = { seq: -1, state: null };
     setHand([]);
   }, [wsLeaveRoom]);
 
@@ -230,6 +261,15 @@ function getSeatName(seat: number): string {
   return names[seat] || `座位${seat}`;
 }
 
+// 座位凭证按房间号保存在本地，刷新页面或断线后仍能回到原来的座位
+function saveSeatToken(roomId?: string, token?: string) {
+  if (roomId && token) localStorage.setItem(`seat-token:${roomId}`, token);
+}
+
+function loadSeatToken(roomId: string): string | undefined {
+  return localStorage.getItem(`seat-token:${roomId}`) ?? undefined;
+}
+
 function getTileName(tileId: number): string {
   const tile = Math.floor(tileId / 4);
   if (tile < 9) return `${tile + 1}万`;
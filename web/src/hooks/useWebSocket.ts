@@ -1,8 +1,10 @@
 import { useState, useEffect, useCallback, useRef } from 'react';
 import { ServerMessage, ClientMessage, MessageType } from '../types';
+import { BINARY_PROTOCOL, JSON_PROTOCOL, decodeServerMessage, encodeClientMessage } from '../protocol';
 
 interface UseWebSocketOptions {
   url: string;
+  binary?: boolean;  // 握手时优先请求二进制编码 (false 时只用 JSON，便于调试)
   onMessage?: (message: ServerMessage) => void;
   onConnect?: () => void;
   onDisconnect?: () => void;
@@ -13,7 +15,7 @@ interface UseWebSocketReturn {
   connected: boolean;
   send: (message: ClientMessage) => void;
   createRoom: () => void;
-  joinRoom: (roomId: string) => void;
+  joinRoom: (roomId: string, token?: string) => void;
   leaveRoom: () => void;
   ready: () => void;
   sendAction: (action: number, tile?: number) => void;
@@ -21,6 +23,7 @@ interface UseWebSocketReturn {
 
 export function useWebSocket({
   url,
+  binary = true,
   onMessage,
   onConnect,
   onDisconnect,
@@ -32,7 +35,9 @@ export function useWebSocket({
 
   const connect = useCallback(() => {
     try {
-      const ws = new WebSocket(url);
+      // 服务器在握手响应中选定子协议，之后按 ws.protocol 编解码
+      const ws = new WebSocket(url, binary ? [BINARY_PROTOCOL, JSON_PROTOCOL] : [JSON_PROTOCOL]);
+      ws.binaryType = 'arraybuffer';
 
       ws.onopen = () => {
         setConnected(true);
@@ -54,7 +59,9 @@ export function useWebSocket({
 
       ws.onmessage = (event) => {
         try {
-          const message: ServerMessage = JSON.parse(event.data);
+          const message: ServerMessage = event.data instanceof ArrayBuffer
+            ? decodeServerMessage(event.data)
+            : JSON.parse(event.data);
           onMessage?.(message);
         } catch (e) {
           console.error('Failed to parse message:', e);
@@ -65,7 +72,7 @@ export function useWebSocket({
     } catch (e) {
       console.error('WebSocket connection error:', e);
     }
-  }, [url, onMessage, onConnect, onDisconnect, onError]);
+  }, [url, binary, onMessage, onConnect, onDisconnect, onError]);
 
   useEffect(() => {
     connect();
@@ -79,8 +86,9 @@ export function useWebSocket({
   }, [connect]);
 
   const send = useCallback((message: ClientMessage) => {
-    if (wsRef.current?.readyState === WebSocket.OPEN) {
-      wsRef.current.send(JSON.stringify(message));
+    const ws = wsRef.current;
+    if (ws?.readyState === WebSocket.OPEN) {
+      ws.send(ws.protocol === BINARY_PROTOCOL ? encodeClientMessage(message) : JSON.stringify(message));
     }
   }, []);
 
@@ -88,8 +96,8 @@ export function useWebSocket({
     send({ type: MessageType.CreateRoom });
   }, [send]);
 
-  const joinRoom = useCallback((roomId: string) => {
-    send({ type: MessageType.JoinRoom, roomId });
+  const joinRoom = useCallback((roomId: string, token?: string) => {
+    send({ type: MessageType.JoinRoom, roomId, token });
   }, [send]);
 
   const leaveRoom = useCallback(() => {
@@ -0,0 +1,223 @@
+import { ClientMessage, GameState, MessageType, ServerMessage, StateEvent, StateEventKind, Wind } from './types';
+
+// WebSocket 子协议，与服务器 src/network/wire_protocol.h 一致
+export const JSON_PROTOCOL = 'mahjong.json';
+export const BINARY_PROTOCOL = 'mahjong.bin.1';
+const BINARY_VERSION = 1;
+
+// 按服务器 MessageType 的顺序
+const MESSAGE_TYPES: MessageType[] = [
+  MessageType.CreateRoom,
+  MessageType.JoinRoom,
+  MessageType.LeaveRoom,
+  MessageType.Ready,
+  MessageType.Action,
+  MessageType.RoomCreated,
+  MessageType.RoomJoined,
+  MessageType.PlayerJoined,
+  MessageType.PlayerLeft,
+  MessageType.GameStart,
+  MessageType.GameState,
+  MessageType.YourTurn,
+  MessageType.PlayerAction,
+  MessageType.GameEnd,
+  MessageType.Error,
+  MessageType.StateDelta,
+  MessageType.SyncRequest,
+];
+
+const ROOM_ID = 1 << 0;
+const SEAT = 1 << 1;
+const ACTION = 1 << 2;
+const TILE = 1 << 3;
+const TILES = 1 << 4;
+const ERROR = 1 << 5;
+const STATE = 1 << 6;
+const SEQ = 1 << 7;
+const EVENTS = 1 << 8;
+const TOKEN = 1 << 9;
+
+// 每种消息携带的字段
+const MESSAGE_FIELDS: number[] = [
+  0,                      // CreateRoom
+  ROOM_ID | TOKEN,        // JoinRoom
+  0,                      // LeaveRoom
+  0,                      // Ready
+  ACTION | TILE,          // Action
+  ROOM_ID | SEAT | TOKEN, // RoomCreated
+  ROOM_ID | SEAT | TOKEN, // RoomJoined
+  SEAT,                   // PlayerJoined
+  SEAT,                   // PlayerLeft
+  0,                      // GameStart
+  STATE | SEQ,            // GameState
+  SEAT | TILE | TILES,    // YourTurn
+  SEAT | ACTION | TILE,   // PlayerAction
+  SEAT | TILES,           // GameEnd
+  ERROR,                  // Error
+  SEQ | EVENTS,           // StateDelta
+  SEQ,                    // SyncRequest
+];
+
+const WINDS: Wind[] = ['east', 'south', 'west', 'north'];
+const HIDDEN_HAND = 0x80;
+
+class ByteReader {
+  private view: DataView;
+  private pos = 0;
+
+  constructor(buffer: ArrayBuffer) {
+    this.view = new DataView(buffer);
+  }
+
+  atEnd(): boolean {
+    return this.pos === this.view.byteLength;
+  }
+
+  u8(): number {
+    if (this.pos >= this.view.byteLength) throw new Error('truncated message');
+    return this.view.getUint8(this.pos++);
+  }
+
+  u16(): number {
+    const lo = this.u8();
+    return lo | (this.u8() << 8);
+  }
+
+  // 255 表示 -1
+  small(): number {
+    const b = this.u8();
+    return b === 255 ? -1 : b;
+  }
+
+  varint(): number {
+    let z = 0;
+    for (let shift = 0; shift < 35; shift += 7) {
+      const b = this.u8();
+      z += (b & 0x7f) * 2 ** shift;
+      if (!(b & 0x80)) {
+        return z % 2 === 0 ? z / 2 : -(z + 1) / 2;
+      }
+    }
+    throw new Error('varint overflow');
+  }
+
+  tiles(count: number): number[] {
+    const out: number[] = [];
+    for (let i = 0; i < count; ++i) out.push(this.small());
+    return out;
+  }
+
+  text(length: number): string {
+    if (this.pos + length > this.view.byteLength) throw new Error('truncated message');
+    const bytes = new Uint8Array(this.view.buffer, this.view.byteOffset + this.pos, length);
+    this.pos += length;
+    return new TextDecoder().decode(bytes);
+  }
+}
+
+function readState(r: ByteReader): GameState {
+  const roundWind = WINDS[r.small() & 3];
+  const dealer = r.small();
+  const currentPlayer = r.small();
+  const remainingTiles = r.small();
+  const honba = r.varint();
+  const riichiSticks = r.varint();
+  const scores = [r.varint(), r.varint(), r.varint(), r.varint()];
+  const flags = r.u16();
+
+  const hands: number[][] = [];
+  for (let i = 0; i < 4; ++i) {
+    const n = r.u8();
+    hands.push(n & HIDDEN_HAND ? new Array<number>(n & ~HIDDEN_HAND).fill(-1) : r.tiles(n));
+  }
+  const discards: number[][] = [];
+  for (let i = 0; i < 4; ++i) discards.push(r.tiles(r.u8()));
+
+  return {
+    roundWind,
+    dealer,
+    currentPlayer,
+    remainingTiles,
+    honba,
+    riichiSticks,
+    scores,
+    riichiStatus: [0, 1, 2, 3].map(i => (flags >> i & 1) === 1),
+    hands,
+    discards,
+    melds: [[], [], [], []],
+    canTsumo: (flags >> 4 & 1) === 1,
+    canRon: (flags >> 5 & 1) === 1,
+    canRiichi: (flags >> 6 & 1) === 1,
+    canChi: (flags >> 7 & 1) === 1,
+    canPon: (flags >> 8 & 1) === 1,
+    canKan: (flags >> 9 & 1) === 1,
+    lastDraw: r.small(),
+    lastDiscard: r.small(),
+    lastDiscardPlayer: r.small(),
+  };
+}
+
+function readEvents(r: ByteReader): StateEvent[] {
+  const events: StateEvent[] = [];
+  const count = r.u8();
+  for (let i = 0; i < count; ++i) {
+    const kind = r.u8();
+    if (kind > StateEventKind.Sticks) throw new Error('unknown event kind');
+    events.push({ kind, seat: r.small(), tile: r.small(), value: r.varint() });
+  }
+  return events;
+}
+
+// 解码服务器的二进制帧，格式错误时抛出异常
+export function decodeServerMessage(buffer: ArrayBuffer): ServerMessage {
+  const r = new ByteReader(buffer);
+  if (r.u8() !== BINARY_VERSION) throw new Error('unsupported version');
+  const index = r.u8();
+  if (index >= MESSAGE_TYPES.length) throw new Error('unknown message type');
+  const fields = MESSAGE_FIELDS[index];
+
+  const message: ServerMessage = { type: MESSAGE_TYPES[index] };
+  if (fields & ROOM_ID) message.roomId = r.text(r.u8());
+  if (fields & SEAT) message.seat = r.small();
+  if (fields & ACTION) message.action = r.small();
+  if (fields & TILE) message.tile = r.small();
+  if (fields & TILES) message.hand = r.tiles(r.u8());
+  if (fields & ERROR) message.errorMsg = r.text(r.u16());
+  if (fields & STATE) message.state = readState(r);
+  if (fields & SEQ) message.seq = r.varint();
+  if (fields & EVENTS) message.events = readEvents(r);
+  if (fields & TOKEN) message.token = r.text(r.u8());
+  if (!r.atEnd()) throw new Error('trailing bytes');
+  return message;
+}
+
+// 编码客户端消息为二进制帧
+export function encodeClientMessage(message: ClientMessage): Uint8Array {
+  const index = MESSAGE_TYPES.indexOf(message.type);
+  if (index < 0) throw new Error(`unknown message type ${message.type}`);
+  const fields = MESSAGE_FIELDS[index];
+
+  const bytes: number[] = [BINARY_VERSION, index];
+  const small = (v: number | undefined) => bytes.push(v === undefined || v < 0 ? 255 : v & 0xff);
+  if (fields & ROOM_ID) {
+    const id = new TextEncoder().encode(message.roomId ?? '').subarray(0, 255);
+    bytes.push(id.length, ...id);
+  }
+  if (fields & ACTION) small(message.action);
+  if (fields & TILE) small(message.tile);
+  if (fields & SEQ) {
+    // zigzag varint
+    const seq = message.seq ?? -1;
+    let z = seq < 0 ? -2 * seq - 1 : 2 * seq;
+    while (z >= 0x80) {
+      bytes.push((z % 0x80) | 0x80);
+      z = Math.floor(z / 0x80);
+    }
+    bytes.push(z);
+  }
+  if (fields & TOKEN) {
+    const token = new TextEncoder().encode(message.token ?? '').subarray(0, 255);
+    bytes.push(token.length, ...token);
+  }
+  return Uint8Array.from(bytes);
+}
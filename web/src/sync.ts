@@ -0,0 +1,56 @@
+import { GameState, StateEvent, StateEventKind } from './types';
+
+// 把增量事件应用到状态上，与服务器 applyStateEvent 一致
+// 返回新的状态对象；事件与状态对不上时返回 null，应重新请求快照
+export function applyStateEvents(state: GameState, events: StateEvent[]): GameState | null {
+  const next: GameState = {
+    ...state,
+    hands: state.hands.map(hand => [...hand]),
+    discards: state.discards.map(river => [...river]),
+    scores: [...state.scores],
+    riichiStatus: [...state.riichiStatus],
+  };
+
+  for (const event of events) {
+    if (event.kind === StateEventKind.Sticks) {
+      next.riichiSticks = event.value;
+      continue;
+    }
+    if (event.seat < 0 || event.seat >= 4) return null;
+    const hand = next.hands[event.seat];
+
+    switch (event.kind) {
+      case StateEventKind.Draw: {
+        // 手牌保持有序 (他家全是 -1)
+        const pos = hand.findIndex(tile => tile > event.tile);
+        hand.splice(pos < 0 ? hand.length : pos, 0, event.tile);
+        next.remainingTiles--;
+        next.currentPlayer = event.seat;
+        next.lastDraw = event.tile;
+        break;
+      }
+      case StateEventKind.Discard: {
+        let pos = hand.indexOf(event.tile);
+        if (pos < 0) pos = hand.indexOf(-1);
+        if (pos < 0) return null;
+        hand.splice(pos, 1);
+        next.discards[event.seat].push(event.tile);
+        next.lastDiscard = event.tile;
+        next.lastDiscardPlayer = event.seat;
+        break;
+      }
+      case StateEventKind.Call:
+        next.currentPlayer = event.seat;
+        break;
+      case StateEventKind.Riichi:
+        next.riichiStatus[event.seat] = true;
+        break;
+      case StateEventKind.Score:
+        next.scores[event.seat] = event.value;
+        break;
+      default:
+        return null;
+    }
+  }
+  return next;
+}
@@ -39,6 +39,25 @@ export enum MessageType {
   GameState = 'game_state',
   GameEnd = 'game_end',
   Error = 'error',
+  StateDelta = 'state_delta',
+  SyncRequest = 'sync_request',
+}
+
+// 增量同步的事件，与服务器 StateEventKind 一致
+export enum StateEventKind {
+  Draw = 0,     // seat 摸 tile (他家为 -1)
+  Discard = 1,  // seat 打出 tile
+  Call = 2,     // seat 以 value 动作鸣 tile
+  Riichi = 3,   // seat 立直
+  Score = 4,    // seat 点数变为 value
+  Sticks = 5,   // 立直棒变为 value
+}
+
+export interface StateEvent {
+  kind: StateEventKind;
+  seat: number;
+  tile: number;
+  value: number;
 }
 
 // 游戏状态
@@ -79,6 +98,9 @@ export interface ServerMessage {
   yaku?: string[];
   score?: number;
   errorMsg?: string;
+  seq?: number;            // GameState: 快照序号；StateDelta: 第一个事件的序号
+  events?: StateEvent[];
+  token?: string;          // RoomCreated / RoomJoined: 座位凭证，断线后凭它回到座位
 }
 
 // 客户端消息
@@ -87,6 +109,8 @@ export interface ClientMessage {
   roomId?: string;
   action?: number;
   tile?: number;
+  seq?: number;  // SyncRequest: 已有状态的序号 (-1 请求快照)
+  token?: string;  // JoinRoom: 对局中重新加入时的座位凭证
 }
 
 // 房间信息